@@ -24,12 +24,14 @@ in vec2 v_TexCoord;
 
 uniform sampler2D u_SceneTexture;
 uniform sampler2D u_BlurredTexture;
+uniform vec2 u_SceneUVScale = vec2(1.0); // Scene texture might be bigger than its rendered viewport
 uniform float u_BloomExposure = 1.0, u_HDRGamma = 2.2;
 uniform bool u_GammaCorrection = false, u_ToneMapping = false;
 
 void main()
 {
-    vec4 scene_color = texture(u_SceneTexture, v_TexCoord);
+    vec2 half_texel = 0.5 / textureSize(u_SceneTexture, 0);
+    vec4 scene_color = texture(u_SceneTexture, clamp(v_TexCoord * u_SceneUVScale, half_texel, u_SceneUVScale - half_texel));
     if(scene_color.a < 0.1)
 	{
 		color = scene_color;
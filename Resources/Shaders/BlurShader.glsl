@@ -25,28 +25,36 @@ in vec2 v_TexCoord;
 uniform sampler2D u_Texture;
 uniform bool u_HorizontalPass;
 uniform int u_BlurAmount = 5;
+uniform vec2 u_UVScale = vec2(1.0); // Texture might be bigger than its rendered viewport
 
 float Weights[5] = float[] (0.2270270270, 0.1945945946, 0.1216216216, 0.0540540541, 0.0162162162);
 
+// Taps clamped to the rendered area texels centers, as if it clamped to edge (the rest of the texture holds stale texels)
+vec3 SampleTap(vec2 uv, vec2 offset)
+{
+    return texture(u_Texture, clamp(uv, offset * 0.5, u_UVScale - offset * 0.5)).rgb;
+}
+
 void main()
 {
     vec2 offset = 1.0 / textureSize(u_Texture, 0);
-    vec3 res = texture(u_Texture, v_TexCoord).rgb * Weights[0];
+    vec2 tex_coords = v_TexCoord * u_UVScale;
+    vec3 res = SampleTap(tex_coords, offset) * Weights[0];
 
     if(u_HorizontalPass)
     {
         for(int i = 1; i < u_BlurAmount; ++i)
         {
-            res += texture(u_Texture, v_TexCoord + vec2(offset.x * i, 0.0)).rgb * Weights[i];
-            res += texture(u_Texture, v_TexCoord - vec2(offset.x * i, 0.0)).rgb * Weights[i];
+            res += SampleTap(tex_coords + vec2(offset.x * i, 0.0), offset) * Weights[i];
+            res += SampleTap(tex_coords - vec2(offset.x * i, 0.0), offset) * Weights[i];
         }
     }
     else
     {
         for(int i = 1; i < u_BlurAmount; ++i)
          {
-             res += texture(u_Texture, v_TexCoord + vec2(0.0, offset.y * i)).rgb * Weights[i];
-             res += texture(u_Texture, v_TexCoord - vec2(0.0, offset.y * i)).rgb * Weights[i];
+             res += SampleTap(tex_coords + vec2(0.0, offset.y * i), offset) * Weights[i];
+             res += SampleTap(tex_coords - vec2(0.0, offset.y * i), offset) * Weights[i];
          }
     }
 
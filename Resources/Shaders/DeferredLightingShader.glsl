@@ -44,76 +44,24 @@ in vec2 TexCoord;
 in vec3 CamPos;
 
 
-// --- Light Structs ---
-struct DirectionalLight
-{
-	vec3 Color, Direction;
-	float Intensity;	
-};
-
-struct PointLight // Pos & Color are vec4 to remember that they are aligned!
-{
-	vec4 Pos, Color;					// Pos & Color are vec4 due to alignment (to keep it in mind!)
-	float Intensity, AttK, AttL, AttQ;	// Attenuation: K constant, L linear, Q quadratic
-};
+// --- Lights ---
+#include "Include/Lights.glsl"
 
 
-// --- Lights Uniforms ---
+// --- GBuffer Uniforms ---
 uniform sampler2D u_gColor;
 uniform sampler2D u_gNormal;
 uniform sampler2D u_gPosition;
 uniform sampler2D u_gSmoothness;
+uniform vec2 u_gBufferUVScale = vec2(1.0); // GBuffer FBO might be bigger than its rendered viewport
 
-uniform DirectionalLight u_DirLight = DirectionalLight(vec3(1.0), vec3(1.0), 1.0);
-
-layout(std430, binding = 0) buffer ssb_Lights // PLights SSBO
-{
-	int CurrentLights;
-	PointLight PLightsVec[];
-};
-
-
-// ------------------------------------------ LIGHT CALCULATION ------------------------------------------
-vec3 CalculateDirectionalLight(vec3 normal, vec3 view, float mat_smoothness)
-{
-	// Direction & Distance
-	vec3 dir = normalize(u_DirLight.Direction);
-	vec3 halfway_dir = normalize(dir + view);
-
-	// Diffuse & Specular
-	float diff_impact = max(dot(normal, dir), 0.0);
-	float spec_impact = pow(max(dot(normal, halfway_dir), 0.0), mat_smoothness * 256.0);
-
-	// Final Impact
-	vec3 light_impact = u_DirLight.Color.rgb * u_DirLight.Intensity * (diff_impact + spec_impact);
-	return light_impact;
-}
-
-
-vec3 CalculateLighting(PointLight light, vec3 normal, vec3 view, vec3 frag_pos, float mat_smoothness)
-{
-	// Direction & Distance
-	vec3 pos_to_frag = light.Pos.xyz - frag_pos;
-	float dist = length(pos_to_frag);
-	vec3 dir = normalize(pos_to_frag);
-	vec3 halfway_dir = normalize(dir + view);
-
-	// Diffuse & Specular
-	float diff_impact = max(dot(normal, dir), 0.0);
-	float spec_impact = pow(max(dot(normal, halfway_dir), 0.0), mat_smoothness * 256.0); //MATERIAL SHININESS!
-
-	// Final Impact
-	float light_att = 1.0/(light.AttK + light.AttL * dist + light.AttQ * dist * dist);
-	vec3 light_impact = light.Color.rgb * light.Intensity * light_att * (diff_impact + spec_impact);
-	
-	return light_impact;
-}
 
 
 // ------------------------------------------------ MAIN -------------------------------------------------
 void main()
 {
-	vec4 albedo_color = texture(u_gColor, TexCoord);
+	vec2 gbuffer_coords = TexCoord * u_gBufferUVScale;
+	vec4 albedo_color = texture(u_gColor, gbuffer_coords);
 	if(albedo_color.a < 0.1)
 	{
 		color = albedo_color;
@@ -121,9 +69,9 @@ void main()
 	}
 
 	vec3 color_vec = albedo_color.rgb;
-	vec3 normal_vec = texture(u_gNormal, TexCoord).rgb;
-	vec3 frag_pos = texture(u_gPosition, TexCoord).rgb;
-	float mat_smoothness = texture(u_gSmoothness, TexCoord).r;
+	vec3 normal_vec = texture(u_gNormal, gbuffer_coords).rgb;
+	vec3 frag_pos = texture(u_gPosition, gbuffer_coords).rgb;
+	float mat_smoothness = texture(u_gSmoothness, gbuffer_coords).r;
 	
 	vec3 view_dir = normalize(CamPos - frag_pos);
 
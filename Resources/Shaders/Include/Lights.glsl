@@ -0,0 +1,60 @@
+// --- Light Structs ---
+struct DirectionalLight
+{
+	vec3 Color, Direction;
+	float Intensity;	
+};
+
+struct PointLight // Pos & Color are vec4 to remember that they are aligned!
+{
+	vec4 Pos, Color;					// Pos & Color are vec4 due to alignment (to keep it in mind!)
+	float Intensity, AttK, AttL, AttQ;	// Attenuation: K constant, L linear, Q quadratic
+};
+
+
+// --- Lights Uniforms ---
+uniform DirectionalLight u_DirLight = DirectionalLight(vec3(1.0), vec3(1.0), 1.0);
+
+layout(std430, binding = 0) buffer ssb_Lights // PLights SSBO
+{
+	int CurrentLights;
+	PointLight PLightsVec[];
+};
+
+
+
+// ------------------------------------------ LIGHT CALCULATION ------------------------------------------
+vec3 CalculateDirectionalLight(vec3 normal, vec3 view, float mat_smoothness)
+{
+	// Direction & Distance
+	vec3 dir = normalize(u_DirLight.Direction);
+	vec3 halfway_dir = normalize(dir + view);
+
+	// Diffuse & Specular
+	float diff_impact = max(dot(normal, dir), 0.0);
+	float spec_impact = pow(max(dot(normal, halfway_dir), 0.0), mat_smoothness * 256.0);
+
+	// Final Impact
+	vec3 light_impact = u_DirLight.Color.rgb * u_DirLight.Intensity * (diff_impact + spec_impact);
+	return light_impact;
+}
+
+
+vec3 CalculateLighting(PointLight light, vec3 normal, vec3 view, vec3 frag_pos, float mat_smoothness)
+{
+	// Direction & Distance
+	vec3 pos_to_frag = light.Pos.xyz - frag_pos;
+	float dist = length(pos_to_frag);
+	vec3 dir = normalize(pos_to_frag);
+	vec3 halfway_dir = normalize(dir + view);
+
+	// Diffuse & Specular
+	float diff_impact = max(dot(normal, dir), 0.0);
+	float spec_impact = pow(max(dot(normal, halfway_dir), 0.0), mat_smoothness * 256.0); //MATERIAL SHININESS!
+
+	// Final Impact
+	float light_att = 1.0/(light.AttK + light.AttL * dist + light.AttQ * dist * dist);
+	vec3 light_impact = light.Color.rgb * light.Intensity * light_att * (diff_impact + spec_impact);
+	
+	return light_impact;
+}
@@ -0,0 +1,107 @@
+// --- Material Struct & Uniform ---
+// Its features are compiled in by the shader keywords: HAS_NORMAL_MAP, HAS_PARALLAX, TWO_SIDED & ALPHA_TEST
+struct Material
+{
+	float Smoothness, Bumpiness, Heighscale, ParallaxLayers;
+	vec4 AlbedoColor;
+	vec4 AlbedoUVTransform;	// Rect in the albedo (scale & offset) if it's an atlas, clamped to it as the textures clamp to edge
+	float AlphaCutoff;		// Alpha tested fragments below it are discarded
+};
+
+uniform Material u_Material = Material(1.0, 1.0, 0.1, 32.0, vec4(1.0), vec4(1.0, 1.0, 0.0, 0.0), 0.5);
+uniform sampler2D u_Albedo;
+
+#ifdef HAS_NORMAL_MAP
+uniform sampler2D u_Normal;
+#endif
+
+#ifdef HAS_PARALLAX
+uniform sampler2D u_Bump;
+#endif
+
+
+
+// ------------------------------------------ RELIEF MAP CALCULATION -------------------------------------
+#ifdef HAS_PARALLAX
+vec2 CalculateParallaxMapping(vec2 tcoords, vec3 view)
+{
+	// 8 & 32 values are like the max & min depth layers for parallax, change it as you see fit
+	float layers_num = mix(u_Material.ParallaxLayers, 8.0, max(dot(vec3(0.0, 0.0, 1.0), view), 0.0));
+
+    // Layers Depth & TCoords Shift
+    float layer_depth = 1.0 / layers_num;
+    float current_layer_depth = 0.0;
+    vec2 P = view.xy * u_Material.Heighscale; // TODO: HEIGHT_SCALE!
+    vec2 tcoords_shift = P / layers_num;
+
+	// Perform Parallax Mapping
+	vec2  current_tcoords = tcoords;
+	float current_depth = texture(u_Bump, current_tcoords).r;
+
+	while(current_layer_depth < current_depth)
+	{
+	    // Move coordinates along P
+	    current_tcoords -= tcoords_shift;
+	    current_depth = texture(u_Bump, current_tcoords).r;
+	    current_layer_depth += layer_depth;  
+	}
+
+	// TCoords & Depth Before/After Collision (to interpolate)
+	vec2 prev_tcoords = current_tcoords + tcoords_shift;
+	float after_depth  = current_depth - current_layer_depth;
+	float before_depth = texture(u_Bump, prev_tcoords).r - current_layer_depth + layer_depth;
+	
+	// Interpolate TCoords
+	float weight = after_depth / (after_depth - before_depth);
+	vec2 ret = prev_tcoords * weight + current_tcoords * (1.0 - weight);
+	return ret;
+}
+#endif
+
+
+
+// ------------------------------------------ MATERIAL SAMPLING ------------------------------------------
+// Displaced by the relief map (view in tangent space)
+vec2 CalculateTexCoords(vec2 tcoords, vec3 view)
+{
+#ifdef HAS_PARALLAX
+	return CalculateParallaxMapping(tcoords, view);
+#else
+	return tcoords;
+#endif
+}
+
+
+vec4 CalculateAlbedo(vec2 tcoords)
+{
+	vec4 albedo = texture(u_Albedo, clamp(tcoords, 0.0, 1.0) * u_Material.AlbedoUVTransform.xy + u_Material.AlbedoUVTransform.zw) * u_Material.AlbedoColor;
+
+#ifdef ALPHA_TEST
+	if(albedo.a < u_Material.AlphaCutoff)
+		discard;
+#endif
+
+	return albedo;
+}
+
+
+// World normal, the vertex one without normal map, facing the camera on back faces if two sided
+vec3 CalculateNormal(vec2 tcoords, mat3 TBN)
+{
+#ifdef HAS_NORMAL_MAP
+	// Normal maps are BC5 (RG only), Z is reconstructed
+	vec3 normal_vec = vec3(texture(u_Normal, tcoords).rg * 2.0 - 1.0, 0.0);
+	normal_vec.z = sqrt(max(1.0 - dot(normal_vec.xy, normal_vec.xy), 0.0));
+	normal_vec.z *= u_Material.Bumpiness;
+	normal_vec = normalize(TBN * normal_vec);
+#else
+	vec3 normal_vec = normalize(TBN[2]);
+#endif
+
+#ifdef TWO_SIDED
+	if(!gl_FrontFacing)
+		normal_vec = -normal_vec;
+#endif
+
+	return normal_vec;
+}
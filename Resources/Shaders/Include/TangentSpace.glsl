@@ -0,0 +1,15 @@
+// --- Tangent Space ---
+// a_Tangent.w is the bitangent handedness in glTF meshes (vec4 tangents), 1 in the ones with vec3 tangents (GL fills w), which
+// give their bitangent instead: its direction flips the handedness (a_Bitangent is zero if the mesh has none)
+mat3 CalculateTBN(mat4 model, vec3 normal, vec4 tangent, vec3 bitangent)
+{
+	vec3 T = normalize(vec3(model * vec4(tangent.xyz, 0.0)));
+	vec3 N = normalize(vec3(model * vec4(normal, 0.0)));
+
+	T = normalize(T - dot(T, N)*N); // Re-orthogonalize
+	vec3 B = cross(N, T) * (tangent.w < 0.0 ? -1.0 : 1.0);
+	if(dot(B, vec3(model * vec4(bitangent, 0.0))) < 0.0)
+		B = -B;
+
+	return mat3(T, B, N);
+}
@@ -0,0 +1,93 @@
+#type COMPUTE_SHADER
+#version 460 core
+
+// Culls the meshlets of a draw (frustum & normal cone) and appends a DrawElementsIndirectCommand for each visible one
+// A thread per meshlet, the commands of the draw are compacted at u_FirstCommand and counted in Counts[1 + u_DrawSlot]
+layout(local_size_x = 64) in;
+
+// --- Camera UBO ---
+layout(std140, binding = 0) uniform ub_CameraData
+{
+	mat4 ViewProjection;
+	vec3 CamPosition;
+};
+
+// --- Meshlets (Meshlet struct in Mesh.h) ---
+struct Meshlet
+{
+	vec4 Sphere;	// Center (xyz) & radius (w), in the mesh space
+	vec4 Cone;		// Axis (xyz) & cutoff (w)
+	uvec4 Range;	// First index & index count, relative to the draw range (zw are padding)
+};
+
+layout(std430, binding = 1) readonly buffer sb_Meshlets
+{
+	Meshlet Meshlets[];
+};
+
+// --- Output ---
+struct DrawCommand
+{
+	uint Count;
+	uint InstanceCount;
+	uint FirstIndex;
+	int BaseVertex;
+	uint BaseInstance;
+};
+
+layout(std430, binding = 2) writeonly buffer sb_Commands
+{
+	DrawCommand Commands[];
+};
+
+layout(std430, binding = 3) buffer sb_Counts
+{
+	uint Counts[];	// [0] is the meshlets drawn in the frame (statistics), then the commands count of each draw
+};
+
+// --- Uniforms ---
+uniform mat4 u_Model = mat4(1.0);
+uniform float u_ModelScale = 1.0;	// Largest axis scale of the model matrix
+uniform int u_MeshletsCount = 0;
+uniform int u_FirstIndex = 0;
+uniform int u_FirstCommand = 0;
+uniform int u_DrawSlot = 0;
+uniform bool u_ConeCulling = true;	// Off for two-sided materials & transforms not keeping the normals (mirrors, non-uniform scales)
+
+
+// --- MAIN ---
+void main()
+{
+	uint meshlet_index = gl_GlobalInvocationID.x;
+	if (meshlet_index >= uint(u_MeshletsCount))
+		return;
+
+	Meshlet meshlet = Meshlets[meshlet_index];
+	vec3 center = (u_Model * vec4(meshlet.Sphere.xyz, 1.0)).xyz;
+	float radius = meshlet.Sphere.w * u_ModelScale;
+
+	// -- Frustum --
+	// Planes from the view-projection rows (Gribb & Hartmann), unnormalized so the radius is scaled by their normals length instead
+	mat4 rows = transpose(ViewProjection);
+	for (int i = 0; i < 3; ++i)
+	{
+		vec4 min_plane = rows[3] + rows[i], max_plane = rows[3] - rows[i];
+		if (dot(min_plane.xyz, center) + min_plane.w < -radius * length(min_plane.xyz) || dot(max_plane.xyz, center) + max_plane.w < -radius * length(max_plane.xyz))
+			return;
+	}
+
+	// -- Normal Cone --
+	// Backfacing if all its triangles face away from the camera, seen from any point of the bounding sphere
+	if (u_ConeCulling && meshlet.Cone.w < 1.0)
+	{
+		vec3 axis = normalize(mat3(u_Model) * meshlet.Cone.xyz);
+		vec3 view = center - CamPosition;
+		if (dot(view, axis) >= meshlet.Cone.w * length(view) + radius)
+			return;
+	}
+
+	// -- Append Command --
+	uint command_index = atomicAdd(Counts[1 + u_DrawSlot], 1);
+	Commands[u_FirstCommand + command_index] = DrawCommand(meshlet.Range.y, 1, uint(u_FirstIndex) + meshlet.Range.x, 0, 0);
+	atomicAdd(Counts[0], 1);
+}
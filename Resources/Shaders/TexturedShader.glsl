@@ -1,3 +1,4 @@
+#keywords HAS_NORMAL_MAP HAS_PARALLAX TWO_SIDED ALPHA_TEST
 #type VERTEX_SHADER
 #version 460 core
 
@@ -5,7 +6,7 @@
 layout(location = 0) in vec3 a_Position;
 layout(location = 1) in vec2 a_TexCoord;
 layout(location = 2) in vec3 a_Normal;
-layout(location = 3) in vec3 a_Tangent;
+layout(location = 3) in vec4 a_Tangent;
 layout(location = 4) in vec3 a_Bitangent;
 
 // --- Interface Block ---
@@ -30,6 +31,9 @@ layout(std140, binding = 0) uniform ub_CameraData
 // --- Uniforms ---
 uniform mat4 u_Model = mat4(1.0);
 
+// --- Tangent Space ---
+#include "Include/TangentSpace.glsl"
+
 // --- MAIN ---
 void main()
 {
@@ -40,13 +44,7 @@ void main()
 	v_VertexData.Normal = transpose(inverse(mat3(u_Model))) * a_Normal;
 	v_VertexData.CamPos = CamPosition;
 
-	vec3 T = normalize(vec3(u_Model * vec4(a_Tangent, 0.0)));
-	vec3 N = normalize(vec3(u_Model * vec4(a_Normal, 0.0)));
-
-	T = normalize(T - dot(T, N)*N); // Re-orthogonalize
-	vec3 B = cross(N, T);
-
-	mat3 TBN = mat3(T, B, N);
+	mat3 TBN = CalculateTBN(u_Model, a_Normal, a_Tangent, a_Bitangent);
 	v_VertexData.TBN = TBN;
 	
 	v_VertexData.Tg_CamPos = TBN * CamPosition;
@@ -81,65 +79,17 @@ in IBlock
 	vec3 Tg_FragPos;
 } v_VertexData;
 
-// --- Uniforms ---
-struct Material
-{
-	float Smoothness, Bumpiness, Heighscale, ParallaxLayers;
-	vec4 AlbedoColor;
-};
-
-uniform Material u_Material = Material(1.0, 1.0, 0.1, 32.0, vec4(1.0));
-uniform sampler2D u_Albedo, u_Normal, u_Bump;
-
-
-
-// ------------------------------------------ RELIEF MAP CALCULATION -------------------------------------
-vec2 CalculateParallaxMapping(vec2 tcoords, vec3 view)
-{
-	// 8 & 32 values are like the max & min depth layers for parallax, change it as you see fit
-	float layers_num = mix(u_Material.ParallaxLayers, 8.0, max(dot(vec3(0.0, 0.0, 1.0), view), 0.0));
-
-    // Layers Depth & TCoords Shift
-    float layer_depth = 1.0 / layers_num;
-    float current_layer_depth = 0.0;
-    vec2 P = view.xy * u_Material.Heighscale; // TODO: HEIGHT_SCALE!
-    vec2 tcoords_shift = P / layers_num;
-
-	// Perform Parallax Mapping
-	vec2  current_tcoords = tcoords;
-	float current_depth = texture(u_Bump, current_tcoords).r;
-
-	while(current_layer_depth < current_depth)
-	{
-	    // Move coordinates along P
-	    current_tcoords -= tcoords_shift;
-	    current_depth = texture(u_Bump, current_tcoords).r;
-	    current_layer_depth += layer_depth;  
-	}
-
-	// TCoords & Depth Before/After Collision (to interpolate)
-	vec2 prev_tcoords = current_tcoords + tcoords_shift;
-	float after_depth  = current_depth - current_layer_depth;
-	float before_depth = texture(u_Bump, prev_tcoords).r - current_layer_depth + layer_depth;
-	
-	// Interpolate TCoords
-	float weight = after_depth / (after_depth - before_depth);
-	vec2 ret = prev_tcoords * weight + current_tcoords * (1.0 - weight);
-	return ret;
-}
+// --- Material ---
+#include "Include/Material.glsl"
 
 // --- MAIN ---
 void main()
 {
 	vec3 view_dir = normalize(v_VertexData.Tg_CamPos - v_VertexData.Tg_FragPos);
-	vec2 tex_coords = CalculateParallaxMapping(v_VertexData.TexCoord, view_dir);
-
-	vec3 normal_vec = texture(u_Normal, tex_coords).rgb;
-	normal_vec = normal_vec * 2.0 - 1.0;
-	normal_vec.z *= u_Material.Bumpiness;
-	normal_vec = normalize(v_VertexData.TBN * normal_vec);
+	vec2 tex_coords = CalculateTexCoords(v_VertexData.TexCoord, view_dir);
+	vec3 normal_vec = CalculateNormal(tex_coords, v_VertexData.TBN);
 
-	gBuff_Color = texture(u_Albedo, tex_coords) * u_Material.AlbedoColor;
+	gBuff_Color = CalculateAlbedo(tex_coords);
 	gBuff_Normal = vec4(normal_vec, 1.0);
 	gBuff_Position = vec4(v_VertexData.FragPos, 1.0);
 	gBuff_Smoothness = vec4(vec3(u_Material.Smoothness), 1.0);
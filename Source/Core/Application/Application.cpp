@@ -1,7 +1,12 @@
 #include "Application.h"
 
 #include "Core/Platform/Input.h"
+#include "Core/Resources/AssetPack.h"
+#include "Core/Resources/Resources.h"
+#include "Core/Utils/FileStringUtils.h"
+#include "Core/Utils/JobSystem.h"
 #include "Renderer/Renderer.h"
+#include "Renderer/Resources/TextureLoader.h"
 
 // --- Testing Layer ---
 #include "Sandbox.h"
@@ -36,7 +41,14 @@ Application::Application(const std::string& name, uint window_width, uint window
 	ASSERT(!s_ApplicationInstance, "An Instance of the Application alrady exists!");
 	s_ApplicationInstance = this;
 
+    // -- Asset Packs --
+    // If there's a packed build of the assets, they are read from it instead of from the loose files
+    FileUtils::MountAssetPack(AssetPack::s_DefaultFilepath);
+
     // -- Initializations --
+	ENGINE_LOG("--- Initializing Job System ---");
+	JobSystem::Init();
+
 	ENGINE_LOG("--- Initializing Application Window ---");
 	m_AppWindow = CreateUnique<Window>(window_width, window_height, name);
 	m_AppWindow->Init();
@@ -64,6 +76,10 @@ Application::~Application()
     Renderer::Shutdown();
     Resources::CleanUp();
     delete m_ImGuiLayer;
+
+    JobSystem::Shutdown();
+
+    FileUtils::UnmountAssetPacks();
 }
 
 void Application::OnWindowResize(uint width, uint height)
@@ -95,6 +111,12 @@ void Application::Update()
         // -- Clear Input State --
         Input::ResetInput();
 
+        // -- Async Texture Uploads --
+        TextureLoader::Update();
+
+        // -- GPU Memory Budget --
+        Resources::Update();
+
         // -- Scene Update (Render) --
         s_Sandbox->OnUpdate(m_DeltaTime);
 
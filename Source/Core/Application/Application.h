@@ -6,6 +6,8 @@
 #include "Core/Platform/Window.h"
 #include "Core/Platform/ImGuiLayer.h"
 
+#include <atomic>
+
 
 // --- Main Declaration, Defined on Main ---
 int main(int argc, char** argv);
@@ -17,17 +19,22 @@ class MemoryMetrics
 {
 public:
 
+	MemoryMetrics() = default;
+	MemoryMetrics(const MemoryMetrics& metrics) { *this = metrics; }
+	MemoryMetrics& operator=(const MemoryMetrics& metrics) { m_TotalAllocated = metrics.GetAllocations(); m_TotalFreed = metrics.GetDeallocations(); return *this; }
+
 	uint GetAllocations()			const { return m_TotalAllocated; }
 	uint GetDeallocations()			const { return m_TotalFreed; }
 	uint GetCurrentMemoryUsage()	const { return m_TotalAllocated - m_TotalFreed; }
 
-	void AddAllocation(uint size)	const { m_TotalAllocated += size; }
-	void AddDeallocation(uint size)	const { m_TotalFreed += size; }
+	// Atomic since worker threads allocate too
+	void AddAllocation(uint size)	const { m_TotalAllocated.fetch_add(size, std::memory_order_relaxed); }
+	void AddDeallocation(uint size)	const { m_TotalFreed.fetch_add(size, std::memory_order_relaxed); }
 
 private:
 
-	mutable uint m_TotalAllocated = 0;
-	mutable uint m_TotalFreed = 0;
+	mutable std::atomic<uint> m_TotalAllocated = { 0 };
+	mutable std::atomic<uint> m_TotalFreed = { 0 };
 };
 
 
@@ -60,7 +60,7 @@ namespace EditorUI
 	}
 
 
-	static void DrawTextureButton(Ref<Texture>& texture, const char* texture_name, ImVec2 btn_size, uint meshindex_uitexturebtn, uint texturebtn_number, float sameline_width = 0.0f)
+	static void DrawTextureButton(Ref<Texture>& texture, const char* texture_name, ImVec2 btn_size, uint meshindex_uitexturebtn, uint texturebtn_number, float sameline_width = 0.0f, TEXTURE_USAGE usage = TEXTURE_USAGE::COLOR)
 	{
 		std::string label = "###texture_" + std::string(texture_name) + "_btn";		
 		uint id = texture == nullptr ? 0 : texture->GetTextureID();
@@ -83,7 +83,7 @@ namespace EditorUI
 		{
 			std::string texture_file = FileUtils::FileDialogs::OpenFile("Any Texture (*.png;*.jpg)\0*.png;*.jpg\0PNG Texture (*.png)\0*.png\0JPG Texture (*.jpg)\0*.jpg\0");
 			if (!texture_file.empty())
-				texture = Resources::CreateTexture(texture_file);
+				texture = Resources::CreateTexture(texture_file, usage);
 		}
 		
 		ImGui::SameLine();
@@ -7,6 +7,8 @@
 #include "Renderer/Renderer.h"
 #include "Renderer/Utils/RenderCommand.h"
 #include "Renderer/Utils/RendererPrimitives.h"
+#include "Renderer/Resources/TextureLoader.h"
+#include "Renderer/Utils/GPUMemory.h"
 
 #include "EditorUI.h"
 
@@ -60,32 +62,47 @@ void Sandbox::Init()
     m_EngineCamera.SetOrientation(0.24f, -0.41f);
 
 
-    // -- Models Setup --
-    Ref<Model> bandit_model = Resources::CreateModel("Resources/Models/TWTODBandit/Bandit_ToTest.obj");
-    bandit_model->GetTransformation().Scale = glm::vec3(0.1f);
-
-    Ref<Model> patrick_model = Resources::CreateModel("Resources/Models/Patrick/Patrick.obj");
-    patrick_model->GetTransformation().Translation = glm::vec3(-3.5f, 3.5f, 3.5f);
-    patrick_model->GetTransformation().Scale = glm::vec3(1.0f);
-    
-    Ref<Model> patrick_model2 = Resources::CreateModel(patrick_model, "Patrick2");
-    patrick_model2->GetTransformation().Translation = glm::vec3(3.5f);
-
-    Ref<Model> plane_model = Resources::CreateModel("Resources/Models/Plane/Plane_Ground.obj");
-    plane_model->GetTransformation().Scale = glm::vec3(0.1f);
-
-    m_SceneModels.push_back(plane_model);
-    m_SceneModels.push_back(bandit_model);
-    m_SceneModels.push_back(patrick_model);
-    m_SceneModels.push_back(patrick_model2);
-
     // -- Shaders --
+    // From their binary caches on warm starts, otherwise submitted up front so the driver compiles them while the models load
+    Timer shaders_timer;
+    shaders_timer.Start();
     m_SkyboxShader = CreateRef<Shader>("Resources/Shaders/SkyboxShader.glsl");
     m_TextureShader = CreateRef<Shader>("Resources/Shaders/TexturedShader.glsl");
     m_LightingShader = CreateRef<Shader>("Resources/Shaders/LightingShader.glsl");
     m_DeferredLightingShader = CreateRef<Shader>("Resources/Shaders/DeferredLightingShader.glsl");
     m_BlurShader = CreateRef<Shader>("Resources/Shaders/BlurShader.glsl");
     m_FinalBloomShader = CreateRef<Shader>("Resources/Shaders/BloomEffectShader.glsl");
+    ENGINE_LOG("Scene shaders submitted in %.2f ms (%i compiling)", shaders_timer.GetMilliseconds(), Shader::GetCompilingCount());
+
+
+    // -- Models Setup --
+    // Loaded concurrently, so the startup takes about as long as the biggest one
+    Timer models_timer;
+    models_timer.Start();
+
+    std::vector<Ref<Model>> models = Resources::FinishModels(Resources::CreateModelsAsync({ "Resources/Models/TWTODBandit/Bandit_ToTest.obj",
+        "Resources/Models/Patrick/Patrick.obj", "Resources/Models/Plane/Plane_Ground.obj" }));
+
+    ENGINE_LOG("Scene models loaded in %.2f ms", models_timer.GetMilliseconds());
+
+    // Small albedos (like Patrick's) into shared atlases, baked once into the cache
+    Resources::BakeTextureAtlases();
+
+    Ref<Model> bandit_model = models[0], patrick_model = models[1], plane_model = models[2];
+    Ref<Model> patrick_model2 = Resources::CreateModel(patrick_model, "Patrick2");
+
+    // -- Scene Entities --
+    TransformComponent transform = {};
+    transform.Scale = glm::vec3(0.1f);
+    CreateModelEntity(plane_model, transform, true);
+    CreateModelEntity(bandit_model, transform);
+
+    transform.Translation = glm::vec3(-3.5f, 3.5f, 3.5f);
+    transform.Scale = glm::vec3(1.0f);
+    CreateModelEntity(patrick_model, transform);
+
+    transform.Translation = glm::vec3(3.5f);
+    CreateModelEntity(patrick_model2, transform);
 
     // -- Framebuffer --
     m_EditorFramebuffer = CreateRef<Framebuffer>(new Framebuffer(WINDOW_WIDTH, WINDOW_HEIGHT,
@@ -144,8 +161,12 @@ void Sandbox::OnUpdate(float dt)
         }
     }
 
-    // -- Camera Update --
+    m_EditorFramebuffer->UpdateDeferredShrink();
+
+    // -- Camera & Scene Update --
     m_EngineCamera.OnUpdate(dt, (m_ViewportFocused || m_ViewportHovered));
+    m_RenderScene.Update(m_Scene);
+    m_RenderScene.Cull(m_Scene, m_EngineCamera.GetCamera().GetViewProjection());
 
     // -- Measure Rendering --
     if (rendering_measure)
@@ -166,6 +187,7 @@ void Sandbox::OnUpdate(float dt)
     m_EditorFramebuffer->Bind();
     Renderer::ClearRenderer();
     Renderer::SetSceneData(m_EngineCamera.GetCamera().GetViewProjection(), m_EngineCamera.GetPosition());
+    Renderer::SetSceneLights(m_Scene);
 
     Ref<Shader> shader = m_TextureShader;
     bool set_directionals = false;
@@ -183,12 +205,11 @@ void Sandbox::OnUpdate(float dt)
     Renderer::BeginScene(shader, set_directionals);
     
     // Draw Calls
-    for (auto& model : m_SceneModels)
-        Renderer::SubmitModel(shader, model);
+    Renderer::SubmitScene(shader, m_RenderScene);
 
     // Draw Lights Spheres
     if (m_DrawLightsSpheres)
-        Renderer::DrawLightsSpheres(shader);
+        Renderer::DrawLightsSpheres(shader, m_Scene);
 
     // End Scene
     Renderer::EndScene(shader);    
@@ -205,30 +226,11 @@ void Sandbox::OnUpdate(float dt)
         if (m_RenderSkybox)
             RenderSkybox();
 
-        Renderer::BeginScene(m_DeferredLightingShader, true);
+        // Lighting waits for its shader to be linked (the fallback program would draw a flat quad over the frame), which stays cleared meanwhile
+        m_DeferredLightingShader->UpdateCompilation();
+        if (m_DeferredLightingShader->IsReady())
+            RenderDeferredLighting();
 
-        // Attach & Send GBuffer Textures
-        RenderCommand::AttachDeferredTexture(m_EditorFramebuffer->GetFBOTextureID(0), 0);
-        RenderCommand::AttachDeferredTexture(m_EditorFramebuffer->GetFBOTextureID(1), 1);
-        RenderCommand::AttachDeferredTexture(m_EditorFramebuffer->GetFBOTextureID(2), 2);
-        RenderCommand::AttachDeferredTexture(m_EditorFramebuffer->GetFBOTextureID(3), 3);
-
-        m_DeferredLightingShader->SetUniformInt("u_gColor", 0);
-        m_DeferredLightingShader->SetUniformInt("u_gNormal", 1);
-        m_DeferredLightingShader->SetUniformInt("u_gPosition", 2);
-        m_DeferredLightingShader->SetUniformInt("u_gSmoothness", 3);
-
-        // Draw Deferred Quad
-        Renderer::Submit(m_DeferredLightingShader, m_QuadArray);
-
-        // Detach GBuffer Textures
-        RenderCommand::DettachDeferredTexture();
-        RenderCommand::DettachDeferredTexture();
-        RenderCommand::DettachDeferredTexture();
-        RenderCommand::DettachDeferredTexture();
-
-        // End Scene
-        Renderer::EndScene(m_DeferredLightingShader);
         m_DeferredFramebuffer->Unbind();
     }
 
@@ -240,10 +242,15 @@ void Sandbox::OnUpdate(float dt)
     }
 
     // Blur
-    if (m_BloomActive)
+    // Waits for its shaders too, the viewport shows the frame without bloom meanwhile
+    m_BlurShader->UpdateCompilation();
+    m_FinalBloomShader->UpdateCompilation();
+    m_BloomDrawn = m_BloomActive && m_BlurShader->IsReady() && m_FinalBloomShader->IsReady();
+    if (m_BloomDrawn)
     {
         bool horizontal = true, first_iteration = true;
         uint texture_to_use = m_DeferredRendering ? m_DeferredFramebuffer->GetFBOTextureID(1) : m_EditorFramebuffer->GetFBOTextureID(1);
+        glm::vec2 scene_uv_scale = m_DeferredRendering ? m_DeferredFramebuffer->GetUVScale() : m_EditorFramebuffer->GetUVScale();
 
         m_BlurShader->Bind();
         m_BlurShader->SetUniformInt("u_BlurAmount", m_BloomBlurAmount);
@@ -252,6 +259,7 @@ void Sandbox::OnUpdate(float dt)
         {
             m_BlurPingPongFramebuffer[horizontal]->Bind();
             m_BlurShader->SetUniformInt("u_HorizontalPass", horizontal);
+            m_BlurShader->SetUniformVec2("u_UVScale", first_iteration ? scene_uv_scale : m_BlurPingPongFramebuffer[!horizontal]->GetUVScale());
 
             glBindTexture(GL_TEXTURE_2D, first_iteration ? texture_to_use : m_BlurPingPongFramebuffer[!horizontal]->GetFBOTextureID());
 
@@ -280,6 +288,7 @@ void Sandbox::OnUpdate(float dt)
         m_FinalBloomShader->SetUniformFloat("u_HDRGamma", m_BloomHDRGamma);
         m_FinalBloomShader->SetUniformInt("u_GammaCorrection", m_GammaCorrection);
         m_FinalBloomShader->SetUniformInt("u_ToneMapping", m_ToneMapping);
+        m_FinalBloomShader->SetUniformVec2("u_SceneUVScale", scene_uv_scale);
         Renderer::Submit(m_FinalBloomShader, m_QuadArray);
 
         m_FinalBloomShader->Unbind();
@@ -288,8 +297,54 @@ void Sandbox::OnUpdate(float dt)
 }
 
 
+Entity Sandbox::CreateModelEntity(const Ref<Model>& model, const TransformComponent& transform, bool is_static)
+{
+    // Bounds are filled by the RenderScene from the model draws
+    Entity entity = m_Scene.Create();
+    m_Scene.Emplace<TransformComponent>(entity, transform);
+    m_Scene.Emplace<ModelComponent>(entity, model, is_static);
+    m_Scene.Emplace<BoundsComponent>(entity);
+    return entity;
+}
+
+
+void Sandbox::RenderDeferredLighting()
+{
+    Renderer::BeginScene(m_DeferredLightingShader, true);
+
+    // Attach & Send GBuffer Textures
+    RenderCommand::AttachDeferredTexture(m_EditorFramebuffer->GetFBOTextureID(0), 0);
+    RenderCommand::AttachDeferredTexture(m_EditorFramebuffer->GetFBOTextureID(1), 1);
+    RenderCommand::AttachDeferredTexture(m_EditorFramebuffer->GetFBOTextureID(2), 2);
+    RenderCommand::AttachDeferredTexture(m_EditorFramebuffer->GetFBOTextureID(3), 3);
+
+    m_DeferredLightingShader->SetUniformInt("u_gColor", 0);
+    m_DeferredLightingShader->SetUniformInt("u_gNormal", 1);
+    m_DeferredLightingShader->SetUniformInt("u_gPosition", 2);
+    m_DeferredLightingShader->SetUniformInt("u_gSmoothness", 3);
+    m_DeferredLightingShader->SetUniformVec2("u_gBufferUVScale", m_EditorFramebuffer->GetUVScale());
+
+    // Draw Deferred Quad
+    Renderer::Submit(m_DeferredLightingShader, m_QuadArray);
+
+    // Detach GBuffer Textures
+    RenderCommand::DettachDeferredTexture();
+    RenderCommand::DettachDeferredTexture();
+    RenderCommand::DettachDeferredTexture();
+    RenderCommand::DettachDeferredTexture();
+
+    // End Scene
+    Renderer::EndScene(m_DeferredLightingShader);
+}
+
+
 void Sandbox::RenderSkybox()
 {
+    // The fallback program would draw the cube flat, so no sky until its shader is linked
+    m_SkyboxShader->UpdateCompilation();
+    if (!m_SkyboxShader->IsReady())
+        return;
+
     RenderCommand::SetCubemapSeamless(true);
     glDepthFunc(GL_LEQUAL);
 
@@ -329,8 +384,9 @@ void Sandbox::OnUIRender(float dt)
     ImVec2 viewportpanel_size = ImGui::GetContentRegionAvail();
     static uint gbtexture_index = 0;
     
+    glm::vec2 editor_uv = m_EditorFramebuffer->GetUVScale();
     if (m_DeferredRendering)
-        ImGui::Image((ImTextureID)(m_EditorFramebuffer->GetFBOTextureID(gbtexture_index)), viewportpanel_size, ImVec2(0, 1), ImVec2(1, 0));
+        ImGui::Image((ImTextureID)(m_EditorFramebuffer->GetFBOTextureID(gbtexture_index)), viewportpanel_size, ImVec2(0, editor_uv.y), ImVec2(editor_uv.x, 0));
     else
     {
         std::string text = "Deferred Rendering Needs to be Active to Display the GBuffer!";
@@ -365,14 +421,14 @@ void Sandbox::OnUIRender(float dt)
         ImGui::Image((ImTextureID)(m_BlurPingPongFramebuffer[1]->GetFBOTextureID()), viewportpanel_size, ImVec2(0, 1), ImVec2(1, 0));
     else
     {
-        if (m_BloomActive)
+        if (m_BloomDrawn)
             ImGui::Image((ImTextureID)(m_BlurFinalFramebuffer->GetFBOTextureID()), viewportpanel_size, ImVec2(0, 1), ImVec2(1, 0));
         else
         {
             if (m_DeferredRendering)
                 ImGui::Image((ImTextureID)(m_DeferredFramebuffer->GetFBOTextureID(displaytexture_index)), viewportpanel_size, ImVec2(0, 1), ImVec2(1, 0));
             else
-                ImGui::Image((ImTextureID)(m_EditorFramebuffer->GetFBOTextureID(displaytexture_index)), viewportpanel_size, ImVec2(0, 1), ImVec2(1, 0));
+                ImGui::Image((ImTextureID)(m_EditorFramebuffer->GetFBOTextureID(displaytexture_index)), viewportpanel_size, ImVec2(0, editor_uv.y), ImVec2(editor_uv.x, 0));
         }
     }
 
@@ -416,11 +472,29 @@ void Sandbox::OnUIRender(float dt)
     ImGui::Text("Graphics Card:     %s", stats.GraphicsCard.c_str()); ImGui::NewLine();
     ImGui::Text("OpenGL Version:    %i.%i (%s)", stats.OGL_MajorVersion, stats.OGL_MinorVersion, stats.GLVersion.c_str()); ImGui::NewLine();
     ImGui::Text("Shading Version:   GLSL %s", stats.GLShadingVersion.c_str()); ImGui::NewLine();
+    ImGui::Text("FBO Reallocations: %i", stats.FBOReallocations); ImGui::NewLine();
+    ImGui::Text("Draw Calls:        %i (%i scene draws, %i culled)", stats.DrawCalls, stats.SceneDraws, stats.CulledDraws); ImGui::NewLine();
+    ImGui::Text("Texture Binds:     %i", stats.TextureBinds); ImGui::NewLine();
+    ImGui::Text("Meshlets:          %i drawn of %i in the scene", stats.DrawnMeshlets, stats.SceneMeshlets); ImGui::NewLine();
+    ImGui::Text("Static Batches:    %i meshes in %i draws", m_RenderScene.GetStaticMeshesCount(), m_RenderScene.GetStaticDrawsCount()); ImGui::NewLine();
+    ImGui::Text("Compiling Shaders: %i", Shader::GetCompilingCount());
+    ImGui::Text("Scene Shader Variants: %i forward, %i deferred", m_LightingShader->GetVariantsCount(), m_TextureShader->GetVariantsCount()); ImGui::NewLine();
+    ImGui::Text("Pending Textures:  %i (%.2f MB uploaded last frame)", TextureLoader::GetPendingTexturesCount(), (float)TextureLoader::GetUploadedBytesLastFrame() / MBTOBYTE(1.0f)); ImGui::NewLine();
+    ImGui::Text("Streamed Textures: %.2f / %.2f MB", (float)TextureLoader::GetStreamedBytes() / MBTOBYTE(1.0f), (float)TextureLoader::GetStreamingBudget() / MBTOBYTE(1.0f)); ImGui::NewLine();
     ImGui::PopTextWrapPos();
+
+    int streaming_budget = (int)((float)TextureLoader::GetStreamingBudget() / MBTOBYTE(1));
+    ImGui::SetNextItemWidth(ImGui::GetContentRegionAvailWidth() * 0.5f);
+    if (ImGui::DragInt("Textures Budget (MB)", &streaming_budget, 4.0f, 16, 8192))
+        TextureLoader::SetStreamingBudget((uint64)(streaming_budget * MBTOBYTE(1)));
     
     ImGui::Separator();
     ImGui::NewLine();
     ImGui::Checkbox("Draw Light Spheres", &m_DrawLightsSpheres);
+
+    bool meshlets_culling = Renderer::IsMeshletsCullingEnabled();
+    if (ImGui::Checkbox("GPU Meshlets Culling", &meshlets_culling))
+        Renderer::SetMeshletsCulling(meshlets_culling);
     //ImGui::NewLine();
     //ImGui::Text("Last Measured Deferred Rendering: %.2f ms", m_DefRendTimer.GetMilliseconds());
     //ImGui::Text("Last Measured Forward Rendering: %.2f ms", m_FwRendTimer.GetMilliseconds());
@@ -626,7 +700,12 @@ void Sandbox::DrawLightsPanel()
 
     ImGui::SameLine(half_avail_width - btn_width / 2.0f);
     if (ImGui::Button("Add Light", { btn_width, 20.0f }))
-        Renderer::AddLight();
+    {
+        if (m_Scene.GetPool<PointLight>().Size() < RendererUtils::s_MaxLights)
+            m_Scene.Emplace<PointLight>(m_Scene.Create());
+        else
+            ENGINE_LOG("Cannot add more lights! Max Lights (%i) reached!", RendererUtils::s_MaxLights);
+    }
 
     ImGui::NewLine();
     ImGui::SameLine(half_avail_width - text_size + (text_size / 2.0f));
@@ -634,8 +713,10 @@ void Sandbox::DrawLightsPanel()
     ImGui::NewLine(); ImGui::Separator(); ImGui::NewLine();
 
     // -- Lights --
+    // Removed after the loop, so the iterated components stay in place
     uint i = 0;
-    for (PointLight& light : Renderer::GetLights())
+    std::vector<Entity> lights_to_remove;
+    m_Scene.View<PointLight>().Each([&](Entity entity, PointLight& light)
     {
         static char popup_id[16];
         sprintf_s(popup_id, 16, "LightTag_%i", i);
@@ -657,7 +738,7 @@ void Sandbox::DrawLightsPanel()
         ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.7f, 0.2f, 0.2f, 1.0f));
         
         if (ImGui::Button("X", { btn_width , 20.0f }))
-            Renderer::RemoveLight(light.GetID());
+            lights_to_remove.push_back(entity);
 
         ImGui::PopStyleColor(2);
         
@@ -688,23 +769,27 @@ void Sandbox::DrawLightsPanel()
         ImGui::PopID();
         ImGui::NewLine(); ImGui::Separator(); ImGui::NewLine();
         ++i;
-    }
+    });
+
+    for (Entity entity : lights_to_remove)
+        m_Scene.Destroy(entity);
 }
 
 
-void Sandbox::DrawMeshMaterials(const Mesh* mesh, std::vector<uint>& materials_shown, uint meshindex_uitexturebtn)
+void Sandbox::DrawMeshMaterials(const Mesh* mesh, std::vector<MaterialHandle>& materials_shown, uint meshindex_uitexturebtn)
 {
     for (uint i = 0; i < mesh->GetSubmeshes()->size(); ++i)
         DrawMeshMaterials(mesh->GetSubmeshes()->at(i).get(), materials_shown, meshindex_uitexturebtn + i + 1);
 
-    std::vector<uint>::iterator it = std::find(materials_shown.begin(), materials_shown.end(), mesh->GetMaterialIndex());
-    if (it == materials_shown.end())
+    Ref<Material> mat = Resources::GetMaterial(mesh->GetMaterial());
+    std::vector<MaterialHandle>::iterator it = std::find(materials_shown.begin(), materials_shown.end(), mesh->GetMaterial());
+    if (mat && it == materials_shown.end())
     {
         // -- Material Name --
-        materials_shown.push_back(mesh->GetMaterialIndex());
-        Ref<Material> mat = Resources::GetMaterial(mesh->GetMaterialIndex());
-        ImGui::NewLine(); ImGui::Text("MATERIAL %i: '%s'", mat->GetID(), mat->GetName().c_str());
-        ImGui::SameLine(); ImGui::Checkbox("Two Sided", &mat->IsTwoSided); ImGui::NewLine();
+        materials_shown.push_back(mesh->GetMaterial());
+        ImGui::NewLine(); ImGui::Text("MATERIAL %i: '%s'", mat->GetID().GetIndex(), mat->GetName().c_str());
+        ImGui::SameLine(); ImGui::Checkbox("Two Sided", &mat->IsTwoSided);
+        ImGui::SameLine(); ImGui::Checkbox("Alpha Test", &mat->IsAlphaTested); ImGui::NewLine();
         ImGui::SetCursorPosX(ImGui::GetCursorPosX() + 20.0f);
 
         // -- Albedo Color --
@@ -713,10 +798,15 @@ void Sandbox::DrawMeshMaterials(const Mesh* mesh, std::vector<uint>& materials_s
         ImGui::ColorEdit4("##MatAlbColor", glm::value_ptr(mat->AlbedoColor), ImGuiColorEditFlags_NoInputs);
 
         // -- Albedo Texture --
+        // A new one replaces the atlas it was baked into, if any, so its rect too
         ImVec2 btn_size = ImVec2(20.0f, 20.0f);
+        Ref<Texture> previous_albedo = mat->Albedo;
         EditorUI::DrawTextureButton(mat->Albedo, "Albedo", btn_size, meshindex_uitexturebtn, 0, 150.0f); ImGui::NewLine();
-        EditorUI::DrawTextureButton(mat->Normal, "Normal", btn_size, meshindex_uitexturebtn, 1);
-        EditorUI::DrawTextureButton(mat->Bump, "Bump", btn_size, meshindex_uitexturebtn, 2, 164.0f);
+        if (mat->Albedo != previous_albedo)
+            mat->AlbedoUVTransform = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+
+        EditorUI::DrawTextureButton(mat->Normal, "Normal", btn_size, meshindex_uitexturebtn, 1, 0.0f, TEXTURE_USAGE::NORMAL);
+        EditorUI::DrawTextureButton(mat->Bump, "Bump", btn_size, meshindex_uitexturebtn, 2, 164.0f, TEXTURE_USAGE::HEIGHT);
 
         // -- Sliders --
         std::string sm_str = std::string("###smoothness" + std::to_string(meshindex_uitexturebtn));
@@ -736,15 +826,17 @@ void Sandbox::DrawMeshMaterials(const Mesh* mesh, std::vector<uint>& materials_s
 void Sandbox::DrawEntitiesPanel()
 {
     uint i = 0;
-    for (auto& entity : m_SceneModels)
+    RenderScene::GetDrawnEntities(m_Scene).Each([&](Entity, TransformComponent& transform, ModelComponent& model_component, BoundsComponent&)
     {
+        const Ref<Model>& model = model_component.EntityModel;
+
         // -- New ImGui ID --
         static char popup_id[16];
         sprintf_s(popup_id, 16, "EntityTag_%i", i);
         ImGui::PushID(popup_id);
 
         // -- Entity Active --
-        ImGui::Checkbox("##EntActive", &entity->GetTransformation().EntityActive);
+        ImGui::Checkbox("##EntActive", &transform.EntityActive);
         
         // -- Entity Name --
         ImGui::SameLine();
@@ -752,26 +844,30 @@ void Sandbox::DrawEntitiesPanel()
 
         char buffer[256];
         memset(buffer, 0, sizeof(buffer));
-        strncpy_s(buffer, entity->GetName().c_str(), sizeof(buffer));
+        strncpy_s(buffer, model->GetName().c_str(), sizeof(buffer));
 
         if (ImGui::InputText("##EntName", buffer, sizeof(buffer), ImGuiInputTextFlags_AutoSelectAll | ImGuiInputTextFlags_CharsNoBlank))
-            entity->SetName(std::string(buffer));
+            model->SetName(std::string(buffer));
 
         // -- Entity Transform --
         float indent = ImGui::GetContentRegionAvailWidth() / 5.0f - 10.0f;
-        EditorUI::DrawVec3Control("Pos", "##Translation", indent, entity->GetTransformation().Translation);
-        EditorUI::DrawVec3Control("Rot", "##Rotation", indent, entity->GetTransformation().Rotation, glm::vec3(0.0f, 180.0f, 0.0f));
-        EditorUI::DrawVec3Control("Sca", "##Scale", indent, entity->GetTransformation().Scale, glm::vec3(0.25f));
+        EditorUI::DrawVec3Control("Pos", "##Translation", indent, transform.Translation);
+        EditorUI::DrawVec3Control("Rot", "##Rotation", indent, transform.Rotation, glm::vec3(0.0f, 180.0f, 0.0f));
+        EditorUI::DrawVec3Control("Sca", "##Scale", indent, transform.Scale, glm::vec3(0.25f));
+
+        // -- Entity Static --
+        ImGui::Checkbox("Static", &model_component.IsStatic);
 
         // -- Entity Materials --
-        std::vector<uint> mats_shown_vec;
-        DrawMeshMaterials(entity->GetRootMesh(), mats_shown_vec, i);
+        std::vector<MaterialHandle> mats_shown_vec;
+        if (model->GetRootMesh())
+            DrawMeshMaterials(model->GetRootMesh(), mats_shown_vec, i);
 
         // -- Pop & Spacing --
         ImGui::PopID();
         ImGui::NewLine(); ImGui::NewLine(); ImGui::NewLine(); ImGui::Separator(); ImGui::NewLine();
         ++i;
-    }
+    });
 }
 
 
@@ -822,4 +918,79 @@ void Sandbox::DrawPerformancePanel()
 
     ImGui::Text("Deallocations"); ImGui::SameLine(text_separation);
     ImGui::Text("%.0f KB", BYTETOKB(m_MemoryMetrics.GetDeallocations()));
+
+    // --- GPU Memory Display ---
+    // Current & high-water mark of each category
+    ImGui::NewLine();
+    ImGui::Separator();
+    ImGui::Text("GPU Memory"); ImGui::SameLine(text_separation);
+    ImGui::Text("%.2f MB (peak %.2f MB)", (float)GPUMemory::GetTotalBytes() / MBTOBYTE(1.0f), (float)GPUMemory::GetTotalPeakBytes() / MBTOBYTE(1.0f));
+
+    for (int i = 0; i < (int)GPU_MEMORY::MAX; ++i)
+    {
+        GPU_MEMORY category = (GPU_MEMORY)i;
+        ImGui::Text("  %s", GPUMemory::GetCategoryName(category)); ImGui::SameLine(text_separation);
+        ImGui::Text("%.2f MB (peak %.2f MB)", (float)GPUMemory::GetAllocatedBytes(category) / MBTOBYTE(1.0f), (float)GPUMemory::GetPeakBytes(category) / MBTOBYTE(1.0f));
+    }
+
+    // Budget, unreferenced resources are evicted past it
+    int gpu_budget = (int)((float)Resources::GetGPUBudget() / MBTOBYTE(1.0f));
+    ImGui::SetNextItemWidth(ImGui::GetContentRegionAvailWidth() * 0.5f);
+    if (ImGui::DragInt("GPU Budget (MB)", &gpu_budget, 8.0f, 64, 16384))
+        Resources::SetGPUBudget((uint64)(gpu_budget * MBTOBYTE(1)));
+
+    ImGui::Text("Evicted Resources"); ImGui::SameLine(text_separation);
+    ImGui::Text("%i", Resources::GetEvictionsCount());
+
+    // --- Transforms Benchmark ---
+    ImGui::NewLine();
+    ImGui::Separator();
+    if (ImGui::Button("Run Transforms Benchmark (100k)"))
+        m_TransformsBenchmark = TransformSystem::RunBenchmark(100000);
+
+    if (m_TransformsBenchmark.TransformsCount > 0)
+    {
+        ImGui::Text("Naive"); ImGui::SameLine(text_separation);
+        ImGui::Text("%.3f ms", m_TransformsBenchmark.NaiveMs);
+        ImGui::Text("Batched"); ImGui::SameLine(text_separation);
+        ImGui::Text("%.3f ms (threaded %.3f ms)", m_TransformsBenchmark.BatchedMs, m_TransformsBenchmark.BatchedThreadedMs);
+        ImGui::Text("Batched 1%% Dirty"); ImGui::SameLine(text_separation);
+        ImGui::Text("%.3f ms", m_TransformsBenchmark.PartialMs);
+        ImGui::Text("Max Error"); ImGui::SameLine(text_separation);
+        ImGui::Text("%g", m_TransformsBenchmark.MaxError);
+    }
+
+    // --- OBJ Import Benchmark ---
+    ImGui::NewLine();
+    ImGui::Separator();
+    if (ImGui::Button("Run OBJ Import Benchmark"))
+        m_ObjBenchmarks = ObjImporter::RunBenchmark({ "Resources/Models/Sphere.obj", "Resources/Models/Patrick/Patrick.obj",
+            "Resources/Models/Plane/Plane_Ground.obj", "Resources/Models/TWTODBandit/Bandit_ToTest.obj" });
+
+    for (const ObjBenchmark& result : m_ObjBenchmarks)
+    {
+        ImGui::Text("%s (%.2f MB)", result.Filepath.c_str(), result.FileMB);
+        ImGui::Text("  Native"); ImGui::SameLine(text_separation);
+        ImGui::Text("%.2f ms, %.1f MB/s (%u vertices, %u triangles)", result.NativeMs, result.NativeMBps, result.NativeVertices, result.NativeTriangles);
+        ImGui::Text("  Assimp"); ImGui::SameLine(text_separation);
+        ImGui::Text("%.2f ms, %.1f MB/s (%u vertices, %u triangles)", result.AssimpMs, result.AssimpMBps, result.AssimpVertices, result.AssimpTriangles);
+    }
+
+    // --- Vertices Interleaving Benchmark ---
+    ImGui::NewLine();
+    ImGui::Separator();
+    if (ImGui::Button("Run Vertices Interleaving Benchmark (1M)"))
+        m_InterleaveBenchmark = MeshImporter::RunInterleaveBenchmark(1000000);
+
+    if (m_InterleaveBenchmark.VerticesCount > 0)
+    {
+        ImGui::Text("Scalar"); ImGui::SameLine(text_separation);
+        ImGui::Text("%.3f ms, %.1f M vertices/s", m_InterleaveBenchmark.ScalarMs, m_InterleaveBenchmark.ScalarMVps);
+        ImGui::Text("SIMD"); ImGui::SameLine(text_separation);
+        ImGui::Text("%.3f ms, %.1f M vertices/s", m_InterleaveBenchmark.SIMDMs, m_InterleaveBenchmark.SIMDMVps);
+        ImGui::Text("SIMD Threaded"); ImGui::SameLine(text_separation);
+        ImGui::Text("%.3f ms, %.1f M vertices/s", m_InterleaveBenchmark.SIMDThreadedMs, m_InterleaveBenchmark.SIMDThreadedMVps);
+        ImGui::Text("Outputs Match"); ImGui::SameLine(text_separation);
+        ImGui::Text("%s", m_InterleaveBenchmark.OutputsMatch ? "Yes" : "No");
+    }
 }
\ No newline at end of file
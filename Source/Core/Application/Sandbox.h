@@ -7,6 +7,8 @@
 #include "Application.h"
 
 #include "Renderer/Entities/CameraController.h"
+#include "Renderer/Entities/RenderScene.h"
+#include "Core/Resources/ObjImporter.h"
 
 #include "Renderer/Resources/Framebuffer.h"
 #include "Renderer/Resources/Buffers.h"
@@ -34,12 +36,14 @@ public:
 private:
 
 	void RenderSkybox();
+	void RenderDeferredLighting();
+	Entity CreateModelEntity(const Ref<Model>& model, const TransformComponent& transform, bool is_static = false);
 
 	void SetMemoryMetrics();
 
 	void DrawLightsPanel();
 	void DrawCameraPanel();
-	void DrawMeshMaterials(const Mesh* mesh, std::vector<uint>& materials_shown, uint meshindex_uitexturebtn);
+	void DrawMeshMaterials(const Mesh* mesh, std::vector<MaterialHandle>& materials_shown, uint meshindex_uitexturebtn);
 	void DrawEntitiesPanel();
 	void DrawPerformancePanel();
 
@@ -47,7 +51,11 @@ private:
 
 	// Scene
 	CameraController m_EngineCamera = {};
-	std::vector<Ref<Model>> m_SceneModels;
+	EntityRegistry m_Scene;
+	RenderScene m_RenderScene;
+	TransformsBenchmark m_TransformsBenchmark = {};
+	std::vector<ObjBenchmark> m_ObjBenchmarks;
+	InterleaveBenchmark m_InterleaveBenchmark = {};
 	Ref<Shader> m_TextureShader, m_LightingShader;
 
 	// Deferred Rendering
@@ -85,6 +93,7 @@ private:
 	bool m_DrawLightsSpheres = true;
 	bool m_DeferredRendering = true;
 	bool m_BloomActive = false;
+	bool m_BloomDrawn = false;	// This frame, bloom waits for its shaders to be linked
 	bool m_RenderSkybox = true;
 };
 
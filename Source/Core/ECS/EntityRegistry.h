@@ -0,0 +1,386 @@
+#ifndef _ENTITYREGISTRY_H_
+#define _ENTITYREGISTRY_H_
+
+#include "../Globals.h"
+#include <algorithm>
+#include <tuple>
+
+
+// ------------------------------------------------------------------------------
+// Stable entity ID: 20 bits of index & 12 of version (bumped when destroyed, so IDs of destroyed entities are detected)
+typedef uint Entity;
+
+namespace EntityUtils
+{
+	static constexpr uint s_IndexBits = 20;
+	static constexpr uint s_IndexMask = (1u << s_IndexBits) - 1;
+	static constexpr uint s_VersionMask = (1u << (32 - s_IndexBits)) - 1;
+	static constexpr Entity s_NullEntity = ~0u;
+
+	inline uint GetIndex(Entity entity)					{ return entity & s_IndexMask; }
+	inline uint GetVersion(Entity entity)				{ return entity >> s_IndexBits; }
+	inline Entity MakeEntity(uint index, uint version)	{ return (version << s_IndexBits) | index; }
+}
+
+
+
+// ------------------------------------------------------------------------------
+struct GroupData;
+
+// Entities with a component: sparse array (by entity index) to a packed one (iterated linearly)
+// Removing swaps the last element into the hole, so the packed order is not stable
+class SparseSet
+{
+	friend class EntityRegistry;
+public:
+
+	virtual ~SparseSet() = default;
+
+	// --- Getters ---
+	inline bool Contains(Entity entity) const
+	{
+		uint index = EntityUtils::GetIndex(entity);
+		return index < m_Sparse.size() && m_Sparse[index] != s_Invalid && m_Dense[m_Sparse[index]] == entity;
+	}
+
+	inline uint GetDenseIndex(Entity entity)		const	{ return m_Sparse[EntityUtils::GetIndex(entity)]; }
+	inline uint Size()								const	{ return (uint)m_Dense.size(); }
+	inline const std::vector<Entity>& GetEntities()	const	{ return m_Dense; }
+
+protected:
+
+	// --- Packed Arrays Management ---
+	void AddEntity(Entity entity)
+	{
+		uint index = EntityUtils::GetIndex(entity);
+		if (index >= m_Sparse.size())
+			m_Sparse.resize(index + 1, s_Invalid);
+
+		m_Sparse[index] = (uint)m_Dense.size();
+		m_Dense.push_back(entity);
+	}
+
+	// Returns the packed position it had (now holding the former last one)
+	uint RemoveEntity(Entity entity)
+	{
+		uint dense_index = GetDenseIndex(entity);
+		m_Dense[dense_index] = m_Dense.back();
+		m_Sparse[EntityUtils::GetIndex(m_Dense[dense_index])] = dense_index;
+		m_Sparse[EntityUtils::GetIndex(entity)] = s_Invalid;
+		m_Dense.pop_back();
+		return dense_index;
+	}
+
+	void SwapDense(uint a, uint b)
+	{
+		if (a == b)
+			return;
+
+		std::swap(m_Dense[a], m_Dense[b]);
+		m_Sparse[EntityUtils::GetIndex(m_Dense[a])] = a;
+		m_Sparse[EntityUtils::GetIndex(m_Dense[b])] = b;
+		SwapComponents(a, b);
+	}
+
+	virtual void Remove(Entity entity) = 0;
+	virtual void SwapComponents(uint a, uint b) = 0;
+
+protected:
+
+	static constexpr uint s_Invalid = ~0u;
+
+	std::vector<uint> m_Sparse;
+	std::vector<Entity> m_Dense;
+	GroupData* m_OwnerGroup = nullptr; // Group keeping its packed order
+};
+
+
+// Components packed in the same order than their entities
+template<typename T>
+class ComponentPool : public SparseSet
+{
+	friend class EntityRegistry;
+public:
+
+	inline T& Get(Entity entity)					{ return m_Components[GetDenseIndex(entity)]; }
+	inline const T& Get(Entity entity)		const	{ return m_Components[GetDenseIndex(entity)]; }
+
+	inline T* Data()								{ return m_Components.data(); }
+	inline const T* Data()					const	{ return m_Components.data(); }
+
+private:
+
+	template<typename... Args>
+	T& Emplace(Entity entity, Args&&... args)
+	{
+		AddEntity(entity);
+		m_Components.push_back(T{ std::forward<Args>(args)... });
+		return m_Components.back();
+	}
+
+	void Remove(Entity entity) override
+	{
+		uint dense_index = RemoveEntity(entity);
+		if (dense_index != m_Components.size() - 1)
+			m_Components[dense_index] = std::move(m_Components.back());
+
+		m_Components.pop_back();
+	}
+
+	void SwapComponents(uint a, uint b) override { std::swap(m_Components[a], m_Components[b]); }
+
+private:
+
+	std::vector<T> m_Components;
+};
+
+
+// Pools owned by a group: the entities with all of their components are kept at the front of all of them, in the same order
+struct GroupData
+{
+	std::vector<SparseSet*> Pools;
+	uint Size = 0;
+};
+
+
+
+// ------------------------------------------------------------------------------
+// Entities with all the components, iterated through the smallest pool (lookups in the rest)
+template<typename... Ts>
+class EntityView
+{
+public:
+
+	EntityView(ComponentPool<Ts>*... pools) : m_Pools(pools...) {}
+
+	// func(Entity, Ts&...)
+	template<typename Func>
+	void Each(Func func)
+	{
+		const SparseSet* smallest = nullptr;
+		std::apply([&smallest](auto*... pool) { ((smallest = !smallest || pool->Size() < smallest->Size() ? pool : smallest), ...); }, m_Pools);
+
+		// Copied so func can add or remove components to the iterated entities
+		std::vector<Entity> entities = smallest->GetEntities();
+		for (Entity entity : entities)
+			if (std::apply([entity](auto*... pool) { return (pool->Contains(entity) && ...); }, m_Pools))
+				func(entity, std::get<ComponentPool<Ts>*>(m_Pools)->Get(entity)...);
+	}
+
+private:
+
+	std::tuple<ComponentPool<Ts>*...> m_Pools;
+};
+
+
+// Entities with all the owned components, packed at the front of each pool in the same order: element i of every
+// component array belongs to the same entity, so systems can run plain loops over them
+template<typename... Ts>
+class EntityGroup
+{
+public:
+
+	EntityGroup(GroupData* data, ComponentPool<Ts>*... pools) : m_Data(data), m_Pools(pools...) {}
+
+	inline uint Size()								const	{ return m_Data->Size; }
+	inline const Entity* GetEntities()				const	{ return std::get<0>(m_Pools)->GetEntities().data(); }
+
+	// Packed array of a component, Size() elements belong to the group
+	template<typename T>
+	inline T* GetComponents()								{ return std::get<ComponentPool<T>*>(m_Pools)->Data(); }
+
+	// func(Entity, Ts&...)
+	template<typename Func>
+	void Each(Func func)
+	{
+		const Entity* entities = GetEntities();
+		for (uint i = 0; i < m_Data->Size; ++i)
+			func(entities[i], std::get<ComponentPool<Ts>*>(m_Pools)->Data()[i]...);
+	}
+
+private:
+
+	GroupData* m_Data = nullptr;
+	std::tuple<ComponentPool<Ts>*...> m_Pools;
+};
+
+
+
+// ------------------------------------------------------------------------------
+// Creates entities & stores their components in one sparse set per type
+// Pointers & references to components are invalidated by adding or removing components of the same type
+class EntityRegistry
+{
+public:
+
+	EntityRegistry() = default;
+	EntityRegistry(const EntityRegistry&) = delete;
+	EntityRegistry& operator=(const EntityRegistry&) = delete;
+
+	// --- Entities ---
+	Entity Create()
+	{
+		if (!m_FreeIndices.empty())
+		{
+			uint index = m_FreeIndices.back();
+			m_FreeIndices.pop_back();
+			return m_Entities[index] = EntityUtils::MakeEntity(index, EntityUtils::GetVersion(m_Entities[index]));
+		}
+
+		ASSERT(m_Entities.size() < EntityUtils::s_IndexMask, "EntityRegistry: Out of entities!");
+		m_Entities.push_back(EntityUtils::MakeEntity((uint)m_Entities.size(), 0));
+		return m_Entities.back();
+	}
+
+	void Destroy(Entity entity)
+	{
+		if (!IsValid(entity))
+			return;
+
+		for (UniquePtr<SparseSet>& pool : m_Pools)
+			if (pool && pool->Contains(entity))
+				RemoveFromPool(pool.get(), entity);
+
+		// The stored entity becomes the next version (invalid until reused), so the old ID is detected
+		uint index = EntityUtils::GetIndex(entity);
+		m_Entities[index] = EntityUtils::MakeEntity(index, (EntityUtils::GetVersion(entity) + 1) & EntityUtils::s_VersionMask) | s_DestroyedBit;
+		m_FreeIndices.push_back(index);
+	}
+
+	inline bool IsValid(Entity entity) const
+	{
+		uint index = EntityUtils::GetIndex(entity);
+		return entity != EntityUtils::s_NullEntity && index < m_Entities.size() && m_Entities[index] == entity;
+	}
+
+	inline uint GetEntitiesCount() const { return (uint)(m_Entities.size() - m_FreeIndices.size()); }
+
+	// --- Components ---
+	template<typename T, typename... Args>
+	T& Emplace(Entity entity, Args&&... args)
+	{
+		ASSERT(IsValid(entity) && !Has<T>(entity), "EntityRegistry: Invalid entity or component already added");
+		ComponentPool<T>& pool = GetPool<T>();
+		pool.Emplace(entity, std::forward<Args>(args)...);
+
+		if (pool.m_OwnerGroup)
+			AddToGroup(pool.m_OwnerGroup, entity);
+
+		return pool.Get(entity);
+	}
+
+	template<typename T>
+	void Remove(Entity entity)
+	{
+		if (Has<T>(entity))
+			RemoveFromPool(&GetPool<T>(), entity);
+	}
+
+	template<typename T>
+	inline bool Has(Entity entity) const
+	{
+		uint type = GetComponentType<T>();
+		return type < m_Pools.size() && m_Pools[type] && m_Pools[type]->Contains(entity);
+	}
+
+	template<typename T> inline T& Get(Entity entity)		{ return GetPool<T>().Get(entity); }
+	template<typename T> inline T* TryGet(Entity entity)	{ return Has<T>(entity) ? &GetPool<T>().Get(entity) : nullptr; }
+
+	template<typename T>
+	ComponentPool<T>& GetPool()
+	{
+		uint type = GetComponentType<T>();
+		if (type >= m_Pools.size())
+			m_Pools.resize(type + 1);
+
+		if (!m_Pools[type])
+			m_Pools[type] = CreateUnique<ComponentPool<T>>();
+
+		return *static_cast<ComponentPool<T>*>(m_Pools[type].get());
+	}
+
+	// --- Iteration ---
+	template<typename... Ts>
+	EntityView<Ts...> View() { return EntityView<Ts...>(&GetPool<Ts>()...); }
+
+	// The first call for a set of components creates the group, a pool can only be owned by one group
+	template<typename... Ts>
+	EntityGroup<Ts...> Group()
+	{
+		std::vector<SparseSet*> pools = { &GetPool<Ts>()... };
+		GroupData* data = pools[0]->m_OwnerGroup;
+		if (data)
+		{
+			ASSERT(data->Pools == pools, "EntityRegistry: Component already owned by another group");
+			return EntityGroup<Ts...>(data, &GetPool<Ts>()...);
+		}
+
+		for (SparseSet* pool : pools)
+			ASSERT(!pool->m_OwnerGroup, "EntityRegistry: Component already owned by another group");
+
+		m_Groups.push_back(CreateUnique<GroupData>());
+		data = m_Groups.back().get();
+		data->Pools = pools;
+		for (SparseSet* pool : pools)
+			pool->m_OwnerGroup = data;
+
+		// Pack the entities that already have all the components
+		std::vector<Entity> entities = pools[0]->GetEntities();
+		for (Entity entity : entities)
+			AddToGroup(data, entity);
+
+		return EntityGroup<Ts...>(data, &GetPool<Ts>()...);
+	}
+
+	void Clear()
+	{
+		m_Entities.clear(); m_FreeIndices.clear();
+		m_Pools.clear(); m_Groups.clear();
+	}
+
+private:
+
+	// --- Groups Packing ---
+	void AddToGroup(GroupData* group, Entity entity)
+	{
+		for (SparseSet* pool : group->Pools)
+			if (!pool->Contains(entity) || pool->GetDenseIndex(entity) < group->Size)
+				return;
+
+		for (SparseSet* pool : group->Pools)
+			pool->SwapDense(pool->GetDenseIndex(entity), group->Size);
+
+		++group->Size;
+	}
+
+	void RemoveFromPool(SparseSet* pool, Entity entity)
+	{
+		// Out of the group first (to its end), so the swap-remove doesn't move anything inside it
+		GroupData* group = pool->m_OwnerGroup;
+		if (group && pool->GetDenseIndex(entity) < group->Size)
+		{
+			--group->Size;
+			for (SparseSet* owned_pool : group->Pools)
+				owned_pool->SwapDense(owned_pool->GetDenseIndex(entity), group->Size);
+		}
+
+		pool->Remove(entity);
+	}
+
+	// Sequential ID of each component type
+	template<typename T>
+	static uint GetComponentType() { static const uint type = s_ComponentTypesCount++; return type; }
+
+private:
+
+	static constexpr uint s_DestroyedBit = EntityUtils::s_IndexMask; // Index bits of destroyed entities (never a valid one)
+
+	std::vector<Entity> m_Entities;		// By index, with their current version
+	std::vector<uint> m_FreeIndices;
+	std::vector<UniquePtr<SparseSet>> m_Pools;
+	std::vector<UniquePtr<GroupData>> m_Groups;
+
+	inline static uint s_ComponentTypesCount = 0;
+};
+
+#endif //_ENTITYREGISTRY_H_
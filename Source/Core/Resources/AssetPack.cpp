@@ -0,0 +1,239 @@
+#include "AssetPack.h"
+
+#include "Core/Utils/Compression.h"
+#include "Core/Utils/Hash.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <unordered_set>
+
+static_assert(sizeof(AssetPackHeader) == 24 && sizeof(AssetPackEntry) == 40, "AssetPack structs must be tightly packed");
+
+// Entries smaller than this fraction of their size once compressed are stored compressed
+static const float s_MinCompressionRatio = 0.9f;
+
+
+// ------------------------------------------------------------------------------
+std::string AssetPack::NormalizePath(const std::string& path)
+{
+	std::filesystem::path fs_path = path;
+	if (fs_path.is_absolute())
+	{
+		std::error_code error;
+		std::filesystem::path relative_path = fs_path.lexically_relative(std::filesystem::current_path(error));
+		if (!error && !relative_path.empty())
+			fs_path = relative_path;
+	}
+
+	std::string ret = fs_path.lexically_normal().generic_string();
+	std::replace(ret.begin(), ret.end(), '\\', '/');
+	std::transform(ret.begin(), ret.end(), ret.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+	return ret;
+}
+
+
+
+// ------------------------------------------------------------------------------
+bool AssetPack::Open(const std::string& filepath)
+{
+	if (!m_File.Map(filepath) || m_File.GetSize() < sizeof(AssetPackHeader))
+		return false;
+
+	// -- Check Header & Tables --
+	const uint8_t* data = m_File.GetData();
+	const AssetPackHeader* header = (const AssetPackHeader*)data;
+	uint64 entries_end = sizeof(AssetPackHeader) + (uint64)header->EntriesCount * sizeof(AssetPackEntry);
+
+	if (header->Magic != s_Magic || header->Version != s_Version || entries_end > m_File.GetSize()
+		|| header->PathsOffset < entries_end || header->PathsOffset + header->PathsSize > m_File.GetSize())
+	{
+		ENGINE_LOG("Invalid or outdated Asset Pack '%s'", filepath.c_str());
+		m_File.Unmap();
+		return false;
+	}
+
+	const AssetPackEntry* entries = (const AssetPackEntry*)(data + sizeof(AssetPackHeader));
+	for (uint i = 0; i < header->EntriesCount; ++i)
+	{
+		if (entries[i].Offset + entries[i].StoredSize > m_File.GetSize() || entries[i].PathOffset >= header->PathsSize)
+		{
+			ENGINE_LOG("Asset Pack '%s' is corrupted", filepath.c_str());
+			m_File.Unmap();
+			return false;
+		}
+	}
+
+	m_Header = header;
+	m_Entries = entries;
+	m_Paths = (const char*)(data + header->PathsOffset);
+	m_Filepath = filepath;
+	return true;
+}
+
+
+const AssetPackEntry* AssetPack::FindEntry(const std::string& normalized_path) const
+{
+	if (!m_Header)
+		return nullptr;
+
+	// -- Binary Search by Hash --
+	uint64 hash = HashUtils::HashString(normalized_path);
+	const AssetPackEntry* end = m_Entries + m_Header->EntriesCount;
+	const AssetPackEntry* entry = std::lower_bound(m_Entries, end, hash, [](const AssetPackEntry& e, uint64 h) { return e.PathHash < h; });
+
+	// -- Check Paths (for collisions) --
+	for (; entry != end && entry->PathHash == hash; ++entry)
+	{
+		const char* path = m_Paths + entry->PathOffset;
+		size_t max_length = m_Header->PathsSize - entry->PathOffset;
+		if (strnlen(path, max_length) == normalized_path.size() && normalized_path.compare(0, normalized_path.size(), path, normalized_path.size()) == 0)
+			return entry;
+	}
+
+	return nullptr;
+}
+
+
+bool AssetPack::ReadEntry(const AssetPackEntry& entry, const uint8_t*& data, std::vector<uint8_t>& buffer) const
+{
+	const uint8_t* stored_data = m_File.GetData() + entry.Offset;
+	if (!(entry.Flags & ASSETPACK_ENTRY_LZ4))
+	{
+		data = stored_data;
+		return entry.StoredSize == entry.Size;
+	}
+
+	buffer.resize(entry.Size);
+	if (!CompressionUtils::LZ4Decompress(stored_data, entry.StoredSize, buffer.data(), buffer.size()))
+	{
+		ENGINE_LOG("Failed to decompress entry '%s' of Asset Pack '%s'", m_Paths + entry.PathOffset, m_Filepath.c_str());
+		buffer.clear();
+		return false;
+	}
+
+	data = buffer.data();
+	return true;
+}
+
+
+
+// ------------------------------------------------------------------------------
+void AssetPackBuilder::AddFile(const std::string& filepath)
+{
+	m_Filepaths.push_back(filepath);
+}
+
+void AssetPackBuilder::AddDirectory(const std::string& directory)
+{
+	std::error_code error;
+	for (const std::filesystem::directory_entry& dir_entry : std::filesystem::recursive_directory_iterator(directory, error))
+		if (dir_entry.is_regular_file())
+			m_Filepaths.push_back(dir_entry.path().generic_string());
+
+	if (error)
+		ENGINE_LOG("Couldn't read directory '%s': %s", directory.c_str(), error.message().c_str());
+}
+
+
+bool AssetPackBuilder::Build(const std::string& pack_filepath, bool compress)
+{
+	// -- Read & Compress Files --
+	// Data is kept in the order files were added, so related assets stay together on disk
+	std::vector<AssetPackEntry> entries;
+	std::vector<std::vector<uint8_t>> entries_data;
+	std::string paths;
+	std::unordered_set<std::string> added_paths = { AssetPack::NormalizePath(pack_filepath) };
+
+	for (const std::string& filepath : m_Filepaths)
+	{
+		std::string normalized_path = AssetPack::NormalizePath(filepath);
+
+		// Skip duplicates & the pack itself if it was inside an added directory
+		if (!added_paths.insert(normalized_path).second)
+			continue;
+
+		std::ifstream file(filepath, std::ios::in | std::ios::binary);
+		if (!file)
+		{
+			ENGINE_LOG("Couldn't open file '%s', skipping it", filepath.c_str());
+			continue;
+		}
+
+		std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+		AssetPackEntry entry = {};
+		entry.PathHash = HashUtils::HashString(normalized_path);
+		entry.Size = data.size();
+		entry.PathOffset = paths.size();
+		paths.append(normalized_path.c_str(), normalized_path.size() + 1);
+
+		if (compress && !data.empty())
+		{
+			std::vector<uint8_t> compressed_data(CompressionUtils::LZ4CompressBound(data.size()));
+			size_t compressed_size = CompressionUtils::LZ4Compress(data.data(), data.size(), compressed_data.data(), compressed_data.size());
+
+			if (compressed_size != 0 && compressed_size < (size_t)(data.size() * s_MinCompressionRatio))
+			{
+				compressed_data.resize(compressed_size);
+				data.swap(compressed_data);
+				entry.Flags |= ASSETPACK_ENTRY_LZ4;
+			}
+		}
+
+		entry.StoredSize = data.size();
+		entries.push_back(entry);
+		entries_data.push_back(std::move(data));
+	}
+
+	// -- Layout Entries --
+	auto align = [](uint64 offset) { return (offset + AssetPack::s_EntryAlignment - 1) & ~(AssetPack::s_EntryAlignment - 1); };
+
+	AssetPackHeader header = {};
+	header.Magic = AssetPack::s_Magic;
+	header.Version = AssetPack::s_Version;
+	header.EntriesCount = entries.size();
+	header.PathsSize = paths.size();
+	header.PathsOffset = sizeof(AssetPackHeader) + entries.size() * sizeof(AssetPackEntry);
+
+	uint64 offset = align(header.PathsOffset + header.PathsSize);
+	for (AssetPackEntry& entry : entries)
+	{
+		entry.Offset = offset;
+		offset = align(offset + entry.StoredSize);
+	}
+
+	// Sorted only in the table (data offsets are already set) for binary searching
+	std::vector<AssetPackEntry> sorted_entries = entries;
+	std::sort(sorted_entries.begin(), sorted_entries.end(), [](const AssetPackEntry& a, const AssetPackEntry& b) { return a.PathHash < b.PathHash; });
+
+	// -- Write Pack --
+	std::ofstream file(pack_filepath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		ENGINE_LOG("Couldn't write Asset Pack at path '%s'", pack_filepath.c_str());
+		return false;
+	}
+
+	const std::vector<char> padding(AssetPack::s_EntryAlignment, 0);
+	file.write((const char*)&header, sizeof(AssetPackHeader));
+	file.write((const char*)sorted_entries.data(), sorted_entries.size() * sizeof(AssetPackEntry));
+	file.write(paths.data(), paths.size());
+
+	uint64 written = header.PathsOffset + header.PathsSize;
+	for (uint i = 0; i < entries.size(); ++i)
+	{
+		file.write(padding.data(), entries[i].Offset - written);
+		file.write((const char*)entries_data[i].data(), entries_data[i].size());
+		written = entries[i].Offset + entries[i].StoredSize;
+	}
+
+	if (!file.good())
+	{
+		ENGINE_LOG("Couldn't write Asset Pack at path '%s'", pack_filepath.c_str());
+		return false;
+	}
+
+	ENGINE_LOG("Built Asset Pack '%s' with %i entries (%.2f MB)", pack_filepath.c_str(), (int)entries.size(), (float)written / MBTOBYTE(1.0f));
+	return true;
+}
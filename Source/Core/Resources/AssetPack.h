@@ -0,0 +1,82 @@
+#ifndef _ASSETPACK_H_
+#define _ASSETPACK_H_
+
+#include "Core/Globals.h"
+#include "Core/Utils/MappedFile.h"
+
+
+// --- Asset Pack Format ---
+// Single file (.agppack) holding many assets, so loading them is a few large sequential reads instead of many small opens
+// Layout: [Header][Entries (sorted by path hash)][Paths][Data of each entry, 4KB aligned]
+struct AssetPackHeader
+{
+	uint Magic, Version, EntriesCount, PathsSize;
+	uint64 PathsOffset;
+};
+
+enum AssetPackEntryFlags : uint { ASSETPACK_ENTRY_LZ4 = 1 << 0 };
+
+struct AssetPackEntry
+{
+	uint64 PathHash;
+	uint64 Offset, StoredSize;	// Absolute in the pack, StoredSize is the compressed size if LZ4
+	uint64 Size;				// Uncompressed size
+	uint PathOffset, Flags;		// PathOffset is relative to the Paths table
+};
+
+
+
+// --- Asset Pack (Reader) ---
+// Memory-maps the whole pack, uncompressed entries are read straight from the mapping
+class AssetPack
+{
+public:
+
+	static const uint s_Magic = 0x4B504741; // "AGPK"
+	static const uint s_Version = 1;
+	static const uint64 s_EntryAlignment = 4096;
+	static constexpr const char* s_DefaultFilepath = "Resources/Assets.agppack"; // Mounted at startup if it exists
+
+	// Relative to the working directory, '/' separated & lowercase, as paths are stored in the pack
+	static std::string NormalizePath(const std::string& path);
+
+	bool Open(const std::string& filepath);
+
+	// Path must be normalized, returns nullptr if the pack doesn't have it
+	const AssetPackEntry* FindEntry(const std::string& normalized_path) const;
+
+	// If the entry is compressed, decompresses it into 'buffer' and points data there, otherwise data points into the mapping
+	bool ReadEntry(const AssetPackEntry& entry, const uint8_t*& data, std::vector<uint8_t>& buffer) const;
+
+	const std::string& GetFilepath()	const { return m_Filepath; }
+	uint GetEntriesCount()				const { return m_Header ? m_Header->EntriesCount : 0; }
+
+private:
+
+	FileUtils::MappedFile m_File;
+	std::string m_Filepath;
+
+	const AssetPackHeader* m_Header = nullptr;
+	const AssetPackEntry* m_Entries = nullptr;
+	const char* m_Paths = nullptr;
+};
+
+
+
+// --- Asset Pack Builder ---
+class AssetPackBuilder
+{
+public:
+
+	void AddFile(const std::string& filepath);
+	void AddDirectory(const std::string& directory); // Recursive
+
+	// Entries are LZ4-compressed only if 'compress' and it saves enough space (already compressed formats like .png don't)
+	bool Build(const std::string& pack_filepath, bool compress = true);
+
+private:
+
+	std::vector<std::string> m_Filepaths;
+};
+
+#endif //_ASSETPACK_H_
@@ -0,0 +1,1102 @@
+#include "GltfImporter.h"
+
+#include "Resources.h"
+#include "MeshCache.h"
+#include "Core/Utils/Hash.h"
+#include "Core/Utils/JobSystem.h"
+#include "Renderer/Resources/Buffers.h"
+#include "Renderer/Resources/Material.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+
+// ------------------------------------------------------------------------------
+// --- JSON ---
+// Minimal DOM reader for the glTF description (a few KB even for big scenes, the heavy data is in the binary buffers)
+namespace
+{
+	class JsonValue
+	{
+		friend class JsonParser;
+	public:
+
+		enum class TYPE : uint8_t { NONE = 0, NULL_VALUE, BOOL, NUMBER, STRING, ARRAY, OBJECT };
+
+		// Missing members & out of range elements are NONE values, so lookups can be chained
+		const JsonValue& Get(const char* key) const
+		{
+			for (size_t i = 0; i < m_Keys.size(); ++i)
+				if (m_Keys[i] == key)
+					return m_Elements[i];
+
+			return None();
+		}
+
+		const JsonValue& At(size_t index)	const { return m_Type == TYPE::ARRAY && index < m_Elements.size() ? m_Elements[index] : None(); }
+		size_t Size()						const { return m_Type == TYPE::ARRAY ? m_Elements.size() : 0; }
+
+		bool Exists()						const { return m_Type != TYPE::NONE; }
+		bool IsObject()						const { return m_Type == TYPE::OBJECT; }
+		bool IsNumber()						const { return m_Type == TYPE::NUMBER; }
+
+		double GetNumber(double fallback)	const { return m_Type == TYPE::NUMBER ? m_Number : fallback; }
+		int GetInt(int fallback)			const { return m_Type == TYPE::NUMBER ? (int)m_Number : fallback; }
+		bool GetBool(bool fallback)			const { return m_Type == TYPE::BOOL ? m_Bool : fallback; }
+		const std::string& GetString()		const { return m_String; }
+
+		// Up to count numbers of an array into values, false if it isn't one of exactly that size
+		bool GetNumbers(float* values, size_t count) const
+		{
+			if (Size() != count)
+				return false;
+
+			for (size_t i = 0; i < count; ++i)
+				values[i] = (float)m_Elements[i].GetNumber(0.0);
+
+			return true;
+		}
+
+	private:
+
+		static const JsonValue& None() { static const JsonValue s_None; return s_None; }
+
+		TYPE m_Type = TYPE::NONE;
+		bool m_Bool = false;
+		double m_Number = 0.0;
+		std::string m_String;
+		std::vector<JsonValue> m_Elements;	// Array elements or object members values
+		std::vector<std::string> m_Keys;	// Object members names
+	};
+
+
+	class JsonParser
+	{
+	public:
+
+		JsonParser(const char* begin, const char* end) : m_Cursor(begin), m_End(end) {}
+
+		bool Parse(JsonValue& root)
+		{
+			SkipSpaces();
+			if (!ParseValue(root, 0))
+				return false;
+
+			SkipSpaces();
+			return m_Cursor == m_End;
+		}
+
+	private:
+
+		void SkipSpaces()
+		{
+			while (m_Cursor < m_End && (*m_Cursor == ' ' || *m_Cursor == '\t' || *m_Cursor == '\n' || *m_Cursor == '\r'))
+				++m_Cursor;
+		}
+
+		bool Consume(char c)
+		{
+			SkipSpaces();
+			if (m_Cursor >= m_End || *m_Cursor != c)
+				return false;
+
+			++m_Cursor;
+			return true;
+		}
+
+		bool ParseValue(JsonValue& value, uint depth)
+		{
+			SkipSpaces();
+			if (depth > s_MaxDepth || m_Cursor >= m_End)
+				return false;
+
+			switch (*m_Cursor)
+			{
+				case '{':	return ParseObject(value, depth);
+				case '[':	return ParseArray(value, depth);
+				case '"':	value.m_Type = JsonValue::TYPE::STRING; return ParseString(value.m_String);
+				case 't':	value.m_Type = JsonValue::TYPE::BOOL; value.m_Bool = true; return ParseLiteral("true");
+				case 'f':	value.m_Type = JsonValue::TYPE::BOOL; value.m_Bool = false; return ParseLiteral("false");
+				case 'n':	value.m_Type = JsonValue::TYPE::NULL_VALUE; return ParseLiteral("null");
+				default:	return ParseNumber(value);
+			}
+		}
+
+		bool ParseObject(JsonValue& value, uint depth)
+		{
+			value.m_Type = JsonValue::TYPE::OBJECT;
+			++m_Cursor;
+			if (Consume('}'))
+				return true;
+
+			do
+			{
+				SkipSpaces();
+				value.m_Keys.emplace_back();
+				value.m_Elements.emplace_back();
+				if (m_Cursor >= m_End || *m_Cursor != '"' || !ParseString(value.m_Keys.back()) || !Consume(':') || !ParseValue(value.m_Elements.back(), depth + 1))
+					return false;
+			}
+			while (Consume(','));
+
+			return Consume('}');
+		}
+
+		bool ParseArray(JsonValue& value, uint depth)
+		{
+			value.m_Type = JsonValue::TYPE::ARRAY;
+			++m_Cursor;
+			if (Consume(']'))
+				return true;
+
+			do
+			{
+				value.m_Elements.emplace_back();
+				if (!ParseValue(value.m_Elements.back(), depth + 1))
+					return false;
+			}
+			while (Consume(','));
+
+			return Consume(']');
+		}
+
+		bool ParseString(std::string& str)
+		{
+			++m_Cursor; // Opening quote
+			while (m_Cursor < m_End && *m_Cursor != '"')
+			{
+				char c = *m_Cursor++;
+				if (c != '\\')
+				{
+					str.push_back(c);
+					continue;
+				}
+
+				if (m_Cursor >= m_End)
+					return false;
+
+				switch (char escaped = *m_Cursor++)
+				{
+					case 'b': str.push_back('\b'); break;
+					case 'f': str.push_back('\f'); break;
+					case 'n': str.push_back('\n'); break;
+					case 'r': str.push_back('\r'); break;
+					case 't': str.push_back('\t'); break;
+					case 'u':
+					{
+						uint code_point = 0;
+						if (!ParseHex4(code_point))
+							return false;
+
+						// Surrogate pair
+						if (code_point >= 0xD800 && code_point <= 0xDBFF && m_End - m_Cursor >= 6 && m_Cursor[0] == '\\' && m_Cursor[1] == 'u')
+						{
+							m_Cursor += 2;
+							uint low = 0;
+							if (!ParseHex4(low))
+								return false;
+
+							code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+						}
+
+						AppendUTF8(str, code_point);
+						break;
+					}
+					default: str.push_back(escaped); break; // ", \ & /
+				}
+			}
+
+			if (m_Cursor >= m_End)
+				return false;
+
+			++m_Cursor; // Closing quote
+			return true;
+		}
+
+		bool ParseHex4(uint& value)
+		{
+			if (m_End - m_Cursor < 4)
+				return false;
+
+			for (int i = 0; i < 4; ++i)
+			{
+				char c = *m_Cursor++;
+				uint digit = c >= '0' && c <= '9' ? c - '0' : (c >= 'a' && c <= 'f' ? c - 'a' + 10 : (c >= 'A' && c <= 'F' ? c - 'A' + 10 : 16));
+				if (digit > 15)
+					return false;
+
+				value = value * 16 + digit;
+			}
+
+			return true;
+		}
+
+		static void AppendUTF8(std::string& str, uint code_point)
+		{
+			if (code_point < 0x80)
+				str.push_back((char)code_point);
+			else if (code_point < 0x800)
+			{
+				str.push_back((char)(0xC0 | (code_point >> 6)));
+				str.push_back((char)(0x80 | (code_point & 0x3F)));
+			}
+			else if (code_point < 0x10000)
+			{
+				str.push_back((char)(0xE0 | (code_point >> 12)));
+				str.push_back((char)(0x80 | ((code_point >> 6) & 0x3F)));
+				str.push_back((char)(0x80 | (code_point & 0x3F)));
+			}
+			else
+			{
+				str.push_back((char)(0xF0 | (code_point >> 18)));
+				str.push_back((char)(0x80 | ((code_point >> 12) & 0x3F)));
+				str.push_back((char)(0x80 | ((code_point >> 6) & 0x3F)));
+				str.push_back((char)(0x80 | (code_point & 0x3F)));
+			}
+		}
+
+		bool ParseLiteral(const char* literal)
+		{
+			size_t length = strlen(literal);
+			if ((size_t)(m_End - m_Cursor) < length || strncmp(m_Cursor, literal, length) != 0)
+				return false;
+
+			m_Cursor += length;
+			return true;
+		}
+
+		bool ParseNumber(JsonValue& value)
+		{
+			char buffer[64];
+			size_t length = 0;
+			while (m_Cursor + length < m_End && length < sizeof(buffer) - 1 && strchr("+-0123456789.eE", m_Cursor[length]))
+				++length;
+
+			memcpy(buffer, m_Cursor, length);
+			buffer[length] = '\0';
+
+			char* number_end = nullptr;
+			value.m_Type = JsonValue::TYPE::NUMBER;
+			value.m_Number = strtod(buffer, &number_end);
+			m_Cursor += number_end - buffer;
+			return number_end != buffer;
+		}
+
+	private:
+
+		static constexpr uint s_MaxDepth = 64;
+		const char* m_Cursor = nullptr;
+		const char* m_End = nullptr;
+	};
+
+
+
+	// ------------------------------------------------------------------------------
+	// --- glTF Data ---
+	static constexpr uint s_GlbMagic = 0x46546C67, s_GlbJsonChunk = 0x4E4F534A, s_GlbBinChunk = 0x004E4942; // "glTF", "JSON", "BIN"
+
+	enum GLTF_COMPONENT : uint { BYTE = 5120, UNSIGNED_BYTE = 5121, SHORT = 5122, UNSIGNED_SHORT = 5123, UNSIGNED_INT = 5125, FLOAT = 5126 };
+	enum GLTF_MODE : int { TRIANGLES = 4 };
+
+	struct GltfBuffer
+	{
+		const uint8_t* Data = nullptr;
+		uint64 Size = 0;
+	};
+
+	// An accessor resolved into its buffer, validated to be fully inside it
+	struct AccessorView
+	{
+		const uint8_t* Data = nullptr;	// First element, nullptr if the accessor has no buffer view (all zeros)
+		uint Count = 0, Components = 0, ComponentType = 0, ElementSize = 0, Stride = 0;
+		bool Normalized = false;
+
+		bool IsTightFloats(uint components)	const { return Data && ComponentType == FLOAT && Components == components && Stride == components * sizeof(float); }
+	};
+
+	uint GetComponentSize(uint component_type)
+	{
+		switch (component_type)
+		{
+			case BYTE: case UNSIGNED_BYTE:		return 1;
+			case SHORT: case UNSIGNED_SHORT:	return 2;
+			case UNSIGNED_INT: case FLOAT:		return 4;
+			default:							return 0;
+		}
+	}
+
+	uint GetTypeComponents(const std::string& type)
+	{
+		if (type == "SCALAR")	return 1;
+		if (type == "VEC2")		return 2;
+		if (type == "VEC3")		return 3;
+		if (type == "VEC4")		return 4;
+		if (type == "MAT2")		return 4;
+		if (type == "MAT3")		return 9;
+		if (type == "MAT4")		return 16;
+		return 0;
+	}
+
+	bool ResolveAccessor(const JsonValue& json, int accessor_index, const std::vector<GltfBuffer>& buffers, AccessorView& view)
+	{
+		const JsonValue& accessor = json.Get("accessors").At(accessor_index);
+		if (!accessor.IsObject() || accessor.Get("sparse").Exists())
+			return false; // Sparse accessors are left to Assimp
+
+		view.ComponentType = (uint)accessor.Get("componentType").GetInt(0);
+		view.Components = GetTypeComponents(accessor.Get("type").GetString());
+		view.Normalized = accessor.Get("normalized").GetBool(false);
+		view.Count = (uint)std::max(accessor.Get("count").GetInt(0), 0);
+
+		uint component_size = GetComponentSize(view.ComponentType);
+		view.ElementSize = component_size * view.Components;
+		view.Stride = view.ElementSize;
+		if (view.ElementSize == 0)
+			return false;
+
+		// -- No Buffer View: Zeros --
+		const JsonValue& buffer_view_index = accessor.Get("bufferView");
+		if (!buffer_view_index.Exists())
+			return true;
+
+		// -- Resolve into the Buffer --
+		const JsonValue& buffer_view = json.Get("bufferViews").At(buffer_view_index.GetInt(-1));
+		int buffer_index = buffer_view.Get("buffer").GetInt(-1);
+		if (!buffer_view.IsObject() || buffer_index < 0 || buffer_index >= (int)buffers.size())
+			return false;
+
+		const GltfBuffer& buffer = buffers[buffer_index];
+		uint64 view_offset = (uint64)std::max(buffer_view.Get("byteOffset").GetNumber(0.0), 0.0);
+		uint64 view_length = (uint64)std::max(buffer_view.Get("byteLength").GetNumber(0.0), 0.0);
+		uint64 accessor_offset = (uint64)std::max(accessor.Get("byteOffset").GetNumber(0.0), 0.0);
+		view.Stride = (uint)std::max(buffer_view.Get("byteStride").GetInt(0), 0);
+		view.Stride = view.Stride > 0 ? view.Stride : view.ElementSize;
+
+		uint64 accessed_size = view.Count > 0 ? accessor_offset + (uint64)(view.Count - 1) * view.Stride + view.ElementSize : 0;
+		if (!buffer.Data || view_offset + view_length > buffer.Size || accessed_size > view_length || view.Stride < view.ElementSize)
+			return false;
+
+		view.Data = buffer.Data + view_offset + accessor_offset;
+		return true;
+	}
+
+	float ReadComponent(const uint8_t* data, uint component_type, bool normalized)
+	{
+		switch (component_type)
+		{
+			case BYTE:				{ int8_t v; memcpy(&v, data, 1); return normalized ? std::max((float)v / 127.0f, -1.0f) : (float)v; }
+			case UNSIGNED_BYTE:		{ uint8_t v = *data; return normalized ? (float)v / 255.0f : (float)v; }
+			case SHORT:				{ int16_t v; memcpy(&v, data, 2); return normalized ? std::max((float)v / 32767.0f, -1.0f) : (float)v; }
+			case UNSIGNED_SHORT:	{ uint16_t v; memcpy(&v, data, 2); return normalized ? (float)v / 65535.0f : (float)v; }
+			case UNSIGNED_INT:		{ uint v; memcpy(&v, data, 4); return (float)v; }
+			case FLOAT:				{ float v; memcpy(&v, data, 4); return v; }
+			default:				return 0.0f;
+		}
+	}
+
+	// Tightly packed floats, components beyond the accessor ones (or all, without buffer view) are 0
+	std::vector<uint8_t> ConvertToFloats(const AccessorView& view, uint components)
+	{
+		std::vector<uint8_t> ret((size_t)view.Count * components * sizeof(float), 0);
+		if (!view.Data)
+			return ret;
+
+		float* out = (float*)ret.data();
+		uint component_size = GetComponentSize(view.ComponentType), read_components = std::min(view.Components, components);
+		for (uint i = 0; i < view.Count; ++i)
+		{
+			const uint8_t* element = view.Data + (size_t)i * view.Stride;
+			for (uint c = 0; c < read_components; ++c)
+				out[(size_t)i * components + c] = ReadComponent(element + c * component_size, view.ComponentType, view.Normalized);
+		}
+
+		return ret;
+	}
+
+	inline uint ReadIndex(const AccessorView& view, uint i)
+	{
+		const uint8_t* element = view.Data + (size_t)i * view.Stride;
+		switch (view.ComponentType)
+		{
+			case UNSIGNED_BYTE:		return *element;
+			case UNSIGNED_SHORT:	{ uint16_t v; memcpy(&v, element, 2); return v; }
+			default:				{ uint v; memcpy(&v, element, 4); return v; }
+		}
+	}
+
+
+	// -- URIs --
+	bool IsDataURI(const std::string& uri) { return uri.compare(0, 5, "data:") == 0; }
+
+	// False if it isn't base64 or has invalid characters
+	bool DecodeDataURI(const std::string& uri, std::vector<uint8_t>& data)
+	{
+		size_t comma = uri.find(',');
+		if (comma == std::string::npos || uri.rfind(";base64", comma) == std::string::npos)
+			return false;
+
+		uint bits = 0, bits_count = 0;
+		data.reserve((uri.size() - comma) * 3 / 4);
+		for (size_t i = comma + 1; i < uri.size() && uri[i] != '='; ++i)
+		{
+			char c = uri[i];
+			int value = c >= 'A' && c <= 'Z' ? c - 'A' : (c >= 'a' && c <= 'z' ? c - 'a' + 26 : (c >= '0' && c <= '9' ? c - '0' + 52 : (c == '+' ? 62 : (c == '/' ? 63 : -1))));
+			if (value < 0)
+				return false;
+
+			bits = (bits << 6) | (uint)value;
+			bits_count += 6;
+			if (bits_count >= 8)
+			{
+				bits_count -= 8;
+				data.push_back((uint8_t)(bits >> bits_count));
+			}
+		}
+
+		return true;
+	}
+
+	std::string DecodePercentURI(const std::string& uri)
+	{
+		std::string ret;
+		for (size_t i = 0; i < uri.size(); ++i)
+		{
+			if (uri[i] == '%' && i + 2 < uri.size() && isxdigit((uint8_t)uri[i + 1]) && isxdigit((uint8_t)uri[i + 2]))
+			{
+				ret.push_back((char)std::stoi(uri.substr(i + 1, 2), nullptr, 16));
+				i += 2;
+			}
+			else
+				ret.push_back(uri[i]);
+		}
+
+		return ret;
+	}
+
+	// Embedded images (in a buffer view or a data URI) are written once into the cache directory, as the textures load from files
+	// Returns the path relative to the model directory, empty if it failed
+	std::string ExtractImage(const std::string& filepath, const uint8_t* data, uint64 size, const std::string& mime_type)
+	{
+		std::string extension = mime_type == "image/jpeg" ? ".jpg" : ".png";
+		std::string filename = std::filesystem::path(filepath).stem().string() + "_" + HashUtils::HashToString(HashUtils::XXH64(data, (size_t)size)) + extension;
+		std::filesystem::path image_path = std::filesystem::path(MeshCache::s_CacheDirectory) / filename;
+
+		std::error_code error;
+		if (!std::filesystem::exists(image_path, error) || std::filesystem::file_size(image_path, error) != size)
+		{
+			std::filesystem::create_directories(image_path.parent_path(), error);
+			std::ofstream file(image_path, std::ios::binary | std::ios::trunc);
+			if (!file.write((const char*)data, size))
+			{
+				ENGINE_LOG("glTF Importer: couldn't extract an image of '%s' into '%s'", filepath.c_str(), image_path.string().c_str());
+				return std::string();
+			}
+		}
+
+		std::filesystem::path model_directory = std::filesystem::absolute(filepath, error).parent_path();
+		return std::filesystem::absolute(image_path, error).lexically_relative(model_directory).generic_string();
+	}
+
+	// Path (relative to the model directory) of a texture image, empty if none
+	std::string GetTexturePath(const JsonValue& json, const JsonValue& texture_info, const std::string& filepath, const std::vector<GltfBuffer>& buffers)
+	{
+		if (!texture_info.IsObject())
+			return std::string();
+
+		const JsonValue& texture = json.Get("textures").At(texture_info.Get("index").GetInt(-1));
+		const JsonValue& image = json.Get("images").At(texture.Get("source").GetInt(-1));
+		if (!image.IsObject())
+			return std::string();
+
+		// -- External File --
+		const std::string& uri = image.Get("uri").GetString();
+		if (!uri.empty() && !IsDataURI(uri))
+			return DecodePercentURI(uri);
+
+		// -- Embedded --
+		std::vector<uint8_t> decoded;
+		if (!uri.empty())
+			return DecodeDataURI(uri, decoded) ? ExtractImage(filepath, decoded.data(), decoded.size(), uri.substr(5, uri.find(';') - 5)) : std::string();
+
+		const JsonValue& buffer_view = json.Get("bufferViews").At(image.Get("bufferView").GetInt(-1));
+		int buffer_index = buffer_view.Get("buffer").GetInt(-1);
+		uint64 offset = (uint64)std::max(buffer_view.Get("byteOffset").GetNumber(0.0), 0.0), length = (uint64)std::max(buffer_view.Get("byteLength").GetNumber(0.0), 0.0);
+		if (buffer_index < 0 || buffer_index >= (int)buffers.size() || !buffers[buffer_index].Data || offset + length > buffers[buffer_index].Size)
+			return std::string();
+
+		return ExtractImage(filepath, buffers[buffer_index].Data + offset, length, image.Get("mimeType").GetString());
+	}
+
+
+
+	// ------------------------------------------------------------------------------
+	// --- Primitives ---
+	// Smooth normals of the vertices (glTF asks for flat ones, which would need unwelding & so converting all the streams)
+	std::vector<uint8_t> GenerateNormals(const float* positions, const uint* indices, uint vertices_count, uint indices_count)
+	{
+		std::vector<uint8_t> ret((size_t)vertices_count * 3 * sizeof(float), 0);
+		glm::vec3* normals = (glm::vec3*)ret.data();
+		for (uint i = 0; i + 2 < indices_count; i += 3)
+		{
+			const glm::vec3* p[3] = { (const glm::vec3*)(positions + indices[i] * 3), (const glm::vec3*)(positions + indices[i + 1] * 3), (const glm::vec3*)(positions + indices[i + 2] * 3) };
+			glm::vec3 face_normal = glm::cross(*p[1] - *p[0], *p[2] - *p[0]); // Area-weighted
+			for (uint c = 0; c < 3; ++c)
+				normals[indices[i + c]] += face_normal;
+		}
+
+		for (uint i = 0; i < vertices_count; ++i)
+			normals[i] = glm::length(normals[i]) > FLT_MIN ? glm::normalize(normals[i]) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+		return ret;
+	}
+
+	// Accumulated from the triangles UVs & orthonormalized against the normals, w is the handedness (as glTF tangents)
+	std::vector<uint8_t> GenerateTangents(const float* positions, const float* texcoords, const float* normals, const uint* indices, uint vertices_count, uint indices_count)
+	{
+		std::vector<glm::vec3> tangents(vertices_count, glm::vec3(0.0f)), bitangents(vertices_count, glm::vec3(0.0f));
+		for (uint i = 0; i + 2 < indices_count; i += 3)
+		{
+			uint i0 = indices[i], i1 = indices[i + 1], i2 = indices[i + 2];
+			glm::vec3 edge1 = glm::vec3(positions[i1 * 3] - positions[i0 * 3], positions[i1 * 3 + 1] - positions[i0 * 3 + 1], positions[i1 * 3 + 2] - positions[i0 * 3 + 2]);
+			glm::vec3 edge2 = glm::vec3(positions[i2 * 3] - positions[i0 * 3], positions[i2 * 3 + 1] - positions[i0 * 3 + 1], positions[i2 * 3 + 2] - positions[i0 * 3 + 2]);
+			glm::vec2 delta_uv1 = glm::vec2(texcoords[i1 * 2] - texcoords[i0 * 2], texcoords[i1 * 2 + 1] - texcoords[i0 * 2 + 1]);
+			glm::vec2 delta_uv2 = glm::vec2(texcoords[i2 * 2] - texcoords[i0 * 2], texcoords[i2 * 2 + 1] - texcoords[i0 * 2 + 1]);
+
+			float determinant = delta_uv1.x * delta_uv2.y - delta_uv2.x * delta_uv1.y;
+			if (glm::abs(determinant) <= FLT_MIN)
+				continue;
+
+			glm::vec3 tangent = (edge1 * delta_uv2.y - edge2 * delta_uv1.y) / determinant;
+			glm::vec3 bitangent = (edge2 * delta_uv1.x - edge1 * delta_uv2.x) / determinant;
+			for (uint index : { i0, i1, i2 })
+			{
+				tangents[index] += tangent;
+				bitangents[index] += bitangent;
+			}
+		}
+
+		std::vector<uint8_t> ret((size_t)vertices_count * 4 * sizeof(float));
+		glm::vec4* out = (glm::vec4*)ret.data();
+		for (uint i = 0; i < vertices_count; ++i)
+		{
+			glm::vec3 normal = glm::vec3(normals[i * 3], normals[i * 3 + 1], normals[i * 3 + 2]);
+			glm::vec3 tangent = tangents[i] - normal * glm::dot(normal, tangents[i]);
+			if (glm::dot(tangent, tangent) <= FLT_MIN)
+				tangent = glm::abs(normal.x) < 0.9f ? glm::cross(normal, glm::vec3(1.0f, 0.0f, 0.0f)) : glm::cross(normal, glm::vec3(0.0f, 1.0f, 0.0f));
+
+			tangent = glm::normalize(tangent);
+			out[i] = glm::vec4(tangent, glm::dot(glm::cross(normal, tangent), bitangents[i]) < 0.0f ? -1.0f : 1.0f);
+		}
+
+		return ret;
+	}
+
+
+	// Resolves the primitive accessors: streams already laid out as the engine ones are referenced in place, the rest converted
+	bool PreparePrimitive(const JsonValue& json, const JsonValue& primitive, const std::vector<GltfBuffer>& buffers, GltfPrimitive& prepared)
+	{
+		const JsonValue& attributes = primitive.Get("attributes");
+		if (primitive.Get("mode").GetInt(TRIANGLES) != TRIANGLES)
+			return false;
+
+		// -- Positions --
+		AccessorView positions;
+		if (!ResolveAccessor(json, attributes.Get("POSITION").GetInt(-1), buffers, positions) || positions.Count == 0)
+			return false;
+
+		prepared.VerticesCount = positions.Count;
+		GltfStream* streams = prepared.Streams;
+		GltfStream& position_stream = streams[(int)GLTF_STREAM::POSITION];
+		if (positions.IsTightFloats(3))
+			position_stream.Data = positions.Data;
+		else
+			position_stream.Converted = ConvertToFloats(positions, 3);
+
+		position_stream.Size = (uint64)positions.Count * 3 * sizeof(float);
+		const float* position_data = (const float*)position_stream.GetData();
+
+		// -- Indices --
+		// Validated, so a corrupted file can't make the GPU read out of the buffers
+		GltfStream& index_stream = streams[(int)GLTF_STREAM::INDICES];
+		if (primitive.Get("indices").Exists())
+		{
+			AccessorView indices;
+			if (!ResolveAccessor(json, primitive.Get("indices").GetInt(-1), buffers, indices) || !indices.Data || indices.Components != 1
+				|| (indices.ComponentType != UNSIGNED_BYTE && indices.ComponentType != UNSIGNED_SHORT && indices.ComponentType != UNSIGNED_INT))
+				return false;
+
+			prepared.IndicesCount = indices.Count;
+			if (indices.ComponentType == UNSIGNED_INT && indices.Stride == sizeof(uint))
+				index_stream.Data = indices.Data;
+			else
+			{
+				index_stream.Converted.resize((size_t)indices.Count * sizeof(uint));
+				uint* out = (uint*)index_stream.Converted.data();
+				for (uint i = 0; i < indices.Count; ++i)
+					out[i] = ReadIndex(indices, i);
+			}
+		}
+		else
+		{
+			prepared.IndicesCount = positions.Count;
+			index_stream.Converted.resize((size_t)positions.Count * sizeof(uint));
+			uint* out = (uint*)index_stream.Converted.data();
+			for (uint i = 0; i < positions.Count; ++i)
+				out[i] = i;
+		}
+
+		prepared.IndicesCount -= prepared.IndicesCount % 3;
+		index_stream.Size = (uint64)prepared.IndicesCount * sizeof(uint);
+		const uint* index_data = (const uint*)index_stream.GetData();
+
+		uint max_index = 0;
+		for (uint i = 0; i < prepared.IndicesCount; ++i)
+			max_index = std::max(max_index, index_data[i]);
+
+		if (prepared.IndicesCount == 0 || max_index >= prepared.VerticesCount)
+			return false;
+
+		// -- Texture Coordinates --
+		// Always converted: glTF UVs start at the top while the textures get flipped on load
+		AccessorView texcoords;
+		bool has_texcoords = attributes.Get("TEXCOORD_0").Exists();
+		if (has_texcoords && (!ResolveAccessor(json, attributes.Get("TEXCOORD_0").GetInt(-1), buffers, texcoords) || texcoords.Count != prepared.VerticesCount))
+			return false;
+
+		GltfStream& texcoord_stream = streams[(int)GLTF_STREAM::TEXCOORD];
+		texcoord_stream.Converted = has_texcoords ? ConvertToFloats(texcoords, 2) : std::vector<uint8_t>((size_t)prepared.VerticesCount * 2 * sizeof(float), 0);
+		texcoord_stream.Size = texcoord_stream.Converted.size();
+
+		float* texcoord_data = (float*)texcoord_stream.Converted.data();
+		for (uint i = 0; has_texcoords && i < prepared.VerticesCount; ++i)
+			texcoord_data[i * 2 + 1] = 1.0f - texcoord_data[i * 2 + 1];
+
+		// -- Normals --
+		AccessorView normals;
+		GltfStream& normal_stream = streams[(int)GLTF_STREAM::NORMAL];
+		if (attributes.Get("NORMAL").Exists())
+		{
+			if (!ResolveAccessor(json, attributes.Get("NORMAL").GetInt(-1), buffers, normals) || normals.Count != prepared.VerticesCount)
+				return false;
+
+			if (normals.IsTightFloats(3))
+				normal_stream.Data = normals.Data;
+			else
+				normal_stream.Converted = ConvertToFloats(normals, 3);
+		}
+		else
+			normal_stream.Converted = GenerateNormals(position_data, index_data, prepared.VerticesCount, prepared.IndicesCount);
+
+		normal_stream.Size = (uint64)prepared.VerticesCount * 3 * sizeof(float);
+
+		// -- Tangents --
+		// vec4 (w is the handedness) into the vec4 tangent attribute, the shaders derive the bitangents signed by it. None without UVs (as Assimp)
+		AccessorView tangents;
+		GltfStream& tangent_stream = streams[(int)GLTF_STREAM::TANGENT];
+		if (attributes.Get("TANGENT").Exists())
+		{
+			if (!ResolveAccessor(json, attributes.Get("TANGENT").GetInt(-1), buffers, tangents) || tangents.Count != prepared.VerticesCount)
+				return false;
+
+			if (tangents.IsTightFloats(4))
+				tangent_stream.Data = tangents.Data;
+			else
+				tangent_stream.Converted = ConvertToFloats(tangents, 4);
+		}
+		else if (has_texcoords)
+			tangent_stream.Converted = GenerateTangents(position_data, texcoord_data, (const float*)normal_stream.GetData(), index_data, prepared.VerticesCount, prepared.IndicesCount);
+		else
+			tangent_stream.Converted.assign((size_t)prepared.VerticesCount * 4 * sizeof(float), 0);
+
+		tangent_stream.Size = (uint64)prepared.VerticesCount * 4 * sizeof(float);
+
+		// -- Bounds --
+		// From the accessor (required by the spec), computed if missing
+		float min[3], max[3];
+		const JsonValue& position_accessor = json.Get("accessors").At(attributes.Get("POSITION").GetInt(-1));
+		if (positions.Data && positions.ComponentType == FLOAT && position_accessor.Get("min").GetNumbers(min, 3) && position_accessor.Get("max").GetNumbers(max, 3))
+			prepared.Bounds = { glm::vec3(min[0], min[1], min[2]), glm::vec3(max[0], max[1], max[2]) };
+		else
+		{
+			prepared.Bounds = { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+			for (uint i = 0; i < prepared.VerticesCount; ++i)
+			{
+				glm::vec3 position = glm::vec3(position_data[i * 3], position_data[i * 3 + 1], position_data[i * 3 + 2]);
+				prepared.Bounds.Min = glm::min(prepared.Bounds.Min, position);
+				prepared.Bounds.Max = glm::max(prepared.Bounds.Max, position);
+			}
+		}
+
+		// -- Meshlets --
+		prepared.Meshlets = MeshImporter::BuildMeshlets(position_data, 3, prepared.VerticesCount, index_data, prepared.IndicesCount);
+
+		// -- Page In Streams --
+		// So the uploads on the main thread don't wait on disk
+		for (const GltfStream& stream : prepared.Streams)
+			if (stream.IsInPlace())
+				FileUtils::PageIn(stream.Data, (size_t)stream.Size);
+
+		return true;
+	}
+
+
+	glm::mat4 GetNodeTransform(const JsonValue& node)
+	{
+		float values[16];
+		if (node.Get("matrix").GetNumbers(values, 16))
+		{
+			glm::mat4 matrix;
+			memcpy(&matrix[0][0], values, sizeof(values)); // Both column-major
+			return matrix;
+		}
+
+		float translation[3] = { 0.0f, 0.0f, 0.0f }, rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f }, scale[3] = { 1.0f, 1.0f, 1.0f };
+		node.Get("translation").GetNumbers(translation, 3);
+		node.Get("rotation").GetNumbers(rotation, 4);
+		node.Get("scale").GetNumbers(scale, 3);
+
+		glm::quat quaternion = glm::quat(rotation[3], rotation[0], rotation[1], rotation[2]);
+		return glm::translate(glm::mat4(1.0f), glm::vec3(translation[0], translation[1], translation[2])) * glm::mat4_cast(quaternion)
+			* glm::scale(glm::mat4(1.0f), glm::vec3(scale[0], scale[1], scale[2]));
+	}
+
+
+	// JSON & binary chunks of a .glb (header: magic, version, length, then chunks: length, type, data), the whole file as JSON
+	// if it's a .gltf. False if it's a GLB but not a valid glTF 2.0 one
+	bool ReadChunks(const uint8_t* data, uint64 file_size, const char*& json_begin, const char*& json_end, GltfBuffer& glb_buffer)
+	{
+		json_begin = (const char*)data;
+		json_end = json_begin + file_size;
+
+		uint header[3];
+		if (file_size < sizeof(header) || (memcpy(header, data, sizeof(header)), header[0] != s_GlbMagic))
+			return true;
+
+		uint64 size = std::min((uint64)header[2], file_size);
+		json_begin = json_end = nullptr;
+		for (uint64 offset = sizeof(header); offset + 8 <= size;)
+		{
+			uint chunk[2];
+			memcpy(chunk, data + offset, sizeof(chunk));
+			offset += sizeof(chunk);
+			if (offset + chunk[0] > size)
+				break;
+
+			if (chunk[1] == s_GlbJsonChunk && !json_begin)
+			{
+				json_begin = (const char*)data + offset;
+				json_end = json_begin + chunk[0];
+			}
+			else if (chunk[1] == s_GlbBinChunk && !glb_buffer.Data)
+				glb_buffer = { data + offset, chunk[0] };
+
+			offset += (chunk[0] + 3) & ~3u;
+		}
+
+		return header[1] == 2 && json_begin != nullptr;
+	}
+}
+
+
+
+// ------------------------------------------------------------------------------
+bool GltfImporter::IsGltfFile(const std::string& filepath)
+{
+	std::string extension = std::filesystem::path(filepath).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)tolower(c); });
+	return extension == ".gltf" || extension == ".glb";
+}
+
+
+std::vector<std::string> GltfImporter::GetExternalBuffers(const std::string& filepath, const uint8_t* data, uint64 size)
+{
+	std::vector<std::string> buffers;
+	const char* json_begin = nullptr, *json_end = nullptr;
+	GltfBuffer glb_buffer;
+	JsonValue json;
+	if (!ReadChunks(data, size, json_begin, json_end, glb_buffer) || !JsonParser(json_begin, json_end).Parse(json) || !json.IsObject())
+		return buffers;
+
+	const JsonValue& buffers_json = json.Get("buffers");
+	std::string directory = FileUtils::GetDirectory(filepath);
+	for (size_t i = 0; i < buffers_json.Size(); ++i)
+	{
+		const std::string& uri = buffers_json.At(i).Get("uri").GetString();
+		if (!uri.empty() && !IsDataURI(uri))
+			buffers.push_back(FileUtils::MakePath(directory, DecodePercentURI(uri)));
+	}
+
+	return buffers;
+}
+
+
+bool GltfImporter::PrepareModel(const std::string& filepath, GltfModel& gltf_model)
+{
+	// -- Map File --
+	gltf_model.Files.push_back(CreateUnique<FileUtils::VirtualFile>());
+	FileUtils::VirtualFile& file = *gltf_model.Files.back();
+	if (!file.Open(filepath))
+	{
+		ENGINE_LOG("glTF Importer: couldn't open '%s'", filepath.c_str());
+		return false;
+	}
+
+	// -- GLB Chunks --
+	const uint8_t* data = file.GetData();
+	const char* json_begin = nullptr, *json_end = nullptr;
+	GltfBuffer glb_buffer;
+	if (!ReadChunks(data, file.GetSize(), json_begin, json_end, glb_buffer))
+	{
+		ENGINE_LOG("glTF Importer: '%s' is not a valid glTF 2.0 binary", filepath.c_str());
+		return false;
+	}
+
+	// -- Parse JSON --
+	JsonValue json;
+	if (!JsonParser(json_begin, json_end).Parse(json) || !json.IsObject())
+	{
+		ENGINE_LOG("glTF Importer: couldn't parse the JSON of '%s'", filepath.c_str());
+		return false;
+	}
+
+	// -- Buffers --
+	// The GLB binary chunk, files mapped (through the VFS) or base64 data
+	const JsonValue& buffers_json = json.Get("buffers");
+	std::vector<GltfBuffer> buffers(buffers_json.Size());
+	std::string directory = FileUtils::GetDirectory(filepath);
+	for (size_t i = 0; i < buffers.size(); ++i)
+	{
+		const std::string& uri = buffers_json.At(i).Get("uri").GetString();
+		if (uri.empty())
+		{
+			buffers[i] = i == 0 ? glb_buffer : GltfBuffer();
+		}
+		else if (IsDataURI(uri))
+		{
+			gltf_model.DecodedBuffers.emplace_back();
+			if (DecodeDataURI(uri, gltf_model.DecodedBuffers.back()))
+				buffers[i] = { gltf_model.DecodedBuffers.back().data(), gltf_model.DecodedBuffers.back().size() };
+		}
+		else
+		{
+			gltf_model.Files.push_back(CreateUnique<FileUtils::VirtualFile>());
+			if (gltf_model.Files.back()->Open(FileUtils::MakePath(directory, DecodePercentURI(uri))))
+				buffers[i] = { gltf_model.Files.back()->GetData(), gltf_model.Files.back()->GetSize() };
+		}
+
+		// Declared size, so accessors can't read past it (the GLB chunk can be padded)
+		buffers[i].Size = std::min(buffers[i].Size, (uint64)std::max(buffers_json.At(i).Get("byteLength").GetNumber(0.0), 0.0));
+		if (!buffers[i].Data)
+			ENGINE_LOG("glTF Importer: couldn't load buffer %zu of '%s'", i, filepath.c_str());
+	}
+
+	// -- Nodes --
+	// Walked from the scene roots (or the parentless nodes, without scenes), their transforms flattened into the model space
+	const JsonValue& nodes = json.Get("nodes");
+	const JsonValue& meshes_json = json.Get("meshes");
+	std::vector<std::pair<int, glm::mat4>> nodes_to_visit;
+
+	const JsonValue& scene = json.Get("scenes").At((size_t)std::max(json.Get("scene").GetInt(0), 0));
+	if (scene.IsObject())
+	{
+		for (size_t i = 0; i < scene.Get("nodes").Size(); ++i)
+			nodes_to_visit.push_back({ scene.Get("nodes").At(i).GetInt(-1), glm::mat4(1.0f) });
+	}
+	else
+	{
+		std::vector<bool> is_child(nodes.Size(), false);
+		for (size_t i = 0; i < nodes.Size(); ++i)
+			for (size_t c = 0; c < nodes.At(i).Get("children").Size(); ++c)
+				if (nodes.At(i).Get("children").At(c).GetInt(-1) >= 0 && nodes.At(i).Get("children").At(c).GetInt(-1) < (int)nodes.Size())
+					is_child[nodes.At(i).Get("children").At(c).GetInt(-1)] = true;
+
+		for (size_t i = 0; i < nodes.Size(); ++i)
+			if (!is_child[i])
+				nodes_to_visit.push_back({ (int)i, glm::mat4(1.0f) });
+	}
+
+	std::vector<bool> visited(nodes.Size(), false); // Nodes are a forest, but a broken file could have cycles
+	while (!nodes_to_visit.empty())
+	{
+		std::pair<int, glm::mat4> node_to_visit = nodes_to_visit.back();
+		nodes_to_visit.pop_back();
+		if (node_to_visit.first < 0 || node_to_visit.first >= (int)nodes.Size() || visited[node_to_visit.first])
+			continue;
+
+		visited[node_to_visit.first] = true;
+		const JsonValue& node = nodes.At(node_to_visit.first);
+		glm::mat4 transform = node_to_visit.second * GetNodeTransform(node);
+
+		int mesh_index = node.Get("mesh").GetInt(-1);
+		if (mesh_index >= 0 && mesh_index < (int)meshes_json.Size())
+		{
+			std::string name = node.Get("name").GetString();
+			gltf_model.Instances.push_back({ name.empty() ? meshes_json.At(mesh_index).Get("name").GetString() : name, (uint)mesh_index, transform });
+		}
+
+		// Reversed, so children are visited in order
+		const JsonValue& children = node.Get("children");
+		for (size_t c = children.Size(); c > 0; --c)
+			nodes_to_visit.push_back({ children.At(c - 1).GetInt(-1), transform });
+	}
+
+	// Without nodes, meshes are drawn as they are
+	if (gltf_model.Instances.empty())
+		for (uint i = 0; i < (uint)meshes_json.Size(); ++i)
+			gltf_model.Instances.push_back({ meshes_json.At(i).Get("name").GetString(), i, glm::mat4(1.0f) });
+
+	if (gltf_model.Instances.empty())
+	{
+		ENGINE_LOG("glTF Importer: no meshes in '%s'", filepath.c_str());
+		return false;
+	}
+
+	// -- Meshes --
+	// Only the instanced ones, each primitive prepared in its own job
+	gltf_model.Meshes.resize(meshes_json.Size());
+	std::vector<std::pair<uint, uint>> primitives; // Mesh & primitive
+	for (const GltfInstance& instance : gltf_model.Instances)
+	{
+		GltfMesh& mesh = gltf_model.Meshes[instance.MeshIndex];
+		const JsonValue& mesh_json = meshes_json.At(instance.MeshIndex);
+		if (!mesh.Primitives.empty() || mesh_json.Get("primitives").Size() == 0)
+			continue;
+
+		mesh.Name = mesh_json.Get("name").GetString();
+		mesh.Primitives.resize(mesh_json.Get("primitives").Size());
+		for (uint p = 0; p < (uint)mesh.Primitives.size(); ++p)
+		{
+			int material = mesh_json.Get("primitives").At(p).Get("material").GetInt(-1);
+			mesh.Primitives[p].MaterialSlot = material >= 0 && material < (int)json.Get("materials").Size() ? material : -1;
+			primitives.push_back({ instance.MeshIndex, p });
+		}
+	}
+
+	std::atomic<uint> failed_primitives = { 0 };
+	JobSystem::ParallelFor((uint)primitives.size(), JobSystem::GetBatchSize((uint)primitives.size()), [&](uint first, uint count)
+	{
+		for (uint i = first; i < first + count; ++i)
+		{
+			const JsonValue& primitive = meshes_json.At(primitives[i].first).Get("primitives").At(primitives[i].second);
+			if (!PreparePrimitive(json, primitive, buffers, gltf_model.Meshes[primitives[i].first].Primitives[primitives[i].second]))
+				failed_primitives.fetch_add(1);
+		}
+	});
+
+	// Unsupported or invalid primitives (sparse accessors, non-triangles modes, out of bounds data) leave the file to Assimp
+	if (failed_primitives > 0)
+	{
+		ENGINE_LOG("glTF Importer: %u primitives of '%s' can't be imported natively", failed_primitives.load(), filepath.c_str());
+		return false;
+	}
+
+	// -- Materials --
+	// PBR metallic-roughness: base color as albedo, roughness as the inverse smoothness. No slots for occlusion & metal-roughness maps
+	const JsonValue& materials_json = json.Get("materials");
+	for (size_t i = 0; i < materials_json.Size(); ++i)
+	{
+		const JsonValue& material_json = materials_json.At(i);
+		const JsonValue& pbr = material_json.Get("pbrMetallicRoughness");
+
+		ImportedMaterial material;
+		material.Name = material_json.Get("name").GetString().empty() ? "material_" + std::to_string(i) : material_json.Get("name").GetString();
+
+		float base_color[4] = { 1.0f, 1.0f, 1.0f, 1.0f }, emissive[3] = { 0.0f, 0.0f, 0.0f };
+		pbr.Get("baseColorFactor").GetNumbers(base_color, 4);
+		material_json.Get("emissiveFactor").GetNumbers(emissive, 3);
+
+		material.AlbedoColor = glm::vec4(base_color[0], base_color[1], base_color[2], base_color[3]);
+		material.EmissiveColor = glm::vec4(emissive[0], emissive[1], emissive[2], 1.0f);
+		material.Smoothness = 1.0f - (float)pbr.Get("roughnessFactor").GetNumber(1.0);
+		if (material.Smoothness < FLT_EPSILON)
+			material.Smoothness = 0.1f;
+
+		material.IsTwoSided = material_json.Get("doubleSided").GetBool(false);
+		material.IsEmissive = emissive[0] > 0.0f || emissive[1] > 0.0f || emissive[2] > 0.0f;
+		material.IsTransparent = material_json.Get("alphaMode").GetString() == "BLEND";
+		material.IsAlphaTested = material_json.Get("alphaMode").GetString() == "MASK";
+		material.AlphaCutoff = (float)material_json.Get("alphaCutoff").GetNumber(0.5);
+
+		material.TexturePaths[(int)MATERIAL_TEXTURE::ALBEDO] = GetTexturePath(json, pbr.Get("baseColorTexture"), filepath, buffers);
+		material.TexturePaths[(int)MATERIAL_TEXTURE::NORMAL] = GetTexturePath(json, material_json.Get("normalTexture"), filepath, buffers);
+		material.TexturePaths[(int)MATERIAL_TEXTURE::EMISSIVE] = GetTexturePath(json, material_json.Get("emissiveTexture"), filepath, buffers);
+		gltf_model.Materials.push_back(material);
+	}
+
+	// -- Stats --
+	for (const GltfMesh& mesh : gltf_model.Meshes)
+		for (const GltfPrimitive& primitive : mesh.Primitives)
+			for (const GltfStream& stream : primitive.Streams)
+				(stream.IsInPlace() ? gltf_model.InPlaceBytes : gltf_model.ConvertedBytes) += stream.Size;
+
+	ENGINE_LOG("glTF '%s': %.2f MB uploaded in place, %.2f MB converted", filepath.c_str(), (float)gltf_model.InPlaceBytes / MBTOBYTE(1.0f), (float)gltf_model.ConvertedBytes / MBTOBYTE(1.0f));
+	return true;
+}
+
+
+
+// ------------------------------------------------------------------------------
+Ref<Model> GltfImporter::CreateModel(const std::string& filepath, const GltfModel& gltf_model)
+{
+	// -- Create Materials --
+	std::string directory = FileUtils::GetDirectory(filepath);
+	std::vector<MaterialHandle> materials;
+	for (const ImportedMaterial& material : gltf_model.Materials)
+		materials.push_back(MeshImporter::CreateMaterial(material, directory)->GetID());
+
+	// -- Create Primitives Buffers --
+	// A vertex buffer per attribute (in their locations order), uploaded straight from the streams. Instances share them
+	static const BufferElement s_StreamsElements[] = { { SHADER_DATA::FLOAT3, "a_Position" }, { SHADER_DATA::FLOAT2, "a_TexCoord" },
+													   { SHADER_DATA::FLOAT3, "a_Normal" }, { SHADER_DATA::FLOAT4, "a_Tangent" } };
+
+	std::vector<std::vector<Ref<VertexArray>>> vertex_arrays(gltf_model.Meshes.size());
+	std::vector<std::vector<Ref<StorageBuffer>>> meshlets_buffers(gltf_model.Meshes.size());
+	for (size_t m = 0; m < gltf_model.Meshes.size(); ++m)
+	{
+		for (const GltfPrimitive& primitive : gltf_model.Meshes[m].Primitives)
+		{
+			Ref<VertexArray> vao = CreateRef<VertexArray>();
+			for (uint s = 0; s < (uint)GLTF_STREAM::INDICES; ++s)
+			{
+				Ref<VertexBuffer> vbo = CreateRef<VertexBuffer>((const float*)primitive.Streams[s].GetData(), (uint)primitive.Streams[s].Size);
+				vbo->SetLayout({ s_StreamsElements[s] });
+				vao->AddVertexBuffer(vbo);
+				vbo->Unbind();
+			}
+
+			const GltfStream& indices = primitive.Streams[(int)GLTF_STREAM::INDICES];
+			Ref<IndexBuffer> ibo = CreateRef<IndexBuffer>((const uint*)indices.GetData(), primitive.IndicesCount);
+			vao->SetIndexBuffer(ibo);
+			vao->Unbind(); ibo->Unbind();
+			vertex_arrays[m].push_back(vao);
+			meshlets_buffers[m].push_back(MeshImporter::CreateMeshletsBuffer(primitive.Meshlets.data(), (uint)primitive.Meshlets.size()));
+		}
+	}
+
+	// -- Create Meshes --
+	// A mesh per instanced primitive, with the node transform
+	Ref<Model> model = CreateRef<Model>(new Model(filepath));
+	for (const GltfInstance& instance : gltf_model.Instances)
+	{
+		const GltfMesh& gltf_mesh = gltf_model.Meshes[instance.MeshIndex];
+		for (size_t p = 0; p < gltf_mesh.Primitives.size(); ++p)
+		{
+			const GltfPrimitive& primitive = gltf_mesh.Primitives[p];
+			MaterialHandle material_id = primitive.MaterialSlot == -1 ? MaterialHandle() : materials[primitive.MaterialSlot];
+			std::string name = instance.Name.empty() ? "unnamed" : instance.Name;
+			if (gltf_mesh.Primitives.size() > 1)
+				name += "_" + std::to_string(p);
+
+			Ref<Mesh> mesh = Resources::CreateMesh(vertex_arrays[instance.MeshIndex][p]);
+			MeshImporter::AddModelMesh(model.get(), mesh, name, material_id, primitive.Bounds, instance.Transform);
+			mesh->SetMeshlets(meshlets_buffers[instance.MeshIndex][p], (uint)primitive.Meshlets.size());
+		}
+	}
+
+	return model;
+}
@@ -0,0 +1,83 @@
+#ifndef _GLTFIMPORTER_H_
+#define _GLTFIMPORTER_H_
+
+#include "Core/Globals.h"
+#include "MeshImporter.h"
+
+#include <glm/glm.hpp>
+
+
+// --- Prepared glTF Data ---
+// Vertex streams (in the attributes locations order) & indices of a primitive
+enum class GLTF_STREAM { POSITION = 0, TEXCOORD, NORMAL, TANGENT, INDICES, MAX };
+
+// In place (into the mapped buffers) when the accessor layout is the engine's one, otherwise converted or generated
+struct GltfStream
+{
+	const void* Data = nullptr;
+	std::vector<uint8_t> Converted;
+	uint64 Size = 0;	// In bytes
+
+	const void* GetData()	const { return Converted.empty() ? Data : Converted.data(); }
+	bool IsInPlace()		const { return Converted.empty(); }
+};
+
+struct GltfPrimitive
+{
+	int MaterialSlot = -1;
+	uint VerticesCount = 0, IndicesCount = 0;
+	GltfStream Streams[(int)GLTF_STREAM::MAX];
+	std::vector<Meshlet> Meshlets;
+	AABB Bounds = {};
+};
+
+struct GltfMesh
+{
+	std::string Name;
+	std::vector<GltfPrimitive> Primitives;
+};
+
+// A node drawing a mesh (many can draw the same one), its transform flattened into the model space
+struct GltfInstance
+{
+	std::string Name;
+	uint MeshIndex = 0;
+	glm::mat4 Transform = glm::mat4(1.0f);
+};
+
+struct GltfModel
+{
+	std::vector<UniquePtr<FileUtils::VirtualFile>> Files;	// Mapped .glb & .bin files, the in-place streams point into them
+	std::vector<std::vector<uint8_t>> DecodedBuffers;		// Base64 (data URI) buffers
+	std::vector<ImportedMaterial> Materials;
+	std::vector<GltfMesh> Meshes;
+	std::vector<GltfInstance> Instances;
+	uint64 InPlaceBytes = 0, ConvertedBytes = 0;
+};
+
+
+
+// --- glTF Importer ---
+// Native glTF 2.0 (.gltf & .glb) importer: accessors are read in place from the mapped buffers, the ones already laid out as
+// the engine's vertex attributes are uploaded straight from there (a vertex buffer per attribute), the rest converted
+// Materials map to the engine ones (PBR metallic-roughness factors & textures), nodes to meshes sharing their primitives buffers
+class GltfImporter
+{
+	friend class MeshImporter;
+public:
+
+	static bool IsGltfFile(const std::string& filepath);
+
+	// Files of its buffers other than the .gltf/.glb itself (resolved), for the mesh cache key when Assimp imports it
+	static std::vector<std::string> GetExternalBuffers(const std::string& filepath, const uint8_t* data, uint64 size);
+
+private:
+
+	// Any thread: maps & parses the file, validates the accessors & converts (or generates) the streams that need it, false if it failed
+	static bool PrepareModel(const std::string& filepath, GltfModel& gltf_model);
+
+	// Main thread: creates the buffers, materials & meshes
+	static Ref<Model> CreateModel(const std::string& filepath, const GltfModel& gltf_model);
+};
+
+#endif //_GLTFIMPORTER_H_
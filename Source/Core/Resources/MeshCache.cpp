@@ -0,0 +1,359 @@
+#include "MeshCache.h"
+
+#include "MeshImporter.h"
+#include "GltfImporter.h"
+#include "ObjImporter.h"
+#include "Resources.h"
+#include "Core/Utils/FileStringUtils.h"
+#include "Core/Utils/Hash.h"
+
+#include <filesystem>
+
+
+// ------------------------------------------------------------------------------
+// --- File Layout ---
+// [Header][Materials][Meshes][Instances][Strings][Vertices (16b aligned)][Indices (16b aligned)][Meshlets (16b aligned)]
+namespace
+{
+	static const uint s_CacheMagic = 0x4D504741; // "AGPM"
+	static const uint s_InvalidString = 0xFFFFFFFF;
+
+	enum CachedMaterialFlags : uint { MATFLAG_TWO_SIDED = 1 << 0, MATFLAG_EMISSIVE = 1 << 1, MATFLAG_TRANSPARENT = 1 << 2, MATFLAG_ALPHA_TESTED = 1 << 3 };
+
+	struct CacheHeader
+	{
+		uint Magic, Version, ImportFlags, MaterialsCount;
+		uint64 SourceHash;
+		uint MeshesCount, StringsSize;
+		uint64 StringsOffset, VerticesOffset, VerticesSize, IndicesOffset, IndicesSize;
+		uint InstancesCount, Padding;
+		uint64 MeshletsOffset, MeshletsSize;
+	};
+
+	struct CachedMaterial
+	{
+		uint NameOffset, Flags;
+		float AlbedoColor[4], EmissiveColor[4];
+		float Smoothness, Bumpiness, AlphaCutoff;
+		uint TextureOffsets[(int)MATERIAL_TEXTURE::MAX];
+	};
+
+	struct CachedMesh
+	{
+		uint NameOffset;
+		int MaterialSlot;
+		uint64 VerticesOffset, VerticesSize;	// In bytes, relative to the vertices blob
+		uint64 IndicesOffset;					// In bytes, relative to the indices blob
+		uint IndicesCount;
+		float AABBMin[3], AABBMax[3];
+		uint MeshletsCount;
+		uint64 MeshletsOffset;					// In bytes, relative to the meshlets blob
+	};
+
+	struct CachedInstance
+	{
+		uint NameOffset, MeshIndex;
+		int MaterialSlot;
+		float Transform[16];
+	};
+
+	static_assert(sizeof(CacheHeader) == 96 && sizeof(CachedMaterial) == 72 && sizeof(CachedMesh) == 72 && sizeof(CachedInstance) == 76, "MeshCache structs must be tightly packed");
+
+	inline uint64 AlignTo16(uint64 offset) { return (offset + 15) & ~(uint64)15; }
+
+	uint AddString(std::string& strings, const std::string& str)
+	{
+		if (str.empty())
+			return s_InvalidString;
+
+		uint offset = (uint)strings.size();
+		strings.append(str.c_str(), str.size() + 1);
+		return offset;
+	}
+
+	std::string GetString(const char* strings, uint strings_size, uint offset)
+	{
+		if (offset == s_InvalidString || offset >= strings_size)
+			return std::string();
+
+		return std::string(strings + offset, strnlen(strings + offset, strings_size - offset));
+	}
+}
+
+
+
+// ------------------------------------------------------------------------------
+uint64 MeshCache::GetSourceHash(const std::string& filepath)
+{
+	FileUtils::VirtualFile source(filepath);
+	if (!source.IsOpen())
+		return 0;
+
+	uint64 seed = ((uint64)s_Version << 32) | (uint64)MeshImporter::GetAssimpImportFlags();
+	uint64 hash = HashUtils::XXH64(source.GetData(), source.GetSize(), seed);
+
+	// -- Dependencies --
+	// Files the importers read besides the source (OBJ material libraries, glTF external buffers), a missing one hashed as such
+	std::vector<std::string> dependencies;
+	if (ObjImporter::IsObjFile(filepath))
+		dependencies = ObjImporter::GetMaterialLibraries(filepath, source.GetData(), source.GetSize());
+	else if (GltfImporter::IsGltfFile(filepath))
+		dependencies = GltfImporter::GetExternalBuffers(filepath, source.GetData(), source.GetSize());
+
+	for (const std::string& dependency_path : dependencies)
+	{
+		FileUtils::VirtualFile dependency(dependency_path);
+		hash = HashUtils::HashString(dependency_path, hash);
+		hash = dependency.IsOpen() ? HashUtils::XXH64(dependency.GetData(), dependency.GetSize(), hash) : HashUtils::HashString("missing", hash);
+	}
+
+	return hash;
+}
+
+std::string MeshCache::GetCacheFilepath(const std::string& filepath)
+{
+	std::string normalized_path = std::filesystem::path(filepath).lexically_normal().generic_string();
+	std::string filename = std::filesystem::path(filepath).stem().string() + "_" + HashUtils::HashToString(HashUtils::HashString(normalized_path)) + ".agpmesh";
+	return FileUtils::MakePath(s_CacheDirectory, filename);
+}
+
+
+
+// ------------------------------------------------------------------------------
+bool MeshCache::OpenModel(const std::string& filepath, uint64 source_hash, FileUtils::VirtualFile& cache)
+{
+	if (source_hash == 0)
+		return false;
+
+	// -- Open Cache File --
+	// Through the VFS, so caches shipped in an asset pack are used too
+	if (!cache.Open(GetCacheFilepath(filepath)) || cache.GetSize() < sizeof(CacheHeader))
+	{
+		cache.Close();
+		return false;
+	}
+
+	// -- Check Header --
+	const uint8_t* data = cache.GetData();
+	const uint64 size = cache.GetSize();
+	const CacheHeader* header = (const CacheHeader*)data;
+
+	if (header->Magic != s_CacheMagic || header->Version != s_Version || header->ImportFlags != MeshImporter::GetAssimpImportFlags() || header->SourceHash != source_hash)
+	{
+		cache.Close();
+		return false;
+	}
+
+	uint64 tables_size = sizeof(CacheHeader) + (uint64)header->MaterialsCount * sizeof(CachedMaterial) + (uint64)header->MeshesCount * sizeof(CachedMesh)
+		+ (uint64)header->InstancesCount * sizeof(CachedInstance);
+
+	if (header->MeshesCount == 0 || header->InstancesCount == 0 || tables_size > size || header->StringsOffset + header->StringsSize > size
+		|| header->VerticesOffset + header->VerticesSize > size || header->IndicesOffset + header->IndicesSize > size || header->MeshletsOffset + header->MeshletsSize > size)
+	{
+		ENGINE_LOG("Mesh Cache for '%s' is corrupted, reimporting it", filepath.c_str());
+		cache.Close();
+		return false;
+	}
+
+	const CachedMesh* meshes = (const CachedMesh*)(data + sizeof(CacheHeader) + (uint64)header->MaterialsCount * sizeof(CachedMaterial));
+	for (uint i = 0; i < header->MeshesCount; ++i)
+	{
+		if (meshes[i].VerticesOffset + meshes[i].VerticesSize > header->VerticesSize || meshes[i].IndicesOffset + (uint64)meshes[i].IndicesCount * sizeof(uint) > header->IndicesSize
+			|| meshes[i].MeshletsOffset + (uint64)meshes[i].MeshletsCount * sizeof(Meshlet) > header->MeshletsSize || meshes[i].MaterialSlot >= (int)header->MaterialsCount)
+		{
+			ENGINE_LOG("Mesh Cache for '%s' is corrupted, reimporting it", filepath.c_str());
+			cache.Close();
+			return false;
+		}
+	}
+
+	const CachedInstance* instances = (const CachedInstance*)(meshes + header->MeshesCount);
+	for (uint i = 0; i < header->InstancesCount; ++i)
+	{
+		if (instances[i].MeshIndex >= header->MeshesCount || instances[i].MaterialSlot >= (int)header->MaterialsCount)
+		{
+			ENGINE_LOG("Mesh Cache for '%s' is corrupted, reimporting it", filepath.c_str());
+			cache.Close();
+			return false;
+		}
+	}
+
+	// -- Page In Buffers Data --
+	// So the uploads on the main thread don't wait on disk
+	FileUtils::PageIn(data + header->VerticesOffset, (size_t)(header->MeshletsOffset + header->MeshletsSize - header->VerticesOffset));
+	return true;
+}
+
+
+Ref<Model> MeshCache::CreateModel(const std::string& filepath, const FileUtils::VirtualFile& cache)
+{
+	const uint8_t* data = cache.GetData();
+	const CacheHeader* header = (const CacheHeader*)data;
+	const CachedMaterial* materials = (const CachedMaterial*)(data + sizeof(CacheHeader));
+	const CachedMesh* meshes = (const CachedMesh*)(materials + header->MaterialsCount);
+	const CachedInstance* instances = (const CachedInstance*)(meshes + header->MeshesCount);
+	const char* strings = (const char*)(data + header->StringsOffset);
+	const uint8_t* vertices = data + header->VerticesOffset;
+	const uint8_t* indices = data + header->IndicesOffset;
+	const uint8_t* meshlets = data + header->MeshletsOffset;
+
+	// -- Create Materials --
+	std::string directory = FileUtils::GetDirectory(filepath);
+	std::vector<MaterialHandle> material_ids;
+	for (uint i = 0; i < header->MaterialsCount; ++i)
+	{
+		const CachedMaterial& cached_mat = materials[i];
+		ImportedMaterial material;
+		material.Name = GetString(strings, header->StringsSize, cached_mat.NameOffset);
+		material.AlbedoColor = glm::vec4(cached_mat.AlbedoColor[0], cached_mat.AlbedoColor[1], cached_mat.AlbedoColor[2], cached_mat.AlbedoColor[3]);
+		material.EmissiveColor = glm::vec4(cached_mat.EmissiveColor[0], cached_mat.EmissiveColor[1], cached_mat.EmissiveColor[2], cached_mat.EmissiveColor[3]);
+		material.Smoothness = cached_mat.Smoothness;
+		material.Bumpiness = cached_mat.Bumpiness;
+		material.AlphaCutoff = cached_mat.AlphaCutoff;
+		material.IsTwoSided = cached_mat.Flags & MATFLAG_TWO_SIDED;
+		material.IsEmissive = cached_mat.Flags & MATFLAG_EMISSIVE;
+		material.IsTransparent = cached_mat.Flags & MATFLAG_TRANSPARENT;
+		material.IsAlphaTested = cached_mat.Flags & MATFLAG_ALPHA_TESTED;
+
+		for (uint t = 0; t < (uint)MATERIAL_TEXTURE::MAX; ++t)
+			material.TexturePaths[t] = GetString(strings, header->StringsSize, cached_mat.TextureOffsets[t]);
+
+		material_ids.push_back(MeshImporter::CreateMaterial(material, directory)->GetID());
+	}
+
+	// -- Create Meshes Buffers --
+	// Uploaded straight from the mapped file, once per unique mesh
+	std::vector<Ref<VertexArray>> vertex_arrays;
+	std::vector<Ref<StorageBuffer>> meshlets_buffers;
+	for (uint i = 0; i < header->MeshesCount; ++i)
+	{
+		const CachedMesh& cached_mesh = meshes[i];
+		const float* mesh_vertices = (const float*)(vertices + cached_mesh.VerticesOffset);
+		const uint* mesh_indices = (const uint*)(indices + cached_mesh.IndicesOffset);
+		vertex_arrays.push_back(MeshImporter::CreateVertexArray(mesh_vertices, (uint)cached_mesh.VerticesSize, mesh_indices, cached_mesh.IndicesCount));
+		meshlets_buffers.push_back(MeshImporter::CreateMeshletsBuffer((const Meshlet*)(meshlets + cached_mesh.MeshletsOffset), cached_mesh.MeshletsCount));
+	}
+
+	// -- Create Meshes --
+	Ref<Model> model = CreateRef<Model>(new Model(filepath));
+	for (uint i = 0; i < header->InstancesCount; ++i)
+	{
+		const CachedInstance& instance = instances[i];
+		const CachedMesh& cached_mesh = meshes[instance.MeshIndex];
+		MaterialHandle material_id = instance.MaterialSlot == -1 ? MaterialHandle() : material_ids[instance.MaterialSlot];
+
+		glm::mat4 transform;
+		memcpy(&transform[0][0], instance.Transform, sizeof(instance.Transform));
+
+		AABB bounds = { glm::vec3(cached_mesh.AABBMin[0], cached_mesh.AABBMin[1], cached_mesh.AABBMin[2]), glm::vec3(cached_mesh.AABBMax[0], cached_mesh.AABBMax[1], cached_mesh.AABBMax[2]) };
+		Ref<Mesh> mesh = Resources::CreateMesh(vertex_arrays[instance.MeshIndex]);
+		MeshImporter::AddModelMesh(model.get(), mesh, GetString(strings, header->StringsSize, instance.NameOffset), material_id, bounds, transform);
+		mesh->SetMeshlets(meshlets_buffers[instance.MeshIndex], cached_mesh.MeshletsCount);
+	}
+
+	return model;
+}
+
+
+void MeshCache::SaveModel(const std::string& filepath, uint64 source_hash, const ImportedModel& imported_model)
+{
+	// -- Build Tables --
+	std::string strings;
+	std::vector<CachedMaterial> materials;
+	std::vector<CachedMesh> meshes;
+	std::vector<CachedInstance> instances;
+	uint64 vertices_size = 0, indices_size = 0, meshlets_size = 0;
+
+	for (const ImportedMaterial& material : imported_model.Materials)
+	{
+		CachedMaterial cached_mat = {};
+		cached_mat.NameOffset = AddString(strings, material.Name);
+		cached_mat.Flags = (material.IsTwoSided ? (uint)MATFLAG_TWO_SIDED : 0u) | (material.IsEmissive ? (uint)MATFLAG_EMISSIVE : 0u)
+			| (material.IsTransparent ? (uint)MATFLAG_TRANSPARENT : 0u) | (material.IsAlphaTested ? (uint)MATFLAG_ALPHA_TESTED : 0u);
+		memcpy(cached_mat.AlbedoColor, &material.AlbedoColor[0], sizeof(cached_mat.AlbedoColor));
+		memcpy(cached_mat.EmissiveColor, &material.EmissiveColor[0], sizeof(cached_mat.EmissiveColor));
+		cached_mat.Smoothness = material.Smoothness;
+		cached_mat.Bumpiness = material.Bumpiness;
+		cached_mat.AlphaCutoff = material.AlphaCutoff;
+
+		for (uint t = 0; t < (uint)MATERIAL_TEXTURE::MAX; ++t)
+			cached_mat.TextureOffsets[t] = AddString(strings, material.TexturePaths[t]);
+
+		materials.push_back(cached_mat);
+	}
+
+	for (const ImportedMesh& mesh : imported_model.Meshes)
+	{
+		CachedMesh cached_mesh = {};
+		cached_mesh.NameOffset = AddString(strings, mesh.Name);
+		cached_mesh.MaterialSlot = mesh.MaterialSlot;
+		cached_mesh.VerticesOffset = vertices_size;
+		cached_mesh.VerticesSize = mesh.Vertices.size() * sizeof(float);
+		cached_mesh.IndicesOffset = indices_size;
+		cached_mesh.IndicesCount = mesh.Indices.size();
+		memcpy(cached_mesh.AABBMin, &mesh.Bounds.Min[0], sizeof(cached_mesh.AABBMin));
+		memcpy(cached_mesh.AABBMax, &mesh.Bounds.Max[0], sizeof(cached_mesh.AABBMax));
+		cached_mesh.MeshletsOffset = meshlets_size;
+		cached_mesh.MeshletsCount = mesh.Meshlets.size();
+
+		vertices_size += cached_mesh.VerticesSize;
+		indices_size += (uint64)cached_mesh.IndicesCount * sizeof(uint);
+		meshlets_size += (uint64)cached_mesh.MeshletsCount * sizeof(Meshlet);
+		meshes.push_back(cached_mesh);
+	}
+
+	for (const ImportedInstance& instance : imported_model.Instances)
+	{
+		CachedInstance cached_instance = {};
+		cached_instance.NameOffset = AddString(strings, instance.Name);
+		cached_instance.MeshIndex = instance.MeshIndex;
+		cached_instance.MaterialSlot = instance.MaterialSlot;
+		memcpy(cached_instance.Transform, &instance.Transform[0][0], sizeof(cached_instance.Transform));
+		instances.push_back(cached_instance);
+	}
+
+	// -- Fill Header --
+	CacheHeader header = {};
+	header.Magic = s_CacheMagic;
+	header.Version = s_Version;
+	header.ImportFlags = MeshImporter::GetAssimpImportFlags();
+	header.MaterialsCount = materials.size();
+	header.SourceHash = source_hash;
+	header.MeshesCount = meshes.size();
+	header.InstancesCount = instances.size();
+	header.StringsSize = strings.size();
+	header.StringsOffset = sizeof(CacheHeader) + materials.size() * sizeof(CachedMaterial) + meshes.size() * sizeof(CachedMesh) + instances.size() * sizeof(CachedInstance);
+	header.VerticesOffset = AlignTo16(header.StringsOffset + header.StringsSize);
+	header.VerticesSize = vertices_size;
+	header.IndicesOffset = AlignTo16(header.VerticesOffset + header.VerticesSize);
+	header.IndicesSize = indices_size;
+	header.MeshletsOffset = AlignTo16(header.IndicesOffset + header.IndicesSize);
+	header.MeshletsSize = meshlets_size;
+
+	// -- Write File --
+	const char padding[16] = {};
+	std::vector<FileUtils::FileChunk> chunks =
+	{
+		{ &header, sizeof(CacheHeader) },
+		{ materials.data(), materials.size() * sizeof(CachedMaterial) },
+		{ meshes.data(), meshes.size() * sizeof(CachedMesh) },
+		{ instances.data(), instances.size() * sizeof(CachedInstance) },
+		{ strings.data(), strings.size() },
+		{ padding, (size_t)(header.VerticesOffset - (header.StringsOffset + header.StringsSize)) }
+	};
+
+	for (const ImportedMesh& mesh : imported_model.Meshes)
+		chunks.push_back({ mesh.Vertices.data(), mesh.Vertices.size() * sizeof(float) });
+
+	chunks.push_back({ padding, (size_t)(header.IndicesOffset - (header.VerticesOffset + header.VerticesSize)) });
+	for (const ImportedMesh& mesh : imported_model.Meshes)
+		chunks.push_back({ mesh.Indices.data(), mesh.Indices.size() * sizeof(uint) });
+
+	chunks.push_back({ padding, (size_t)(header.MeshletsOffset - (header.IndicesOffset + header.IndicesSize)) });
+	for (const ImportedMesh& mesh : imported_model.Meshes)
+		chunks.push_back({ mesh.Meshlets.data(), mesh.Meshlets.size() * sizeof(Meshlet) });
+
+	std::string cache_filepath = GetCacheFilepath(filepath);
+	if (!FileUtils::WriteFileAtomic(cache_filepath, chunks))
+		ENGINE_LOG("Couldn't write Mesh Cache file at path '%s'", cache_filepath.c_str());
+}
@@ -0,0 +1,38 @@
+#ifndef _MESHCACHE_H_
+#define _MESHCACHE_H_
+
+#include "Core/Globals.h"
+
+class Model;
+struct ImportedModel;
+namespace FileUtils { class VirtualFile; }
+
+
+// Binary cache (.agpmesh) of imported models: final interleaved vertices, indices & meshlets of the unique meshes, their instances, materials and bounds
+// Keyed by the hash of the source file & the ones it depends on, & the import flags, so a warm start loads it with no Assimp at all
+class MeshCache
+{
+	friend class MeshImporter;
+public:
+
+	static constexpr const char* s_CacheDirectory = "Resources/Cache/Meshes";
+	static const uint s_Version = 6; // Bump on any format change (or of the importers output)
+
+private:
+
+	// Any thread: opens & validates the cache of the source, paging its data in. Returns false if there's no valid one (missing, outdated,
+	// other import flags or version)
+	static bool OpenModel(const std::string& filepath, uint64 source_hash, FileUtils::VirtualFile& cache);
+
+	// Main thread: creates the model from an opened cache (buffers uploaded straight from it)
+	static Ref<Model> CreateModel(const std::string& filepath, const FileUtils::VirtualFile& cache);
+
+	static void SaveModel(const std::string& filepath, uint64 source_hash, const ImportedModel& imported_model);
+
+	// Hash of the source file contents, of the files the importers read with it (.mtl, external buffers) & of the import flags,
+	// 0 if the source file can't be read
+	static uint64 GetSourceHash(const std::string& filepath);
+	static std::string GetCacheFilepath(const std::string& filepath);
+};
+
+#endif //_MESHCACHE_H_
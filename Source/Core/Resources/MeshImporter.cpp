@@ -1,170 +1,382 @@
 #include "MeshImporter.h"
 
 #include "Resources.h"
+#include "MeshCache.h"
+#include "ObjImporter.h"
+#include "GltfImporter.h"
 #include "Core/Utils/FileStringUtils.h"
+#include "Core/Utils/Hash.h"
+#include "Core/Utils/JobSystem.h"
+#include "Core/Utils/Timer.h"
 #include "Renderer/Resources/Buffers.h"
 #include "Renderer/Resources/Material.h"
 #include "Renderer/Resources/Mesh.h"
 
+#include <assimp/cfileio.h>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <unordered_map>
+#include <emmintrin.h>
+
 
 // ------------------------------------------------------------------------------
+// --- Assimp File System ---
+// Makes Assimp read the model & its referenced files (like .mtl) through the engine's VFS, so packed models import transparently
+namespace
+{
+    struct AssimpFile
+    {
+        FileUtils::VirtualFile File;
+        size_t Cursor = 0;
+    };
+
+    size_t AssimpFileRead(aiFile* ai_file, char* buffer, size_t size, size_t count)
+    {
+        AssimpFile* file = (AssimpFile*)ai_file->UserData;
+        if (size == 0)
+            return 0;
+
+        size_t read_count = std::min(count, (file->File.GetSize() - file->Cursor) / size);
+        memcpy(buffer, file->File.GetData() + file->Cursor, read_count * size);
+        file->Cursor += read_count * size;
+        return read_count;
+    }
+
+    size_t AssimpFileWrite(aiFile*, const char*, size_t, size_t) { return 0; }
+    size_t AssimpFileTell(aiFile* ai_file) { return ((AssimpFile*)ai_file->UserData)->Cursor; }
+    size_t AssimpFileSize(aiFile* ai_file) { return ((AssimpFile*)ai_file->UserData)->File.GetSize(); }
+    void AssimpFileFlush(aiFile*) {}
+
+    aiReturn AssimpFileSeek(aiFile* ai_file, size_t offset, aiOrigin origin)
+    {
+        AssimpFile* file = (AssimpFile*)ai_file->UserData;
+        size_t base = origin == aiOrigin_CUR ? file->Cursor : (origin == aiOrigin_END ? file->File.GetSize() : 0);
+        if (base + offset > file->File.GetSize())
+            return aiReturn_FAILURE;
+
+        file->Cursor = base + offset;
+        return aiReturn_SUCCESS;
+    }
+
+    aiFile* AssimpFileOpen(aiFileIO*, const char* filepath, const char* mode)
+    {
+        if (strchr(mode, 'w') || strchr(mode, 'a'))
+            return nullptr;
+
+        AssimpFile* file = new AssimpFile();
+        if (!file->File.Open(filepath))
+        {
+            delete file;
+            return nullptr;
+        }
+
+        return new aiFile{ AssimpFileRead, AssimpFileWrite, AssimpFileTell, AssimpFileSize, AssimpFileSeek, AssimpFileFlush, (aiUserData)file };
+    }
+
+    void AssimpFileClose(aiFileIO*, aiFile* ai_file)
+    {
+        delete (AssimpFile*)ai_file->UserData;
+        delete ai_file;
+    }
+
+    static const uint s_VertexFloats = 14;          // MeshImporter::GetVertexLayout()
+    static const uint s_InterleaveBatch = 65536;    // Vertices per job when interleaving a mesh
+}
+
+
+
+// ------------------------------------------------------------------------------
+MeshImporter::IMPORT_MODE MeshImporter::s_ImportMode = MeshImporter::IMPORT_MODE::HIERARCHY;
+
 Ref<Model> MeshImporter::LoadModel(const std::string& filepath)
+{
+    PreparedModel prepared;
+    if (!PrepareModel(filepath, prepared))
+        return nullptr;
+
+    return FinalizeModel(prepared);
+}
+
+
+bool MeshImporter::PrepareModel(const std::string& filepath, PreparedModel& prepared)
+{
+    prepared.Filepath = filepath;
+
+    // -- Load glTF --
+    // Its buffers are binary already & get uploaded in place, so there's no mesh cache for it (Assimp only if it fails)
+    if (GltfImporter::IsGltfFile(filepath))
+    {
+        prepared.Gltf = CreateRef<GltfModel>();
+        if (GltfImporter::PrepareModel(filepath, *prepared.Gltf))
+            return true;
+
+        prepared.Gltf.reset();
+    }
+
+    // -- Load from Cache --
+    // If the source file didn't change since it was cached, we don't need Assimp at all
+    uint64 source_hash = MeshCache::GetSourceHash(filepath);
+    prepared.Cache = CreateUnique<FileUtils::VirtualFile>();
+    if (MeshCache::OpenModel(filepath, source_hash, *prepared.Cache))
+        return true;
+
+    prepared.Cache.reset();
+
+    // -- Import Scene & Cache it --
+    // OBJs through the native importer, the rest (or the OBJs it fails with) through Assimp
+    bool imported = ObjImporter::IsObjFile(filepath) && ObjImporter::ImportModel(filepath, prepared.Imported);
+    if (!imported)
+    {
+        prepared.Imported = ImportedModel();
+        if (!ImportAssimpScene(filepath, prepared.Imported))
+            return false;
+    }
+
+    DeduplicateMeshes(prepared.Imported);
+
+    std::vector<ImportedMesh>& meshes = prepared.Imported.Meshes;
+    JobSystem::ParallelFor((uint)meshes.size(), JobSystem::GetBatchSize((uint)meshes.size()), [&meshes](uint first, uint count)
+    {
+        for (uint i = first; i < first + count; ++i)
+            meshes[i].Meshlets = BuildMeshlets(meshes[i].Vertices.data(), s_VertexFloats, (uint)meshes[i].Vertices.size() / s_VertexFloats, meshes[i].Indices.data(), (uint)meshes[i].Indices.size());
+    });
+
+    if (source_hash != 0)
+        MeshCache::SaveModel(filepath, source_hash, prepared.Imported);
+
+    return true;
+}
+
+
+Ref<Model> MeshImporter::FinalizeModel(const PreparedModel& prepared)
+{
+    if (prepared.Gltf)
+        return GltfImporter::CreateModel(prepared.Filepath, *prepared.Gltf);
+
+    if (prepared.Cache)
+        return MeshCache::CreateModel(prepared.Filepath, *prepared.Cache);
+
+    if (prepared.Imported.Meshes.empty())
+        return nullptr;
+
+    return CreateModel(prepared.Filepath, prepared.Imported);
+}
+
+
+BufferLayout MeshImporter::GetVertexLayout()
+{
+    return { { SHADER_DATA::FLOAT3, "a_Position" }, { SHADER_DATA::FLOAT2, "a_TexCoord" }, { SHADER_DATA::FLOAT3, "a_Normal" },
+             { SHADER_DATA::FLOAT3, "a_Tangent" }, { SHADER_DATA::FLOAT3, "a_Bitangent" } };
+}
+
+
+
+// ------------------------------------------------------------------------------
+bool MeshImporter::ImportAssimpScene(const std::string& filepath, ImportedModel& imported_model)
 {
     // -- Load Scene --
-    const aiScene* scene = aiImportFile(filepath.c_str(), aiProcess_Triangulate | aiProcess_CalcTangentSpace | aiProcess_GenSmoothNormals //| aiProcess_FlipUVs // FlipUVs gives problem with UVs, I think because STB already flips them
-        | aiProcess_JoinIdenticalVertices | aiProcess_PreTransformVertices | aiProcess_ImproveCacheLocality | aiProcess_OptimizeMeshes | aiProcess_SortByPType);
+    aiFileIO file_system = { AssimpFileOpen, AssimpFileClose, nullptr };
+    const aiScene* scene = aiImportFileEx(filepath.c_str(), GetAssimpImportFlags(), &file_system);
 
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
     {
         ENGINE_LOG("Error Opening Assimp Scene from '%s'\nAssimp Error: %s", filepath.c_str(), aiGetErrorString());
-        return nullptr;
+        return false;
     }
 
     if (scene->mNumMeshes == 0)
     {
         ENGINE_LOG("Error Loading Model, there were no meshes to load!");
-        return nullptr;
+        aiReleaseImport(scene);
+        return false;
     }
 
     // -- Load Materials --
-    std::vector<uint> materials;
+    // Slots of the assimp materials in the imported ones (-1 for Assimp's default material, which is not loaded)
+    std::vector<int> material_slots(scene->mNumMaterials, -1);
     for (uint i = 0; i < scene->mNumMaterials; ++i)
     {
-        const Ref<Material>* mat = ProcessAssimpMaterial(scene->mMaterials[i], FileUtils::GetDirectory(filepath));
-        if (mat != nullptr)
-            materials.push_back((*mat)->GetID());
+        ImportedMaterial material;
+        if (ProcessAssimpMaterial(scene->mMaterials[i], material))
+        {
+            material_slots[i] = (int)imported_model.Materials.size();
+            imported_model.Materials.push_back(material);
+        }
     }
 
     // -- Load Meshes --
-    aiMesh* first_mesh = scene->mMeshes[0];
-    Ref<Model> model = CreateRef<Model>(new Model(filepath));
+    // Placed by the nodes (first one the root, the rest its submeshes), each scene mesh processed once however many nodes place it
+    std::vector<ImportedInstance> instances;
+    ProcessAssimpNode(scene, scene->mRootNode, glm::mat4(1.0f), instances);
+
+    std::vector<int> mesh_slots(scene->mNumMeshes, -1);
+    std::vector<aiMesh*> ai_meshes;
+    for (ImportedInstance& instance : instances)
+    {
+        aiMesh* ai_mesh = scene->mMeshes[instance.MeshIndex];
+        if (ai_mesh->mNumVertices == 0 || ai_mesh->mNumFaces == 0)
+            continue;
+
+        if (mesh_slots[instance.MeshIndex] == -1)
+        {
+            mesh_slots[instance.MeshIndex] = (int)ai_meshes.size();
+            ai_meshes.push_back(ai_mesh);
+        }
 
-    model->m_RootMesh = ProcessAssimpMesh(scene, first_mesh)->get();
-    model->m_RootMesh->m_MaterialIndex = first_mesh->mMaterialIndex == 0 ? 0 : materials[first_mesh->mMaterialIndex - 1];
-    model->m_RootMesh->m_Name = first_mesh->mName.length > 0 ? first_mesh->mName.C_Str() : "unnamed";
+        instance.MeshIndex = (uint)mesh_slots[instance.MeshIndex];
+        instance.MaterialSlot = ai_mesh->mMaterialIndex < material_slots.size() ? material_slots[ai_mesh->mMaterialIndex] : -1;
+        imported_model.Instances.push_back(instance);
+    }
+
+    // Vertices interleaved per mesh across the jobs threads
+    imported_model.Meshes.resize(ai_meshes.size());
+    JobSystem::ParallelFor((uint)ai_meshes.size(), JobSystem::GetBatchSize((uint)ai_meshes.size()), [&](uint first, uint count)
+    {
+        for (uint i = first; i < first + count; ++i)
+        {
+            ImportedMesh& mesh = imported_model.Meshes[i];
+            ProcessAssimpMesh(ai_meshes[i], mesh);
 
-    ProcessAssimpNode(scene, scene->mRootNode, model->m_RootMesh, materials);
+            if (ai_meshes[i]->mName.length > 0)
+                mesh.Name = ai_meshes[i]->mName.C_Str();
+
+            if (ai_meshes[i]->mMaterialIndex < material_slots.size())
+                mesh.MaterialSlot = material_slots[ai_meshes[i]->mMaterialIndex];
+        }
+    });
 
     // -- Release Assimp & Return --
     aiReleaseImport(scene);
-    return model;
+    return !imported_model.Meshes.empty();
 }
 
 
-void MeshImporter::ProcessAssimpNode(const aiScene* ai_scene, aiNode* ai_node, Mesh* mesh, const std::vector<uint> loaded_materials)
+void MeshImporter::ProcessAssimpNode(const aiScene* ai_scene, aiNode* ai_node, const glm::mat4& parent_transform, std::vector<ImportedInstance>& instances)
 {
+    // -- Accumulate Node Transform --
+    // Assimp matrices are row-major (identity everywhere when flattened)
+    const aiMatrix4x4& m = ai_node->mTransformation;
+    glm::mat4 transform = parent_transform * glm::mat4(m.a1, m.b1, m.c1, m.d1, m.a2, m.b2, m.c2, m.d2, m.a3, m.b3, m.c3, m.d3, m.a4, m.b4, m.c4, m.d4);
+
     // -- Process Node Meshes --
-    std::vector<Ref<Mesh>*> meshes;
     for (uint i = 0; i < ai_node->mNumMeshes; ++i)
     {
-        if (ai_node->mMeshes[i] != 0)
-        {
-            aiMesh* ai_mesh = ai_scene->mMeshes[ai_node->mMeshes[i]];
-            meshes.push_back(ProcessAssimpMesh(ai_scene, ai_mesh));
-
-            if (ai_mesh->mName.length > 0)
-                (*meshes[i])->SetName(ai_mesh->mName.C_Str());
+        const aiMesh* ai_mesh = ai_scene->mMeshes[ai_node->mMeshes[i]];
 
-            if (ai_mesh->mMaterialIndex != 0)
-                (*meshes[i])->m_MaterialIndex = loaded_materials[ai_mesh->mMaterialIndex - 1]; // -1 Because we are not loading assimp's default material
-        }
+        ImportedInstance instance;
+        instance.Name = ai_mesh->mName.length > 0 ? ai_mesh->mName.C_Str() : (ai_node->mName.length > 0 ? ai_node->mName.C_Str() : "unnamed");
+        instance.MeshIndex = ai_node->mMeshes[i];
+        instance.Transform = transform;
+        instances.push_back(instance);
     }
 
-    // -- Fill Mesh' Submeshes --
-    for (uint i = 0; i < meshes.size(); ++i)
-        if (meshes[i] != nullptr)
-            mesh->AddSubmesh(meshes[i]);
-    
     // -- Process Node Children Meshes --
     for (uint i = 0; i < ai_node->mNumChildren; i++)
-        ProcessAssimpNode(ai_scene, ai_node->mChildren[i], mesh, loaded_materials);
+        ProcessAssimpNode(ai_scene, ai_node->mChildren[i], transform, instances);
 }
 
 
 
 // ------------------------------------------------------------------------------
-Ref<Mesh>* MeshImporter::ProcessAssimpMesh(const aiScene* ai_scene, aiMesh* ai_mesh)
+void MeshImporter::ProcessAssimpMesh(aiMesh* ai_mesh, ImportedMesh& imported_mesh)
 {
-    if (ai_mesh->mNumVertices == 0 || ai_mesh->mNumFaces == 0)
-        return nullptr;
-
     // -- Process Vertices --
-    std::vector<float> vertices;
-    std::vector<uint> indices;
-    
-    for (uint i = 0; i < ai_mesh->mNumVertices; ++i)
-    {
-        // Positions & Normals
-        glm::vec3 positions = glm::vec3(0.0f), normals = glm::vec3(0.0f);
-        glm::vec2 texture_coords = glm::vec2(0.0f);
-        
-        if (ai_mesh->HasPositions())
-            positions = { ai_mesh->mVertices[i].x, ai_mesh->mVertices[i].y, ai_mesh->mVertices[i].z };
-
-        if (ai_mesh->mTextureCoords[0])
-            texture_coords = { ai_mesh->mTextureCoords[0][i].x, ai_mesh->mTextureCoords[0][i].y };
-        else
-            int a = 0;
-
-        if (ai_mesh->HasNormals())
-            normals = { ai_mesh->mNormals[i].x, ai_mesh->mNormals[i].y, ai_mesh->mNormals[i].z };
-
-        vertices.push_back(positions.x);
-        vertices.push_back(positions.y);
-        vertices.push_back(positions.z);
-        vertices.push_back(texture_coords.x);
-        vertices.push_back(texture_coords.y);
-        vertices.push_back(normals.x);
-        vertices.push_back(normals.y);
-        vertices.push_back(normals.z);
-
-        // Tangents & Bitangents
-        glm::vec3 tangents = glm::vec3(0.0f), bitangents = glm::vec3(0.0f); // TODO: Ojo aqui q diu en jess q estan flipped
-        if (ai_mesh->HasTangentsAndBitangents())
-        {
-            tangents = { ai_mesh->mTangents[i].x, ai_mesh->mTangents[i].y, ai_mesh->mTangents[i].z };
-            bitangents = { ai_mesh->mBitangents[i].x, ai_mesh->mBitangents[i].y, ai_mesh->mBitangents[i].z };
-        }
+    // Interleaved straight into the exact-size buffer, big meshes split across the jobs threads
+    const uint vertices_count = ai_mesh->mNumVertices;
+    imported_mesh.Vertices.resize((size_t)vertices_count * s_VertexFloats);
 
-        vertices.push_back(tangents.x);
-        vertices.push_back(tangents.y);
-        vertices.push_back(tangents.z);
-        vertices.push_back(bitangents.x);
-        vertices.push_back(bitangents.y);
-        vertices.push_back(bitangents.z);
-    }
+    std::vector<AABB> batches_bounds((vertices_count + s_InterleaveBatch - 1) / s_InterleaveBatch, { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) });
+    JobSystem::ParallelFor(vertices_count, s_InterleaveBatch, [&](uint first, uint count)
+    {
+        batches_bounds[first / s_InterleaveBatch] = InterleaveVertices(ai_mesh, first, count, imported_mesh.Vertices.data());
+    });
+
+    imported_mesh.Bounds = { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+    for (const AABB& bounds : batches_bounds)
+        imported_mesh.Bounds.Merge(bounds);
 
     // -- Process Indices --
+    // Counted first, so they are copied into an exact-size buffer too
+    size_t indices_count = 0;
+    for (uint i = 0; i < ai_mesh->mNumFaces; ++i)
+        indices_count += ai_mesh->mFaces[i].mNumIndices;
+
+    imported_mesh.Indices.resize(indices_count);
+    uint* indices = imported_mesh.Indices.data();
     for (uint i = 0; i < ai_mesh->mNumFaces; ++i)
     {
-        aiFace face = ai_mesh->mFaces[i];
-        for (uint j = 0; j < face.mNumIndices; ++j)
-            indices.push_back(face.mIndices[j]);
+        const aiFace& face = ai_mesh->mFaces[i];
+        memcpy(indices, face.mIndices, face.mNumIndices * sizeof(uint));
+        indices += face.mNumIndices;
     }
+}
 
-    // -- Create Buffers & Mesh --
-    BufferLayout layout = { { SHADER_DATA::FLOAT3, "a_Position" }, { SHADER_DATA::FLOAT2, "a_TexCoord" }, { SHADER_DATA::FLOAT3, "a_Normal" },
-                            { SHADER_DATA::FLOAT3, "a_Tangent" }, { SHADER_DATA::FLOAT3, "a_Bitangent" } };
 
-    Ref<VertexBuffer> vbo = CreateRef<VertexBuffer>(vertices.data(), vertices.size() * sizeof(float));
-    Ref<IndexBuffer> ibo = CreateRef<IndexBuffer>(indices.data(), indices.size());
-    Ref<VertexArray> vao = CreateRef<VertexArray>();
+AABB MeshImporter::InterleaveVertices(const aiMesh* ai_mesh, uint first, uint count, float* vertices)
+{
+    static_assert(sizeof(aiVector3D) == 3 * sizeof(float), "The interleaving kernel needs single precision Assimp");
+    static const float s_Zeros[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
 
-    vbo->SetLayout(layout);
-    vao->AddVertexBuffer(vbo);
-    vao->SetIndexBuffer(ibo);
-    vao->Unbind(); vbo->Unbind(); ibo->Unbind();
-    return Resources::CreateMesh(vao);
+    // -- Attributes Streams --
+    // In the layout order, missing ones read the zeros with no stride. Texture coordinates are vec3 too (their z gets overwritten)
+    const float* streams[5] = { (const float*)ai_mesh->mVertices, (const float*)ai_mesh->mTextureCoords[0], (const float*)ai_mesh->mNormals,
+                                (const float*)ai_mesh->mTangents, (const float*)ai_mesh->mBitangents };
+
+    const uint offsets[5] = { 0, 3, 5, 8, 11 }, components[5] = { 3, 2, 3, 3, 3 };
+    size_t strides[5];
+    for (uint s = 0; s < 5; ++s)
+    {
+        strides[s] = streams[s] ? 3 : 0;
+        streams[s] = streams[s] ? streams[s] : s_Zeros;
+    }
+
+    // -- Interleave --
+    // A 4-wide load & store per attribute in the layout order, each store's 4th float being overwritten by the next one. The last vertex
+    // of the range goes scalar, so nothing is read past the Assimp arrays nor written into the next range (another thread's)
+    __m128 aabb_min = _mm_set1_ps(FLT_MAX), aabb_max = _mm_set1_ps(-FLT_MAX);
+    const uint simd_count = count > 0 ? count - 1 : 0;
+    for (uint i = first; i < first + simd_count; ++i)
+    {
+        float* vertex = vertices + (size_t)i * s_VertexFloats;
+        __m128 position = _mm_loadu_ps(streams[0] + i * strides[0]);
+        _mm_storeu_ps(vertex, position);
+        _mm_storeu_ps(vertex + offsets[1], _mm_loadu_ps(streams[1] + i * strides[1]));
+        _mm_storeu_ps(vertex + offsets[2], _mm_loadu_ps(streams[2] + i * strides[2]));
+        _mm_storeu_ps(vertex + offsets[3], _mm_loadu_ps(streams[3] + i * strides[3]));
+        _mm_storeu_ps(vertex + offsets[4], _mm_loadu_ps(streams[4] + i * strides[4]));
+
+        aabb_min = _mm_min_ps(aabb_min, position); // 4th lane is the next vertex x, discarded
+        aabb_max = _mm_max_ps(aabb_max, position);
+    }
+
+    alignas(16) float min[4], max[4];
+    _mm_store_ps(min, aabb_min);
+    _mm_store_ps(max, aabb_max);
+    AABB bounds = { glm::vec3(min[0], min[1], min[2]), glm::vec3(max[0], max[1], max[2]) };
+
+    for (uint i = first + simd_count; i < first + count; ++i)
+    {
+        float* vertex = vertices + (size_t)i * s_VertexFloats;
+        for (uint s = 0; s < 5; ++s)
+            for (uint c = 0; c < components[s]; ++c)
+                vertex[offsets[s] + c] = streams[s][i * strides[s] + c];
+
+        bounds.Merge({ glm::vec3(vertex[0], vertex[1], vertex[2]), glm::vec3(vertex[0], vertex[1], vertex[2]) });
+    }
+
+    return bounds;
 }
 
 
-const Ref<Material>* MeshImporter::ProcessAssimpMaterial(aiMaterial* ai_material, const std::string& directory)
+bool MeshImporter::ProcessAssimpMaterial(aiMaterial* ai_material, ImportedMaterial& imported_material)
 {
     // -- Ignore Assimp Default Material --
     aiString name = aiString("unnamed");
     ai_material->Get(AI_MATKEY_NAME, name);
     if (name.C_Str() == std::string(AI_DEFAULT_MATERIAL_NAME))
-        return nullptr;
+        return false;
 
     // -- Load Material Variables --
     ai_real shininess = 0.1f, opacity = 1.0f, bumpscale = 1.0f;
@@ -192,49 +404,390 @@ const Ref<Material>* MeshImporter::ProcessAssimpMaterial(aiMaterial* ai_material
     //ai_material->Get(AI_MATKEY_SHININESS_STRENGTH, nn2);      // ? (?)
 
 
-    // -- Create Material & Set Variables --
-    const Ref<Material>& mat = *Resources::CreateMaterial(name.C_Str());
-    mat->AlbedoColor = glm::vec4(diffuse.r, diffuse.g, diffuse.b, opacity);
-    mat->EmissiveColor= glm::vec4(emissive.r, emissive.g, emissive.b, 1.0f);
-    mat->Bumpiness = bumpscale;
-    mat->Smoothness = shininess / 256.0f;
+    // -- Set Material Variables --
+    ImportedMaterial& mat = imported_material;
+    mat.Name = name.C_Str();
+    mat.AlbedoColor = glm::vec4(diffuse.r, diffuse.g, diffuse.b, opacity);
+    mat.EmissiveColor= glm::vec4(emissive.r, emissive.g, emissive.b, 1.0f);
+    mat.Bumpiness = bumpscale;
+    mat.Smoothness = shininess / 256.0f;
+
+    if (glm::epsilonEqual(mat.Smoothness, 0.0f, glm::epsilon<float>()))
+        mat.Smoothness = 0.1f;
+
+    if (glm::epsilonEqual(mat.Bumpiness, 0.0f, glm::epsilon<float>()))
+        mat.Bumpiness = 1.0f;
+
+    mat.IsTwoSided = (!two_sided && opacity < 1.0f) ? true : two_sided;
+    mat.IsEmissive = emissive.IsBlack() ? false : true;
+    mat.IsTransparent = opacity < 1.0f;
+
+    // -- Set Material Textures --
+    mat.TexturePaths[(int)MATERIAL_TEXTURE::ALBEDO] = LoadMaterialTexture(ai_material, aiTextureType_DIFFUSE);
+    mat.TexturePaths[(int)MATERIAL_TEXTURE::EMISSIVE] = LoadMaterialTexture(ai_material, aiTextureType_EMISSIVE);
+    mat.TexturePaths[(int)MATERIAL_TEXTURE::SPECULAR] = LoadMaterialTexture(ai_material, aiTextureType_SPECULAR);
+    mat.TexturePaths[(int)MATERIAL_TEXTURE::NORMAL] = LoadMaterialTexture(ai_material, aiTextureType_NORMALS);
+    mat.TexturePaths[(int)MATERIAL_TEXTURE::BUMP] = LoadMaterialTexture(ai_material, aiTextureType_HEIGHT);
+
+    return true;
+}
+
+
+
+// ------------------------------------------------------------------------------
+std::string MeshImporter::LoadMaterialTexture(aiMaterial* ai_material, aiTextureType texture_type)
+{
+    if (ai_material->GetTextureCount(texture_type) == 0)
+        return std::string();
+
+    aiString texture_filename;
+    ai_material->GetTexture(texture_type, 0, &texture_filename);
+    return texture_filename.C_Str();
+}
+
+
+void MeshImporter::DeduplicateMeshes(ImportedModel& imported_model)
+{
+    std::vector<ImportedMesh>& meshes = imported_model.Meshes;
+    std::vector<ImportedInstance>& instances = imported_model.Instances;
+
+    // -- Default Instances --
+    if (instances.empty())
+    {
+        for (uint i = 0; i < (uint)meshes.size(); ++i)
+            instances.push_back({ meshes[i].Name, i, meshes[i].MaterialSlot, glm::mat4(1.0f) });
+    }
+
+    // -- Hash Meshes --
+    std::vector<uint64> hashes(meshes.size());
+    JobSystem::ParallelFor((uint)meshes.size(), JobSystem::GetBatchSize((uint)meshes.size()), [&](uint first, uint count)
+    {
+        for (uint i = first; i < first + count; ++i)
+        {
+            uint64 indices_hash = HashUtils::XXH64(meshes[i].Indices.data(), meshes[i].Indices.size() * sizeof(uint));
+            hashes[i] = HashUtils::XXH64(meshes[i].Vertices.data(), meshes[i].Vertices.size() * sizeof(float), indices_hash);
+        }
+    });
+
+    // -- Merge Identical Meshes --
+    // Compared when hashes match, so a collision just keeps both. The merged mesh keeps the first one name & material (instances have theirs)
+    auto is_same_geometry = [](const ImportedMesh& a, const ImportedMesh& b)
+    {
+        return a.Vertices.size() == b.Vertices.size() && a.Indices.size() == b.Indices.size()
+            && memcmp(a.Vertices.data(), b.Vertices.data(), a.Vertices.size() * sizeof(float)) == 0
+            && memcmp(a.Indices.data(), b.Indices.data(), a.Indices.size() * sizeof(uint)) == 0;
+    };
+
+    std::unordered_map<uint64, uint> unique_meshes; // Hash -> merged mesh
+    std::vector<ImportedMesh> merged_meshes;
+    std::vector<uint> remap(meshes.size());
+    for (uint i = 0; i < (uint)meshes.size(); ++i)
+    {
+        auto it = unique_meshes.find(hashes[i]);
+        if (it != unique_meshes.end() && is_same_geometry(merged_meshes[it->second], meshes[i]))
+        {
+            remap[i] = it->second;
+            continue;
+        }
+
+        remap[i] = (uint)merged_meshes.size();
+        unique_meshes.emplace(hashes[i], remap[i]);
+        merged_meshes.push_back(std::move(meshes[i]));
+    }
+
+    for (ImportedInstance& instance : instances)
+        instance.MeshIndex = remap[instance.MeshIndex];
+
+    meshes = std::move(merged_meshes);
+}
 
-    if (glm::epsilonEqual(mat->Smoothness, 0.0f, glm::epsilon<float>()))
-        mat->Smoothness = 0.1f;
 
-    if (glm::epsilonEqual(mat->Bumpiness, 0.0f, glm::epsilon<float>()))
-        mat->Bumpiness = 1.0f;
 
-    mat->IsTwoSided = (!two_sided && opacity < 1.0f) ? true : two_sided;
-    mat->IsEmissive = emissive.IsBlack() ? false : true;
-    mat->IsTransparent = opacity < 1.0f;
+// ------------------------------------------------------------------------------
+std::vector<Meshlet> MeshImporter::BuildMeshlets(const float* positions, uint positions_stride, uint vertices_count, const uint* indices, uint indices_count)
+{
+    std::vector<Meshlet> meshlets;
+    if (indices_count < 3)
+        return meshlets;
+
+    auto get_position = [positions, positions_stride](uint vertex) { return glm::make_vec3(positions + (uint64)vertex * positions_stride); };
+
+    // -- Split Triangles --
+    // A meshlet is closed when the next triangle doesn't fit. Vertices are stamped with the meshlet they were last counted in
+    std::vector<uint> vertex_meshlet(vertices_count, UINT_MAX);
+    uint meshlet_vertices = 0;
+    meshlets.emplace_back();
+
+    for (uint i = 0; i + 2 < indices_count; i += 3)
+    {
+        const uint meshlet_index = (uint)meshlets.size() - 1;
+        const uint* triangle = indices + i;
+
+        uint new_vertices = (vertex_meshlet[triangle[0]] != meshlet_index)
+            + (vertex_meshlet[triangle[1]] != meshlet_index && triangle[1] != triangle[0])
+            + (vertex_meshlet[triangle[2]] != meshlet_index && triangle[2] != triangle[0] && triangle[2] != triangle[1]);
+
+        Meshlet* meshlet = &meshlets.back();
+        if (meshlet_vertices + new_vertices > Meshlet::s_MaxVertices || meshlet->IndexCount / 3 + 1 > Meshlet::s_MaxTriangles)
+        {
+            meshlets.emplace_back();
+            meshlet = &meshlets.back();
+            meshlet->FirstIndex = i;
+            meshlet_vertices = 0;
+        }
+
+        for (uint v = 0; v < 3; ++v)
+        {
+            if (vertex_meshlet[triangle[v]] != (uint)meshlets.size() - 1)
+            {
+                vertex_meshlet[triangle[v]] = (uint)meshlets.size() - 1;
+                ++meshlet_vertices;
+            }
+        }
+
+        meshlet->IndexCount += 3;
+    }
+
+    // -- Bounds & Normal Cones --
+    // Sphere around the meshlet box center, cone around the average of its triangles normals (as meshoptimizer's conservative one)
+    for (Meshlet& meshlet : meshlets)
+    {
+        AABB bounds = { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+        glm::vec3 normals_sum = glm::vec3(0.0f);
+        for (uint i = meshlet.FirstIndex; i < meshlet.FirstIndex + meshlet.IndexCount; i += 3)
+        {
+            glm::vec3 a = get_position(indices[i]), b = get_position(indices[i + 1]), c = get_position(indices[i + 2]);
+            bounds.Merge({ glm::min(a, glm::min(b, c)), glm::max(a, glm::max(b, c)) });
+
+            glm::vec3 normal = glm::cross(b - a, c - a);
+            float length = glm::length(normal);
+            if (length > FLT_MIN)
+                normals_sum += normal / length;
+        }
+
+        meshlet.Center = bounds.GetCenter();
+        for (uint i = meshlet.FirstIndex; i < meshlet.FirstIndex + meshlet.IndexCount; ++i)
+            meshlet.Radius = std::max(meshlet.Radius, glm::length(get_position(indices[i]) - meshlet.Center));
+
+        float axis_length = glm::length(normals_sum);
+        if (axis_length <= FLT_MIN)
+            continue;
+
+        meshlet.ConeAxis = normals_sum / axis_length;
+        float min_dot = 1.0f;
+        for (uint i = meshlet.FirstIndex; i < meshlet.FirstIndex + meshlet.IndexCount; i += 3)
+        {
+            glm::vec3 a = get_position(indices[i]);
+            glm::vec3 normal = glm::cross(get_position(indices[i + 1]) - a, get_position(indices[i + 2]) - a);
+            float length = glm::length(normal);
+            if (length > FLT_MIN)
+                min_dot = std::min(min_dot, glm::dot(normal / length, meshlet.ConeAxis));
+        }
+
+        // Cones wider than ~84 degrees (half angle) would hardly ever be culled
+        meshlet.ConeCutoff = min_dot <= 0.1f ? 1.0f : std::sqrt(1.0f - min_dot * min_dot);
+    }
+
+    return meshlets;
+}
+
+
+
+// ------------------------------------------------------------------------------
+Ref<Model> MeshImporter::CreateModel(const std::string& filepath, const ImportedModel& imported_model)
+{
+    // -- Create Materials --
+    std::string directory = FileUtils::GetDirectory(filepath);
+    std::vector<MaterialHandle> materials;
+    for (const ImportedMaterial& material : imported_model.Materials)
+        materials.push_back(CreateMaterial(material, directory)->GetID());
+
+    // -- Create Meshes Buffers --
+    // Once per unique mesh, shared by all its instances
+    std::vector<Ref<VertexArray>> vertex_arrays;
+    std::vector<Ref<StorageBuffer>> meshlets_buffers;
+    for (const ImportedMesh& imported_mesh : imported_model.Meshes)
+    {
+        vertex_arrays.push_back(CreateVertexArray(imported_mesh.Vertices.data(), imported_mesh.Vertices.size() * sizeof(float), imported_mesh.Indices.data(), imported_mesh.Indices.size()));
+        meshlets_buffers.push_back(CreateMeshletsBuffer(imported_mesh.Meshlets.data(), (uint)imported_mesh.Meshlets.size()));
+    }
+
+    // -- Create Meshes --
+    Ref<Model> model = CreateRef<Model>(new Model(filepath));
+    for (const ImportedInstance& instance : imported_model.Instances)
+    {
+        Ref<Mesh> mesh = Resources::CreateMesh(vertex_arrays[instance.MeshIndex]);
+        MaterialHandle material_id = instance.MaterialSlot == -1 ? MaterialHandle() : materials[instance.MaterialSlot];
+        AddModelMesh(model.get(), mesh, instance.Name, material_id, imported_model.Meshes[instance.MeshIndex].Bounds, instance.Transform);
+        mesh->SetMeshlets(meshlets_buffers[instance.MeshIndex], (uint)imported_model.Meshes[instance.MeshIndex].Meshlets.size());
+    }
+
+    return model;
+}
+
+
+Ref<VertexArray> MeshImporter::CreateVertexArray(const float* vertices, uint vertices_size, const uint* indices, uint indices_count)
+{
+    // -- Create Buffers --
+    Ref<VertexBuffer> vbo = CreateRef<VertexBuffer>(vertices, vertices_size);
+    Ref<IndexBuffer> ibo = CreateRef<IndexBuffer>(indices, indices_count);
+    Ref<VertexArray> vao = CreateRef<VertexArray>();
+
+    vbo->SetLayout(GetVertexLayout());
+    vao->AddVertexBuffer(vbo);
+    vao->SetIndexBuffer(ibo);
+    vao->Unbind(); vbo->Unbind(); ibo->Unbind();
+    return vao;
+}
+
+
+Ref<StorageBuffer> MeshImporter::CreateMeshletsBuffer(const Meshlet* meshlets, uint meshlets_count)
+{
+    if (meshlets_count == 0)
+        return nullptr;
+
+    return CreateRef<StorageBuffer>(meshlets, (uint64)meshlets_count * sizeof(Meshlet));
+}
+
+
+Ref<Material> MeshImporter::CreateMaterial(const ImportedMaterial& imported_material, const std::string& directory)
+{
+    // -- Create Material & Set Variables --
+    Ref<Material> mat = Resources::CreateMaterial(imported_material.Name);
+    mat->AlbedoColor = imported_material.AlbedoColor;
+    mat->EmissiveColor = imported_material.EmissiveColor;
+    mat->Bumpiness = imported_material.Bumpiness;
+    mat->Smoothness = imported_material.Smoothness;
+    mat->IsTwoSided = imported_material.IsTwoSided;
+    mat->IsEmissive = imported_material.IsEmissive;
+    mat->IsTransparent = imported_material.IsTransparent;
+    mat->IsAlphaTested = imported_material.IsAlphaTested;
+    mat->AlphaCutoff = imported_material.AlphaCutoff;
 
     // -- Set Material Textures --
-    if (ai_material->GetTextureCount(aiTextureType_DIFFUSE) > 0)
-        mat->Albedo = Resources::CreateTexture(LoadMaterialTexture(ai_material, aiTextureType_DIFFUSE, directory));
+    const std::string* textures = imported_material.TexturePaths;
+    if (!textures[(int)MATERIAL_TEXTURE::ALBEDO].empty())
+        mat->Albedo = Resources::CreateTexture(FileUtils::MakePath(directory, textures[(int)MATERIAL_TEXTURE::ALBEDO]));
 
-    if (ai_material->GetTextureCount(aiTextureType_EMISSIVE) > 0)
-        mat->Emissive = Resources::CreateTexture(LoadMaterialTexture(ai_material, aiTextureType_EMISSIVE, directory));
+    if (!textures[(int)MATERIAL_TEXTURE::EMISSIVE].empty())
+        mat->Emissive = Resources::CreateTexture(FileUtils::MakePath(directory, textures[(int)MATERIAL_TEXTURE::EMISSIVE]));
 
-    if (ai_material->GetTextureCount(aiTextureType_SPECULAR) > 0)
-        mat->Specular = Resources::CreateTexture(LoadMaterialTexture(ai_material, aiTextureType_SPECULAR, directory));
+    if (!textures[(int)MATERIAL_TEXTURE::SPECULAR].empty())
+        mat->Specular = Resources::CreateTexture(FileUtils::MakePath(directory, textures[(int)MATERIAL_TEXTURE::SPECULAR]));
 
-    if (ai_material->GetTextureCount(aiTextureType_NORMALS) > 0)
-        mat->Normal = Resources::CreateTexture(LoadMaterialTexture(ai_material, aiTextureType_NORMALS, directory));
+    if (!textures[(int)MATERIAL_TEXTURE::NORMAL].empty())
+        mat->Normal = Resources::CreateTexture(FileUtils::MakePath(directory, textures[(int)MATERIAL_TEXTURE::NORMAL]), TEXTURE_USAGE::NORMAL);
 
-    if (ai_material->GetTextureCount(aiTextureType_HEIGHT) > 0)
-        mat->Bump = Resources::CreateTexture(LoadMaterialTexture(ai_material, aiTextureType_HEIGHT, directory));
+    if (!textures[(int)MATERIAL_TEXTURE::BUMP].empty())
+        mat->Bump = Resources::CreateTexture(FileUtils::MakePath(directory, textures[(int)MATERIAL_TEXTURE::BUMP]), TEXTURE_USAGE::HEIGHT);
 
     // -- Return Material --
-    return &mat;
+    return mat;
+}
+
+
+void MeshImporter::AddModelMesh(Model* model, const Ref<Mesh>& mesh, const std::string& name, MaterialHandle material_id, const AABB& bounds, const glm::mat4& local_transform)
+{
+    mesh->m_Name = name;
+    mesh->m_Material = material_id;
+    mesh->m_Bounds = bounds;
+    mesh->m_LocalTransform = local_transform;
+
+    if (model->m_RootMesh == nullptr)
+    {
+        model->m_RootMesh = mesh.get();
+        model->m_Bounds = bounds.Transformed(local_transform);
+    }
+    else
+    {
+        model->m_RootMesh->AddSubmesh(mesh);
+        model->m_Bounds.Merge(bounds.Transformed(local_transform));
+    }
 }
 
 
 
 // ------------------------------------------------------------------------------
-std::string MeshImporter::LoadMaterialTexture(aiMaterial* ai_material, aiTextureType texture_type, const std::string& directory)
+InterleaveBenchmark MeshImporter::RunInterleaveBenchmark(uint vertices_count, uint runs)
 {
-    aiString texture_filename;
-    ai_material->GetTexture(texture_type, 0, &texture_filename);
-    return FileUtils::MakePath(directory, texture_filename.C_Str());
+    InterleaveBenchmark ret;
+    ret.VerticesCount = vertices_count;
+    if (vertices_count == 0 || runs == 0)
+        return ret;
+
+    // -- Build Mesh --
+    // All the attributes, deterministic pseudo-random values
+    uint seed = 12345u;
+    auto random = [&seed]() { seed = seed * 1664525u + 1013904223u; return -1.0f + 2.0f * (float)(seed >> 8) / (float)(1u << 24); };
+
+    aiMesh ai_mesh;
+    ai_mesh.mNumVertices = vertices_count;
+    ai_mesh.mVertices = new aiVector3D[vertices_count];
+    ai_mesh.mNormals = new aiVector3D[vertices_count];
+    ai_mesh.mTangents = new aiVector3D[vertices_count];
+    ai_mesh.mBitangents = new aiVector3D[vertices_count];
+    ai_mesh.mTextureCoords[0] = new aiVector3D[vertices_count];
+    ai_mesh.mNumUVComponents[0] = 2;
+
+    for (uint i = 0; i < vertices_count; ++i)
+    {
+        ai_mesh.mVertices[i] = aiVector3D(random(), random(), random()) * 50.0f;
+        ai_mesh.mNormals[i] = aiVector3D(random(), random(), random()).Normalize();
+        ai_mesh.mTangents[i] = aiVector3D(random(), random(), random()).Normalize();
+        ai_mesh.mBitangents[i] = aiVector3D(random(), random(), random()).Normalize();
+        ai_mesh.mTextureCoords[0][i] = aiVector3D(random(), random(), 0.0f);
+    }
+
+    // -- Scalar --
+    // As ProcessAssimpMesh() was: a push_back per float, no reserve
+    Timer timer;
+    std::vector<float> scalar_vertices, simd_vertices, threaded_vertices;
+    ret.ScalarMs = ret.SIMDMs = ret.SIMDThreadedMs = FLT_MAX;
+    for (uint run = 0; run < runs; ++run)
+    {
+        std::vector<float> vertices;
+        timer.Start();
+        for (uint i = 0; i < vertices_count; ++i)
+        {
+            const aiVector3D& position = ai_mesh.mVertices[i], & uv = ai_mesh.mTextureCoords[0][i], & normal = ai_mesh.mNormals[i];
+            const aiVector3D& tangent = ai_mesh.mTangents[i], & bitangent = ai_mesh.mBitangents[i];
+            for (float value : { position.x, position.y, position.z, uv.x, uv.y, normal.x, normal.y, normal.z, tangent.x, tangent.y, tangent.z, bitangent.x, bitangent.y, bitangent.z })
+                vertices.push_back(value);
+        }
+
+        ret.ScalarMs = std::min(ret.ScalarMs, timer.GetMilliseconds());
+        scalar_vertices = std::move(vertices);
+    }
+
+    // -- SIMD, 1 Thread --
+    for (uint run = 0; run < runs; ++run)
+    {
+        std::vector<float> vertices;
+        timer.Start();
+        vertices.resize((size_t)vertices_count * s_VertexFloats);
+        InterleaveVertices(&ai_mesh, 0, vertices_count, vertices.data());
+
+        ret.SIMDMs = std::min(ret.SIMDMs, timer.GetMilliseconds());
+        simd_vertices = std::move(vertices);
+    }
+
+    // -- SIMD, Threaded --
+    // As ProcessAssimpMesh()
+    for (uint run = 0; run < runs; ++run)
+    {
+        std::vector<float> vertices;
+        timer.Start();
+        vertices.resize((size_t)vertices_count * s_VertexFloats);
+        JobSystem::ParallelFor(vertices_count, s_InterleaveBatch, [&](uint first, uint count) { InterleaveVertices(&ai_mesh, first, count, vertices.data()); });
+
+        ret.SIMDThreadedMs = std::min(ret.SIMDThreadedMs, timer.GetMilliseconds());
+        threaded_vertices = std::move(vertices);
+    }
+
+    // -- Results --
+    ret.ScalarMVps = (float)vertices_count / (ret.ScalarMs * 1000.0f);
+    ret.SIMDMVps = (float)vertices_count / (ret.SIMDMs * 1000.0f);
+    ret.SIMDThreadedMVps = (float)vertices_count / (ret.SIMDThreadedMs * 1000.0f);
+    ret.OutputsMatch = scalar_vertices == simd_vertices && scalar_vertices == threaded_vertices;
+    return ret;
 }
@@ -2,6 +2,9 @@
 #define _MESHIMPORTER_H_
 
 #include "Core/Globals.h"
+#include "Renderer/Resources/Buffers.h"
+#include "Renderer/Resources/Mesh.h"
+#include "Core/Utils/FileStringUtils.h"
 
 #include <assimp/cimport.h>
 #include <assimp/scene.h>
@@ -10,19 +13,142 @@
 class Mesh;
 class Material;
 class Model;
+struct GltfModel;
 
+
+// --- Imported Data ---
+// CPU-side result of an import, before creating any GPU resource
+enum class MATERIAL_TEXTURE { ALBEDO = 0, EMISSIVE, SPECULAR, NORMAL, BUMP, MAX };
+
+struct ImportedMaterial
+{
+	std::string Name = "unnamed";
+	glm::vec4 AlbedoColor = glm::vec4(1.0f), EmissiveColor = glm::vec4(0.0f);
+	float Smoothness = 0.1f, Bumpiness = 1.0f, AlphaCutoff = 0.5f;
+	bool IsTwoSided = true, IsEmissive = false, IsTransparent = false, IsAlphaTested = false;
+
+	std::string TexturePaths[(int)MATERIAL_TEXTURE::MAX]; // Relative to the model directory, empty if none
+};
+
+// Unique geometry, placed in the model by its instances
+struct ImportedMesh
+{
+	std::string Name = "unnamed";
+	int MaterialSlot = -1;				// Index in ImportedModel::Materials, -1 for the default material
+	std::vector<float> Vertices;		// Interleaved as MeshImporter::GetVertexLayout()
+	std::vector<uint> Indices;
+	std::vector<Meshlet> Meshlets;		// Built once the model is imported (see MeshImporter::BuildMeshlets())
+	AABB Bounds = {};
+};
+
+// A placement of a mesh (each one becomes an engine mesh, all of them sharing the mesh buffers)
+struct ImportedInstance
+{
+	std::string Name = "unnamed";
+	uint MeshIndex = 0;						// In ImportedModel::Meshes
+	int MaterialSlot = -1;
+	glm::mat4 Transform = glm::mat4(1.0f);	// Relative to the model
+};
+
+struct ImportedModel
+{
+	std::vector<ImportedMaterial> Materials;
+	std::vector<ImportedMesh> Meshes;
+	std::vector<ImportedInstance> Instances;	// First one is the root mesh, the rest are its submeshes. If an importer leaves it
+												// empty, each mesh is placed once untransformed (with its name & material)
+};
+
+// CPU-side stage of a model load (any thread): its mesh cache opened & paged in or, without a valid one, the source imported
+struct PreparedModel
+{
+	std::string Filepath;
+	Ref<GltfModel> Gltf;						// glTF files (not cached, their buffers are uploaded in place)
+	UniquePtr<FileUtils::VirtualFile> Cache;	// Open if loaded from the mesh cache
+	ImportedModel Imported;						// Otherwise
+};
+
+
+// Timings of MeshImporter::RunInterleaveBenchmark() over a synthetic mesh with all the attributes (best of the runs)
+struct InterleaveBenchmark
+{
+	uint VerticesCount = 0;
+	float ScalarMs = 0.0f, SIMDMs = 0.0f, SIMDThreadedMs = 0.0f;		// A push_back per float (as before), SIMD kernel in 1 thread & split across threads
+	float ScalarMVps = 0.0f, SIMDMVps = 0.0f, SIMDThreadedMVps = 0.0f;	// Millions of vertices per second
+	bool OutputsMatch = false;
+};
+
+
+
+// --- Mesh Importer ---
 class MeshImporter
 {
 	friend class Resources;
+	friend class MeshCache;
+	friend class ObjImporter;
+	friend class GltfImporter;
+public:
+
+	// Hierarchy keeps the nodes transforms as the meshes local ones, so repeated nodes place the same mesh (sharing its buffers)
+	// Flattened bakes them into the vertices (aiProcess_PreTransformVertices), duplicating the geometry of repeated nodes
+	// Identical meshes are merged into one in both modes. Set it before loading, it applies to the models loaded afterwards
+	enum class IMPORT_MODE { HIERARCHY = 0, FLATTENED };
+	static void SetImportMode(IMPORT_MODE mode)	{ s_ImportMode = mode; }
+	static IMPORT_MODE GetImportMode()			{ return s_ImportMode; }
+
+	// Changing these invalidates the mesh cache
+	static const uint s_AssimpImportFlags = aiProcess_Triangulate | aiProcess_CalcTangentSpace | aiProcess_GenSmoothNormals //| aiProcess_FlipUVs // FlipUVs gives problem with UVs, I think because STB already flips them
+		| aiProcess_JoinIdenticalVertices | aiProcess_ImproveCacheLocality | aiProcess_OptimizeMeshes | aiProcess_SortByPType;
+
+	// The flags above plus the import mode ones
+	static uint GetAssimpImportFlags() { return s_AssimpImportFlags | (s_ImportMode == IMPORT_MODE::FLATTENED ? aiProcess_PreTransformVertices : 0); }
+
+	static BufferLayout GetVertexLayout();
+
+	// Splits the triangles into meshlets of up to Meshlet::s_MaxVertices & s_MaxTriangles, greedily in the indices order (already
+	// optimized for the vertex cache), so each one is a contiguous indices range. Positions are read every positions_stride floats
+	static std::vector<Meshlet> BuildMeshlets(const float* positions, uint positions_stride, uint vertices_count, const uint* indices, uint indices_count);
+
+	// --- Benchmark ---
+	static InterleaveBenchmark RunInterleaveBenchmark(uint vertices_count = 1000000, uint runs = 5);
+
 private:
 
+	// Prepare & Finalize in place
 	static Ref<Model> LoadModel(const std::string& filepath);
 
-	static void ProcessAssimpNode(const aiScene* ai_scene, aiNode* ai_node, Mesh* mesh, const std::vector<uint> loaded_materials);
-	static Ref<Mesh>* ProcessAssimpMesh(const aiScene* ai_scene, aiMesh* ai_mesh);
-	static const Ref<Material>* ProcessAssimpMaterial(aiMaterial* ai_material, const std::string& directory);
+	// Any thread: reads & parses the model (caching the import), false if it failed
+	static bool PrepareModel(const std::string& filepath, PreparedModel& prepared);
+
+	// Main thread: creates the GPU resources of a prepared model
+	static Ref<Model> FinalizeModel(const PreparedModel& prepared);
+
+	// --- Assimp Import (CPU) ---
+	static bool ImportAssimpScene(const std::string& filepath, ImportedModel& imported_model);
+	static void ProcessAssimpNode(const aiScene* ai_scene, aiNode* ai_node, const glm::mat4& parent_transform, std::vector<ImportedInstance>& instances);
+	static void ProcessAssimpMesh(aiMesh* ai_mesh, ImportedMesh& imported_mesh);
+
+	// Interleaves the [first, first + count) vertices of Assimp's attributes (SoA, an array each) into the engine's layout with SSE,
+	// straight into the vertices buffer (of the mesh size). Missing attributes are written as zeros. Returns the range bounds
+	static AABB InterleaveVertices(const aiMesh* ai_mesh, uint first, uint count, float* vertices);
+	static bool ProcessAssimpMaterial(aiMaterial* ai_material, ImportedMaterial& imported_material);
+
+	static std::string LoadMaterialTexture(aiMaterial* ai_material, aiTextureType texture_type);
+
+	// Merges the meshes with identical vertices & indices (by hash) into one, placed by all their instances
+	static void DeduplicateMeshes(ImportedModel& imported_model);
+
+	// --- Resources Creation (GPU) ---
+	static Ref<Model> CreateModel(const std::string& filepath, const ImportedModel& imported_model);
+	static Ref<VertexArray> CreateVertexArray(const float* vertices, uint vertices_size, const uint* indices, uint indices_count);
+	static Ref<StorageBuffer> CreateMeshletsBuffer(const Meshlet* meshlets, uint meshlets_count); // Null if there are none
+	static Ref<Material> CreateMaterial(const ImportedMaterial& imported_material, const std::string& directory);
+
+	// Names the mesh, sets its material, bounds & transform in the model and attaches it to the model (as root if it has none)
+	static void AddModelMesh(Model* model, const Ref<Mesh>& mesh, const std::string& name, MaterialHandle material_id, const AABB& bounds, const glm::mat4& local_transform = glm::mat4(1.0f));
+
+private:
 
-	static std::string LoadMaterialTexture(aiMaterial* ai_material, aiTextureType texture_type, const std::string& directory);
+	static IMPORT_MODE s_ImportMode;
 };
 
-#endif //_MESHIMPORTER_H_
\ No newline at end of file
+#endif //_MESHIMPORTER_H_
@@ -0,0 +1,987 @@
+#include "ObjImporter.h"
+
+#include "Core/Utils/FileStringUtils.h"
+#include "Core/Utils/JobSystem.h"
+#include "Core/Utils/Timer.h"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <unordered_map>
+
+
+// ------------------------------------------------------------------------------
+namespace
+{
+	static constexpr size_t s_MinChunkSize = 256 * 1024;	// Smaller files are parsed in less chunks (down to 1)
+	static constexpr uint s_ChunksPerThread = 4;			// Some slack for uneven chunks
+	static constexpr uint s_VertexFloats = 14;				// MeshImporter::GetVertexLayout()
+
+	// -- Parsed Data --
+	// Face corner: position, texcoord & normal indices (0-based, -1 if not given)
+	// Negative (relative) OBJ indices are resolved against the chunk's own elements while parsing, the chunk's base added later
+	struct ObjCorner
+	{
+		int Indices[3] = { -1, -1, -1 };
+		uint RelativeMask = 0;	// Bit per index still missing the chunk's base
+
+		bool operator==(const ObjCorner& corner) const { return Indices[0] == corner.Indices[0] && Indices[1] == corner.Indices[1] && Indices[2] == corner.Indices[2]; }
+	};
+
+	// usemtl or group (g, o) statement, applying from a triangle of the chunk on
+	struct ObjStatement
+	{
+		uint FirstTriangle = 0;
+		std::string Name;
+		bool IsMaterial = false;
+	};
+
+	struct ObjChunk
+	{
+		const char* Begin = nullptr;
+		const char* End = nullptr;
+
+		std::vector<float> Positions, TexCoords, Normals;	// xyz, uv, xyz
+		std::vector<ObjCorner> Corners;						// Triangulated, 3 per triangle
+		std::vector<ObjStatement> Statements;
+		std::vector<std::string> MaterialLibraries;
+
+		uint ElementsBase[3] = { 0, 0, 0 };					// Positions, texcoords & normals of the previous chunks
+	};
+
+	// Triangles of a chunk drawn by a mesh
+	struct ObjTrianglesSpan
+	{
+		uint Chunk, FirstTriangle, Count;
+	};
+
+	struct ObjMesh
+	{
+		std::string Name, Material;
+		std::vector<ObjTrianglesSpan> Spans;
+		uint TrianglesCount = 0;
+	};
+
+	struct ObjMaterial
+	{
+		ImportedMaterial Material;
+		glm::vec3 Diffuse = glm::vec3(0.6f), Emissive = glm::vec3(0.0f);	// Defaults as Assimp's OBJ importer
+		float Shininess = 0.0f, Opacity = 1.0f, BumpScale = 1.0f;
+	};
+
+
+
+	// ------------------------------------------------------------------------------
+	// --- Text Parsing ---
+	inline bool IsDigit(char c)			{ return (uint8_t)(c - '0') < 10; }
+	inline bool IsSpace(char c)			{ return c == ' ' || c == '\t' || c == '\r'; }
+
+	inline const char* SkipSpaces(const char* p, const char* end)
+	{
+		while (p < end && IsSpace(*p))
+			++p;
+
+		return p;
+	}
+
+	inline const char* SkipToken(const char* p, const char* end)
+	{
+		while (p < end && !IsSpace(*p))
+			++p;
+
+		return p;
+	}
+
+	// True if the line starts by the keyword followed by a space (or ends there), p is left after it
+	inline bool ReadKeyword(const char*& p, const char* end, const char* keyword)
+	{
+		size_t length = strlen(keyword);
+		if ((size_t)(end - p) < length || strncmp(p, keyword, length) != 0 || (p + length < end && !IsSpace(p[length])))
+			return false;
+
+		p += length;
+		return true;
+	}
+
+	// Rest of the line without surrounding spaces (names & paths can have spaces inside)
+	inline std::string ReadLineRest(const char* p, const char* end)
+	{
+		p = SkipSpaces(p, end);
+		while (end > p && IsSpace(end[-1]))
+			--end;
+
+		return std::string(p, end);
+	}
+
+
+	// -- Numbers --
+	// 8 digits at once (SWAR) as in fast_float (Lemire, "Number Parsing at a Gigabyte per Second"), little endian
+	inline bool IsEightDigits(uint64_t chars)
+	{
+		return ((chars & 0xF0F0F0F0F0F0F0F0ull) | (((chars + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) == 0x3333333333333333ull;
+	}
+
+	inline uint64_t ParseEightDigits(uint64_t chars)
+	{
+		const uint64_t mask = 0x000000FF000000FFull, mul1 = 0x000F424000000064ull, mul2 = 0x0000271000000001ull;
+		chars -= 0x3030303030303030ull;
+		chars = (chars * 10) + (chars >> 8);
+		return (((chars & mask) * mul1) + (((chars >> 16) & mask) * mul2)) >> 32;
+	}
+
+	// Accumulates up to 19 significant digits into the mantissa, the ones past it only scale the exponent
+	inline const char* ParseDigits(const char* p, const char* end, uint64_t& mantissa, int& exponent, bool fractional)
+	{
+		while (end - p >= 8 && mantissa < 100000000000ull)
+		{
+			uint64_t chars;
+			memcpy(&chars, p, 8);
+			if (!IsEightDigits(chars))
+				break;
+
+			mantissa = mantissa * 100000000ull + ParseEightDigits(chars);
+			exponent -= fractional ? 8 : 0;
+			p += 8;
+		}
+
+		for (; p < end && IsDigit(*p); ++p)
+		{
+			if (mantissa < 1000000000000000000ull)
+			{
+				mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+				exponent -= fractional ? 1 : 0;
+			}
+			else if (!fractional)
+				++exponent;
+		}
+
+		return p;
+	}
+
+	// For what the fast path doesn't take (inf, nan, huge exponents)
+	const char* ParseFloatFallback(const char* p, const char* end, float& value)
+	{
+		char buffer[64];
+		size_t length = std::min((size_t)(SkipToken(p, end) - p), sizeof(buffer) - 1);
+		memcpy(buffer, p, length);
+		buffer[length] = '\0';
+
+		char* parsed_end = nullptr;
+		value = strtof(buffer, &parsed_end);
+		return parsed_end == buffer ? nullptr : p + (parsed_end - buffer);
+	}
+
+	// Nullptr if there's no number. The mantissa (exact up to 2^53) scaled by exact powers of 10 in doubles (Clinger's fast
+	// path), then rounded to float: at most 1 ulp away from strtof() in halfway cases, far below the precision of any model
+	const char* ParseFloat(const char* p, const char* end, float& value)
+	{
+		static const double s_Powers10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+											 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+		const char* start = p;
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+'))
+			negative = *p++ == '-';
+
+		// -- Mantissa --
+		uint64_t mantissa = 0;
+		int exponent = 0;
+		const char* digits_start = p;
+		p = ParseDigits(p, end, mantissa, exponent, false);
+		bool has_digits = p != digits_start;
+
+		if (p < end && *p == '.')
+		{
+			const char* fraction_start = ++p;
+			p = ParseDigits(p, end, mantissa, exponent, true);
+			has_digits |= p != fraction_start;
+		}
+
+		if (!has_digits)
+			return ParseFloatFallback(start, end, value);
+
+		// -- Exponent --
+		if (p < end && (*p == 'e' || *p == 'E'))
+		{
+			const char* exponent_start = p++;
+			bool negative_exponent = false;
+			if (p < end && (*p == '-' || *p == '+'))
+				negative_exponent = *p++ == '-';
+
+			if (p < end && IsDigit(*p))
+			{
+				int explicit_exponent = 0;
+				for (; p < end && IsDigit(*p); ++p)
+					explicit_exponent = explicit_exponent < 10000 ? explicit_exponent * 10 + (*p - '0') : explicit_exponent;
+
+				exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+			}
+			else
+				p = exponent_start; // Not an exponent
+		}
+
+		// -- Scale --
+		if (mantissa == 0)
+		{
+			value = negative ? -0.0f : 0.0f;
+			return p;
+		}
+
+		if (exponent < -44 || exponent > 44)
+			return ParseFloatFallback(start, end, value);
+
+		double result = (double)mantissa;
+		int abs_exponent = exponent < 0 ? -exponent : exponent;
+		if (abs_exponent > 22)
+		{
+			result = exponent < 0 ? result / s_Powers10[22] : result * s_Powers10[22];
+			abs_exponent -= 22;
+		}
+
+		result = exponent < 0 ? result / s_Powers10[abs_exponent] : result * s_Powers10[abs_exponent];
+		value = (float)(negative ? -result : result);
+		return p;
+	}
+
+	// Nullptr if there's no number
+	inline const char* ParseInt(const char* p, const char* end, int& value)
+	{
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+'))
+			negative = *p++ == '-';
+
+		if (p >= end || !IsDigit(*p))
+			return nullptr;
+
+		int64_t result = 0;
+		for (; p < end && IsDigit(*p); ++p)
+			result = result < INT32_MAX ? result * 10 + (*p - '0') : result;
+
+		value = (int)(negative ? -std::min(result, (int64_t)INT32_MAX) : std::min(result, (int64_t)INT32_MAX));
+		return p;
+	}
+
+	// Pushes exactly count floats (0 for the missing or invalid ones), extra ones are ignored (like the w or vertex colors)
+	inline void ParseFloats(const char* p, const char* end, uint count, std::vector<float>& values)
+	{
+		for (uint i = 0; i < count; ++i)
+		{
+			float value = 0.0f;
+			p = SkipSpaces(p, end);
+			if (p < end)
+			{
+				const char* number_end = ParseFloat(p, end, value);
+				p = number_end ? number_end : SkipToken(p, end);
+			}
+
+			values.push_back(value);
+		}
+	}
+
+
+
+	// ------------------------------------------------------------------------------
+	// --- OBJ Parsing ---
+	// Face of any number of corners (v, v/vt, v//vn or v/vt/vn), fan-triangulated
+	void ParseFace(const char* p, const char* end, ObjChunk& chunk)
+	{
+		const int elements_count[3] = { (int)chunk.Positions.size() / 3, (int)chunk.TexCoords.size() / 2, (int)chunk.Normals.size() / 3 };
+		ObjCorner first, previous;
+		uint corners_count = 0;
+
+		while ((p = SkipSpaces(p, end)) < end && *p != '#')
+		{
+			ObjCorner corner;
+			for (uint i = 0; i < 3 && p < end; ++i)
+			{
+				if (i > 0)
+				{
+					if (*p != '/')
+						break;
+					++p;
+				}
+
+				int index = 0;
+				if (const char* index_end = ParseInt(p, end, index))
+				{
+					p = index_end;
+					if (index > 0)
+						corner.Indices[i] = index - 1;
+					else if (index < 0)
+					{
+						corner.Indices[i] = elements_count[i] + index;
+						corner.RelativeMask |= 1u << i;
+					}
+				}
+			}
+
+			p = SkipToken(p, end);
+			if (corner.Indices[0] == -1 && !(corner.RelativeMask & 1u))
+				continue; // Corner without position
+
+			if (++corners_count == 1)
+				first = corner;
+			else if (corners_count > 2)
+			{
+				chunk.Corners.push_back(first);
+				chunk.Corners.push_back(previous);
+				chunk.Corners.push_back(corner);
+			}
+
+			previous = corner;
+		}
+	}
+
+
+	void ParseLine(const char* p, const char* end, ObjChunk& chunk)
+	{
+		p = SkipSpaces(p, end);
+		if (p == end)
+			return;
+
+		switch (*p)
+		{
+			case 'v':
+				if (ReadKeyword(p, end, "v"))
+					ParseFloats(p, end, 3, chunk.Positions);
+				else if (ReadKeyword(p, end, "vt"))
+					ParseFloats(p, end, 2, chunk.TexCoords);
+				else if (ReadKeyword(p, end, "vn"))
+					ParseFloats(p, end, 3, chunk.Normals);
+				break;
+
+			case 'f':
+				if (ReadKeyword(p, end, "f"))
+					ParseFace(p, end, chunk);
+				break;
+
+			case 'u':
+				if (ReadKeyword(p, end, "usemtl"))
+					chunk.Statements.push_back({ (uint)chunk.Corners.size() / 3, ReadLineRest(p, end), true });
+				break;
+
+			case 'g': case 'o':
+				if (ReadKeyword(p, end, "g") || ReadKeyword(p, end, "o"))
+					chunk.Statements.push_back({ (uint)chunk.Corners.size() / 3, ReadLineRest(p, end), false });
+				break;
+
+			case 'm':
+				if (ReadKeyword(p, end, "mtllib"))
+					chunk.MaterialLibraries.push_back(ReadLineRest(p, end));
+				break;
+
+			default:
+				break; // Comments, smoothing groups, lines & unsupported statements
+		}
+	}
+
+
+	void ParseChunk(ObjChunk& chunk)
+	{
+		const char* p = chunk.Begin;
+		while (p < chunk.End)
+		{
+			const char* line_end = (const char*)memchr(p, '\n', chunk.End - p);
+			line_end = line_end ? line_end : chunk.End;
+
+			ParseLine(p, line_end, chunk);
+			p = line_end + 1;
+		}
+	}
+
+
+	// Chunks of about the same size, each ending after a line break (the last one at the file end)
+	std::vector<ObjChunk> SplitChunks(const char* data, size_t size)
+	{
+		size_t max_chunks = (size_t)(JobSystem::GetThreadsCount() + 1) * s_ChunksPerThread;
+		size_t chunks_count = std::max<size_t>(1, std::min(size / s_MinChunkSize, max_chunks));
+
+		std::vector<ObjChunk> chunks;
+		const char* begin = data;
+		const char* end = data + size;
+		for (size_t i = 1; i <= chunks_count && begin < end; ++i)
+		{
+			const char* chunk_end = end;
+			if (i < chunks_count)
+			{
+				const char* split = std::max(begin, data + size * i / chunks_count);
+				const char* line_break = (const char*)memchr(split, '\n', end - split);
+				chunk_end = line_break ? line_break + 1 : end;
+			}
+
+			chunks.emplace_back();
+			chunks.back().Begin = begin;
+			chunks.back().End = chunk_end;
+			begin = chunk_end;
+		}
+
+		return chunks;
+	}
+
+
+
+	// ------------------------------------------------------------------------------
+	// --- MTL Parsing ---
+	// Texture statement: [-option args...] filename (relative to the model directory, may have spaces)
+	std::string ParseTexturePath(const char* p, const char* end, float* bump_scale)
+	{
+		while ((p = SkipSpaces(p, end)) < end && *p == '-')
+		{
+			const char* option = p;
+			p = SkipToken(p, end);
+			std::string option_name(option, p);
+
+			// Options arguments are numbers or on/off, except -type & -imfchan (single token)
+			uint max_args = (option_name == "-mm") ? 2 : (option_name == "-o" || option_name == "-s" || option_name == "-t") ? 3 : 1;
+			for (uint i = 0; i < max_args; ++i)
+			{
+				const char* arg = SkipSpaces(p, end);
+				float value = 0.0f;
+				const char* number_end = ParseFloat(arg, end, value);
+				bool is_number = number_end && (number_end == end || IsSpace(*number_end));
+				if (i > 0 && !is_number)
+					break; // Optional arguments (-o, -s & -t take 1 to 3)
+
+				if (option_name == "-bm" && bump_scale && is_number)
+					*bump_scale = value;
+
+				p = SkipToken(arg, end);
+			}
+		}
+
+		return ReadLineRest(p, end);
+	}
+
+
+	void ParseMaterialLibrary(const std::string& filepath, std::vector<ObjMaterial>& materials)
+	{
+		FileUtils::VirtualFile file;
+		if (!file.Open(filepath))
+		{
+			ENGINE_LOG("OBJ Importer: couldn't open material library '%s'", filepath.c_str());
+			return;
+		}
+
+		const char* p = (const char*)file.GetData();
+		const char* file_end = p + file.GetSize();
+		ObjMaterial* material = nullptr;
+
+		auto read_color = [](const char* p, const char* end) { std::vector<float> rgb; ParseFloats(p, end, 3, rgb); return glm::vec3(rgb[0], rgb[1], rgb[2]); };
+		auto read_float = [](const char* p, const char* end) { std::vector<float> value; ParseFloats(p, end, 1, value); return value[0]; };
+
+		while (p < file_end)
+		{
+			const char* end = (const char*)memchr(p, '\n', file_end - p);
+			end = end ? end : file_end;
+			const char* line = SkipSpaces(p, end);
+			p = end + 1;
+
+			if (ReadKeyword(line, end, "newmtl"))
+			{
+				materials.emplace_back();
+				material = &materials.back();
+				material->Material.Name = ReadLineRest(line, end);
+				continue;
+			}
+
+			if (!material)
+				continue;
+
+			ImportedMaterial& mat = material->Material;
+			if (ReadKeyword(line, end, "Kd"))
+				material->Diffuse = read_color(line, end);
+			else if (ReadKeyword(line, end, "Ke"))
+				material->Emissive = read_color(line, end);
+			else if (ReadKeyword(line, end, "Ns"))
+				material->Shininess = read_float(line, end);
+			else if (ReadKeyword(line, end, "d"))
+				material->Opacity = read_float(line, end);
+			else if (ReadKeyword(line, end, "Tr"))
+				material->Opacity = 1.0f - read_float(line, end);
+			else if (ReadKeyword(line, end, "map_Kd"))
+				mat.TexturePaths[(int)MATERIAL_TEXTURE::ALBEDO] = ParseTexturePath(line, end, nullptr);
+			else if (ReadKeyword(line, end, "map_Ke"))
+				mat.TexturePaths[(int)MATERIAL_TEXTURE::EMISSIVE] = ParseTexturePath(line, end, nullptr);
+			else if (ReadKeyword(line, end, "map_Ks"))
+				mat.TexturePaths[(int)MATERIAL_TEXTURE::SPECULAR] = ParseTexturePath(line, end, nullptr);
+			else if (ReadKeyword(line, end, "norm") || ReadKeyword(line, end, "map_Kn"))
+				mat.TexturePaths[(int)MATERIAL_TEXTURE::NORMAL] = ParseTexturePath(line, end, nullptr);
+			else if (ReadKeyword(line, end, "map_Bump") || ReadKeyword(line, end, "map_bump") || ReadKeyword(line, end, "bump"))
+				mat.TexturePaths[(int)MATERIAL_TEXTURE::BUMP] = ParseTexturePath(line, end, &material->BumpScale);
+		}
+
+		// -- Set Material Variables --
+		// Same mapping as MeshImporter::ProcessAssimpMaterial() (Assimp's OBJ materials are two sided)
+		for (ObjMaterial& material : materials)
+		{
+			ImportedMaterial& mat = material.Material;
+			mat.AlbedoColor = glm::vec4(material.Diffuse, material.Opacity);
+			mat.EmissiveColor = glm::vec4(material.Emissive, 1.0f);
+			mat.Smoothness = material.Shininess / 256.0f;
+			mat.Bumpiness = material.BumpScale;
+
+			if (glm::abs(mat.Smoothness) < FLT_EPSILON)
+				mat.Smoothness = 0.1f;
+
+			if (glm::abs(mat.Bumpiness) < FLT_EPSILON)
+				mat.Bumpiness = 1.0f;
+
+			mat.IsTwoSided = true;
+			mat.IsEmissive = material.Emissive.r > 10e-3f || material.Emissive.g > 10e-3f || material.Emissive.b > 10e-3f;
+			mat.IsTransparent = material.Opacity < 1.0f;
+		}
+	}
+
+
+
+	// ------------------------------------------------------------------------------
+	// --- Welding ---
+	// Open addressing (linear probing) table of indices into a keys array owned by the caller, sized for a maximum of keys
+	class WeldTable
+	{
+	public:
+
+		explicit WeldTable(uint max_keys)
+		{
+			uint capacity = 16;
+			while (capacity < max_keys * 2)
+				capacity <<= 1;
+
+			m_Slots.assign(capacity, s_Empty);
+			m_Mask = capacity - 1;
+		}
+
+		// Index of an equal key already in, otherwise new_index (added)
+		template<typename EqualFunc>
+		uint FindOrAdd(uint hash, uint new_index, EqualFunc equal)
+		{
+			uint slot = hash & m_Mask;
+			while (m_Slots[slot] != s_Empty)
+			{
+				if (equal(m_Slots[slot]))
+					return m_Slots[slot];
+
+				slot = (slot + 1) & m_Mask;
+			}
+
+			m_Slots[slot] = new_index;
+			return new_index;
+		}
+
+	private:
+
+		static constexpr uint s_Empty = ~0u;
+		std::vector<uint> m_Slots;
+		uint m_Mask = 0;
+	};
+
+	inline uint HashIndex(int index)
+	{
+		uint64_t hash = (uint64_t)(uint)index * 0x9E3779B97F4A7C15ull;
+		return (uint)(hash ^ (hash >> 32));
+	}
+
+	inline uint HashCorner(const ObjCorner& corner)
+	{
+		uint64_t hash = (uint64_t)(uint)corner.Indices[0] * 0x9E3779B97F4A7C15ull;
+		hash ^= (uint64_t)(uint)corner.Indices[1] * 0xC2B2AE3D27D4EB4Full;
+		hash ^= (uint64_t)(uint)corner.Indices[2] * 0x165667B19E3779F9ull;
+		return (uint)(hash ^ (hash >> 32));
+	}
+
+
+	// All chunks elements, once their indices are resolved
+	struct ObjElements
+	{
+		std::vector<float> Positions, TexCoords, Normals;
+	};
+
+	void BuildMesh(const ObjMesh& obj_mesh, const std::vector<ObjChunk>& chunks, const ObjElements& elements, ImportedMesh& mesh)
+	{
+		// -- Weld Corners --
+		std::vector<ObjCorner> vertices_keys;
+		vertices_keys.reserve(obj_mesh.TrianglesCount * 3);
+		mesh.Indices.resize(obj_mesh.TrianglesCount * 3);
+		uint* indices = mesh.Indices.data();
+
+		WeldTable table(obj_mesh.TrianglesCount * 3);
+		for (const ObjTrianglesSpan& span : obj_mesh.Spans)
+		{
+			const ObjCorner* corners = chunks[span.Chunk].Corners.data() + span.FirstTriangle * 3;
+			for (uint i = 0; i < span.Count * 3; ++i)
+			{
+				const ObjCorner& corner = corners[i];
+				uint new_index = (uint)vertices_keys.size();
+				uint index = table.FindOrAdd(HashCorner(corner), new_index, [&](uint key) { return vertices_keys[key] == corner; });
+				if (index == new_index)
+					vertices_keys.push_back(corner);
+
+				*indices++ = index;
+			}
+		}
+
+		// -- Interleave Vertices --
+		const uint vertices_count = (uint)vertices_keys.size();
+		mesh.Vertices.assign((size_t)vertices_count * s_VertexFloats, 0.0f);
+		float* vertices = mesh.Vertices.data();
+
+		bool has_texcoords = false, missing_normals = false;
+		glm::vec3 aabb_min = glm::vec3(FLT_MAX), aabb_max = glm::vec3(-FLT_MAX);
+		for (uint i = 0; i < vertices_count; ++i)
+		{
+			const ObjCorner& key = vertices_keys[i];
+			float* vertex = vertices + (size_t)i * s_VertexFloats;
+
+			if (key.Indices[0] >= 0)
+				memcpy(vertex, &elements.Positions[(size_t)key.Indices[0] * 3], 3 * sizeof(float));
+
+			if (key.Indices[1] >= 0)
+			{
+				memcpy(vertex + 3, &elements.TexCoords[(size_t)key.Indices[1] * 2], 2 * sizeof(float));
+				has_texcoords = true;
+			}
+
+			if (key.Indices[2] >= 0)
+				memcpy(vertex + 5, &elements.Normals[(size_t)key.Indices[2] * 3], 3 * sizeof(float));
+			else
+				missing_normals = true;
+
+			glm::vec3 position = glm::vec3(vertex[0], vertex[1], vertex[2]);
+			aabb_min = glm::min(aabb_min, position);
+			aabb_max = glm::max(aabb_max, position);
+		}
+
+		mesh.Bounds = { aabb_min, aabb_max };
+		auto position_of = [vertices](uint vertex) { const float* v = vertices + (size_t)vertex * s_VertexFloats; return glm::vec3(v[0], v[1], v[2]); };
+
+		// -- Generate Missing Normals --
+		// Smooth, averaging the normals of the faces around each position (as aiProcess_GenSmoothNormals)
+		if (missing_normals)
+		{
+			std::vector<int> smooth_positions;
+			std::vector<uint> smooth_slots(vertices_count, ~0u);
+			WeldTable positions_table(vertices_count);
+			for (uint i = 0; i < vertices_count; ++i)
+			{
+				int position = vertices_keys[i].Indices[0];
+				if (vertices_keys[i].Indices[2] >= 0)
+					continue;
+
+				uint new_slot = (uint)smooth_positions.size();
+				smooth_slots[i] = positions_table.FindOrAdd(HashIndex(position), new_slot, [&](uint slot) { return smooth_positions[slot] == position; });
+				if (smooth_slots[i] == new_slot)
+					smooth_positions.push_back(position);
+			}
+
+			std::vector<glm::vec3> smooth_normals(smooth_positions.size(), glm::vec3(0.0f));
+			for (size_t i = 0; i < mesh.Indices.size(); i += 3)
+			{
+				const uint* triangle = &mesh.Indices[i];
+				glm::vec3 face_normal = glm::cross(position_of(triangle[1]) - position_of(triangle[0]), position_of(triangle[2]) - position_of(triangle[0]));
+				float length = glm::length(face_normal);
+				if (length <= FLT_MIN)
+					continue;
+
+				for (uint c = 0; c < 3; ++c)
+					if (smooth_slots[triangle[c]] != ~0u)
+						smooth_normals[smooth_slots[triangle[c]]] += face_normal / length;
+			}
+
+			for (uint i = 0; i < vertices_count; ++i)
+			{
+				if (smooth_slots[i] == ~0u)
+					continue;
+
+				glm::vec3 normal = smooth_normals[smooth_slots[i]];
+				float length = glm::length(normal);
+				normal = length > FLT_MIN ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+				memcpy(vertices + (size_t)i * s_VertexFloats + 5, &normal, 3 * sizeof(float));
+			}
+		}
+
+		// -- Tangents & Bitangents --
+		// Accumulated per vertex from its triangles UVs & orthonormalized against its normal (none without texcoords, as Assimp)
+		if (!has_texcoords)
+			return;
+
+		std::vector<glm::vec3> tangents(vertices_count, glm::vec3(0.0f)), bitangents(vertices_count, glm::vec3(0.0f));
+		for (size_t i = 0; i < mesh.Indices.size(); i += 3)
+		{
+			const uint* triangle = &mesh.Indices[i];
+			const float* v0 = vertices + (size_t)triangle[0] * s_VertexFloats;
+			const float* v1 = vertices + (size_t)triangle[1] * s_VertexFloats;
+			const float* v2 = vertices + (size_t)triangle[2] * s_VertexFloats;
+
+			glm::vec3 edge1 = position_of(triangle[1]) - position_of(triangle[0]), edge2 = position_of(triangle[2]) - position_of(triangle[0]);
+			glm::vec2 delta_uv1 = glm::vec2(v1[3] - v0[3], v1[4] - v0[4]), delta_uv2 = glm::vec2(v2[3] - v0[3], v2[4] - v0[4]);
+
+			float determinant = delta_uv1.x * delta_uv2.y - delta_uv2.x * delta_uv1.y;
+			if (glm::abs(determinant) <= FLT_MIN)
+				continue;
+
+			float inverse = 1.0f / determinant;
+			glm::vec3 tangent = (edge1 * delta_uv2.y - edge2 * delta_uv1.y) * inverse;
+			glm::vec3 bitangent = (edge2 * delta_uv1.x - edge1 * delta_uv2.x) * inverse;
+			for (uint c = 0; c < 3; ++c)
+			{
+				tangents[triangle[c]] += tangent;
+				bitangents[triangle[c]] += bitangent;
+			}
+		}
+
+		for (uint i = 0; i < vertices_count; ++i)
+		{
+			float* vertex = vertices + (size_t)i * s_VertexFloats;
+			glm::vec3 normal = glm::vec3(vertex[5], vertex[6], vertex[7]);
+			glm::vec3 tangent = tangents[i] - normal * glm::dot(normal, tangents[i]);
+			glm::vec3 bitangent = bitangents[i] - normal * glm::dot(normal, bitangents[i]);
+
+			// Degenerated UVs: any basis around the normal
+			if (glm::dot(tangent, tangent) <= FLT_MIN)
+				tangent = glm::abs(normal.x) < 0.9f ? glm::cross(normal, glm::vec3(1.0f, 0.0f, 0.0f)) : glm::cross(normal, glm::vec3(0.0f, 1.0f, 0.0f));
+
+			tangent = glm::normalize(tangent);
+			if (glm::dot(bitangent, bitangent) <= FLT_MIN)
+				bitangent = glm::cross(normal, tangent);
+
+			bitangent = glm::normalize(bitangent);
+			memcpy(vertex + 8, &tangent, 3 * sizeof(float));
+			memcpy(vertex + 11, &bitangent, 3 * sizeof(float));
+		}
+	}
+}
+
+
+
+// ------------------------------------------------------------------------------
+bool ObjImporter::IsObjFile(const std::string& filepath)
+{
+	size_t dot = filepath.find_last_of('.');
+	if (dot == std::string::npos)
+		return false;
+
+	std::string extension = filepath.substr(dot + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)tolower(c); });
+	return extension == "obj";
+}
+
+
+std::vector<std::string> ObjImporter::GetMaterialLibraries(const std::string& filepath, const uint8_t* data, uint64 size)
+{
+	// Only the mtllib lines, the rest isn't parsed
+	std::vector<std::string> libraries;
+	std::string directory = FileUtils::GetDirectory(filepath);
+	const char* p = (const char*)data, *end = p + size;
+	while (p < end)
+	{
+		const char* line_end = (const char*)memchr(p, '\n', end - p);
+		line_end = line_end ? line_end : end;
+
+		const char* line = SkipSpaces(p, line_end);
+		if (ReadKeyword(line, line_end, "mtllib"))
+		{
+			std::string library = FileUtils::MakePath(directory, ReadLineRest(line, line_end));
+			if (std::find(libraries.begin(), libraries.end(), library) == libraries.end())
+				libraries.push_back(library);
+		}
+
+		p = line_end + 1;
+	}
+
+	return libraries;
+}
+
+
+bool ObjImporter::ImportModel(const std::string& filepath, ImportedModel& imported_model)
+{
+	// -- Map & Parse Chunks --
+	FileUtils::VirtualFile file;
+	if (!file.Open(filepath))
+	{
+		ENGINE_LOG("OBJ Importer: couldn't open '%s'", filepath.c_str());
+		return false;
+	}
+
+	std::vector<ObjChunk> chunks = SplitChunks((const char*)file.GetData(), file.GetSize());
+	JobSystem::ParallelFor((uint)chunks.size(), JobSystem::GetBatchSize((uint)chunks.size()), [&chunks](uint first, uint count)
+	{
+		for (uint i = first; i < first + count; ++i)
+			ParseChunk(chunks[i]);
+	});
+
+	// -- Gather Elements --
+	// Each chunk's elements go after the previous ones, its relative indices get resolved & all of them validated
+	uint elements_count[3] = { 0, 0, 0 };
+	for (ObjChunk& chunk : chunks)
+	{
+		memcpy(chunk.ElementsBase, elements_count, sizeof(elements_count));
+		elements_count[0] += (uint)chunk.Positions.size() / 3;
+		elements_count[1] += (uint)chunk.TexCoords.size() / 2;
+		elements_count[2] += (uint)chunk.Normals.size() / 3;
+	}
+
+	if (elements_count[0] == 0)
+	{
+		ENGINE_LOG("OBJ Importer: no vertices in '%s'", filepath.c_str());
+		return false;
+	}
+
+	ObjElements elements;
+	elements.Positions.resize((size_t)elements_count[0] * 3);
+	elements.TexCoords.resize((size_t)elements_count[1] * 2);
+	elements.Normals.resize((size_t)elements_count[2] * 3);
+
+	JobSystem::ParallelFor((uint)chunks.size(), JobSystem::GetBatchSize((uint)chunks.size()), [&](uint first, uint count)
+	{
+		for (uint i = first; i < first + count; ++i)
+		{
+			ObjChunk& chunk = chunks[i];
+			std::copy(chunk.Positions.begin(), chunk.Positions.end(), elements.Positions.begin() + (size_t)chunk.ElementsBase[0] * 3);
+			std::copy(chunk.TexCoords.begin(), chunk.TexCoords.end(), elements.TexCoords.begin() + (size_t)chunk.ElementsBase[1] * 2);
+			std::copy(chunk.Normals.begin(), chunk.Normals.end(), elements.Normals.begin() + (size_t)chunk.ElementsBase[2] * 3);
+
+			for (ObjCorner& corner : chunk.Corners)
+			{
+				for (uint e = 0; e < 3; ++e)
+				{
+					int index = corner.Indices[e] + ((corner.RelativeMask >> e) & 1u ? (int)chunk.ElementsBase[e] : 0);
+					corner.Indices[e] = index >= 0 && index < (int)elements_count[e] ? index : -1;
+				}
+
+				corner.RelativeMask = 0;
+			}
+		}
+	});
+
+	// -- Split Meshes --
+	// A mesh per material (in order of use), named after the group it starts in
+	std::vector<ObjMesh> meshes;
+	std::unordered_map<std::string, uint> material_meshes;
+	std::string current_material, current_group;
+
+	auto add_span = [&](uint chunk, uint first_triangle, uint count)
+	{
+		if (count == 0)
+			return;
+
+		auto it = material_meshes.find(current_material);
+		if (it == material_meshes.end())
+		{
+			it = material_meshes.emplace(current_material, (uint)meshes.size()).first;
+			meshes.emplace_back();
+			meshes.back().Material = current_material;
+			meshes.back().Name = !current_group.empty() ? current_group : (!current_material.empty() ? current_material : "unnamed");
+		}
+
+		ObjMesh& mesh = meshes[it->second];
+		mesh.Spans.push_back({ chunk, first_triangle, count });
+		mesh.TrianglesCount += count;
+	};
+
+	std::vector<std::string> material_libraries;
+	for (uint c = 0; c < (uint)chunks.size(); ++c)
+	{
+		uint cursor = 0;
+		for (const ObjStatement& statement : chunks[c].Statements)
+		{
+			add_span(c, cursor, statement.FirstTriangle - cursor);
+			cursor = statement.FirstTriangle;
+			(statement.IsMaterial ? current_material : current_group) = statement.Name;
+		}
+
+		add_span(c, cursor, (uint)chunks[c].Corners.size() / 3 - cursor);
+		for (const std::string& library : chunks[c].MaterialLibraries)
+			if (std::find(material_libraries.begin(), material_libraries.end(), library) == material_libraries.end())
+				material_libraries.push_back(library);
+	}
+
+	if (meshes.empty())
+	{
+		ENGINE_LOG("OBJ Importer: no faces in '%s'", filepath.c_str());
+		return false;
+	}
+
+	// -- Load Materials --
+	// Only the used ones, in order of use. Unknown ones get the default material (as Assimp)
+	std::vector<ObjMaterial> library_materials;
+	std::string directory = FileUtils::GetDirectory(filepath);
+	for (const std::string& library : material_libraries)
+		ParseMaterialLibrary(FileUtils::MakePath(directory, library), library_materials);
+
+	imported_model.Meshes.resize(meshes.size());
+	for (size_t i = 0; i < meshes.size(); ++i)
+	{
+		imported_model.Meshes[i].Name = meshes[i].Name;
+		auto material = std::find_if(library_materials.begin(), library_materials.end(), [&](const ObjMaterial& mat) { return mat.Material.Name == meshes[i].Material; });
+		if (material != library_materials.end())
+		{
+			imported_model.Meshes[i].MaterialSlot = (int)imported_model.Materials.size();
+			imported_model.Materials.push_back(material->Material);
+		}
+	}
+
+	// -- Build Meshes --
+	JobSystem::ParallelFor((uint)meshes.size(), JobSystem::GetBatchSize((uint)meshes.size()), [&](uint first, uint count)
+	{
+		for (uint i = first; i < first + count; ++i)
+			BuildMesh(meshes[i], chunks, elements, imported_model.Meshes[i]);
+	});
+
+	return true;
+}
+
+
+
+// ------------------------------------------------------------------------------
+std::vector<ObjBenchmark> ObjImporter::RunBenchmark(const std::vector<std::string>& filepaths, uint runs)
+{
+	std::vector<ObjBenchmark> ret;
+	for (const std::string& filepath : filepaths)
+	{
+		FileUtils::VirtualFile file;
+		if (!file.Open(filepath))
+			continue;
+
+		ObjBenchmark result;
+		result.Filepath = filepath;
+		result.FileMB = (float)file.GetSize() / MBTOBYTE(1.0f);
+		result.NativeMs = result.AssimpMs = FLT_MAX;
+
+		Timer timer;
+		for (uint r = 0; r < std::max(runs, 1u); ++r)
+		{
+			// -- Native --
+			ImportedModel native_model;
+			timer.Start();
+			ObjImporter::ImportModel(filepath, native_model);
+			result.NativeMs = std::min(result.NativeMs, timer.GetMilliseconds());
+
+			// -- Assimp --
+			ImportedModel assimp_model;
+			timer.Start();
+			MeshImporter::ImportAssimpScene(filepath, assimp_model);
+			result.AssimpMs = std::min(result.AssimpMs, timer.GetMilliseconds());
+
+			// -- Output Size --
+			result.NativeVertices = result.NativeTriangles = result.AssimpVertices = result.AssimpTriangles = 0;
+			for (const ImportedMesh& mesh : native_model.Meshes)
+			{
+				result.NativeVertices += (uint)mesh.Vertices.size() / s_VertexFloats;
+				result.NativeTriangles += (uint)mesh.Indices.size() / 3;
+			}
+
+			for (const ImportedMesh& mesh : assimp_model.Meshes)
+			{
+				result.AssimpVertices += (uint)mesh.Vertices.size() / s_VertexFloats;
+				result.AssimpTriangles += (uint)mesh.Indices.size() / 3;
+			}
+		}
+
+		result.NativeMBps = result.FileMB / (std::max(result.NativeMs, 0.001f) / 1000.0f);
+		result.AssimpMBps = result.FileMB / (std::max(result.AssimpMs, 0.001f) / 1000.0f);
+		ret.push_back(result);
+	}
+
+	return ret;
+}
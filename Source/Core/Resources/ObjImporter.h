@@ -0,0 +1,39 @@
+#ifndef _OBJIMPORTER_H_
+#define _OBJIMPORTER_H_
+
+#include "Core/Globals.h"
+#include "MeshImporter.h"
+
+
+// Timings of ObjImporter::RunBenchmark() for a file, native importer against Assimp (both up to an ImportedModel)
+struct ObjBenchmark
+{
+	std::string Filepath;
+	float FileMB = 0.0f;
+	float NativeMs = 0.0f, AssimpMs = 0.0f;			// Best of the runs
+	float NativeMBps = 0.0f, AssimpMBps = 0.0f;		// Parse throughput
+	uint NativeVertices = 0, AssimpVertices = 0;	// After welding
+	uint NativeTriangles = 0, AssimpTriangles = 0;
+};
+
+
+// Native Wavefront OBJ/MTL importer, outputs the same ImportedModel as the Assimp path (a mesh per material, first one the root)
+// The mapped file is split in chunks at line boundaries & parsed in parallel (fast_float-like numbers parsing), then the face
+// corners of each mesh are welded with a hash table straight into the engine's interleaved vertex layout, a job per mesh
+class ObjImporter
+{
+public:
+
+	static bool IsObjFile(const std::string& filepath);
+
+	// Material libraries (mtllib, resolved) it references, for the mesh cache key: both importers read them
+	static std::vector<std::string> GetMaterialLibraries(const std::string& filepath, const uint8_t* data, uint64 size);
+
+	// Any thread, false if it failed (the model is left empty)
+	static bool ImportModel(const std::string& filepath, ImportedModel& imported_model);
+
+	// --- Benchmark ---
+	static std::vector<ObjBenchmark> RunBenchmark(const std::vector<std::string>& filepaths, uint runs = 3);
+};
+
+#endif //_OBJIMPORTER_H_
@@ -1,5 +1,15 @@
 #include "Resources.h"
 #include "MeshImporter.h"
+#include "AssetPack.h"
+#include "TextureAtlas.h"
+#include "Core/Utils/FileStringUtils.h"
+#include "Core/Utils/Hash.h"
+#include "Core/Utils/JobSystem.h"
+#include "Renderer/Resources/TextureLoader.h"
+#include "Renderer/Utils/GPUMemory.h"
+
+#include <algorithm>
+#include <unordered_set>
 
 
 // ------------------------------------------------------------------------------
@@ -7,33 +17,35 @@ std::vector<std::string> Resources::GetResourcesReferences()
 {
 	std::vector<std::string> ret;
 	ret.push_back("----- RESOURCES REFERENCES -----");
-	ret.push_back("- Materials (" + std::to_string(m_Materials.size()) + ")");
+	ret.push_back("- Materials (" + std::to_string(m_Materials.Size()) + ")");
 
 	for (auto& mat : m_Materials)
 	{
-		std::string m_str = "\tMat " + std::to_string(mat.first) + " '" + mat.second->m_Name + "' -> Refs: " + std::to_string(mat.second.use_count());
+		std::string m_str = "\tMat " + std::to_string(mat->m_ID.GetIndex()) + " '" + mat->m_Name + "' -> Refs: " + std::to_string(mat.use_count());
 		ret.push_back(m_str);
 	}
 
-	ret.push_back("- Meshes (" + std::to_string(m_Meshes.size()) + ")");
+	ret.push_back("- Meshes (" + std::to_string(m_Meshes.Size()) + ")");
 	for (auto& mesh : m_Meshes)
 	{
-		std::string m_str = "\tMesh " + std::to_string(mesh.first) + " (MatID: " + std::to_string(mesh.second->GetMaterialIndex()) + ") '";
-		m_str += mesh.second->GetName() + "' -> Refs: " + std::to_string(mesh.second.use_count());
+		std::string m_str = "\tMesh " + std::to_string(mesh->m_ID.GetIndex()) + " (MatID: " + std::to_string(mesh->m_Material.GetIndex()) + ") '";
+		m_str += mesh->GetName() + "' -> Refs: " + std::to_string(mesh.use_count());
 		ret.push_back(m_str);
 	}
 
-	ret.push_back("- Models (" + std::to_string(m_Models.size()) + ")");
+	ret.push_back("- Models (" + std::to_string(m_Models.Size()) + ")");
 	for (auto& model : m_Models)
 	{
 		std::string m_str = "\tModel '" + model->m_Name + "' -> Refs: " + std::to_string(model.use_count());
+		m_str += ", VRAM: " + std::to_string(GetMeshGPUBytes(model->m_RootMesh) / 1024) + " KB";
 		ret.push_back(m_str);
 	}
 
-	ret.push_back("- Textures (" + std::to_string(m_Textures.size()) + ")\n\tFirst 5 are Default ones");
+	ret.push_back("- Textures (" + std::to_string(m_Textures.Size()) + ")\n\tFirst 5 are Default ones");
 	for (auto& tex : m_Textures)
 	{
-		std::string t_str = "\tTexture " + std::to_string(tex->m_ID) + " -> Refs: " + std::to_string(tex.use_count()) + "\n";
+		std::string t_str = "\tTexture " + std::to_string(tex->GetTextureID()) + " -> Refs: " + std::to_string(tex.use_count());
+		t_str += ", VRAM: " + std::to_string(tex->GetGPUBytes() / 1024) + " KB\n";
 		ret.push_back(t_str);
 	}
 	
@@ -43,21 +55,21 @@ std::vector<std::string> Resources::GetResourcesReferences()
 void Resources::PrintResourcesReferences()
 {
 	ENGINE_LOG("\n\n----- RESOURCES REFERENCES -----");
-	ENGINE_LOG("\t- Materials (%i)", m_Materials.size());
+	ENGINE_LOG("\t- Materials (%i)", m_Materials.Size());
 	for (auto& mat : m_Materials)
-		ENGINE_LOG("\t\tMat %i '%s' -> Refs: %i", mat.first, mat.second->m_Name.c_str(), mat.second.use_count());
+		ENGINE_LOG("\t\tMat %i '%s' -> Refs: %i", mat->m_ID.GetIndex(), mat->m_Name.c_str(), mat.use_count());
 
-	ENGINE_LOG("\t- Meshes (%i)", m_Meshes.size());
+	ENGINE_LOG("\t- Meshes (%i)", m_Meshes.Size());
 	for (auto& mesh : m_Meshes)
-		ENGINE_LOG("\t\tMesh %i (MatID: %i) '%s' -> Refs: %i", mesh.first, mesh.second->GetMaterialIndex(), mesh.second->GetName().c_str(), mesh.second.use_count());
+		ENGINE_LOG("\t\tMesh %i (MatID: %i) '%s' -> Refs: %i", mesh->m_ID.GetIndex(), mesh->m_Material.GetIndex(), mesh->GetName().c_str(), mesh.use_count());
 
-	ENGINE_LOG("\t- Models (%i)", m_Models.size());
+	ENGINE_LOG("\t- Models (%i)", m_Models.Size());
 	for(auto& model : m_Models)
-		ENGINE_LOG("\t\tModel '%s' -> Refs: %i", model->m_Name.c_str(), model.use_count());
+		ENGINE_LOG("\t\tModel '%s' -> Refs: %i, VRAM: %llu KB", model->m_Name.c_str(), model.use_count(), GetMeshGPUBytes(model->m_RootMesh) / 1024);
 
-	ENGINE_LOG("\t- Textures (%i)\n\t\tFirst 5 are Default ones", m_Textures.size());
+	ENGINE_LOG("\t- Textures (%i)\n\t\tFirst 5 are Default ones", m_Textures.Size());
 	for(auto& tex : m_Textures)
-		ENGINE_LOG("\t\tTexture %i -> Refs: %i", tex->m_ID, tex.use_count());
+		ENGINE_LOG("\t\tTexture %i -> Refs: %i, VRAM: %llu KB", tex->GetTextureID(), tex.use_count(), tex->GetGPUBytes() / 1024);
 
 	ENGINE_LOG("\n");
 }
@@ -68,21 +80,162 @@ void Resources::PrintResourcesReferences()
 void Resources::CleanUp()
 {
 	for (auto& mesh : m_Meshes)
-		mesh.second.reset();
+		mesh.reset();
 
-	for (uint i = 0; i < m_Textures.size(); ++i)
-		m_Textures[i].reset();
+	for (auto& texture : m_Textures)
+		texture.reset();
 
-	for (uint i = 0; i < m_Models.size(); ++i)
-		m_Models[i].reset();
+	for (auto& model : m_Models)
+		model.reset();
 
 	for (auto& mat : m_Materials)
-		mat.second.reset();
+		mat.reset();
 
-	m_Textures.clear();
-	m_Models.clear();
-	m_Meshes.clear();
-	m_Materials.clear();
+	m_Textures.Clear();
+	m_Models.Clear();
+	m_Meshes.Clear();
+	m_Materials.Clear();
+
+	m_TexturesRegistry.clear();
+	m_ModelsRegistry.clear();
+	m_ModelsContentRegistry.clear();
+}
+
+
+uint64 Resources::GetPathHash(const std::string& filepath, uint64 seed)
+{
+	// Same normalization than asset packs, so any relative path, absolute one or casing of a file gets the same hash
+	return HashUtils::HashString(AssetPack::NormalizePath(filepath), seed);
+}
+
+
+
+// ------------------------------------------------------------------------------
+// --- GPU Memory Budget ---
+uint64 Resources::m_GPUBudget = RendererUtils::s_GPUMemoryBudget;
+uint64 Resources::m_FrameCount = 0;
+uint Resources::m_EvictionsCount = 0;
+
+
+void Resources::Update()
+{
+	++m_FrameCount;
+
+	// -- Stamp Referenced Resources --
+	// Anything besides Resources holding them (materials, the scene, the renderer...) means they're in use
+	for (Ref<Texture>& texture : m_Textures)
+		if (texture.use_count() > 1)
+			texture->m_LastUsedFrame = m_FrameCount;
+
+	for (Ref<Model>& model : m_Models)
+		if (model.use_count() > 1)
+			model->m_LastUsedFrame = m_FrameCount;
+
+	if (GPUMemory::GetTotalBytes() <= m_GPUBudget)
+		return;
+
+	// -- Gather Unreferenced Resources --
+	// Only the reloadable ones (from a path) & not models copies (they share the meshes with the original)
+	struct EvictionCandidate { uint64 LastUsedFrame = 0; TextureHandle EvictedTexture = {}; ModelHandle EvictedModel = {}; };
+	std::vector<EvictionCandidate> candidates;
+
+	for (uint i = 0; i < m_Textures.Size(); ++i)
+	{
+		const Ref<Texture>& texture = m_Textures[i];
+		if (texture.use_count() == 1 && texture->m_Path != "unpathed")
+			candidates.push_back({ texture->m_LastUsedFrame, m_Textures.GetHandle(i), {} });
+	}
+
+	for (uint i = 0; i < m_Models.Size(); ++i)
+	{
+		const Ref<Model>& model = m_Models[i];
+		if (model.use_count() > 1 || model->m_Path == "unpathed" || !model->m_RootMesh)
+			continue;
+
+		auto shares_meshes = [&model](const Ref<Model>& other) { return other != model && other->m_RootMesh == model->m_RootMesh; };
+		if (std::none_of(m_Models.begin(), m_Models.end(), shares_meshes))
+			candidates.push_back({ model->m_LastUsedFrame, {}, m_Models.GetHandle(i) });
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const EvictionCandidate& a, const EvictionCandidate& b) { return a.LastUsedFrame < b.LastUsedFrame; });
+
+	// -- Evict Least Recently Used --
+	// Textures of evicted models' materials become unreferenced, so they can go in the next frames
+	for (const EvictionCandidate& candidate : candidates)
+	{
+		if (GPUMemory::GetTotalBytes() <= m_GPUBudget)
+			break;
+
+		if (!candidate.EvictedTexture.IsNull())
+			m_Textures.Remove(candidate.EvictedTexture);
+		else
+			EvictModel(candidate.EvictedModel);
+
+		++m_EvictionsCount;
+	}
+}
+
+
+uint64 Resources::GetMeshGPUBytes(const Mesh* mesh)
+{
+	// Instanced meshes share their vertex arrays (& meshlets), so each one is counted once
+	uint64 bytes = 0;
+	std::unordered_set<const VertexArray*> counted_arrays;
+	std::vector<const Mesh*> meshes_to_visit = { mesh };
+	while (!meshes_to_visit.empty())
+	{
+		const Mesh* visited_mesh = meshes_to_visit.back();
+		meshes_to_visit.pop_back();
+		if (!visited_mesh)
+			continue;
+
+		if (visited_mesh->m_VertexArray && counted_arrays.insert(visited_mesh->m_VertexArray.get()).second)
+			bytes += visited_mesh->m_VertexArray->GetGPUBytes() + (visited_mesh->m_MeshletsBuffer ? visited_mesh->m_MeshletsBuffer->GetGPUBytes() : 0);
+
+		for (const Ref<Mesh>& submesh : visited_mesh->m_Submeshes)
+			meshes_to_visit.push_back(submesh.get());
+	}
+
+	return bytes;
+}
+
+
+void Resources::EvictModel(ModelHandle model)
+{
+	// -- Gather Meshes & Materials --
+	std::vector<MeshHandle> meshes_ids;
+	std::vector<MaterialHandle> materials_ids;
+	std::vector<const Mesh*> meshes_to_visit = { (*m_Models.Get(model))->m_RootMesh };
+	while (!meshes_to_visit.empty())
+	{
+		const Mesh* mesh = meshes_to_visit.back();
+		meshes_to_visit.pop_back();
+
+		meshes_ids.push_back(mesh->m_ID);
+		materials_ids.push_back(mesh->m_Material);
+		for (const Ref<Mesh>& submesh : mesh->m_Submeshes)
+			meshes_to_visit.push_back(submesh.get());
+	}
+
+	// -- Delete Model & Meshes --
+	// Submeshes are held by their parents too, so they're gone once the whole hierarchy is erased
+	m_Models.Remove(model);
+	for (MeshHandle mesh_id : meshes_ids)
+		m_Meshes.Remove(mesh_id);
+
+	++m_MeshesVersion;
+
+	// -- Delete Materials Nobody Else Uses --
+	for (MaterialHandle material_id : materials_ids)
+	{
+		const Ref<Material>* material = m_Materials.Get(material_id);
+		if (!material || material->use_count() > 1)
+			continue;
+
+		auto uses_material = [material_id](const Ref<Mesh>& mesh) { return mesh->m_Material == material_id; };
+		if (std::none_of(m_Meshes.begin(), m_Meshes.end(), uses_material))
+			m_Materials.Remove(material_id);
+	}
 }
 
 
@@ -90,21 +243,36 @@ void Resources::CleanUp()
 
 // ------------------------------------------------------------------------------
 // --- Textures ---
-std::vector<Ref<Texture>> Resources::m_Textures = {};
+SlotMap<Texture> Resources::m_Textures = {};
+std::unordered_map<uint64, TextureHandle> Resources::m_TexturesRegistry = {};
 
 
-Ref<Texture> Resources::CreateTexture(const std::string& filepath)
+Ref<Texture> Resources::CreateTexture(const std::string& filepath, TEXTURE_USAGE usage)
 {
 	// --- Check if resource already exists ---
-	for (uint i = 0; i < m_Textures.size(); ++i)
+	// The same image with another usage is processed differently, so it's another texture
+	// Byte-identical images under other paths are found by the TextureLoader, which shares their GPU storage
+	uint64 path_hash = GetPathHash(filepath, (uint64)usage);
+	auto registered = m_TexturesRegistry.find(path_hash);
+	if (registered != m_TexturesRegistry.end())
 	{
-		if (m_Textures[i]->m_Path != "unpathed" && m_Textures[i]->m_Path == filepath)
-			return m_Textures[i];
+		if (Ref<Texture>* texture = m_Textures.Get(registered->second))
+		{
+			(*texture)->m_LastUsedFrame = m_FrameCount;
+			return *texture;
+		}
 	}
 
 	// --- Create Resource ---
-	Ref<Texture> texture = CreateRef<Texture>(new Texture(filepath));
-	m_Textures.push_back(texture);
+	// Loaded asynchronously, materials bind a default texture until it's resident (synchronously & uncompressed if the loader isn't running yet)
+	Ref<Texture> texture = TextureLoader::LoadAsync(filepath, usage);
+	if (texture == nullptr)
+	{
+		texture = CreateRef<Texture>(new Texture(filepath));
+		texture->m_Usage = usage;
+	}
+
+	m_TexturesRegistry[path_hash] = m_Textures.Insert(texture);
 	return texture;
 }
 
@@ -112,23 +280,29 @@ Ref<Texture> Resources::CreateTexture(const std::string& filepath)
 
 // ------------------------------------------------------------------------------
 // --- Models ---
-std::vector<Ref<Model>> Resources::m_Models = {};
+SlotMap<Model> Resources::m_Models = {};
+std::unordered_map<uint64, ModelHandle> Resources::m_ModelsRegistry = {};
+std::unordered_map<uint64, ModelHandle> Resources::m_ModelsContentRegistry = {};
 
 Ref<Model> Resources::CreateModel(const std::string& filepath, Mesh* root_mesh)
 {
 	// --- Check if resource already exists ---
-	for (uint i = 0; i < m_Models.size(); ++i)
-	{
-		if (m_Models[i]->m_Path != "unpathed" && m_Models[i]->m_Path == filepath)
-			return m_Models[i];
-	}
+	uint64 path_hash = GetPathHash(filepath);
+	if (Ref<Model> model = FindModel(path_hash))
+		return model;
+
+	// --- Check if its contents already exist ---
+	// A byte-identical file under another path becomes a copy sharing the meshes (imports are synchronous, so is hashing the file)
+	uint64 content_hash = GetContentHash(filepath);
+	if (Ref<Model> model = CreateContentCopy(filepath, path_hash, content_hash))
+		return model;
 
 	// --- Create Resource ---
 	Ref<Model> model = MeshImporter::LoadModel(filepath);
 	if (model == nullptr)
 		return nullptr;
 
-	m_Models.push_back(model);
+	RegisterModel(model, path_hash, content_hash);
 	return model;
 }
 
@@ -140,51 +314,192 @@ Ref<Model> Resources::CreateModel(const Ref<Model>& model, const std::string& ne
 		return nullptr;
 
 	model->m_Name = new_name;
-	m_Models.push_back(new_model);
+	m_Models.Insert(new_model);
 	return new_model;
 }
 
 
+// -- Models Batches --
+struct ModelsBatch
+{
+	struct Entry
+	{
+		std::string Filepath;
+		uint64 PathHash = 0, ContentHash = 0;
+		Ref<Model> LoadedModel = nullptr;				// Set if it was registered already (or once finished)
+		UniquePtr<PreparedModel> Prepared = nullptr;	// Filled by its job, if it had to be loaded
+	};
+
+	std::vector<Entry> Entries;	// Not resized once the jobs start
+	JobCounter Jobs;
+
+	~ModelsBatch() { JobSystem::Wait(Jobs); } // Never destroyed under its jobs
+};
+
+Ref<ModelsBatch> Resources::CreateModelsAsync(const std::vector<std::string>& filepaths)
+{
+	Ref<ModelsBatch> batch = CreateRef<ModelsBatch>();
+	batch->Entries.resize(filepaths.size());
+
+	for (uint i = 0; i < filepaths.size(); ++i)
+	{
+		ModelsBatch::Entry& entry = batch->Entries[i];
+		entry.Filepath = filepaths[i];
+		entry.PathHash = GetPathHash(filepaths[i]);
+		entry.LoadedModel = FindModel(entry.PathHash);
+
+		// Repeated paths are loaded once (the rest find it registered when finishing)
+		bool repeated = std::any_of(batch->Entries.begin(), batch->Entries.begin() + i, [&entry](const ModelsBatch::Entry& other) { return other.PathHash == entry.PathHash; });
+		if (entry.LoadedModel || repeated)
+			continue;
+
+		entry.Prepared = CreateUnique<PreparedModel>();
+		ModelsBatch::Entry* job_entry = &entry;
+		JobSystem::Run([job_entry]()
+			{
+				job_entry->ContentHash = GetContentHash(job_entry->Filepath);
+				if (!MeshImporter::PrepareModel(job_entry->Filepath, *job_entry->Prepared))
+					job_entry->Prepared.reset();
+			}, &batch->Jobs);
+	}
+
+	return batch;
+}
+
+std::vector<Ref<Model>> Resources::FinishModels(const Ref<ModelsBatch>& batch)
+{
+	JobSystem::Wait(batch->Jobs);
+
+	// -- Create & Register Models --
+	// In order, so content duplicates within the batch become copies of the first one
+	std::vector<Ref<Model>> models;
+	for (ModelsBatch::Entry& entry : batch->Entries)
+	{
+		if (!entry.LoadedModel)
+			entry.LoadedModel = FindModel(entry.PathHash);
+
+		if (!entry.LoadedModel && entry.Prepared)
+		{
+			entry.LoadedModel = CreateContentCopy(entry.Filepath, entry.PathHash, entry.ContentHash);
+			if (!entry.LoadedModel)
+			{
+				entry.LoadedModel = MeshImporter::FinalizeModel(*entry.Prepared);
+				if (entry.LoadedModel)
+					RegisterModel(entry.LoadedModel, entry.PathHash, entry.ContentHash);
+			}
+		}
+
+		// The prepared data (& mapped caches) isn't needed anymore
+		entry.Prepared.reset();
+		models.push_back(entry.LoadedModel);
+	}
+
+	return models;
+}
+
+
+
+// -- Models Registries --
+Ref<Model> Resources::FindModel(uint64 path_hash)
+{
+	auto registered = m_ModelsRegistry.find(path_hash);
+	if (registered == m_ModelsRegistry.end())
+		return nullptr;
+
+	Ref<Model>* model = m_Models.Get(registered->second);
+	if (!model)
+		return nullptr;
+
+	(*model)->m_LastUsedFrame = m_FrameCount;
+	return *model;
+}
+
+Ref<Model> Resources::CreateContentCopy(const std::string& filepath, uint64 path_hash, uint64 content_hash)
+{
+	auto content_registered = m_ModelsContentRegistry.find(content_hash);
+	if (content_hash == 0 || content_registered == m_ModelsContentRegistry.end())
+		return nullptr;
+
+	Ref<Model>* original = m_Models.Get(content_registered->second);
+	if (!original)
+		return nullptr;
+
+	Ref<Model> model = CreateRef<Model>(new Model(filepath, (*original)->m_RootMesh));
+	model->m_Bounds = (*original)->m_Bounds;
+	model->m_LastUsedFrame = m_FrameCount;
+
+	m_ModelsRegistry[path_hash] = m_Models.Insert(model);
+	return model;
+}
+
+void Resources::RegisterModel(const Ref<Model>& model, uint64 path_hash, uint64 content_hash)
+{
+	ModelHandle handle = m_Models.Insert(model);
+	m_ModelsRegistry[path_hash] = handle;
+	if (content_hash != 0)
+		m_ModelsContentRegistry[content_hash] = handle;
+}
+
+uint64 Resources::GetContentHash(const std::string& filepath)
+{
+	FileUtils::VirtualFile file(filepath);
+	return file.IsOpen() ? HashUtils::XXH64(file.GetData(), file.GetSize()) : 0;
+}
+
+
 
 // ------------------------------------------------------------------------------
 // --- Meshes & Materials ---
-std::unordered_map<int, Ref<Mesh>> Resources::m_Meshes = {};
-std::unordered_map<int, Ref<Material>> Resources::m_Materials = {};
+SlotMap<Mesh> Resources::m_Meshes = {};
+SlotMap<Material> Resources::m_Materials = {};
+uint64 Resources::m_MeshesVersion = 0;
 
-Ref<Mesh>* Resources::CreateMesh(const Ref<VertexArray>& vertex_array, uint material_index, Mesh* parent)
+Ref<Mesh> Resources::CreateMesh(const Ref<VertexArray>& vertex_array, MaterialHandle material, Mesh* parent)
 {
-	int id = m_Meshes.size();
-	Ref<Mesh> mesh = CreateRef<Mesh>(new Mesh(vertex_array, id, material_index, parent));
-	m_Meshes.insert({ id,  mesh });
-	return &m_Meshes[id];
+	Ref<Mesh> mesh = CreateRef<Mesh>(new Mesh(vertex_array, material, parent));
+	mesh->m_ID = m_Meshes.Insert(mesh);
+	++m_MeshesVersion;
+	return mesh;
 }
 
 
-const Ref<Material>* Resources::CreateMaterial(const std::string& name)
+Ref<Material> Resources::CreateMaterial(const std::string& name)
 {
-	int id = m_Materials.size(); // TODO: There should be some default materials (white, ...) which are indexes 0-4!!!
+	// TODO: There should be some default materials (white, ...)!!!
 	std::string mat_name = name;
 	if (name.find_last_of('.') != name.npos)
 		mat_name = name.substr((size_t)0, name.find_last_of('.'));
 
-	m_Materials.insert({ id, CreateRef<Material>(new Material(id, mat_name)) });
-	return &m_Materials[id];
+	Ref<Material> material = CreateRef<Material>(new Material(mat_name));
+	material->m_ID = m_Materials.Insert(material);
+	return material;
 }
 
 
-void Resources::DeleteAllMeshReferences(uint meshID_to_delete)
+uint Resources::BakeTextureAtlases()
 {
-	if (m_Meshes.find(meshID_to_delete) == m_Meshes.end())
+	std::vector<Ref<Material>> materials;
+	for (const Ref<Material>& material : m_Materials)
+		materials.push_back(material);
+
+	return TextureAtlas::BakeMaterials(materials);
+}
+
+
+void Resources::DeleteAllMeshReferences(MeshHandle mesh_to_delete)
+{
+	Ref<Mesh>* mesh = m_Meshes.Get(mesh_to_delete);
+	if (!mesh)
 		return;
 
 	// -- Delete from Parent --
-	Mesh* parent = m_Meshes[meshID_to_delete]->m_ParentMesh;
+	Mesh* parent = (*mesh)->m_ParentMesh;
 	if (parent)
 	{
 		std::vector<Ref<Mesh>>::iterator it = parent->m_Submeshes.begin();
 		for (; it != parent->m_Submeshes.end(); it++)
 		{
-			if ((*it)->GetID() == meshID_to_delete)
+			if ((*it)->GetID() == mesh_to_delete)
 			{
 				parent->m_Submeshes.erase(it);
 				break;
@@ -192,35 +507,36 @@ void Resources::DeleteAllMeshReferences(uint meshID_to_delete)
 		}
 	}
 
-	// -- Delete from Ref Ptrs List --
-	if (m_Meshes.find(meshID_to_delete) != m_Meshes.end())
-		m_Meshes.erase(meshID_to_delete);
-
-	// -- Delete All References --
+	// -- Delete All References & Erase from List --
 	// This will call mesh destructor, which calls mesh->DeleteMesh(), so all good :)
-	m_Meshes[meshID_to_delete].reset();
+	m_Meshes.Remove(mesh_to_delete);
+	++m_MeshesVersion;
 }
 
 
-void Resources::DeleteAllMaterialReferences(uint materialID_to_delete)
+void Resources::DeleteAllMaterialReferences(MaterialHandle material_to_delete)
 {
-	if (m_Materials.find(materialID_to_delete) == m_Materials.end())
+	if (!m_Materials.IsValid(material_to_delete))
 		return;
 
 	// -- Change the Material on all Meshes --
+	// Null ones render with the magenta material
 	for (auto& mesh : m_Meshes)
-		if(mesh.second->m_MaterialIndex == materialID_to_delete) // TODO: There should be some default materials (white, ...) which are indexes 0-4!!!
-			mesh.second->m_MaterialIndex = 0;
+		if(mesh->m_Material == material_to_delete)
+			mesh->m_Material = {};
 
 	// -- Delete All References & Erase from List --
-	// This will call mesh destructor, which calls mesh->DeleteMesh(), so all good :)
-	m_Materials[materialID_to_delete].reset();
-	m_Materials.erase(materialID_to_delete);
+	m_Materials.Remove(material_to_delete);
+	++m_MeshesVersion;
 }
 
 
-void Resources::SetMeshMaterial(uint meshID, uint materialID)
+void Resources::SetMeshMaterial(MeshHandle mesh, MaterialHandle material)
 {
-	if (m_Materials.find(materialID) != m_Materials.end())
-		m_Meshes[meshID]->m_MaterialIndex = materialID;
-}
\ No newline at end of file
+	Ref<Mesh>* mesh_ref = m_Meshes.Get(mesh);
+	if (mesh_ref && m_Materials.IsValid(material))
+	{
+		(*mesh_ref)->m_Material = material;
+		++m_MeshesVersion;
+	}
+}
@@ -2,6 +2,7 @@
 #define _RESOURCES_H_
 
 #include "Core/Globals.h"
+#include "Core/Utils/SlotMap.h"
 #include "Renderer/Resources/Buffers.h"
 #include "Renderer/Resources/Texture.h"
 #include "Renderer/Resources/Mesh.h"
@@ -11,9 +12,11 @@
 // that's what's CleanUp for, although not needed because smart ptrs clean
 // themselves, it is good practice since we can have lots of resources, so we make sure to free them in-app
 
+struct ModelsBatch;
 
 class Resources
 {
+	friend class Application;
 public:
 
 	enum class TexturesIndex { WHITE = 0, BLACK, MAGENTA, TESTNORMAL, TESTALBEDO, ALBEDO, SPECULAR, NORMAL, EMISSIVE, BUMP };
@@ -24,33 +27,82 @@ public:
 	static void CleanUp();
 
 	// --- Create Resources ---
-	static Ref<Texture> CreateTexture(const std::string& filepath);
+	static Ref<Texture> CreateTexture(const std::string& filepath, TEXTURE_USAGE usage = TEXTURE_USAGE::COLOR);
 	static Ref<Model> CreateModel(const std::string& filepath, Mesh* root_mesh = nullptr);
 	static Ref<Model> CreateModel(const Ref<Model>& model, const std::string& new_name);
+
+	// Batch load: the files are read & parsed (or their mesh caches paged in) concurrently on the jobs threads, starting now
+	// FinishModels() waits for them (helping with the jobs) & creates their GPU resources in one go, returning the models
+	// in the filepaths order (nullptr for the ones that failed)
+	static Ref<ModelsBatch> CreateModelsAsync(const std::vector<std::string>& filepaths);
+	static std::vector<Ref<Model>> FinishModels(const Ref<ModelsBatch>& batch);
 	
-	static Ref<Mesh>* CreateMesh(const Ref<VertexArray>& vertex_array, uint material_index = 0, Mesh* parent = nullptr);
-	const static Ref<Material>* CreateMaterial(const std::string& name = "unnamed");
+	static Ref<Mesh> CreateMesh(const Ref<VertexArray>& vertex_array, MaterialHandle material = {}, Mesh* parent = nullptr);
+	static Ref<Material> CreateMaterial(const std::string& name = "unnamed");
+
+	// Bakes the small albedos of the materials into shared atlases (see TextureAtlas), returns the atlases count
+	static uint BakeTextureAtlases();
 
 	// --- Unload Resources ---
-	static void DeleteAllMeshReferences(uint meshID_to_delete);
-	static void DeleteAllMaterialReferences(uint materialID_to_delete);
+	static void DeleteAllMeshReferences(MeshHandle mesh_to_delete);
+	static void DeleteAllMaterialReferences(MaterialHandle material_to_delete);
 
 	// --- Other Resources Stuff --
-	static void SetMeshMaterial(uint meshID, uint materialID);
+	static void SetMeshMaterial(MeshHandle mesh, MaterialHandle material);
 	static void PrintResourcesReferences();
 	static std::vector<std::string> GetResourcesReferences();
 
+	// --- GPU Memory Budget ---
+	// Past it, textures & models only referenced by Resources are evicted (least recently referenced first), creating them again reloads them
+	static void SetGPUBudget(uint64 budget_bytes)			{ m_GPUBudget = budget_bytes; }
+	static uint64 GetGPUBudget()							{ return m_GPUBudget; }
+	static uint GetEvictionsCount()							{ return m_EvictionsCount; }
+
+	// Changes whenever meshes are created, deleted or their material is changed, so flattened scenes know when to rebuild
+	static uint64 GetMeshesVersion()						{ return m_MeshesVersion; }
+
 	// --- Getters ---
-	static const Ref<Material> GetMaterial(uint index)		{ if (m_Materials.find(index) != m_Materials.end()) return m_Materials[index]; return nullptr; }
+	static Ref<Material> GetMaterial(MaterialHandle material)	{ Ref<Material>* ret = m_Materials.Get(material); return ret ? *ret : nullptr; }
+
+	// Non-owning, for the render loop (no refcount touched), nullptr if the material was deleted
+	static Material* GetMaterialPtr(MaterialHandle material)	{ Ref<Material>* ret = m_Materials.Get(material); return ret ? ret->get() : nullptr; }
+
+private:
+
+	// Once per frame: updates the resources usage & evicts them if over the GPU budget
+	static void Update();
+
+	static uint64 GetMeshGPUBytes(const Mesh* mesh); // Including its submeshes, shared vertex arrays counted once
+
+	// Of the normalized path, the key of the registries
+	static uint64 GetPathHash(const std::string& filepath, uint64 seed = 0);
+	static void EvictModel(ModelHandle model);
+
+	// --- Models Registries ---
+	static Ref<Model> FindModel(uint64 path_hash);
+	static Ref<Model> CreateContentCopy(const std::string& filepath, uint64 path_hash, uint64 content_hash); // nullptr if no model with those contents
+	static void RegisterModel(const Ref<Model>& model, uint64 path_hash, uint64 content_hash);
+	static uint64 GetContentHash(const std::string& filepath); // 0 if it can't be read
 
 private:
 
 	// --- Resources ---
-	static std::vector<Ref<Texture>> m_Textures;
-	static std::vector<Ref<Model>> m_Models;
+	// Slot maps: packed arrays looked up by generational handles (stale once the resource is removed)
+	static SlotMap<Texture> m_Textures;
+	static SlotMap<Model> m_Models;
+	static SlotMap<Mesh> m_Meshes;
+	static SlotMap<Material> m_Materials;
+	static uint64 m_MeshesVersion;
+
+	// Registries to find resources in O(1), without holding them (handles go stale if evicted)
+	static std::unordered_map<uint64, TextureHandle> m_TexturesRegistry;		// By path hash & usage
+	static std::unordered_map<uint64, ModelHandle> m_ModelsRegistry;			// By path hash
+	static std::unordered_map<uint64, ModelHandle> m_ModelsContentRegistry;	// By file contents hash
 
-	static std::unordered_map<int, Ref<Mesh>> m_Meshes;
-	static std::unordered_map<int, Ref<Material>> m_Materials;
+	// --- GPU Memory Budget ---
+	static uint64 m_GPUBudget;
+	static uint64 m_FrameCount;
+	static uint m_EvictionsCount;
 };
 
 #endif //_RESOURCES_H_
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "ShaderCache.h"
+
+#include "Core/Utils/FileStringUtils.h"
+#include "Core/Utils/Hash.h"
+
+#include <algorithm>
+#include <filesystem>
+
+
+// ------------------------------------------------------------------------------
+// --- File Layout ---
+// [Header][Program Binary]
+namespace
+{
+	static const uint s_CacheMagic = 0x53504741; // "AGPS"
+
+	struct CacheHeader
+	{
+		uint Magic, Version;
+		uint64 SourcesHash;
+		uint BinaryFormat, BinarySize;
+	};
+
+	static_assert(sizeof(CacheHeader) == 24, "ShaderCache header must be tightly packed");
+}
+
+
+
+// ------------------------------------------------------------------------------
+uint64 ShaderCache::GetSourcesHash(const std::unordered_map<GLenum, std::string>& sources)
+{
+	// -- Driver --
+	// Binaries are only valid for the same driver, so its strings go in the key
+	static const uint64 driver_hash = [] {
+		std::string driver = std::string((const char*)glGetString(GL_VENDOR)) + "|" + std::string((const char*)glGetString(GL_RENDERER)) + "|"
+			+ std::string((const char*)glGetString(GL_VERSION));
+		return HashUtils::HashString(driver, s_Version);
+	}();
+
+	// -- Sources --
+	// In stages order, as the map order isn't
+	std::vector<GLenum> stages;
+	for (const auto& [stage, source] : sources)
+		stages.push_back(stage);
+
+	std::sort(stages.begin(), stages.end());
+	uint64 hash = driver_hash;
+	for (GLenum stage : stages)
+	{
+		hash = HashUtils::XXH64(&stage, sizeof(GLenum), hash);
+		hash = HashUtils::HashString(sources.at(stage), hash);
+	}
+
+	return hash;
+}
+
+std::string ShaderCache::GetCacheFilepath(const std::string& name)
+{
+	std::string normalized_name = std::filesystem::path(name).lexically_normal().generic_string();
+	std::string filename = std::filesystem::path(name).stem().string() + "_" + HashUtils::HashToString(HashUtils::HashString(normalized_name)) + ".agpshader";
+	return FileUtils::MakePath(s_CacheDirectory, filename);
+}
+
+
+
+// ------------------------------------------------------------------------------
+uint ShaderCache::LoadProgram(const std::string& name, uint64 sources_hash)
+{
+	// -- Open Cache File --
+	FileUtils::VirtualFile cache(GetCacheFilepath(name));
+	if (!cache.IsOpen() || cache.GetSize() < sizeof(CacheHeader))
+		return 0;
+
+	// -- Check Header --
+	const CacheHeader* header = (const CacheHeader*)cache.GetData();
+	if (header->Magic != s_CacheMagic || header->Version != s_Version || header->SourcesHash != sources_hash)
+		return 0;
+
+	if (header->BinarySize == 0 || sizeof(CacheHeader) + (uint64)header->BinarySize > cache.GetSize())
+	{
+		ENGINE_LOG("Shader Cache for '%s' is corrupted, compiling it", name.c_str());
+		return 0;
+	}
+
+	// -- Create Program --
+	// Drivers reject binaries of other versions (updates not always changing the version string), failing the link
+	GLuint program = glCreateProgram();
+	glProgramBinary(program, header->BinaryFormat, cache.GetData() + sizeof(CacheHeader), (GLsizei)header->BinarySize);
+
+	GLint is_linked = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &is_linked);
+	if (is_linked == GL_FALSE)
+	{
+		ENGINE_LOG("Shader Cache for '%s' was rejected by the driver, compiling it", name.c_str());
+		glDeleteProgram(program);
+		return 0;
+	}
+
+	return program;
+}
+
+
+bool ShaderCache::SaveProgram(const std::string& name, uint64 sources_hash, uint program)
+{
+	// -- Retrieve Binary --
+	GLint binary_length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binary_length);
+	if (binary_length <= 0)
+		return false;
+
+	std::vector<uint8_t> binary(binary_length);
+	GLenum binary_format = 0;
+	glGetProgramBinary(program, binary_length, &binary_length, &binary_format, binary.data());
+	if (binary_length <= 0)
+		return false;
+
+	CacheHeader header = {};
+	header.Magic = s_CacheMagic;
+	header.Version = s_Version;
+	header.SourcesHash = sources_hash;
+	header.BinaryFormat = binary_format;
+	header.BinarySize = (uint)binary_length;
+
+	// -- Write File --
+	std::string cache_filepath = GetCacheFilepath(name);
+	if (!FileUtils::WriteFileAtomic(cache_filepath, { { &header, sizeof(CacheHeader) }, { binary.data(), (size_t)header.BinarySize } }))
+	{
+		ENGINE_LOG("Couldn't write Shader Cache file at path '%s'", cache_filepath.c_str());
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,28 @@
+#ifndef _SHADERCACHE_H_
+#define _SHADERCACHE_H_
+
+#include "Core/Globals.h"
+#include <glad/glad.h>
+
+
+// Binary cache (.agpshader) of linked shader programs (glGetProgramBinary), so a warm start skips compiling & linking their GLSL
+// Keyed by the preprocessed sources & the GL vendor, renderer & version, the driver can still reject a binary (then it's compiled again)
+class ShaderCache
+{
+public:
+
+	static constexpr const char* s_CacheDirectory = "Resources/Cache/Shaders";
+	static const uint s_Version = 1; // Bump on any format change
+
+	// Creates the program from its cached binary, returns 0 if there's no valid cache for the sources or the driver rejected it
+	static uint LoadProgram(const std::string& name, uint64 sources_hash);
+
+	// Of a program linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT, returns false if it couldn't be retrieved or written
+	static bool SaveProgram(const std::string& name, uint64 sources_hash, uint program);
+
+	// Hash of the sources (in stages order), the cache version & the driver strings (the ones in RendererStatistics)
+	static uint64 GetSourcesHash(const std::unordered_map<GLenum, std::string>& sources);
+	static std::string GetCacheFilepath(const std::string& name);
+};
+
+#endif //_SHADERCACHE_H_
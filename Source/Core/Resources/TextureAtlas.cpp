@@ -0,0 +1,238 @@
+#include "TextureAtlas.h"
+#include "Resources.h"
+
+#include "Core/Utils/FileStringUtils.h"
+#include "Core/Utils/Hash.h"
+#include "Core/Utils/JobSystem.h"
+#include "Core/Utils/Timer.h"
+
+#include <stb_image.h>
+#include <stb_image_write.h>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <unordered_map>
+
+
+// ------------------------------------------------------------------------------
+namespace
+{
+	static const uint s_NotBaked = ~0u;
+
+	// A source texture & its cell in an atlas, in the atlas image rows (top to bottom, the loaded textures are flipped)
+	struct AtlasSource
+	{
+		std::string Path;
+		uint64 Hash = 0;						// Of the file contents
+		uint Width = 0, Height = 0;
+		uint CellWidth = 0, CellHeight = 0;		// With the guard border, aligned to the padding
+		uint X = 0, Y = 0;
+		uint Atlas = s_NotBaked;
+	};
+
+	inline uint AlignToPadding(uint value)
+	{
+		return (value + TextureAtlas::s_Padding - 1) / TextureAtlas::s_Padding * TextureAtlas::s_Padding;
+	}
+
+
+	// Shelf packing of the sources [first, ...) of order (sorted by height) into a size x size atlas, returns how many fit
+	uint PackShelves(std::vector<AtlasSource>& sources, const std::vector<uint>& order, uint first, uint size)
+	{
+		uint x = 0, y = 0, shelf_height = 0, i = first;
+		for (; i < (uint)order.size(); ++i)
+		{
+			AtlasSource& source = sources[order[i]];
+			if (x + source.CellWidth > size)
+			{
+				x = 0;
+				y += shelf_height;
+				shelf_height = 0;
+			}
+
+			if (source.CellWidth > size || y + source.CellHeight > size)
+				break;
+
+			source.X = x; source.Y = y;
+			x += source.CellWidth;
+			shelf_height = std::max(shelf_height, source.CellHeight);
+		}
+
+		return i - first;
+	}
+
+
+	// Decodes the source into its cell (RGBA), the guard border replicating its edge texels
+	bool ComposeSource(const AtlasSource& source, uint8_t* atlas, uint atlas_size)
+	{
+		FileUtils::VirtualFile file(source.Path);
+		if (!file.IsOpen())
+			return false;
+
+		int width, height, channels;
+		stbi_set_flip_vertically_on_load_thread(0);
+		stbi_uc* pixels = stbi_load_from_memory(file.GetData(), (int)file.GetSize(), &width, &height, &channels, 4);
+		if (!pixels || (uint)width != source.Width || (uint)height != source.Height)
+		{
+			stbi_image_free(pixels);
+			return false;
+		}
+
+		const int padding = (int)TextureAtlas::s_Padding;
+		for (uint cy = 0; cy < source.CellHeight; ++cy)
+		{
+			const int sy = std::clamp((int)cy - padding, 0, height - 1);
+			uint8_t* row = atlas + ((size_t)(source.Y + cy) * atlas_size + source.X) * 4;
+			for (uint cx = 0; cx < source.CellWidth; ++cx)
+			{
+				const int sx = std::clamp((int)cx - padding, 0, width - 1);
+				memcpy(row + (size_t)cx * 4, pixels + ((size_t)sy * width + sx) * 4, 4);
+			}
+		}
+
+		stbi_image_free(pixels);
+		return true;
+	}
+}
+
+
+
+// ------------------------------------------------------------------------------
+uint TextureAtlas::BakeMaterials(const std::vector<Ref<Material>>& materials)
+{
+	Timer timer;
+	timer.Start();
+
+	// -- Eligible Materials & Sources --
+	// Sources by path (materials sharing a texture share its cell), the ones that can't be baked are kept as not baked
+	std::vector<AtlasSource> sources;
+	std::unordered_map<std::string, uint> sources_index;
+	std::vector<std::pair<Material*, uint>> materials_sources;
+	for (const Ref<Material>& material : materials)
+	{
+		if (!material || !material->Albedo || material->Normal || material->Bump || material->Albedo->GetUsage() != TEXTURE_USAGE::COLOR
+			|| material->AlbedoUVTransform != glm::vec4(1.0f, 1.0f, 0.0f, 0.0f))
+			continue;
+
+		const std::string& path = material->Albedo->GetPath();
+		auto it = sources_index.find(path);
+		if (it == sources_index.end())
+		{
+			FileUtils::VirtualFile file(path);
+			int width = 0, height = 0, channels = 0;
+			bool eligible = file.IsOpen() && stbi_info_from_memory(file.GetData(), (int)file.GetSize(), &width, &height, &channels)
+				&& (uint)width <= s_MaxSourceSize && (uint)height <= s_MaxSourceSize;
+
+			it = sources_index.emplace(path, eligible ? (uint)sources.size() : s_NotBaked).first;
+			if (eligible)
+			{
+				AtlasSource source;
+				source.Path = path;
+				source.Hash = HashUtils::XXH64(file.GetData(), file.GetSize());
+				source.Width = (uint)width; source.Height = (uint)height;
+				source.CellWidth = AlignToPadding(source.Width + 2 * s_Padding);
+				source.CellHeight = AlignToPadding(source.Height + 2 * s_Padding);
+				sources.push_back(source);
+			}
+		}
+
+		if (it->second != s_NotBaked)
+			materials_sources.push_back({ material.get(), it->second });
+	}
+
+	if (sources.size() < 2)
+		return 0;
+
+	// -- Pack --
+	// Tallest first, each atlas the smallest power of two fitting the remaining sources (or as many as fit in the biggest)
+	std::vector<uint> order(sources.size());
+	for (uint i = 0; i < (uint)order.size(); ++i)
+		order[i] = i;
+
+	std::stable_sort(order.begin(), order.end(), [&sources](uint a, uint b) { return sources[a].CellHeight > sources[b].CellHeight; });
+
+	struct AtlasLayout { uint First = 0, Count = 0, Size = 0; };
+	std::vector<AtlasLayout> atlases;
+	for (uint first = 0; first < (uint)order.size();)
+	{
+		const uint remaining = (uint)order.size() - first;
+		uint size = s_MinAtlasSize;
+		while (size < s_MaxAtlasSize && PackShelves(sources, order, first, size) < remaining)
+			size *= 2;
+
+		uint count = PackShelves(sources, order, first, size);
+		ASSERT(count > 0, "Texture Atlas: a source doesn't fit in an empty atlas");
+
+		// An atlas of a single texture would just be a padded copy of it
+		if (count > 1)
+			atlases.push_back({ first, count, size });
+
+		first += count;
+	}
+
+	// -- Compose & Load Atlases --
+	uint baked_atlases = 0;
+	for (uint a = 0; a < (uint)atlases.size(); ++a)
+	{
+		const AtlasLayout& layout = atlases[a];
+
+		// Named by its sources contents & cells
+		uint64 key = HashUtils::XXH64(&layout.Size, sizeof(uint), s_Version);
+		for (uint i = layout.First; i < layout.First + layout.Count; ++i)
+		{
+			const AtlasSource& source = sources[order[i]];
+			const uint64 cell[] = { source.Hash, source.X, source.Y, source.Width, source.Height };
+			key = HashUtils::XXH64(cell, sizeof(cell), key);
+		}
+
+		std::error_code error;
+		std::string atlas_path = (std::filesystem::path(s_AtlasDirectory) / (HashUtils::HashToString(key) + ".png")).generic_string();
+		if (!std::filesystem::exists(atlas_path, error))
+		{
+			// Sources decoded into their cells across the jobs threads, the rest (unused) left transparent black
+			std::vector<uint8_t> atlas((size_t)layout.Size * layout.Size * 4, 0);
+			std::atomic<bool> failed = false;
+			JobSystem::ParallelFor(layout.Count, JobSystem::GetBatchSize(layout.Count), [&](uint first, uint count)
+				{
+					for (uint i = first; i < first + count; ++i)
+						if (!ComposeSource(sources[order[layout.First + i]], atlas.data(), layout.Size))
+							failed = true;
+				});
+
+			// Encoded in memory, then written as the caches
+			std::vector<uint8_t> png;
+			auto write_png = [](void* context, void* data, int size) { std::vector<uint8_t>& png = *(std::vector<uint8_t>*)context; png.insert(png.end(), (uint8_t*)data, (uint8_t*)data + size); };
+			if (failed || !stbi_write_png_to_func(write_png, &png, (int)layout.Size, (int)layout.Size, 4, atlas.data(), (int)layout.Size * 4)
+				|| !FileUtils::WriteFileAtomic(atlas_path, { { png.data(), png.size() } }))
+			{
+				ENGINE_LOG("Texture Atlas: couldn't compose or write the atlas '%s'", atlas_path.c_str());
+				continue;
+			}
+		}
+
+		for (uint i = layout.First; i < layout.First + layout.Count; ++i)
+			sources[order[i]].Atlas = a;
+
+		// -- Remap Materials --
+		// The atlas loads flipped as any texture, so the cells rows are counted from its bottom
+		Ref<Texture> atlas_texture = Resources::CreateTexture(atlas_path);
+		const float size = (float)layout.Size;
+		for (const std::pair<Material*, uint>& material_source : materials_sources)
+		{
+			const AtlasSource& source = sources[material_source.second];
+			if (source.Atlas != a)
+				continue;
+
+			material_source.first->Albedo = atlas_texture;
+			material_source.first->AlbedoUVTransform = glm::vec4((float)source.Width / size, (float)source.Height / size,
+				(float)(source.X + s_Padding) / size, (float)(layout.Size - source.Y - s_Padding - source.Height) / size);
+		}
+
+		++baked_atlases;
+	}
+
+	ENGINE_LOG("Texture Atlas: %u textures baked into %u atlases in %.2f ms", (uint)std::count_if(sources.begin(), sources.end(), [](const AtlasSource& source) { return source.Atlas != s_NotBaked; }),
+		baked_atlases, timer.GetMilliseconds());
+
+	return baked_atlases;
+}
@@ -0,0 +1,27 @@
+#ifndef _TEXTUREATLAS_H_
+#define _TEXTUREATLAS_H_
+
+#include "Core/Globals.h"
+#include "Renderer/Resources/Material.h"
+
+
+// Offline bake of small color textures into shared atlases (images in the cache directory, loaded as any other texture), so the materials
+// using them bind the same texture. Each texture gets a guard border replicating its edges (as its clamp to edge sampling) & its cell is
+// aligned to the border size, so the mips up to log2(s_Padding) & the compressed blocks never mix neighbours. Materials get their placement
+// as the albedo UV transform. Only materials with just an albedo are baked: normal & bump maps share its UVs, they'd need the same layout
+class TextureAtlas
+{
+public:
+
+	static constexpr const char* s_AtlasDirectory = "Resources/Cache/Atlases";
+	static const uint s_Version = 1;			// Bump on any layout change
+	static const uint s_MaxSourceSize = 1024;	// In either dimension, bigger textures keep their own
+	static const uint s_MinAtlasSize = 256, s_MaxAtlasSize = 4096;
+	static const uint s_Padding = 16;			// Guard border & cells alignment, in texels
+
+	// Bakes the albedos of the eligible materials (not baked yet) & replaces them by the atlases, returns the atlases count
+	// Atlases are named by the hash of their sources & layout, so they're only composed & written the first time
+	static uint BakeMaterials(const std::vector<Ref<Material>>& materials);
+};
+
+#endif //_TEXTUREATLAS_H_
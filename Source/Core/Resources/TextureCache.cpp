@@ -0,0 +1,138 @@
+#include "TextureCache.h"
+
+#include "Core/Utils/FileStringUtils.h"
+#include "Core/Utils/Hash.h"
+
+#include <filesystem>
+
+
+// ------------------------------------------------------------------------------
+// --- File Layout ---
+// [Header][Levels][Data (16b aligned)]
+namespace
+{
+	static const uint s_CacheMagic = 0x54504741; // "AGPT"
+
+	struct CacheHeader
+	{
+		uint Magic, Version, Usage, InternalFormat;
+		uint64 SourceHash;
+		uint DataFormat, LevelsCount;
+		uint64 DataOffset, DataSize;
+	};
+
+	struct CachedLevel
+	{
+		uint Width, Height;
+		uint64 Offset, Size; // In bytes, relative to the data blob
+	};
+
+	static_assert(sizeof(CacheHeader) == 48 && sizeof(CachedLevel) == 24, "TextureCache structs must be tightly packed");
+
+	inline uint64 AlignTo16(uint64 offset) { return (offset + 15) & ~(uint64)15; }
+}
+
+
+
+// ------------------------------------------------------------------------------
+uint64 TextureCache::GetSourceHash(const uint8_t* source_data, uint64 source_size, TEXTURE_USAGE usage)
+{
+	uint64 seed = ((uint64)s_Version << 32) | (uint64)usage;
+	return HashUtils::XXH64(source_data, source_size, seed);
+}
+
+std::string TextureCache::GetCacheFilepath(const std::string& filepath, TEXTURE_USAGE usage)
+{
+	std::string normalized_path = std::filesystem::path(filepath).lexically_normal().generic_string();
+	std::string filename = std::filesystem::path(filepath).stem().string() + "_" + HashUtils::HashToString(HashUtils::HashString(normalized_path))
+		+ "_" + std::to_string((int)usage) + ".agptex";
+
+	return FileUtils::MakePath(s_CacheDirectory, filename);
+}
+
+
+
+// ------------------------------------------------------------------------------
+bool TextureCache::LoadTexture(const std::string& filepath, TEXTURE_USAGE usage, uint64 source_hash, TextureData& texture_data)
+{
+	// -- Open Cache File --
+	Ref<FileUtils::VirtualFile> cache = CreateRef<FileUtils::VirtualFile>(GetCacheFilepath(filepath, usage));
+	if (!cache->IsOpen() || cache->GetSize() < sizeof(CacheHeader))
+		return false;
+
+	// -- Check Header --
+	const uint8_t* data = cache->GetData();
+	const uint64 size = cache->GetSize();
+	const CacheHeader* header = (const CacheHeader*)data;
+
+	if (header->Magic != s_CacheMagic || header->Version != s_Version || header->Usage != (uint)usage || header->SourceHash != source_hash)
+		return false;
+
+	const CachedLevel* levels = (const CachedLevel*)(data + sizeof(CacheHeader));
+	if (header->LevelsCount == 0 || sizeof(CacheHeader) + (uint64)header->LevelsCount * sizeof(CachedLevel) > size || header->DataOffset + header->DataSize > size)
+	{
+		ENGINE_LOG("Texture Cache for '%s' is corrupted, reprocessing it", filepath.c_str());
+		return false;
+	}
+
+	for (uint i = 0; i < header->LevelsCount; ++i)
+	{
+		if (levels[i].Offset + levels[i].Size > header->DataSize || levels[i].Width == 0 || levels[i].Height == 0)
+		{
+			ENGINE_LOG("Texture Cache for '%s' is corrupted, reprocessing it", filepath.c_str());
+			return false;
+		}
+	}
+
+	// -- Set Levels --
+	// Data is read from the file when each level is uploaded
+	texture_data.InternalFormat = header->InternalFormat;
+	texture_data.DataFormat = header->DataFormat;
+	texture_data.Levels.resize(header->LevelsCount);
+	for (uint i = 0; i < header->LevelsCount; ++i)
+		texture_data.Levels[i] = { levels[i].Width, levels[i].Height, levels[i].Offset, levels[i].Size };
+
+	texture_data.Data.clear();
+	texture_data.File = cache;
+	texture_data.FileDataOffset = header->DataOffset;
+	return true;
+}
+
+
+bool TextureCache::SaveTexture(const std::string& filepath, TEXTURE_USAGE usage, uint64 source_hash, const TextureData& texture_data)
+{
+	// -- Build Tables --
+	std::vector<CachedLevel> levels;
+	for (const TextureMipLevel& level : texture_data.Levels)
+		levels.push_back({ level.Width, level.Height, level.Offset, level.Size });
+
+	CacheHeader header = {};
+	header.Magic = s_CacheMagic;
+	header.Version = s_Version;
+	header.Usage = (uint)usage;
+	header.InternalFormat = texture_data.InternalFormat;
+	header.SourceHash = source_hash;
+	header.DataFormat = texture_data.DataFormat;
+	header.LevelsCount = levels.size();
+	header.DataOffset = AlignTo16(sizeof(CacheHeader) + levels.size() * sizeof(CachedLevel));
+	header.DataSize = texture_data.Data.size();
+
+	// -- Write File --
+	const char padding[16] = {};
+	std::vector<FileUtils::FileChunk> chunks =
+	{
+		{ &header, sizeof(CacheHeader) },
+		{ levels.data(), levels.size() * sizeof(CachedLevel) },
+		{ padding, (size_t)(header.DataOffset - (sizeof(CacheHeader) + levels.size() * sizeof(CachedLevel))) },
+		{ texture_data.Data.data(), texture_data.Data.size() }
+	};
+
+	std::string cache_filepath = GetCacheFilepath(filepath, usage);
+	if (!FileUtils::WriteFileAtomic(cache_filepath, chunks))
+	{
+		ENGINE_LOG("Couldn't write Texture Cache file at path '%s'", cache_filepath.c_str());
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,52 @@
+#ifndef _TEXTURECACHE_H_
+#define _TEXTURECACHE_H_
+
+#include "Core/Globals.h"
+#include "Core/Utils/FileStringUtils.h"
+#include "Renderer/Resources/Texture.h"
+
+
+// CPU-side texture ready to upload: the whole mip chain (compressed blocks or raw pixels) in a single buffer
+struct TextureMipLevel
+{
+	uint Width = 0, Height = 0;
+	uint64 Offset = 0, Size = 0; // In bytes, within TextureData::Data
+};
+
+struct TextureData
+{
+	GLenum InternalFormat = 0;
+	GLenum DataFormat = 0; // 0 if compressed
+	std::vector<TextureMipLevel> Levels;
+
+	// Levels data is either owned or read straight from the mapped cache file (so streamed textures don't keep every level in memory)
+	std::vector<uint8_t> Data;
+	Ref<FileUtils::VirtualFile> File = nullptr;
+	uint64 FileDataOffset = 0;
+
+	bool IsCompressed() const { return DataFormat == 0; }
+	const uint8_t* GetLevelData(uint level) const { return (File ? File->GetData() + FileDataOffset : Data.data()) + Levels[level].Offset; }
+};
+
+
+
+// Binary cache (.agptex) of processed textures: compressed (or raw) mip chains ready to upload, so a warm start skips decoding & compressing
+// Keyed by the source file hash & its usage, since the same image is processed differently as color, normal or height
+class TextureCache
+{
+public:
+
+	static constexpr const char* s_CacheDirectory = "Resources/Cache/Textures";
+	static const uint s_Version = 2; // Bump on any format or processing change
+
+	// Used by the TextureLoader workers (thread-safe as long as they don't process the same texture)
+	// Returns false if there's no valid cache for the source (missing, outdated, other usage or version), the cache file is kept mapped in texture_data
+	static bool LoadTexture(const std::string& filepath, TEXTURE_USAGE usage, uint64 source_hash, TextureData& texture_data);
+	static bool SaveTexture(const std::string& filepath, TEXTURE_USAGE usage, uint64 source_hash, const TextureData& texture_data);
+
+	// Hash of the source file contents, version & usage
+	static uint64 GetSourceHash(const uint8_t* source_data, uint64 source_size, TEXTURE_USAGE usage);
+	static std::string GetCacheFilepath(const std::string& filepath, TEXTURE_USAGE usage);
+};
+
+#endif //_TEXTURECACHE_H_
@@ -0,0 +1,177 @@
+#include "Compression.h"
+
+
+// ------------------------------------------------------------------------------
+namespace
+{
+	static const size_t s_MinMatch = 4;
+	static const size_t s_LastLiterals = 5;		// Last bytes of a block are always literals
+	static const size_t s_MatchFindLimit = 12;	// Last match must start at least this before the end
+	static const size_t s_MaxOffset = 65535;
+	static const uint s_HashLog = 16;
+
+	inline uint Read32(const uint8_t* ptr)		{ uint ret; memcpy(&ret, ptr, sizeof(uint)); return ret; }
+	inline uint HashSequence(uint sequence)		{ return (sequence * 2654435761U) >> (32 - s_HashLog); }
+
+	// Lengths >= 15 are continued in extra bytes of 255 until the last one (< 255)
+	inline uint8_t* WriteLength(uint8_t* op, size_t length)
+	{
+		for (length -= 15; length >= 255; length -= 255)
+			*op++ = 255;
+
+		*op++ = (uint8_t)length;
+		return op;
+	}
+
+	inline bool ReadLength(const uint8_t*& ip, const uint8_t* iend, size_t& length)
+	{
+		uint8_t byte = 0;
+		do
+		{
+			if (ip >= iend)
+				return false;
+
+			byte = *ip++;
+			length += byte;
+		} while (byte == 255);
+
+		return true;
+	}
+}
+
+
+
+// ------------------------------------------------------------------------------
+size_t CompressionUtils::LZ4Compress(const uint8_t* src, size_t src_size, uint8_t* dst, size_t dst_capacity)
+{
+	const uint8_t* ip = src, *anchor = src;
+	const uint8_t* iend = src + src_size;
+	uint8_t* op = dst, *oend = dst + dst_capacity;
+
+	// -- Find & Write Matches --
+	if (src_size > s_MatchFindLimit)
+	{
+		std::vector<uint> hash_table((size_t)1 << s_HashLog, 0);
+		const uint8_t* match_limit = iend - s_MatchFindLimit;
+		const uint8_t* match_end_limit = iend - s_LastLiterals;
+		uint misses = 0;
+
+		while (ip < match_limit)
+		{
+			// Search a previous occurrence of the next 4 bytes
+			uint hash = HashSequence(Read32(ip));
+			const uint8_t* match = src + hash_table[hash];
+			hash_table[hash] = (uint)(ip - src);
+
+			if (match >= ip || (size_t)(ip - match) > s_MaxOffset || Read32(match) != Read32(ip))
+			{
+				ip += 1 + (misses++ >> 6); // Skip faster on incompressible data
+				continue;
+			}
+
+			// Extend the match backwards (into pending literals) & forwards
+			while (ip > anchor && match > src && ip[-1] == match[-1])
+			{
+				--ip;
+				--match;
+			}
+
+			const uint8_t* match_end = ip + s_MinMatch;
+			for (const uint8_t* ref = match + s_MinMatch; match_end < match_end_limit && *match_end == *ref; ++ref)
+				++match_end;
+
+			// Write sequence: token, literals length, literals, offset, match length
+			size_t literals = ip - anchor, match_length = match_end - ip - s_MinMatch;
+			if ((size_t)(oend - op) < 1 + literals / 255 + 1 + literals + 2 + match_length / 255 + 1)
+				return 0;
+
+			uint8_t* token = op++;
+			*token = (uint8_t)((literals >= 15 ? 15 : literals) << 4);
+			if (literals >= 15)
+				op = WriteLength(op, literals);
+
+			memcpy(op, anchor, literals);
+			op += literals;
+
+			uint16_t offset = (uint16_t)(ip - match);
+			*op++ = (uint8_t)(offset & 0xFF);
+			*op++ = (uint8_t)(offset >> 8);
+
+			*token |= (uint8_t)(match_length >= 15 ? 15 : match_length);
+			if (match_length >= 15)
+				op = WriteLength(op, match_length);
+
+			ip = anchor = match_end;
+			misses = 0;
+		}
+	}
+
+	// -- Write Last Literals --
+	size_t literals = iend - anchor;
+	if ((size_t)(oend - op) < 1 + literals / 255 + 1 + literals)
+		return 0;
+
+	*op++ = (uint8_t)((literals >= 15 ? 15 : literals) << 4);
+	if (literals >= 15)
+		op = WriteLength(op, literals);
+
+	memcpy(op, anchor, literals);
+	op += literals;
+	return op - dst;
+}
+
+
+bool CompressionUtils::LZ4Decompress(const uint8_t* src, size_t src_size, uint8_t* dst, size_t dst_size)
+{
+	const uint8_t* ip = src, *iend = src + src_size;
+	uint8_t* op = dst, *oend = dst + dst_size;
+
+	while (ip < iend)
+	{
+		// -- Literals --
+		uint8_t token = *ip++;
+		size_t literals = token >> 4;
+		if (literals == 15 && !ReadLength(ip, iend, literals))
+			return false;
+
+		if (literals > (size_t)(iend - ip) || literals > (size_t)(oend - op))
+			return false;
+
+		memcpy(op, ip, literals);
+		ip += literals;
+		op += literals;
+
+		// Last sequence has only literals
+		if (ip == iend)
+			break;
+
+		// -- Match --
+		if (iend - ip < 2)
+			return false;
+
+		size_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > (size_t)(op - dst))
+			return false;
+
+		size_t match_length = token & 15;
+		if (match_length == 15 && !ReadLength(ip, iend, match_length))
+			return false;
+
+		match_length += s_MinMatch;
+		if (match_length > (size_t)(oend - op))
+			return false;
+
+		// Matches can overlap the output they are writing (e.g. runs of a single byte)
+		const uint8_t* match = op - offset;
+		if (offset >= match_length)
+			memcpy(op, match, match_length);
+		else
+			for (size_t i = 0; i < match_length; ++i)
+				op[i] = match[i];
+
+		op += match_length;
+	}
+
+	return op == oend;
+}
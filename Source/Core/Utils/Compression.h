@@ -0,0 +1,19 @@
+#ifndef _COMPRESSION_H_
+#define _COMPRESSION_H_
+
+#include "../Globals.h"
+
+// LZ4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md), fast to decompress, used for packed & cached assets
+namespace CompressionUtils
+{
+	// Worst case size of LZ4-compressing src_size bytes
+	inline size_t LZ4CompressBound(size_t src_size) { return src_size + src_size / 255 + 16; }
+
+	// Returns the compressed size, 0 if it didn't fit in dst_capacity
+	size_t LZ4Compress(const uint8_t* src, size_t src_size, uint8_t* dst, size_t dst_capacity);
+
+	// Returns false if src is malformed or doesn't decompress to exactly dst_size bytes
+	bool LZ4Decompress(const uint8_t* src, size_t src_size, uint8_t* dst, size_t dst_size);
+}
+
+#endif //_COMPRESSION_H_
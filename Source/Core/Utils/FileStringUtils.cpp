@@ -1,5 +1,10 @@
 #include "FileStringUtils.h"
 #include "Core/Application/Application.h"
+#include "Core/Resources/AssetPack.h"
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
 
 // --- To get usage of windows file dialogs ---
 #include <commdlg.h>
@@ -50,7 +55,129 @@ namespace FileUtils
         return 0;
     }
 
-    
+    bool FileUtils::WriteFileAtomic(const std::string& filepath, const std::vector<FileChunk>& chunks)
+    {
+        std::error_code error;
+        std::filesystem::path parent_path = std::filesystem::path(filepath).parent_path();
+        if (!parent_path.empty())
+            std::filesystem::create_directories(parent_path, error);
+
+        std::string temp_filepath = filepath + ".tmp";
+        std::ofstream file(temp_filepath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+
+        for (const FileChunk& chunk : chunks)
+            file.write((const char*)chunk.Data, chunk.Size);
+
+        bool success = file.good();
+        file.close();
+
+        if (success)
+            std::filesystem::rename(temp_filepath, filepath, error);
+
+        if (!success || error)
+        {
+            std::filesystem::remove(temp_filepath, error);
+            return false;
+        }
+
+        return true;
+    }
+
+
+
+    // ----- Virtual File System -----
+    static std::vector<UniquePtr<AssetPack>> s_AssetPacks;
+
+    static const AssetPack* FindPackedFile(const std::string& filepath, const AssetPackEntry*& entry)
+    {
+        if (s_AssetPacks.empty())
+            return nullptr;
+
+        std::string normalized_path = AssetPack::NormalizePath(filepath);
+        for (auto it = s_AssetPacks.rbegin(); it != s_AssetPacks.rend(); ++it)
+        {
+            entry = (*it)->FindEntry(normalized_path);
+            if (entry)
+                return it->get();
+        }
+
+        return nullptr;
+    }
+
+    bool FileUtils::MountAssetPack(const std::string& pack_filepath)
+    {
+        UniquePtr<AssetPack> pack = CreateUnique<AssetPack>();
+        if (!pack->Open(pack_filepath))
+            return false;
+
+        ENGINE_LOG("Mounted Asset Pack '%s' (%i entries)", pack_filepath.c_str(), pack->GetEntriesCount());
+        s_AssetPacks.push_back(std::move(pack));
+        return true;
+    }
+
+    void FileUtils::UnmountAssetPacks()
+    {
+        s_AssetPacks.clear();
+    }
+
+    bool FileUtils::FileExists(const std::string& filepath)
+    {
+        const AssetPackEntry* entry = nullptr;
+        return FindPackedFile(filepath, entry) != nullptr || std::filesystem::exists(filepath);
+    }
+
+
+    bool VirtualFile::Open(const std::string& filepath)
+    {
+        Close();
+
+        // -- Packed File --
+        const AssetPackEntry* entry = nullptr;
+        if (const AssetPack* pack = FindPackedFile(filepath, entry))
+        {
+            if (entry->Size == 0 || !pack->ReadEntry(*entry, m_Data, m_Buffer))
+            {
+                Close();
+                return false;
+            }
+
+            m_Size = entry->Size;
+            m_Packed = true;
+            return true;
+        }
+
+        // -- Loose File --
+        if (!m_LooseFile.Map(filepath))
+            return false;
+
+        m_Data = m_LooseFile.GetData();
+        m_Size = m_LooseFile.GetSize();
+        return true;
+    }
+
+    void VirtualFile::Close()
+    {
+        m_LooseFile.Unmap();
+        m_Buffer.clear();
+        m_Buffer.shrink_to_fit();
+
+        m_Data = nullptr;
+        m_Size = 0;
+        m_Packed = false;
+    }
+
+    void PageIn(const void* data, size_t size)
+    {
+        const uint8_t* bytes = (const uint8_t*)data;
+        uint checksum = 0;
+        for (size_t offset = 0; offset < size; offset += 4096)
+            checksum += bytes[offset];
+
+        static std::atomic<uint> s_Checksum = { 0 }; // Just so the reads aren't optimized away
+        s_Checksum += checksum;
+    }
 
 
 
@@ -2,6 +2,7 @@
 #define _FILESTRINGUTILS_H_
 
 #include "../Globals.h"
+#include "MappedFile.h"
 
 namespace FileUtils
 {
@@ -12,6 +13,56 @@ namespace FileUtils
 	// Last time file was modified. Check for file modifications for hot reloads.
 	uint64 GetFileLastWriteTimestamp(const char* filepath);
 
+	// Bytes to write into a file, in order
+	struct FileChunk
+	{
+		const void* Data = nullptr;
+		size_t Size = 0;
+	};
+
+	// Writes the chunks into a temporary file first, renamed once complete, so a crash while writing never leaves a half-written file
+	// behind (caches & such). Creates the file directory if needed, returns false (leaving no file) if it couldn't write it
+	bool WriteFileAtomic(const std::string& filepath, const std::vector<FileChunk>& chunks);
+
+
+	// --- Virtual File System ---
+	// Paths are resolved first into the mounted asset packs (last mounted first), then into the disk
+	// Packs are meant to be mounted at startup, before loading any asset
+	bool MountAssetPack(const std::string& pack_filepath);
+	void UnmountAssetPacks();
+
+	bool FileExists(const std::string& filepath);
+
+	// Read-only contents of a file wherever it lives. Loose & uncompressed packed files are memory-mapped, compressed ones decompressed
+	class VirtualFile
+	{
+	public:
+
+		VirtualFile() = default;
+		VirtualFile(const std::string& filepath) { Open(filepath); }
+
+		// Returns false if the file doesn't exist (in packs or disk), can't be read or is empty
+		bool Open(const std::string& filepath);
+		void Close();
+
+		const uint8_t* GetData()	const { return m_Data; }
+		size_t GetSize()			const { return m_Size; }
+		bool IsOpen()				const { return m_Data != nullptr; }
+		bool IsPacked()				const { return m_Packed; }
+
+	private:
+
+		MappedFile m_LooseFile;
+		std::vector<uint8_t> m_Buffer;
+
+		const uint8_t* m_Data = nullptr;
+		size_t m_Size = 0;
+		bool m_Packed = false;
+	};
+
+	// Touches a byte per page of (mapped) data, so the reads after it (like uploads on the main thread) don't wait on disk
+	void PageIn(const void* data, size_t size);
+
 
 	// --- Files Dialogues ---
 	class FileDialogs
@@ -0,0 +1,102 @@
+#ifndef _HASH_H_
+#define _HASH_H_
+
+#include "../Globals.h"
+
+// xxHash64 (https://github.com/Cyan4973/xxHash), non-cryptographic hash used to key caches and detect duplicated assets
+namespace HashUtils
+{
+	namespace Internal
+	{
+		static const uint64 s_Prime1 = 11400714785074694791ULL;
+		static const uint64 s_Prime2 = 14029467366897019727ULL;
+		static const uint64 s_Prime3 = 1609587929392839161ULL;
+		static const uint64 s_Prime4 = 9650029242287828579ULL;
+		static const uint64 s_Prime5 = 2870177450012600261ULL;
+
+		inline uint64 RotateLeft(uint64 value, int bits)		{ return (value << bits) | (value >> (64 - bits)); }
+		inline uint64 Read64(const uint8_t* ptr)				{ uint64 ret; memcpy(&ret, ptr, sizeof(uint64)); return ret; }
+		inline uint64 Read32(const uint8_t* ptr)				{ uint32_t ret; memcpy(&ret, ptr, sizeof(uint32_t)); return (uint64)ret; }
+
+		inline uint64 Round(uint64 acc, uint64 input)
+		{
+			acc += input * s_Prime2;
+			acc = RotateLeft(acc, 31);
+			return acc * s_Prime1;
+		}
+
+		inline uint64 MergeRound(uint64 acc, uint64 value)
+		{
+			acc ^= Round(0, value);
+			return acc * s_Prime1 + s_Prime4;
+		}
+	}
+
+
+	// --- Hash Functions ---
+	inline uint64 XXH64(const void* data, size_t size, uint64 seed = 0)
+	{
+		using namespace Internal;
+		const uint8_t* ptr = (const uint8_t*)data;
+		const uint8_t* end = ptr + size;
+		uint64 hash = 0;
+
+		// -- Stripes of 32 bytes --
+		if (size >= 32)
+		{
+			const uint8_t* limit = end - 32;
+			uint64 v1 = seed + s_Prime1 + s_Prime2, v2 = seed + s_Prime2, v3 = seed, v4 = seed - s_Prime1;
+
+			do
+			{
+				v1 = Round(v1, Read64(ptr));		ptr += 8;
+				v2 = Round(v2, Read64(ptr));		ptr += 8;
+				v3 = Round(v3, Read64(ptr));		ptr += 8;
+				v4 = Round(v4, Read64(ptr));		ptr += 8;
+			} while (ptr <= limit);
+
+			hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+			hash = MergeRound(hash, v1);
+			hash = MergeRound(hash, v2);
+			hash = MergeRound(hash, v3);
+			hash = MergeRound(hash, v4);
+		}
+		else
+			hash = seed + s_Prime5;
+
+		hash += (uint64)size;
+
+		// -- Remaining Bytes --
+		for (; ptr + 8 <= end; ptr += 8)
+			hash = RotateLeft(hash ^ Round(0, Read64(ptr)), 27) * s_Prime1 + s_Prime4;
+
+		if (ptr + 4 <= end)
+		{
+			hash = RotateLeft(hash ^ (Read32(ptr) * s_Prime1), 23) * s_Prime2 + s_Prime3;
+			ptr += 4;
+		}
+
+		for (; ptr < end; ++ptr)
+			hash = RotateLeft(hash ^ ((*ptr) * s_Prime5), 11) * s_Prime1;
+
+		// -- Avalanche --
+		hash ^= hash >> 33;
+		hash *= s_Prime2;
+		hash ^= hash >> 29;
+		hash *= s_Prime3;
+		hash ^= hash >> 32;
+		return hash;
+	}
+
+	inline uint64 HashString(const std::string& str, uint64 seed = 0) { return XXH64(str.data(), str.size(), seed); }
+
+	// Hexadecimal string of a hash, for filenames
+	inline std::string HashToString(uint64 hash)
+	{
+		char buffer[17];
+		snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long)hash);
+		return std::string(buffer);
+	}
+}
+
+#endif //_HASH_H_
@@ -0,0 +1,415 @@
+#include "JobSystem.h"
+
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+
+// ------------------------------------------------------------------------------
+struct Job
+{
+	JobFunction Function;
+	JobCounter* Counter = nullptr;
+	bool Background = false;
+};
+
+
+namespace
+{
+	// Chase-Lev deque (fixed capacity, as in "Correct and Efficient Work-Stealing for Weak Memory Models", Lê et al. 2013)
+	// The owner thread pushes & pops at the bottom, any thread steals from the top
+	class JobDeque
+	{
+	public:
+
+		// False if full
+		bool Push(Job* job)
+		{
+			int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+			int64_t top = m_Top.load(std::memory_order_acquire);
+			if (bottom - top >= s_Capacity)
+				return false;
+
+			m_Jobs[bottom & s_CapacityMask].store(job, std::memory_order_relaxed);
+			m_Bottom.store(bottom + 1, std::memory_order_release);
+			return true;
+		}
+
+		Job* Pop()
+		{
+			int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+			m_Bottom.store(bottom, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t top = m_Top.load(std::memory_order_relaxed);
+
+			if (top > bottom)
+			{
+				m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			// Last job: races with the thieves for it
+			Job* job = m_Jobs[bottom & s_CapacityMask].load(std::memory_order_relaxed);
+			if (top == bottom)
+			{
+				if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					job = nullptr;
+
+				m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			}
+
+			return job;
+		}
+
+		Job* Steal()
+		{
+			int64_t top = m_Top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+			if (top >= bottom)
+				return nullptr;
+
+			Job* job = m_Jobs[top & s_CapacityMask].load(std::memory_order_relaxed);
+			if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return nullptr;
+
+			return job;
+		}
+
+	private:
+
+		static constexpr int64_t s_Capacity = 4096, s_CapacityMask = s_Capacity - 1;
+
+		alignas(64) std::atomic<int64_t> m_Top = { 0 };
+		alignas(64) std::atomic<int64_t> m_Bottom = { 0 };
+		std::atomic<Job*> m_Jobs[s_Capacity] = {};
+	};
+
+
+	static constexpr uint s_ExternalThread = ~0u;
+	static constexpr uint s_SpinsBeforeSleep = 64;
+
+	// -- Threads --
+	static std::vector<std::thread> s_Workers;
+	static std::vector<UniquePtr<JobDeque>> s_Deques;	// Main thread's one first, then a worker's one each
+	static thread_local uint s_ThreadIndex = s_ExternalThread;
+	static thread_local uint s_StealSeed = 0;
+
+	// -- Shared Jobs --
+	// Overflow ones (of external threads or overflowing a deque) are taken by any thread, waiting ones too, background ones only by workers
+	static std::mutex s_SharedMutex;
+	static std::deque<Job*> s_OverflowJobs, s_BackgroundJobs;
+	static std::atomic<uint> s_OverflowJobsCount = { 0 }, s_BackgroundJobsCount = { 0 };	// Checked before locking
+
+	Job* PopSharedJob(std::deque<Job*>& jobs, std::atomic<uint>& jobs_count)
+	{
+		if (jobs_count.load() == 0)
+			return nullptr;
+
+		std::lock_guard<std::mutex> lock(s_SharedMutex);
+		if (jobs.empty())
+			return nullptr;
+
+		Job* job = jobs.front();
+		jobs.pop_front();
+		jobs_count.fetch_sub(1);
+		return job;
+	}
+
+	// -- Sleeping Workers --
+	static std::mutex s_SleepMutex;
+	static std::condition_variable s_SleepCondition;
+	static std::atomic<uint> s_QueuedJobs = { 0 };
+	static std::atomic<uint> s_SleepingWorkers = { 0 };
+	static std::atomic<bool> s_Stop = { false };
+}
+
+
+
+// ------------------------------------------------------------------------------
+void JobSystem::Init(uint threads_count)
+{
+	ASSERT(s_Deques.empty(), "Job System already initialized!");
+	if (threads_count == 0)
+	{
+		uint hardware_threads = std::thread::hardware_concurrency();
+		threads_count = hardware_threads > 1 ? hardware_threads - 1 : 1;
+	}
+
+	s_Stop = false;
+	s_ThreadIndex = 0;
+	for (uint i = 0; i <= threads_count; ++i)
+		s_Deques.push_back(CreateUnique<JobDeque>());
+
+	s_Workers.reserve(threads_count);
+	for (uint i = 1; i <= threads_count; ++i)
+		s_Workers.emplace_back(&JobSystem::WorkerLoop, i);
+
+	ENGINE_LOG("Job System running %i worker threads", threads_count);
+}
+
+
+void JobSystem::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(s_SleepMutex);
+		s_Stop = true;
+	}
+
+	s_SleepCondition.notify_all();
+	for (std::thread& worker : s_Workers)
+		worker.join();
+
+	// -- Drop Queued Jobs --
+	for (UniquePtr<JobDeque>& deque : s_Deques)
+		while (Job* job = deque->Steal())
+			delete job;
+
+	for (Job* job : s_OverflowJobs)
+		delete job;
+	for (Job* job : s_BackgroundJobs)
+		delete job;
+
+	s_Workers.clear();
+	s_Deques.clear();
+	s_OverflowJobs.clear();
+	s_BackgroundJobs.clear();
+	s_OverflowJobsCount = 0;
+	s_BackgroundJobsCount = 0;
+	s_QueuedJobs = 0;
+}
+
+
+uint JobSystem::GetThreadsCount()
+{
+	return (uint)s_Workers.size();
+}
+
+bool JobSystem::IsInitialized()
+{
+	return !s_Deques.empty();
+}
+
+
+
+// ------------------------------------------------------------------------------
+void JobSystem::Run(JobFunction function, JobCounter* counter, JobCounter* dependency)
+{
+	// Without threads, jobs just run in place (so their dependencies always ran already)
+	if (!IsInitialized())
+	{
+		function();
+		return;
+	}
+
+	Job* job = new Job{ std::move(function), counter, false };
+	if (counter)
+		counter->m_Pending.fetch_add(1, std::memory_order_relaxed);
+
+	if (dependency)
+	{
+		// Checked under the lock, so it either gets queued by Finish() or is done already
+		std::lock_guard<std::mutex> lock(dependency->m_DependentsMutex);
+		if (!dependency->IsDone())
+		{
+			dependency->m_Dependents.push_back(job);
+			return;
+		}
+	}
+
+	Queue(job);
+}
+
+
+void JobSystem::RunBackground(JobFunction function, JobCounter* counter)
+{
+	if (!IsInitialized())
+	{
+		function();
+		return;
+	}
+
+	if (counter)
+		counter->m_Pending.fetch_add(1, std::memory_order_relaxed);
+
+	Queue(new Job{ std::move(function), counter, true });
+}
+
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	while (!counter.IsDone())
+	{
+		if (Job* job = FindJob(s_ThreadIndex, false))
+			Execute(job);
+		else
+			std::this_thread::yield();
+	}
+
+	// The last Finish() might still hold the lock, taking it ensures the counter is not used anymore (so it can be destroyed)
+	std::lock_guard<std::mutex> lock(counter.m_DependentsMutex);
+}
+
+
+void JobSystem::ParallelFor(uint count, uint batch_size, const std::function<void(uint, uint)>& func)
+{
+	if (count == 0)
+		return;
+
+	batch_size = batch_size > 0 ? batch_size : 1;
+	uint batches = (count + batch_size - 1) / batch_size;
+	if (batches == 1 || !IsInitialized())
+	{
+		func(0, count);
+		return;
+	}
+
+	// Pushed last to first, so the calling thread pops the first ones while the rest get stolen
+	JobCounter counter;
+	for (uint b = batches - 1; b > 0; --b)
+	{
+		uint first = b * batch_size, batch_count = count - first < batch_size ? count - first : batch_size;
+		Run([&func, first, batch_count]() { func(first, batch_count); }, &counter);
+	}
+
+	func(0, batch_size);
+	Wait(counter);
+}
+
+
+uint JobSystem::GetBatchSize(uint count)
+{
+	// The calling thread takes part too
+	const uint batches = (GetThreadsCount() + 1) * s_BatchesPerThread;
+	return (count + batches - 1) / batches;
+}
+
+
+
+// ------------------------------------------------------------------------------
+void JobSystem::WorkerLoop(uint thread_index)
+{
+	s_ThreadIndex = thread_index;
+	s_StealSeed = thread_index;
+
+	uint spins = 0;
+	while (!s_Stop.load(std::memory_order_relaxed))
+	{
+		if (Job* job = FindJob(thread_index, true))
+		{
+			Execute(job);
+			spins = 0;
+			continue;
+		}
+
+		if (++spins < s_SpinsBeforeSleep)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// -- Sleep until Jobs Queued --
+		// Counted as sleeping before checking, so Queue() either sees it sleeping (& notifies) or this sees the job
+		std::unique_lock<std::mutex> lock(s_SleepMutex);
+		s_SleepingWorkers.fetch_add(1);
+		s_SleepCondition.wait(lock, []() { return s_QueuedJobs.load() > 0 || s_Stop.load(); });
+		s_SleepingWorkers.fetch_sub(1);
+		spins = 0;
+	}
+}
+
+
+void JobSystem::Queue(Job* job)
+{
+	// Counted before it can be taken (& uncounted)
+	s_QueuedJobs.fetch_add(1);
+
+	uint thread_index = s_ThreadIndex;
+	if (job->Background)
+	{
+		std::lock_guard<std::mutex> lock(s_SharedMutex);
+		s_BackgroundJobs.push_back(job);
+		s_BackgroundJobsCount.fetch_add(1);
+	}
+	else if (thread_index == s_ExternalThread || !s_Deques[thread_index]->Push(job))
+	{
+		std::lock_guard<std::mutex> lock(s_SharedMutex);
+		s_OverflowJobs.push_back(job);
+		s_OverflowJobsCount.fetch_add(1);
+	}
+
+	if (s_SleepingWorkers.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(s_SleepMutex);
+		s_SleepCondition.notify_one();
+	}
+}
+
+
+Job* JobSystem::FindJob(uint thread_index, bool take_background)
+{
+	Job* job = nullptr;
+
+	// -- Own Jobs --
+	if (thread_index != s_ExternalThread)
+		job = s_Deques[thread_index]->Pop();
+
+	// -- Steal --
+	// From a random thread onwards, so thieves don't all hit the same one
+	if (!job)
+	{
+		const uint deques_count = (uint)s_Deques.size();
+		s_StealSeed = s_StealSeed * 1664525u + 1013904223u;
+		uint first = (s_StealSeed >> 8) % deques_count;
+
+		for (uint i = 0; i < deques_count && !job; ++i)
+		{
+			uint victim = (first + i) % deques_count;
+			if (victim != thread_index)
+				job = s_Deques[victim]->Steal();
+		}
+	}
+
+	// -- Shared Jobs --
+	// Overflow ones can be waited on, so waiting threads must take them too (all workers might be waiting)
+	if (!job)
+		job = PopSharedJob(s_OverflowJobs, s_OverflowJobsCount);
+	if (!job && take_background)
+		job = PopSharedJob(s_BackgroundJobs, s_BackgroundJobsCount);
+
+	if (job)
+		s_QueuedJobs.fetch_sub(1);
+
+	return job;
+}
+
+
+void JobSystem::Execute(Job* job)
+{
+	job->Function();
+	if (job->Counter)
+		Finish(job->Counter);
+
+	delete job;
+}
+
+
+void JobSystem::Finish(JobCounter* counter)
+{
+	uint pending = counter->m_Pending.load(std::memory_order_acquire);
+	while (pending > 1)
+		if (counter->m_Pending.compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel))
+			return;
+
+	// -- Last Job: Queue Dependents --
+	// Decremented under the lock, so Wait() can't return (& the counter be destroyed) while it's still used here
+	std::vector<Job*> dependents;
+	{
+		std::lock_guard<std::mutex> lock(counter->m_DependentsMutex);
+		if (counter->m_Pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			dependents.swap(counter->m_Dependents);
+	}
+
+	for (Job* job : dependents)
+		Queue(job);
+}
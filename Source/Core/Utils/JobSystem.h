@@ -0,0 +1,85 @@
+#ifndef _JOBSYSTEM_H_
+#define _JOBSYSTEM_H_
+
+#include "../Globals.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+typedef std::function<void()> JobFunction;
+struct Job;
+
+
+// Pending jobs of a set: waited on or used as dependency of other jobs
+// Must outlive its jobs & the ones depending on it, JobSystem::Wait() on it before destroying it
+class JobCounter
+{
+	friend class JobSystem;
+public:
+
+	JobCounter() = default;
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	inline bool IsDone()		const	{ return m_Pending.load(std::memory_order_acquire) == 0; }
+	inline uint GetPending()	const	{ return m_Pending.load(std::memory_order_acquire); }
+
+private:
+
+	std::atomic<uint> m_Pending = { 0 };
+
+	std::mutex m_DependentsMutex;
+	std::vector<Job*> m_Dependents;	// Jobs waiting for it, queued when it reaches 0
+};
+
+
+
+// ------------------------------------------------------------------------------
+// Work-stealing job system: one Chase-Lev deque per thread (workers & main one), each thread pushes & pops its own jobs
+// (LIFO, cache-warm) and steals the oldest ones of the others (FIFO) when out of work
+// Waiting on a counter runs other jobs meanwhile, so waiting from a job (nested parallel loops) doesn't stall a worker
+// Jobs from threads not owned by the system (or overflowing a deque) go to a shared locked queue any thread takes, waiting ones too
+// Background jobs go to another one, only taken by idle workers
+class JobSystem
+{
+public:
+
+	// --- Class Stuff ---
+	// 0 threads means one per hardware thread minus the main one (at least 1). Init() must be called from the main thread
+	static void Init(uint threads_count = 0);
+	static void Shutdown(); // Jobs still queued are dropped
+
+	// --- Jobs ---
+	// The counter (if any) gets incremented now & decremented once the job ran. A job with a dependency is queued once it's done
+	static void Run(JobFunction function, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+
+	// For long jobs no frame waits on (decoding, IO), so Wait() never picks them up
+	static void RunBackground(JobFunction function, JobCounter* counter = nullptr);
+
+	// Runs other jobs (of any set, except background ones) until the counter is done
+	static void Wait(JobCounter& counter);
+
+	// func(first, count) for batches of [0, count), blocks until all ran (the calling thread takes part)
+	static void ParallelFor(uint count, uint batch_size, const std::function<void(uint, uint)>& func);
+
+	// For loops of heavy uneven items (meshes, chunks, textures): a few batches per thread balance them without a job per item
+	static uint GetBatchSize(uint count);
+
+	// --- Getters ---
+	static uint GetThreadsCount(); // Workers, without the main thread
+	static bool IsInitialized();
+
+private:
+
+	static const uint s_BatchesPerThread = 4;
+
+	static void WorkerLoop(uint thread_index);
+
+	static void Queue(Job* job);
+	static Job* FindJob(uint thread_index, bool take_background);
+	static void Execute(Job* job);
+	static void Finish(JobCounter* counter);
+};
+
+#endif //_JOBSYSTEM_H_
@@ -0,0 +1,90 @@
+#include "MappedFile.h"
+
+#ifndef _WIN32
+    #include <sys/mman.h>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+// ------------------------------------------------------------------------------
+namespace FileUtils
+{
+    // ----- Memory Mapped Files -----
+    bool MappedFile::Map(const std::string& filepath)
+    {
+        Unmap();
+
+        #ifdef _WIN32
+                m_FileHandle = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+                if (m_FileHandle == INVALID_HANDLE_VALUE)
+                    return false;
+
+                LARGE_INTEGER file_size;
+                if (!GetFileSizeEx(m_FileHandle, &file_size) || file_size.QuadPart == 0)
+                {
+                    Unmap();
+                    return false;
+                }
+
+                m_MappingHandle = CreateFileMappingA(m_FileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+                if (m_MappingHandle == NULL)
+                {
+                    Unmap();
+                    return false;
+                }
+
+                m_Data = (const uint8_t*)MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0);
+                m_Size = (size_t)file_size.QuadPart;
+        #else
+                m_FileDescriptor = open(filepath.c_str(), O_RDONLY);
+                if (m_FileDescriptor == -1)
+                    return false;
+
+                struct stat attrib;
+                if (fstat(m_FileDescriptor, &attrib) != 0 || attrib.st_size == 0)
+                {
+                    Unmap();
+                    return false;
+                }
+
+                void* data = mmap(nullptr, (size_t)attrib.st_size, PROT_READ, MAP_PRIVATE, m_FileDescriptor, 0);
+                m_Data = data == MAP_FAILED ? nullptr : (const uint8_t*)data;
+                m_Size = (size_t)attrib.st_size;
+        #endif
+
+        if (!m_Data)
+        {
+            Unmap();
+            return false;
+        }
+
+        return true;
+    }
+
+    void MappedFile::Unmap()
+    {
+        #ifdef _WIN32
+                if (m_Data)
+                    UnmapViewOfFile(m_Data);
+                if (m_MappingHandle != NULL)
+                    CloseHandle(m_MappingHandle);
+                if (m_FileHandle != INVALID_HANDLE_VALUE)
+                    CloseHandle(m_FileHandle);
+
+                m_MappingHandle = NULL;
+                m_FileHandle = INVALID_HANDLE_VALUE;
+        #else
+                if (m_Data)
+                    munmap((void*)m_Data, m_Size);
+                if (m_FileDescriptor != -1)
+                    close(m_FileDescriptor);
+
+                m_FileDescriptor = -1;
+        #endif
+
+        m_Data = nullptr;
+        m_Size = 0;
+    }
+}
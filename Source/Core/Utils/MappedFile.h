@@ -0,0 +1,42 @@
+#ifndef _MAPPEDFILE_H_
+#define _MAPPEDFILE_H_
+
+#include "../Globals.h"
+
+namespace FileUtils
+{
+	// --- Memory Mapped Files ---
+	// Read-only view of a whole file, the OS pages it in on demand. Unmapped on destruction
+	class MappedFile
+	{
+	public:
+
+		MappedFile() = default;
+		MappedFile(const std::string& filepath) { Map(filepath); }
+		~MappedFile() { Unmap(); }
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// Returns false if the file couldn't be opened or is empty
+		bool Map(const std::string& filepath);
+		void Unmap();
+
+		const uint8_t* GetData()	const { return m_Data; }
+		size_t GetSize()			const { return m_Size; }
+		bool IsMapped()				const { return m_Data != nullptr; }
+
+	private:
+
+		const uint8_t* m_Data = nullptr;
+		size_t m_Size = 0;
+
+		#ifdef _WIN32
+			HANDLE m_FileHandle = INVALID_HANDLE_VALUE, m_MappingHandle = NULL;
+		#else
+			int m_FileDescriptor = -1;
+		#endif
+	};
+}
+
+#endif //_MAPPEDFILE_H_
@@ -0,0 +1,171 @@
+#ifndef _SLOTMAP_H_
+#define _SLOTMAP_H_
+
+#include "../Globals.h"
+#include <vector>
+
+template<typename T, typename V> class SlotMap;
+
+
+// ------------------------------------------------------------------------------
+// Typed 32-bit handle to a SlotMap element: 20 bits of slot index & 12 of generation
+// The slot generation is bumped when its element is removed, so stale handles are detected instead of pointing to another element
+// A slot is retired once its generation reaches the 12-bit limit (4095 reuses), so generations never wrap back to a stale one
+// 0 is the null handle (generations start at 1), only slot maps create non-null ones
+template<typename T>
+class Handle
+{
+	template<typename, typename> friend class SlotMap;
+public:
+
+	static constexpr uint s_IndexBits = 20;
+	static constexpr uint s_IndexMask = (1u << s_IndexBits) - 1;
+	static constexpr uint s_GenerationMask = (1u << (32 - s_IndexBits)) - 1;
+
+	Handle() = default;
+
+	// --- Getters ---
+	inline bool IsNull()					const	{ return m_Value == 0; } // SlotMap::IsValid() tells if it's still alive
+	inline uint GetIndex()					const	{ return m_Value & s_IndexMask; }
+	inline uint GetGeneration()				const	{ return m_Value >> s_IndexBits; }
+	inline uint GetValue()					const	{ return m_Value; }
+
+	bool operator==(const Handle& handle)	const	{ return m_Value == handle.m_Value; }
+	bool operator!=(const Handle& handle)	const	{ return m_Value != handle.m_Value; }
+
+private:
+
+	Handle(uint index, uint generation) : m_Value((generation << s_IndexBits) | index) {}
+
+	uint m_Value = 0;
+};
+
+
+// ------------------------------------------------------------------------------
+// Elements are packed in a dense array (iterating them is linear, no holes), slots map handles to them
+// Removing swaps the last element into the hole, so pointers from Get() & iterators are invalidated by Insert() & Remove()
+template<typename T, typename V = Ref<T>>
+class SlotMap
+{
+public:
+
+	typedef Handle<T> HandleType;
+
+	// --- Elements ---
+	HandleType Insert(V value)
+	{
+		uint slot_index = 0;
+		if (m_FreeSlots.empty())
+		{
+			ASSERT(m_Slots.size() < HandleType::s_IndexMask, "SlotMap: Out of slots!");
+			slot_index = (uint)m_Slots.size();
+			m_Slots.push_back({ s_InvalidIndex, 1 });
+		}
+		else
+		{
+			slot_index = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		}
+
+		Slot& slot = m_Slots[slot_index];
+		slot.DenseIndex = (uint)m_Values.size();
+		m_Values.push_back(std::move(value));
+		m_DenseToSlot.push_back(slot_index);
+		return HandleType(slot_index, slot.Generation);
+	}
+
+	bool Remove(HandleType handle)
+	{
+		if (!IsValid(handle))
+			return false;
+
+		// -- Fill the Hole with the Last Element --
+		Slot& slot = m_Slots[handle.GetIndex()];
+		uint last = (uint)m_Values.size() - 1;
+		if (slot.DenseIndex != last)
+		{
+			m_Values[slot.DenseIndex] = std::move(m_Values[last]);
+			m_DenseToSlot[slot.DenseIndex] = m_DenseToSlot[last];
+			m_Slots[m_DenseToSlot[last]].DenseIndex = slot.DenseIndex;
+		}
+
+		m_Values.pop_back();
+		m_DenseToSlot.pop_back();
+
+		// -- Free the Slot --
+		FreeSlot(handle.GetIndex());
+		return true;
+	}
+
+	void Clear()
+	{
+		for (uint slot_index : m_DenseToSlot)
+			FreeSlot(slot_index);
+
+		m_Values.clear();
+		m_DenseToSlot.clear();
+	}
+
+	// --- Lookups ---
+	// Non-owning & constant time (no hashing), nullptr if the handle is null or stale
+	inline V* Get(HandleType handle)						{ return IsValid(handle) ? &m_Values[m_Slots[handle.GetIndex()].DenseIndex] : nullptr; }
+	inline const V* Get(HandleType handle)			const	{ return IsValid(handle) ? &m_Values[m_Slots[handle.GetIndex()].DenseIndex] : nullptr; }
+
+	inline bool IsValid(HandleType handle) const
+	{
+		uint index = handle.GetIndex();
+		return !handle.IsNull() && index < m_Slots.size() && m_Slots[index].Generation == handle.GetGeneration() && m_Slots[index].DenseIndex != s_InvalidIndex;
+	}
+
+	// Handle of the element at a dense position (such as while iterating)
+	inline HandleType GetHandle(uint dense_index)	const	{ uint slot_index = m_DenseToSlot[dense_index]; return HandleType(slot_index, m_Slots[slot_index].Generation); }
+
+	// --- Dense Access ---
+	inline uint Size()								const	{ return (uint)m_Values.size(); }
+	inline bool Empty()								const	{ return m_Values.empty(); }
+	inline V& operator[](uint dense_index)					{ return m_Values[dense_index]; }
+	inline const V& operator[](uint dense_index)	const	{ return m_Values[dense_index]; }
+
+	typename std::vector<V>::iterator begin()				{ return m_Values.begin(); }
+	typename std::vector<V>::iterator end()					{ return m_Values.end(); }
+	typename std::vector<V>::const_iterator begin()	const	{ return m_Values.begin(); }
+	typename std::vector<V>::const_iterator end()	const	{ return m_Values.end(); }
+
+private:
+
+	void FreeSlot(uint slot_index)
+	{
+		// Slots that used up their generations are retired (never reused), so a wrapped one can't match a stale handle
+		Slot& slot = m_Slots[slot_index];
+		slot.DenseIndex = s_InvalidIndex;
+		if (slot.Generation == HandleType::s_GenerationMask)
+			return;
+
+		++slot.Generation;
+		m_FreeSlots.push_back(slot_index);
+	}
+
+private:
+
+	struct Slot { uint DenseIndex = s_InvalidIndex; uint Generation = 1; };
+	static constexpr uint s_InvalidIndex = ~0u;
+
+	std::vector<V> m_Values;			// Dense
+	std::vector<uint> m_DenseToSlot;	// Slot of each dense element, to fix it when swapping on removals
+	std::vector<Slot> m_Slots;
+	std::vector<uint> m_FreeSlots;
+};
+
+
+// ------------------------------------------------------------------------------
+class Mesh;
+class Material;
+class Texture;
+class Model;
+
+typedef Handle<Mesh> MeshHandle;
+typedef Handle<Material> MaterialHandle;
+typedef Handle<Texture> TextureHandle;
+typedef Handle<Model> ModelHandle;
+
+#endif //_SLOTMAP_H_
@@ -0,0 +1,29 @@
+#ifndef _COMPONENTS_H_
+#define _COMPONENTS_H_
+
+#include "Core/Globals.h"
+#include "Renderer/Resources/Buffers.h"
+#include "Renderer/Resources/Mesh.h"
+
+#include <glm/glm.hpp>
+
+// Scene entities components (besides TransformComponent & PointLight), stored in an EntityRegistry
+
+
+// Model drawn by the entity (shared, many entities can draw the same one with their own transform)
+// Static ones are baked into the RenderScene static batches (see StaticBatches), moving them rebakes them
+struct ModelComponent
+{
+	Ref<Model> EntityModel = nullptr;
+	bool IsStatic = false;
+};
+
+
+// Bounds of the entity draws, kept by the RenderScene (local ones on rebuild, the world sphere as the transform changes)
+struct BoundsComponent
+{
+	AABB LocalBounds = {};
+	glm::vec4 WorldSphere = glm::vec4(0.0f);	// Center (xyz) & radius (w)
+};
+
+#endif //_COMPONENTS_H_
@@ -20,21 +20,15 @@ public:
 
 
 // --- Point Light ---
+// Scene component, its entity identifies it
 class PointLight : public Light
 {
-	friend class Renderer;
-private:
-
-	PointLight(int id) : m_ID(id) {}
-
 public:
-	
-	~PointLight() = default;
 
-	inline uint GetID()		const { return m_ID; }
-	inline operator uint()	const { return m_ID; }
+	PointLight() = default;
+	~PointLight() = default;
 
-	float GetLightRadius(float max_distance)
+	float GetLightRadius(float max_distance) const
 	{
 		return 1.0f / (AttenuationK + AttenuationL * max_distance + AttenuationQ * max_distance * max_distance);
 	}
@@ -54,10 +48,6 @@ public:
 	glm::vec3 Position = glm::vec3(0.0f, 1.0f, 2.0f);
 	float AttenuationK = 1.0f, AttenuationL = 0.09f, AttenuationQ = 0.032f;
 	bool Active = true;
-
-private:
-
-	int m_ID = -1;
 };
 
 #endif //_LIGHT_H_
\ No newline at end of file
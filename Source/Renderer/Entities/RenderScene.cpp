@@ -0,0 +1,252 @@
+#include "RenderScene.h"
+#include "Core/Resources/Resources.h"
+#include "Core/Utils/JobSystem.h"
+
+#include <algorithm>
+
+
+// ------------------------------------------------------------------------------
+static const uint s_CullBatchSize = 256; // Entities per culling job
+
+static bool TransformsEqual(const TransformComponent& a, const TransformComponent& b)
+{
+	return a.EntityActive == b.EntityActive && a.Translation == b.Translation && a.Rotation == b.Rotation && a.Scale == b.Scale;
+}
+
+
+
+// ------------------------------------------------------------------------------
+void RenderScene::Update(EntityRegistry& scene)
+{
+	EntityGroup<TransformComponent, ModelComponent, BoundsComponent> entities = GetDrawnEntities(scene);
+	const Entity* group_entities = entities.GetEntities();
+
+	// Any entity added, removed or reordered in the group (or meshes changed) invalidates the draws ranges
+	// So does a material edited in a batch shared by several (its rect or what it draws with), rebaking them
+	bool entities_changed = entities.Size() != m_Entities.size() || !std::equal(m_Entities.begin(), m_Entities.end(), group_entities);
+	if (entities_changed || m_MeshesVersion != Resources::GetMeshesVersion() || m_StaticBatches.IsOutdated())
+	{
+		Rebuild(entities);
+		return;
+	}
+
+	// -- Changed Transforms --
+	// Components are edited directly (editor, gameplay), so changes are detected against the last seen values
+	// Static entities changing (or flagged & unflagged) need their batches rebaked, so they rebuild the scene
+	const TransformComponent* transforms = entities.GetComponents<TransformComponent>();
+	const ModelComponent* models = entities.GetComponents<ModelComponent>();
+	for (uint i = 0; i < entities.Size(); ++i)
+	{
+		if (models[i].IsStatic != (bool)m_EntitiesStatic[i] || (models[i].IsStatic && !TransformsEqual(transforms[i], m_EntitiesTransforms[i])))
+		{
+			Rebuild(entities);
+			return;
+		}
+
+		if (!TransformsEqual(transforms[i], m_EntitiesTransforms[i]))
+		{
+			m_EntitiesTransforms[i] = transforms[i];
+			m_Transforms.SetLocal(i, transforms[i]);
+		}
+	}
+
+	m_Transforms.Update();
+	BoundsComponent* bounds = entities.GetComponents<BoundsComponent>();
+	for (uint entity_index : m_Transforms.GetUpdated())
+		UpdateEntityDraws(entity_index, bounds[entity_index]);
+}
+
+
+void RenderScene::Rebuild(EntityGroup<TransformComponent, ModelComponent, BoundsComponent>& entities)
+{
+	// -- Clear Draws --
+	m_Entities.assign(entities.GetEntities(), entities.GetEntities() + entities.Size());
+	m_EntitiesTransforms.clear(); m_EntitiesStatic.clear(); m_EntitiesFirstDraw.clear(); m_EntitiesDrawsCount.clear();
+	m_LocalMatrices.clear(); m_WorldMatrices.clear(); m_DrawRanges.clear(); m_Materials.clear();
+	m_LocalBounds.clear(); m_WorldSpheres.clear(); m_Flags.clear();
+	m_VisibleDraws.clear();
+	m_Transforms.Clear();
+	m_MeshletsCount = 0;
+
+	// -- Flatten Hierarchies --
+	const TransformComponent* transforms = entities.GetComponents<TransformComponent>();
+	const ModelComponent* models = entities.GetComponents<ModelComponent>();
+	BoundsComponent* bounds = entities.GetComponents<BoundsComponent>();
+
+	std::vector<const Mesh*> meshes_to_visit;
+	std::vector<std::pair<uint, const Mesh*>> static_meshes; // Entity & mesh, baked once the world matrices are computed
+	for (uint i = 0; i < entities.Size(); ++i)
+	{
+		m_EntitiesTransforms.push_back(transforms[i]);
+		m_EntitiesStatic.push_back(models[i].IsStatic);
+		m_EntitiesFirstDraw.push_back((uint)m_DrawRanges.size());
+		m_Transforms.SetLocal(m_Transforms.Create(), transforms[i]);
+
+		if (models[i].EntityModel && models[i].EntityModel->GetRootMesh())
+			meshes_to_visit.push_back(models[i].EntityModel->GetRootMesh());
+
+		bool has_bounds = false;
+		while (!meshes_to_visit.empty())
+		{
+			const Mesh* mesh = meshes_to_visit.back();
+			meshes_to_visit.pop_back();
+
+			for (const Ref<Mesh>& submesh : *mesh->GetSubmeshes())
+				meshes_to_visit.push_back(submesh.get());
+
+			if (!mesh->m_VertexArray || !mesh->m_VertexArray->GetIndexBuffer())
+				continue;
+
+			// Entity bounds enclose all its meshes (in the model space)
+			AABB mesh_bounds = mesh->GetBounds().Transformed(mesh->GetLocalTransform());
+			if (has_bounds)
+				bounds[i].LocalBounds.Merge(mesh_bounds);
+			else
+				bounds[i].LocalBounds = mesh_bounds;
+
+			has_bounds = true;
+			if (models[i].IsStatic)
+			{
+				static_meshes.push_back({ i, mesh });
+				continue;
+			}
+
+			m_DrawRanges.push_back({ mesh->m_VertexArray.get(), 0, mesh->m_VertexArray->GetIndexBuffer()->GetCount(), mesh->m_MeshletsBuffer.get(), mesh->m_MeshletsCount });
+			m_MeshletsCount += mesh->m_MeshletsCount;
+			m_Materials.push_back(mesh->GetMaterial());
+			m_LocalBounds.push_back(mesh->GetBounds());
+			m_LocalMatrices.push_back(mesh->GetLocalTransform());
+		}
+
+		m_EntitiesDrawsCount.push_back((uint)m_DrawRanges.size() - m_EntitiesFirstDraw.back());
+		if (!has_bounds)
+			bounds[i].LocalBounds = AABB();
+	}
+
+	// -- World Data --
+	m_WorldMatrices.resize(m_DrawRanges.size());
+	m_WorldSpheres.resize(m_DrawRanges.size());
+	m_Flags.resize(m_DrawRanges.size());
+
+	m_Transforms.Update();
+	for (uint i = 0; i < entities.Size(); ++i)
+		UpdateEntityDraws(i, bounds[i]);
+
+	// -- Static Batches --
+	// Meshes of the active static entities baked in world space (again only if they changed), drawn as their chunks
+	std::vector<StaticMeshInstance> static_instances;
+	for (const std::pair<uint, const Mesh*>& static_mesh : static_meshes)
+	{
+		if (m_EntitiesTransforms[static_mesh.first].EntityActive)
+			static_instances.push_back({ static_mesh.second->m_VertexArray, static_mesh.second->GetMaterial(), m_Transforms.GetWorld(static_mesh.first) * static_mesh.second->GetLocalTransform() });
+	}
+
+	m_StaticBatches.Build(static_instances);
+	m_StaticFirstDraw = (uint)m_DrawRanges.size();
+	for (const StaticBatches::Chunk& chunk : m_StaticBatches.GetChunks())
+	{
+		if (chunk.IndexCount == 0)
+			continue;
+
+		m_DrawRanges.push_back({ chunk.ChunkVertexArray, chunk.FirstIndex, chunk.IndexCount, chunk.Meshlets.get(), chunk.MeshletsCount });
+		m_Materials.push_back(chunk.Material);
+		m_LocalBounds.push_back(chunk.Bounds);
+		m_LocalMatrices.push_back(glm::mat4(1.0f));
+		m_WorldMatrices.push_back(glm::mat4(1.0f));
+		m_WorldSpheres.push_back(chunk.Bounds.GetBoundingSphere(glm::mat4(1.0f)));
+		m_Flags.push_back(chunk.AlbedoUVBaked ? (uint8_t)(DRAW_ACTIVE | DRAW_ALBEDO_UV_BAKED) : (uint8_t)DRAW_ACTIVE);
+		m_MeshletsCount += chunk.MeshletsCount;
+	}
+
+	m_MeshesVersion = Resources::GetMeshesVersion();
+}
+
+
+void RenderScene::UpdateEntityDraws(uint entity_index, BoundsComponent& bounds)
+{
+	// Submeshes are drawn with their entity transform (times their own in the model)
+	const glm::mat4& world_matrix = m_Transforms.GetWorld(entity_index);
+	uint8_t flags = m_EntitiesTransforms[entity_index].EntityActive ? DRAW_ACTIVE : 0;
+	bounds.WorldSphere = bounds.LocalBounds.GetBoundingSphere(world_matrix);
+
+	uint first = m_EntitiesFirstDraw[entity_index], last = first + m_EntitiesDrawsCount[entity_index];
+	for (uint i = first; i < last; ++i)
+	{
+		m_WorldMatrices[i] = world_matrix * m_LocalMatrices[i];
+		m_WorldSpheres[i] = m_LocalBounds[i].GetBoundingSphere(m_WorldMatrices[i]);
+		m_Flags[i] = flags;
+	}
+}
+
+
+
+// ------------------------------------------------------------------------------
+void RenderScene::Cull(EntityRegistry& scene, const glm::mat4& view_projection)
+{
+	// -- Frustum Planes --
+	// From the view-projection rows (Gribb & Hartmann), normalized so distances are in world units
+	glm::vec4 planes[6];
+	for (uint i = 0; i < 3; ++i)
+	{
+		glm::vec4 row = glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+		glm::vec4 row_w = glm::vec4(view_projection[0][3], view_projection[1][3], view_projection[2][3], view_projection[3][3]);
+		planes[i * 2] = row_w + row;
+		planes[i * 2 + 1] = row_w - row;
+	}
+
+	for (glm::vec4& plane : planes)
+		plane /= glm::length(glm::vec3(plane));
+
+	auto sphere_visible = [&planes](const glm::vec4& sphere)
+	{
+		for (uint p = 0; p < 6; ++p)
+			if (glm::dot(glm::vec3(planes[p]), glm::vec3(sphere)) + planes[p].w < -sphere.w)
+				return false;
+
+		return true;
+	};
+
+	// -- Test Spheres --
+	// Entities bounds first (packed), only the draws of the visible ones get tested. Each job writes the flags of its own entities draws
+	EntityGroup<TransformComponent, ModelComponent, BoundsComponent> entities = GetDrawnEntities(scene);
+	const BoundsComponent* bounds = entities.GetComponents<BoundsComponent>();
+	const uint entities_count = std::min(entities.Size(), (uint)m_Entities.size());
+
+	JobSystem::ParallelFor(entities_count, s_CullBatchSize, [&](uint first_entity, uint count)
+		{
+			for (uint e = first_entity; e < first_entity + count; ++e)
+			{
+				uint first = m_EntitiesFirstDraw[e], last = first + m_EntitiesDrawsCount[e];
+				bool entity_visible = m_EntitiesTransforms[e].EntityActive && sphere_visible(bounds[e].WorldSphere);
+
+				for (uint i = first; i < last; ++i)
+				{
+					if (entity_visible && sphere_visible(m_WorldSpheres[i]))
+						m_Flags[i] |= DRAW_VISIBLE;
+					else
+						m_Flags[i] &= ~DRAW_VISIBLE;
+				}
+			}
+		});
+
+	// -- Visible Draws --
+	// Compacted afterwards, in draws order
+	m_VisibleDraws.clear();
+	const uint draws_count = entities_count > 0 ? m_EntitiesFirstDraw[entities_count - 1] + m_EntitiesDrawsCount[entities_count - 1] : 0;
+	for (uint i = 0; i < draws_count; ++i)
+		if (m_Flags[i] & DRAW_VISIBLE)
+			m_VisibleDraws.push_back(i);
+
+	// -- Static Draws --
+	// Few chunks, already in world space
+	for (uint i = m_StaticFirstDraw; i < GetDrawsCount(); ++i)
+	{
+		if (sphere_visible(m_WorldSpheres[i]))
+		{
+			m_Flags[i] |= DRAW_VISIBLE;
+			m_VisibleDraws.push_back(i);
+		}
+		else
+			m_Flags[i] &= ~DRAW_VISIBLE;
+	}
+}
@@ -0,0 +1,90 @@
+#ifndef _RENDERSCENE_H_
+#define _RENDERSCENE_H_
+
+#include "Core/Globals.h"
+#include "Core/Utils/SlotMap.h"
+#include "Core/ECS/EntityRegistry.h"
+#include "Renderer/Resources/Buffers.h"
+#include "Renderer/Resources/Mesh.h"
+#include "TransformSystem.h"
+#include "StaticBatches.h"
+#include "Components.h"
+
+#include <glm/glm.hpp>
+
+
+// Flattened scene, extracted from the entities with Transform, Model & Bounds components (an owning group, so they're packed):
+// their models meshes hierarchies are walked once into structure-of-arrays (one entry per drawn mesh), so each frame
+// culling & submission are linear loops over contiguous arrays instead of recursions through shared ptrs
+// Rebuilt when the entities or meshes (through Resources) change, the entities transforms are cached in a TransformSystem
+// (one root per entity), so only the ones that changed get their matrices recomputed & their draws refreshed
+// Meshes of static entities are baked into StaticBatches instead, their chunks appended as draws after the entities ones
+class RenderScene
+{
+	friend class Renderer;
+public:
+
+	// Draw flags (albedo UV baked: static chunk with the atlas rects in its UVs, see StaticBatches)
+	enum DRAW_FLAGS : uint8_t { DRAW_ACTIVE = 1 << 0, DRAW_VISIBLE = 1 << 1, DRAW_ALBEDO_UV_BAKED = 1 << 2 };
+
+	// Index range of a vertex array to draw, with its meshlets (if any) for the GPU culling
+	struct DrawRange
+	{
+		const VertexArray* DrawVertexArray = nullptr;
+		uint FirstIndex = 0, IndexCount = 0;
+		const StorageBuffer* Meshlets = nullptr;
+		uint MeshletsCount = 0;
+	};
+
+public:
+
+	// Group of the entities drawn (creates it on the first call)
+	static EntityGroup<TransformComponent, ModelComponent, BoundsComponent> GetDrawnEntities(EntityRegistry& scene) { return scene.Group<TransformComponent, ModelComponent, BoundsComponent>(); }
+
+	// --- Per-Frame ---
+	// Picks up entities, hierarchy & transform changes, call before culling
+	void Update(EntityRegistry& scene);
+
+	// Frustum-culls the entities bounds, then the draws of the visible ones. Those are the ones submitted by Renderer::SubmitScene()
+	void Cull(EntityRegistry& scene, const glm::mat4& view_projection);
+
+	// --- Getters ---
+	uint GetDrawsCount()							const	{ return (uint)m_DrawRanges.size(); }
+	uint GetVisibleDrawsCount()						const	{ return (uint)m_VisibleDraws.size(); }
+	uint GetMeshletsCount()							const	{ return m_MeshletsCount; }
+	uint GetStaticMeshesCount()						const	{ return m_StaticBatches.GetMeshesCount(); }
+	uint GetStaticDrawsCount()						const	{ return GetDrawsCount() - m_StaticFirstDraw; }
+
+private:
+
+	void Rebuild(EntityGroup<TransformComponent, ModelComponent, BoundsComponent>& entities);
+	void UpdateEntityDraws(uint entity_index, BoundsComponent& bounds);
+
+private:
+
+	// --- Entities (in the group order) ---
+	std::vector<Entity> m_Entities;
+	std::vector<TransformComponent> m_EntitiesTransforms;		// Last ones seen, to detect changes
+	std::vector<uint8_t> m_EntitiesStatic;						// Same
+	std::vector<uint> m_EntitiesFirstDraw, m_EntitiesDrawsCount;	// Range of each entity in the draws arrays
+	TransformSystem m_Transforms;								// Same index than the entities
+
+	// --- Draws (SoA) ---
+	std::vector<glm::mat4> m_LocalMatrices;						// Of the meshes in their models
+	std::vector<glm::mat4> m_WorldMatrices;
+	std::vector<DrawRange> m_DrawRanges;
+	std::vector<MaterialHandle> m_Materials;
+	std::vector<AABB> m_LocalBounds;
+	std::vector<glm::vec4> m_WorldSpheres;						// Center (xyz) & radius (w)
+	std::vector<uint8_t> m_Flags;
+
+	std::vector<uint> m_VisibleDraws;
+	uint m_MeshletsCount = 0;									// Of all the draws
+	uint64 m_MeshesVersion = 0;
+
+	// --- Static Draws ---
+	StaticBatches m_StaticBatches;
+	uint m_StaticFirstDraw = 0;									// Its chunks draws, up to the end of the draws arrays
+};
+
+#endif //_RENDERSCENE_H_
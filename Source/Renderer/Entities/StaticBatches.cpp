@@ -0,0 +1,430 @@
+#include "StaticBatches.h"
+#include "Core/Resources/MeshImporter.h"
+#include "Core/Resources/Resources.h"
+#include "Core/Utils/Hash.h"
+#include "Core/Utils/JobSystem.h"
+#include "Core/Utils/Timer.h"
+
+#include <glm/gtc/matrix_inverse.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <numeric>
+#include <unordered_map>
+
+
+// ------------------------------------------------------------------------------
+namespace
+{
+	static const uint s_VertexFloats = 14;				// MeshImporter::GetVertexLayout()
+	static const uint s_MaxChunkVertices = 65536;		// Chunks are split until under it (or down to a single mesh)
+
+	// Geometry of a vertex array in the engine's vertex layout
+	struct SourceGeometry
+	{
+		std::vector<float> Vertices;
+		std::vector<uint> Indices;
+		AABB Bounds = {};
+	};
+
+	// Merged geometry of a material (or of the materials sharing an atlas, with their rects baked into the UVs)
+	struct MaterialBatch
+	{
+		MaterialHandle Material = {};
+		bool AlbedoUVBaked = false;
+		std::vector<float> Vertices;
+		std::vector<uint> Indices;
+	};
+
+	inline glm::vec3 SafeNormalize(const glm::vec3& vector)
+	{
+		float length = glm::length(vector);
+		return length > FLT_MIN ? vector / length : vector;
+	}
+
+	inline uint64 GetMaterialKey(MaterialHandle material)
+	{
+		return ((uint64)material.GetGeneration() << 32) | (uint64)material.GetIndex();
+	}
+
+	// Everything a material draws with but its albedo rect, the ones baked into an atlas with equal keys can share a batch
+	uint64 GetAtlasBatchKey(const Material& material)
+	{
+		const Texture* textures[] = { material.Albedo.get(), material.Emissive.get(), material.Specular.get(), material.Normal.get(), material.Bump.get() };
+		const glm::vec4 colors[] = { material.AlbedoColor, material.SpecularColor, material.EmissiveColor };
+		const float values[] = { material.Smoothness, material.Bumpiness, material.Heightscale, material.ParallaxLayers,
+			(float)material.IsTransparent, (float)material.IsEmissive, (float)material.IsTwoSided, (float)material.IsAlphaTested, material.AlphaCutoff };
+
+		uint64 key = HashUtils::XXH64(textures, sizeof(textures));
+		key = HashUtils::XXH64(colors, sizeof(colors), key);
+		return HashUtils::XXH64(values, sizeof(values), key);
+	}
+
+	inline uint64 GetSharedMaterialKey(const Material& material)
+	{
+		return HashUtils::XXH64(&material.AlbedoUVTransform, sizeof(glm::vec4), GetAtlasBatchKey(material));
+	}
+
+	// Baked UVs are only exact if the shader clamp (before the rect transform) changes none of them
+	bool UVsInUnitRange(const SourceGeometry& geometry)
+	{
+		for (size_t v = 0; v < geometry.Vertices.size(); v += s_VertexFloats)
+			if (geometry.Vertices[v + 3] < 0.0f || geometry.Vertices[v + 3] > 1.0f || geometry.Vertices[v + 4] < 0.0f || geometry.Vertices[v + 4] > 1.0f)
+				return false;
+
+		return true;
+	}
+
+
+	// Reads back the vertex array buffers, their attributes matched by name with the engine's layout ones (missing ones stay zero)
+	// Bitangents not in the source are derived from the normals & tangents (with the handedness in the tangents w, if they have it)
+	void ReadGeometry(const VertexArray& vertex_array, SourceGeometry& geometry)
+	{
+		const BufferLayout engine_layout = MeshImporter::GetVertexLayout();
+		auto find_engine_element = [&engine_layout](const std::string& name) -> const BufferElement*
+		{
+			for (const BufferElement& element : engine_layout)
+				if (element.Name == name)
+					return &element;
+
+			return nullptr;
+		};
+
+		// -- Vertices Count --
+		uint vertices_count = 0;
+		for (const Ref<VertexBuffer>& vbo : vertex_array.GetVertexBuffers())
+			for (const BufferElement& element : vbo->GetLayout())
+				if (element.Name == "a_Position" && vbo->GetLayout().GetStride() > 0)
+					vertices_count = (uint)(vbo->GetGPUBytes() / vbo->GetLayout().GetStride());
+
+		geometry.Vertices.assign((size_t)vertices_count * s_VertexFloats, 0.0f);
+		std::vector<float> handedness(vertices_count, 1.0f);
+		bool has_bitangents = false;
+
+		// -- Attributes --
+		std::vector<uint8_t> data;
+		for (const Ref<VertexBuffer>& vbo : vertex_array.GetVertexBuffers())
+		{
+			const BufferLayout& layout = vbo->GetLayout();
+			data.resize(vbo->GetGPUBytes());
+			vbo->GetData(data.data(), (uint)data.size());
+
+			for (const BufferElement& element : layout)
+			{
+				const BufferElement* engine_element = find_engine_element(element.Name);
+				if (!engine_element || element.Type < SHADER_DATA::FLOAT || element.Type > SHADER_DATA::FLOAT4)
+					continue;
+
+				has_bitangents |= element.Name == "a_Bitangent";
+				const uint source_count = element.GetElementTypeCount(), copy_count = std::min(source_count, engine_element->GetElementTypeCount());
+				const uint engine_offset = (uint)engine_element->Offset / sizeof(float);
+				const bool tangent_handedness = element.Name == "a_Tangent" && source_count == 4;
+
+				for (uint v = 0; v < vertices_count; ++v)
+				{
+					uint64 source_offset = (uint64)v * layout.GetStride() + element.Offset;
+					if (source_offset + source_count * sizeof(float) > data.size())
+						break;
+
+					const float* source = (const float*)(data.data() + source_offset);
+					memcpy(&geometry.Vertices[(size_t)v * s_VertexFloats + engine_offset], source, copy_count * sizeof(float));
+					if (tangent_handedness)
+						handedness[v] = source[3] < 0.0f ? -1.0f : 1.0f;
+				}
+			}
+		}
+
+		if (!has_bitangents)
+		{
+			for (uint v = 0; v < vertices_count; ++v)
+			{
+				float* vertex = &geometry.Vertices[(size_t)v * s_VertexFloats];
+				glm::vec3 bitangent = glm::cross(glm::vec3(vertex[5], vertex[6], vertex[7]), glm::vec3(vertex[8], vertex[9], vertex[10])) * handedness[v];
+				vertex[11] = bitangent.x; vertex[12] = bitangent.y; vertex[13] = bitangent.z;
+			}
+		}
+
+		// -- Indices --
+		// Dropped if any is out of the vertices (nothing of it gets baked then)
+		const Ref<IndexBuffer>& ibo = vertex_array.GetIndexBuffer();
+		geometry.Indices.resize(ibo ? ibo->GetCount() - ibo->GetCount() % 3 : 0);
+		if (!geometry.Indices.empty())
+			ibo->GetData(geometry.Indices.data(), (uint)geometry.Indices.size() * sizeof(uint));
+
+		if (std::any_of(geometry.Indices.begin(), geometry.Indices.end(), [vertices_count](uint index) { return index >= vertices_count; }))
+			geometry.Indices.clear();
+
+		// -- Bounds --
+		geometry.Bounds = { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+		for (uint v = 0; v < vertices_count; ++v)
+		{
+			glm::vec3 position = glm::vec3(geometry.Vertices[(size_t)v * s_VertexFloats], geometry.Vertices[(size_t)v * s_VertexFloats + 1], geometry.Vertices[(size_t)v * s_VertexFloats + 2]);
+			geometry.Bounds.Merge({ position, position });
+		}
+
+		if (vertices_count == 0)
+			geometry.Bounds = {};
+	}
+
+
+	// Splits the [first, first + count) instances at the median of their centers along the longest axis, until a chunk is under the
+	// vertices limit or has a single instance. Chunks are output as ranges of the (reordered) instances
+	void SplitChunks(std::vector<uint>& instances, uint first, uint count, const std::vector<AABB>& world_bounds, const std::vector<uint>& vertices_counts,
+		std::vector<std::pair<uint, uint>>& chunks)
+	{
+		uint64 vertices = 0;
+		AABB centers = { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+		for (uint i = first; i < first + count; ++i)
+		{
+			vertices += vertices_counts[instances[i]];
+			centers.Merge({ world_bounds[instances[i]].GetCenter(), world_bounds[instances[i]].GetCenter() });
+		}
+
+		if (count == 1 || vertices <= s_MaxChunkVertices)
+		{
+			chunks.push_back({ first, count });
+			return;
+		}
+
+		glm::vec3 extents = centers.Max - centers.Min;
+		int axis = extents.x >= extents.y && extents.x >= extents.z ? 0 : (extents.y >= extents.z ? 1 : 2);
+		uint half = count / 2;
+		std::nth_element(instances.begin() + first, instances.begin() + first + half, instances.begin() + first + count, [&world_bounds, axis](uint a, uint b)
+			{ return world_bounds[a].GetCenter()[axis] < world_bounds[b].GetCenter()[axis]; });
+
+		SplitChunks(instances, first, half, world_bounds, vertices_counts, chunks);
+		SplitChunks(instances, first + half, count - half, world_bounds, vertices_counts, chunks);
+	}
+
+
+	// Writes the geometry transformed to world space into the batch arrays (at the offsets), winding flipped if the transform mirrors it
+	// UVs get the albedo rect transform (scale & offset) if the batch bakes them
+	void BakeInstance(const SourceGeometry& geometry, const glm::mat4& world_matrix, const glm::vec4& uv_transform, MaterialBatch& batch, uint vertex_offset, uint index_offset)
+	{
+		const glm::mat3 tangent_matrix = glm::mat3(world_matrix), normal_matrix = glm::inverseTranspose(tangent_matrix);
+		const bool mirrored = glm::determinant(tangent_matrix) < 0.0f;
+
+		const uint vertices_count = (uint)(geometry.Vertices.size() / s_VertexFloats);
+		for (uint v = 0; v < vertices_count; ++v)
+		{
+			const float* source = &geometry.Vertices[(size_t)v * s_VertexFloats];
+			float* vertex = &batch.Vertices[((size_t)vertex_offset + v) * s_VertexFloats];
+
+			glm::vec3 position = glm::vec3(world_matrix * glm::vec4(source[0], source[1], source[2], 1.0f));
+			glm::vec3 normal = SafeNormalize(normal_matrix * glm::vec3(source[5], source[6], source[7]));
+			glm::vec3 tangent = SafeNormalize(tangent_matrix * glm::vec3(source[8], source[9], source[10]));
+			glm::vec3 bitangent = SafeNormalize(tangent_matrix * glm::vec3(source[11], source[12], source[13]));
+
+			vertex[0] = position.x;		vertex[1] = position.y;		vertex[2] = position.z;
+			vertex[3] = source[3] * uv_transform.x + uv_transform.z;		vertex[4] = source[4] * uv_transform.y + uv_transform.w;
+			vertex[5] = normal.x;		vertex[6] = normal.y;		vertex[7] = normal.z;
+			vertex[8] = tangent.x;		vertex[9] = tangent.y;		vertex[10] = tangent.z;
+			vertex[11] = bitangent.x;	vertex[12] = bitangent.y;	vertex[13] = bitangent.z;
+		}
+
+		uint* indices = &batch.Indices[index_offset];
+		for (size_t i = 0; i < geometry.Indices.size(); i += 3)
+		{
+			indices[i] = geometry.Indices[i] + vertex_offset;
+			indices[i + 1] = geometry.Indices[mirrored ? i + 2 : i + 1] + vertex_offset;
+			indices[i + 2] = geometry.Indices[mirrored ? i + 1 : i + 2] + vertex_offset;
+		}
+	}
+}
+
+
+
+// ------------------------------------------------------------------------------
+bool StaticBatches::Build(const std::vector<StaticMeshInstance>& instances)
+{
+	if (instances == m_Instances && !IsOutdated())
+		return false;
+
+	Timer timer;
+	timer.Start();
+
+	Clear();
+	m_Instances = instances;
+	const uint instances_count = (uint)m_Instances.size();
+	if (instances_count == 0)
+		return true;
+
+	// -- Read Source Geometry --
+	// Once per vertex array, instanced meshes share them
+	std::unordered_map<const VertexArray*, SourceGeometry> geometries;
+	std::vector<const SourceGeometry*> instances_geometry(instances_count);
+	std::vector<AABB> world_bounds(instances_count);
+	std::vector<uint> vertices_counts(instances_count);
+
+	for (uint i = 0; i < instances_count; ++i)
+	{
+		const VertexArray* vertex_array = m_Instances[i].MeshVertexArray.get();
+		auto it = geometries.find(vertex_array);
+		if (it == geometries.end())
+		{
+			it = geometries.emplace(vertex_array, SourceGeometry()).first;
+			ReadGeometry(*vertex_array, it->second);
+		}
+
+		instances_geometry[i] = &it->second;
+		world_bounds[i] = it->second.Bounds.Transformed(m_Instances[i].WorldMatrix);
+		vertices_counts[i] = (uint)(it->second.Vertices.size() / s_VertexFloats);
+	}
+
+	// -- Group by Material --
+	// Materials baked into an atlas group by their atlas batch key instead (their UVs are in the unit range), the first one drawing them all
+	std::vector<uint> instances_group(instances_count);
+	std::vector<glm::vec4> instances_uv_transform(instances_count, glm::vec4(1.0f, 1.0f, 0.0f, 0.0f));
+	std::vector<MaterialBatch> batches;
+	std::unordered_map<uint64, uint> material_groups, atlas_groups;
+	std::unordered_map<uint64, MaterialHandle> shared_materials;
+
+	for (uint i = 0; i < instances_count; ++i)
+	{
+		const Material* material = Resources::GetMaterialPtr(m_Instances[i].Material);
+		const bool atlased = material && material->Albedo && material->AlbedoUVTransform != glm::vec4(1.0f, 1.0f, 0.0f, 0.0f) && UVsInUnitRange(*instances_geometry[i]);
+
+		std::unordered_map<uint64, uint>& groups = atlased ? atlas_groups : material_groups;
+		const uint64 key = atlased ? GetAtlasBatchKey(*material) : GetMaterialKey(m_Instances[i].Material);
+		auto it = groups.find(key);
+		if (it == groups.end())
+		{
+			it = groups.emplace(key, (uint)batches.size()).first;
+			batches.emplace_back();
+			batches.back().Material = m_Instances[i].Material;
+			batches.back().AlbedoUVBaked = atlased;
+		}
+
+		instances_group[i] = it->second;
+		if (atlased)
+		{
+			instances_uv_transform[i] = material->AlbedoUVTransform;
+			shared_materials[GetMaterialKey(m_Instances[i].Material)] = m_Instances[i].Material;
+		}
+	}
+
+	for (const auto& [material_key, material] : shared_materials)
+		m_SharedMaterials.push_back({ material, GetSharedMaterialKey(*Resources::GetMaterialPtr(material)) });
+
+	// -- Split in Chunks --
+	// Instances ordered by batch, then by chunk within each batch
+	std::vector<uint> order(instances_count);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&instances_group](uint a, uint b) { return instances_group[a] < instances_group[b]; });
+
+	std::vector<std::pair<uint, uint>> chunk_ranges;	// In the order array
+	std::vector<uint> chunks_batch;
+	for (uint first = 0; first < instances_count;)
+	{
+		uint last = first;
+		while (last < instances_count && instances_group[order[last]] == instances_group[order[first]])
+			++last;
+
+		SplitChunks(order, first, last - first, world_bounds, vertices_counts, chunk_ranges);
+		chunks_batch.resize(chunk_ranges.size(), instances_group[order[first]]);
+		first = last;
+	}
+
+	// -- Bake Geometry --
+	// Offsets of each instance in its material arrays (in the chunks order, so each chunk is a contiguous range), then baked in parallel
+	std::vector<uint> vertex_offsets(instances_count), index_offsets(instances_count), instances_batch(instances_count);
+	for (uint c = 0; c < (uint)chunk_ranges.size(); ++c)
+	{
+		MaterialBatch& batch = batches[chunks_batch[c]];
+		for (uint i = chunk_ranges[c].first; i < chunk_ranges[c].first + chunk_ranges[c].second; ++i)
+		{
+			vertex_offsets[i] = (uint)(batch.Vertices.size() / s_VertexFloats);
+			index_offsets[i] = (uint)batch.Indices.size();
+			instances_batch[i] = chunks_batch[c];
+			batch.Vertices.resize(batch.Vertices.size() + (size_t)vertices_counts[order[i]] * s_VertexFloats);
+			batch.Indices.resize(batch.Indices.size() + instances_geometry[order[i]]->Indices.size());
+		}
+	}
+
+	JobSystem::ParallelFor(instances_count, JobSystem::GetBatchSize(instances_count), [&](uint first, uint count)
+		{
+			for (uint i = first; i < first + count; ++i)
+				BakeInstance(*instances_geometry[order[i]], m_Instances[order[i]].WorldMatrix, instances_uv_transform[order[i]], batches[instances_batch[i]], vertex_offsets[i], index_offsets[i]);
+		});
+
+	// -- Chunks --
+	// Meshlets built over each chunk vertices range (indices rebased to it)
+	m_Chunks.resize(chunk_ranges.size());
+	std::vector<std::vector<Meshlet>> chunks_meshlets(chunk_ranges.size());
+	JobSystem::ParallelFor((uint)chunk_ranges.size(), JobSystem::GetBatchSize((uint)chunk_ranges.size()), [&](uint first, uint count)
+		{
+			for (uint c = first; c < first + count; ++c)
+			{
+				const MaterialBatch& batch = batches[chunks_batch[c]];
+				const uint first_instance = chunk_ranges[c].first, last_instance = chunk_ranges[c].first + chunk_ranges[c].second - 1;
+
+				Chunk& chunk = m_Chunks[c];
+				chunk.Material = batch.Material;
+				chunk.AlbedoUVBaked = batch.AlbedoUVBaked;
+				chunk.MeshesCount = chunk_ranges[c].second;
+				chunk.FirstIndex = index_offsets[first_instance];
+				chunk.IndexCount = index_offsets[last_instance] + (uint)instances_geometry[order[last_instance]]->Indices.size() - chunk.FirstIndex;
+
+				chunk.Bounds = world_bounds[order[first_instance]];
+				for (uint i = first_instance + 1; i <= last_instance; ++i)
+					chunk.Bounds.Merge(world_bounds[order[i]]);
+
+				const uint first_vertex = vertex_offsets[first_instance];
+				const uint vertices_count = vertex_offsets[last_instance] + vertices_counts[order[last_instance]] - first_vertex;
+				std::vector<uint> chunk_indices(batch.Indices.begin() + chunk.FirstIndex, batch.Indices.begin() + chunk.FirstIndex + chunk.IndexCount);
+				for (uint& index : chunk_indices)
+					index -= first_vertex;
+
+				chunks_meshlets[c] = MeshImporter::BuildMeshlets(batch.Vertices.data() + (size_t)first_vertex * s_VertexFloats, s_VertexFloats, vertices_count, chunk_indices.data(), chunk.IndexCount);
+			}
+		});
+
+	// -- Upload --
+	for (const MaterialBatch& batch : batches)
+	{
+		Ref<VertexBuffer> vbo = CreateRef<VertexBuffer>(batch.Vertices.data(), (uint)(batch.Vertices.size() * sizeof(float)));
+		Ref<IndexBuffer> ibo = CreateRef<IndexBuffer>(batch.Indices.data(), (uint)batch.Indices.size());
+		Ref<VertexArray> vao = CreateRef<VertexArray>();
+
+		vbo->SetLayout(MeshImporter::GetVertexLayout());
+		vao->AddVertexBuffer(vbo);
+		vao->SetIndexBuffer(ibo);
+		vao->Unbind(); vbo->Unbind(); ibo->Unbind();
+		m_VertexArrays.push_back(vao);
+	}
+
+	for (uint c = 0; c < (uint)m_Chunks.size(); ++c)
+	{
+		m_Chunks[c].ChunkVertexArray = m_VertexArrays[chunks_batch[c]].get();
+		m_Chunks[c].MeshletsCount = (uint)chunks_meshlets[c].size();
+		if (!chunks_meshlets[c].empty())
+			m_Chunks[c].Meshlets = CreateRef<StorageBuffer>(chunks_meshlets[c].data(), (uint64)chunks_meshlets[c].size() * sizeof(Meshlet));
+	}
+
+	ENGINE_LOG("Static Batching: %u meshes baked into %u chunks of %u batches (%u materials sharing atlases) in %.2f ms", instances_count, (uint)m_Chunks.size(),
+		(uint)batches.size(), (uint)m_SharedMaterials.size(), timer.GetMilliseconds());
+
+	return true;
+}
+
+
+void StaticBatches::Clear()
+{
+	m_Instances.clear();
+	m_Chunks.clear();
+	m_VertexArrays.clear();
+	m_SharedMaterials.clear();
+}
+
+
+bool StaticBatches::IsOutdated() const
+{
+	// A few materials (the ones baked into atlases), checked every frame
+	for (const std::pair<MaterialHandle, uint64>& shared_material : m_SharedMaterials)
+	{
+		const Material* material = Resources::GetMaterialPtr(shared_material.first);
+		if (!material || GetSharedMaterialKey(*material) != shared_material.second)
+			return true;
+	}
+
+	return false;
+}
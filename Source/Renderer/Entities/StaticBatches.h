@@ -0,0 +1,66 @@
+#ifndef _STATICBATCHES_H_
+#define _STATICBATCHES_H_
+
+#include "Core/Globals.h"
+#include "Core/Utils/SlotMap.h"
+#include "Renderer/Resources/Buffers.h"
+#include "Renderer/Resources/Mesh.h"
+
+#include <glm/glm.hpp>
+
+
+// A mesh of a static entity to bake: its whole vertex array, material & world transform
+struct StaticMeshInstance
+{
+	Ref<VertexArray> MeshVertexArray = nullptr;	// Held so a rebuilt scene can't match a new array at the same address
+	MaterialHandle Material = {};
+	glm::mat4 WorldMatrix = glm::mat4(1.0f);
+
+	bool operator==(const StaticMeshInstance& instance) const { return MeshVertexArray == instance.MeshVertexArray && Material == instance.Material && WorldMatrix == instance.WorldMatrix; }
+};
+
+
+// Static meshes sharing a material, pre-transformed into world space & merged into a vertex array per material
+// Materials baked into the same atlas (see TextureAtlas) & equal otherwise share one too, their albedo UVs baked into their rects
+// Each material geometry is split spatially (median cuts along the longest axis) into chunks of whole meshes, each one an index
+// range of it with its world bounds & meshlets, so they're culled & drawn as any other draw (with an identity transform)
+// Vertex arrays keep only the GPU copy of their data, so the source geometry is read back from them when baking
+class StaticBatches
+{
+public:
+
+	struct Chunk
+	{
+		const VertexArray* ChunkVertexArray = nullptr;
+		uint FirstIndex = 0, IndexCount = 0;
+		Ref<StorageBuffer> Meshlets = nullptr;
+		uint MeshletsCount = 0;
+		MaterialHandle Material = {};
+		AABB Bounds = {};			// World space
+		uint MeshesCount = 0;
+		bool AlbedoUVBaked = false;	// Its UVs are in the atlas already, drawn without the material AlbedoUVTransform
+	};
+
+public:
+
+	// Bakes the instances (main thread) unless they're the ones already baked (& up to date), returns true if it did
+	bool Build(const std::vector<StaticMeshInstance>& instances);
+	void Clear();
+
+	// A material sharing a batch with others changed (or was deleted) since baking
+	bool IsOutdated() const;
+
+	// --- Getters ---
+	const std::vector<Chunk>& GetChunks()	const { return m_Chunks; }
+	uint GetMeshesCount()					const { return (uint)m_Instances.size(); }
+
+private:
+
+	std::vector<StaticMeshInstance> m_Instances;	// Baked ones
+	std::vector<Ref<VertexArray>> m_VertexArrays;	// A merged one per material
+	std::vector<Chunk> m_Chunks;
+
+	std::vector<std::pair<MaterialHandle, uint64>> m_SharedMaterials;	// With the key (rect included) they were baked with
+};
+
+#endif //_STATICBATCHES_H_
@@ -0,0 +1,290 @@
+#include "TransformSystem.h"
+#include "Core/Utils/Timer.h"
+#include "Core/Utils/JobSystem.h"
+
+#include <emmintrin.h>
+#include <xmmintrin.h>
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#endif
+
+
+// ------------------------------------------------------------------------------
+namespace
+{
+	static const uint s_ThreadedMinTransforms = 16384;	// Below it, splitting costs more than it saves
+	static const uint s_ThreadedBatchSize = 4096;
+
+
+	// Column-major 4x4 product with SSE (a * b)
+	inline void MultiplyMatrices(const glm::mat4& a, const glm::mat4& b, glm::mat4& result)
+	{
+		const float* a_ptr = &a[0][0];
+		__m128 a0 = _mm_loadu_ps(a_ptr), a1 = _mm_loadu_ps(a_ptr + 4), a2 = _mm_loadu_ps(a_ptr + 8), a3 = _mm_loadu_ps(a_ptr + 12);
+
+		for (int c = 0; c < 4; ++c)
+		{
+			__m128 column = _mm_mul_ps(a0, _mm_set1_ps(b[c][0]));
+			column = _mm_add_ps(column, _mm_mul_ps(a1, _mm_set1_ps(b[c][1])));
+			column = _mm_add_ps(column, _mm_mul_ps(a2, _mm_set1_ps(b[c][2])));
+			column = _mm_add_ps(column, _mm_mul_ps(a3, _mm_set1_ps(b[c][3])));
+			_mm_storeu_ps(&result[c][0], column);
+		}
+	}
+
+
+	// T * R * S of 4 transforms (one per lane), same result than TransformComponent::GetTransform()
+	// Columns come out as lanes, so they're transposed into each transform matrix
+	inline void StoreLocalMatrices(__m128 tx, __m128 ty, __m128 tz, __m128 qx, __m128 qy, __m128 qz, __m128 qw, __m128 sx, __m128 sy, __m128 sz, glm::mat4* const* out)
+	{
+		const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f), zero = _mm_setzero_ps();
+
+		// -- Rotation from Quaternion --
+		__m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+		__m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+		__m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+
+		// -- Scaled Columns --
+		__m128 c0x = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+		__m128 c0y = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+		__m128 c0z = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+		__m128 c0w = zero;
+
+		__m128 c1x = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+		__m128 c1y = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+		__m128 c1z = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+		__m128 c1w = zero;
+
+		__m128 c2x = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+		__m128 c2y = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+		__m128 c2z = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+		__m128 c2w = zero;
+
+		__m128 c3w = one;
+
+		// -- Transpose Lanes into Matrices --
+		_MM_TRANSPOSE4_PS(c0x, c0y, c0z, c0w);
+		_MM_TRANSPOSE4_PS(c1x, c1y, c1z, c1w);
+		_MM_TRANSPOSE4_PS(c2x, c2y, c2z, c2w);
+		_MM_TRANSPOSE4_PS(tx, ty, tz, c3w);
+
+		const __m128 columns[4][4] = { { c0x, c1x, c2x, tx }, { c0y, c1y, c2y, ty }, { c0z, c1z, c2z, tz }, { c0w, c1w, c2w, c3w } };
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			float* matrix = &(*out[lane])[0][0];
+			for (int c = 0; c < 4; ++c)
+				_mm_storeu_ps(matrix + c * 4, columns[lane][c]);
+		}
+	}
+}
+
+
+
+// ------------------------------------------------------------------------------
+uint TransformSystem::Create(uint parent)
+{
+	ASSERT(parent == s_NoParent || parent < m_Parents.size(), "TransformSystem: Parents must be created before their children");
+
+	m_TranslationX.push_back(0.0f); m_TranslationY.push_back(0.0f); m_TranslationZ.push_back(0.0f);
+	m_RotationX.push_back(0.0f); m_RotationY.push_back(0.0f); m_RotationZ.push_back(0.0f); m_RotationW.push_back(1.0f);
+	m_ScaleX.push_back(1.0f); m_ScaleY.push_back(1.0f); m_ScaleZ.push_back(1.0f);
+
+	m_Parents.push_back(parent);
+	m_Flags.push_back(LOCAL_DIRTY | WORLD_DIRTY);
+	m_Local.push_back(glm::mat4(1.0f));
+	m_World.push_back(glm::mat4(1.0f));
+
+	uint id = (uint)m_Parents.size() - 1;
+	m_LocalDirty.push_back(id);
+	m_AnyDirty = true;
+	return id;
+}
+
+void TransformSystem::Clear()
+{
+	m_TranslationX.clear(); m_TranslationY.clear(); m_TranslationZ.clear();
+	m_RotationX.clear(); m_RotationY.clear(); m_RotationZ.clear(); m_RotationW.clear();
+	m_ScaleX.clear(); m_ScaleY.clear(); m_ScaleZ.clear();
+
+	m_Parents.clear(); m_Flags.clear();
+	m_Local.clear(); m_World.clear();
+	m_LocalDirty.clear(); m_Updated.clear();
+	m_AnyDirty = false;
+}
+
+
+void TransformSystem::SetLocal(uint id, const glm::vec3& translation, const glm::vec3& rotation_degrees, const glm::vec3& scale)
+{
+	glm::quat rotation = glm::quat(glm::radians(rotation_degrees));
+	m_TranslationX[id] = translation.x; m_TranslationY[id] = translation.y; m_TranslationZ[id] = translation.z;
+	m_RotationX[id] = rotation.x; m_RotationY[id] = rotation.y; m_RotationZ[id] = rotation.z; m_RotationW[id] = rotation.w;
+	m_ScaleX[id] = scale.x; m_ScaleY[id] = scale.y; m_ScaleZ[id] = scale.z;
+
+	if (!(m_Flags[id] & LOCAL_DIRTY))
+		m_LocalDirty.push_back(id);
+
+	m_Flags[id] |= LOCAL_DIRTY | WORLD_DIRTY;
+	m_AnyDirty = true;
+}
+
+
+
+// ------------------------------------------------------------------------------
+void TransformSystem::Update(bool multithreaded)
+{
+	m_Updated.clear();
+	if (!m_AnyDirty)
+		return;
+
+	// -- Local Matrices --
+	// Independent of each other, so big batches are split across the jobs threads (the calling one takes part)
+	const uint local_count = (uint)m_LocalDirty.size();
+	if (multithreaded && local_count >= s_ThreadedMinTransforms)
+		JobSystem::ParallelFor(local_count, s_ThreadedBatchSize, [this](uint first, uint count) { ComputeLocalMatrices(m_LocalDirty.data() + first, count); });
+	else
+		ComputeLocalMatrices(m_LocalDirty.data(), local_count);
+
+	m_LocalDirty.clear();
+
+	// -- Propagate & World Matrices --
+	// Parents go before their children, so one forward pass dirties the descendants & has their parent world matrix ready
+	const uint transforms_count = (uint)m_Parents.size();
+	for (uint i = 0; i < transforms_count; ++i)
+	{
+		uint parent = m_Parents[i];
+		if (parent != s_NoParent && (m_Flags[parent] & WORLD_DIRTY))
+			m_Flags[i] |= WORLD_DIRTY;
+
+		if (!(m_Flags[i] & WORLD_DIRTY))
+			continue;
+
+		if (parent == s_NoParent)
+			m_World[i] = m_Local[i];
+		else
+			MultiplyMatrices(m_World[parent], m_Local[i], m_World[i]);
+
+		m_Updated.push_back(i);
+	}
+
+	// Flags cleared after the pass, children check their parent's one
+	for (uint id : m_Updated)
+		m_Flags[id] = 0;
+
+	m_AnyDirty = false;
+}
+
+
+void TransformSystem::ComputeLocalMatrices(const uint* ids, uint count)
+{
+	uint i = 0;
+
+#if defined(__AVX2__)
+	// -- 8 Transforms per Iteration --
+	// Computed in AVX lanes, stored as 2 halves through the SSE transpose
+	for (; i + 8 <= count; i += 8)
+	{
+		const uint* id = ids + i;
+		#define GATHER8(array) _mm256_setr_ps(array[id[0]], array[id[1]], array[id[2]], array[id[3]], array[id[4]], array[id[5]], array[id[6]], array[id[7]])
+		__m256 tx = GATHER8(m_TranslationX), ty = GATHER8(m_TranslationY), tz = GATHER8(m_TranslationZ);
+		__m256 qx = GATHER8(m_RotationX), qy = GATHER8(m_RotationY), qz = GATHER8(m_RotationZ), qw = GATHER8(m_RotationW);
+		__m256 sx = GATHER8(m_ScaleX), sy = GATHER8(m_ScaleY), sz = GATHER8(m_ScaleZ);
+		#undef GATHER8
+
+		glm::mat4* out[8];
+		for (int lane = 0; lane < 8; ++lane)
+			out[lane] = &m_Local[id[lane]];
+
+		StoreLocalMatrices(_mm256_castps256_ps128(tx), _mm256_castps256_ps128(ty), _mm256_castps256_ps128(tz),
+			_mm256_castps256_ps128(qx), _mm256_castps256_ps128(qy), _mm256_castps256_ps128(qz), _mm256_castps256_ps128(qw),
+			_mm256_castps256_ps128(sx), _mm256_castps256_ps128(sy), _mm256_castps256_ps128(sz), out);
+
+		StoreLocalMatrices(_mm256_extractf128_ps(tx, 1), _mm256_extractf128_ps(ty, 1), _mm256_extractf128_ps(tz, 1),
+			_mm256_extractf128_ps(qx, 1), _mm256_extractf128_ps(qy, 1), _mm256_extractf128_ps(qz, 1), _mm256_extractf128_ps(qw, 1),
+			_mm256_extractf128_ps(sx, 1), _mm256_extractf128_ps(sy, 1), _mm256_extractf128_ps(sz, 1), out + 4);
+	}
+#endif
+
+	// -- 4 Transforms per Iteration --
+	// The last lanes of an incomplete batch repeat the last transform (same result written again)
+	for (; i < count; i += 4)
+	{
+		uint id[4];
+		for (uint lane = 0; lane < 4; ++lane)
+			id[lane] = ids[glm::min(i + lane, count - 1)];
+
+		#define GATHER4(array) _mm_setr_ps(array[id[0]], array[id[1]], array[id[2]], array[id[3]])
+		__m128 tx = GATHER4(m_TranslationX), ty = GATHER4(m_TranslationY), tz = GATHER4(m_TranslationZ);
+		__m128 qx = GATHER4(m_RotationX), qy = GATHER4(m_RotationY), qz = GATHER4(m_RotationZ), qw = GATHER4(m_RotationW);
+		__m128 sx = GATHER4(m_ScaleX), sy = GATHER4(m_ScaleY), sz = GATHER4(m_ScaleZ);
+		#undef GATHER4
+
+		glm::mat4* out[4] = { &m_Local[id[0]], &m_Local[id[1]], &m_Local[id[2]], &m_Local[id[3]] };
+		StoreLocalMatrices(tx, ty, tz, qx, qy, qz, qw, sx, sy, sz, out);
+	}
+}
+
+
+
+// ------------------------------------------------------------------------------
+TransformsBenchmark TransformSystem::RunBenchmark(uint transforms_count)
+{
+	TransformsBenchmark ret;
+	ret.TransformsCount = transforms_count;
+
+	// -- Build Transforms --
+	// Chains of 4 (root & 3 descendants), deterministic pseudo-random values
+	std::vector<TransformComponent> components(transforms_count);
+	std::vector<uint> parents(transforms_count);
+	uint seed = 12345u;
+	auto random = [&seed](float min, float max) { seed = seed * 1664525u + 1013904223u; return min + (max - min) * (float)(seed >> 8) / (float)(1u << 24); };
+
+	TransformSystem system;
+	for (uint i = 0; i < transforms_count; ++i)
+	{
+		TransformComponent& component = components[i];
+		component.Translation = glm::vec3(random(-50.0f, 50.0f), random(-50.0f, 50.0f), random(-50.0f, 50.0f));
+		component.Rotation = glm::vec3(random(-180.0f, 180.0f), random(-180.0f, 180.0f), random(-180.0f, 180.0f));
+		component.Scale = glm::vec3(random(0.5f, 1.5f));
+
+		parents[i] = i % 4 == 0 ? s_NoParent : i - 1;
+		system.Create(parents[i]);
+		system.SetLocal(i, component);
+	}
+
+	// -- Naive --
+	std::vector<glm::mat4> naive_world(transforms_count);
+	Timer timer;
+	timer.Start();
+	for (uint i = 0; i < transforms_count; ++i)
+		naive_world[i] = parents[i] == s_NoParent ? components[i].GetTransform() : naive_world[parents[i]] * components[i].GetTransform();
+
+	ret.NaiveMs = timer.GetMilliseconds();
+
+	// -- Batched, All Dirty --
+	timer.Start();
+	system.Update(false);
+	ret.BatchedMs = timer.GetMilliseconds();
+
+	for (uint i = 0; i < transforms_count; ++i)
+		for (int c = 0; c < 4; ++c)
+			for (int r = 0; r < 4; ++r)
+				ret.MaxError = glm::max(ret.MaxError, glm::abs(naive_world[i][c][r] - system.GetWorld(i)[c][r]));
+
+	for (uint i = 0; i < transforms_count; ++i)
+		system.SetLocal(i, components[i]);
+
+	timer.Start();
+	system.Update(true);
+	ret.BatchedThreadedMs = timer.GetMilliseconds();
+
+	// -- Batched, 1% Dirty --
+	for (uint i = 0; i < transforms_count; i += 100)
+		system.SetLocal(i, components[i]);
+
+	timer.Start();
+	system.Update(true);
+	ret.PartialMs = timer.GetMilliseconds();
+
+	return ret;
+}
@@ -0,0 +1,77 @@
+#ifndef _TRANSFORMSYSTEM_H_
+#define _TRANSFORMSYSTEM_H_
+
+#include "Core/Globals.h"
+#include "TransformComponent.h"
+
+#include <glm/glm.hpp>
+
+
+// Timings (ms) of TransformSystem::RunBenchmark()
+struct TransformsBenchmark
+{
+	uint TransformsCount = 0;
+	float NaiveMs = 0.0f;				// TransformComponent::GetTransform() & parent product for all, every time
+	float BatchedMs = 0.0f;				// All dirty, SIMD batch in 1 thread
+	float BatchedThreadedMs = 0.0f;		// All dirty, SIMD batch split across threads
+	float PartialMs = 0.0f;				// 1% dirty
+	float MaxError = 0.0f;				// Between naive & batched world matrices
+};
+
+
+// Cached local & world matrices of a set of transforms, stored as structure-of-arrays
+// Changing a transform marks it dirty, Update() propagates it down its hierarchy & recomputes only the dirty ones: the local matrices
+// in a batched SSE (AVX2 if available) loop, optionally split across threads, then the world ones parents first
+class TransformSystem
+{
+public:
+
+	static constexpr uint s_NoParent = ~0u;
+
+	// --- Transforms ---
+	// Parents must be created before their children (so a single forward pass resolves a hierarchy)
+	uint Create(uint parent = s_NoParent);
+	void Clear();
+
+	void SetLocal(uint id, const glm::vec3& translation, const glm::vec3& rotation_degrees, const glm::vec3& scale);
+	void SetLocal(uint id, const TransformComponent& transform) { SetLocal(id, transform.Translation, transform.Rotation, transform.Scale); }
+
+	// Recomputes the dirty transforms & their descendants
+	void Update(bool multithreaded = true);
+
+	// --- Getters ---
+	const glm::mat4& GetLocal(uint id)		const	{ return m_Local[id]; }
+	const glm::mat4& GetWorld(uint id)		const	{ return m_World[id]; }
+	uint GetCount()							const	{ return (uint)m_Parents.size(); }
+
+	// Transforms whose world matrix changed in the last Update() (ascending)
+	const std::vector<uint>& GetUpdated()	const	{ return m_Updated; }
+
+	// --- Benchmark ---
+	// Hierarchies of 4 levels, compares the naive path with the batched updates
+	static TransformsBenchmark RunBenchmark(uint transforms_count = 100000);
+
+private:
+
+	// Local matrices of the transforms in the list (SoA lanes gathered by index)
+	void ComputeLocalMatrices(const uint* ids, uint count);
+
+private:
+
+	enum TRANSFORM_FLAGS : uint8_t { LOCAL_DIRTY = 1 << 0, WORLD_DIRTY = 1 << 1 };
+
+	// --- Local TRS (SoA) ---
+	std::vector<float> m_TranslationX, m_TranslationY, m_TranslationZ;
+	std::vector<float> m_RotationX, m_RotationY, m_RotationZ, m_RotationW; // Quaternion
+	std::vector<float> m_ScaleX, m_ScaleY, m_ScaleZ;
+
+	// --- Hierarchy & Cache ---
+	std::vector<uint> m_Parents;
+	std::vector<uint8_t> m_Flags;
+	std::vector<glm::mat4> m_Local, m_World;
+
+	std::vector<uint> m_LocalDirty, m_Updated;
+	bool m_AnyDirty = false;
+};
+
+#endif //_TRANSFORMSYSTEM_H_
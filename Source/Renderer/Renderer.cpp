@@ -6,22 +6,40 @@
 #include "Utils/RendererPrimitives.h"
 
 #include "Resources/Texture.h"
+#include "Resources/TextureLoader.h"
+#include "Core/Utils/JobSystem.h"
 
 #include <glad/glad.h>
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cfloat>
 
 
 // ------------------------------------------------------------------------------
 RendererStatistics Renderer::m_RendererStatistics = {};
 UniformBuffer* Renderer::m_CameraUniformBuffer = nullptr;
+glm::mat4 Renderer::m_ViewProjection = glm::mat4(1.0f);
+float Renderer::m_ViewportHeight = 1.0f;
 
 Light Renderer::m_DirectionalLight = {};
 ShaderStorageBuffer* Renderer::m_LightsSSBuffer = nullptr;
-std::vector<PointLight> Renderer::m_Lights = {};
-uint Renderer::m_LightsIndex = 0;
 Ref<Model> Renderer::m_Sphere = nullptr;
+Ref<ModelsBatch> Renderer::m_SphereLoad = nullptr;
 Ref<Material> Renderer::m_DefaultMaterial = nullptr;
 Ref<Material> Renderer::m_MagentaMaterial = nullptr;
+std::vector<Renderer::DrawCommand> Renderer::m_DrawCommands = {};
+uint Renderer::m_BoundTextures[s_TextureSlots] = {};
+
+bool Renderer::m_MeshletsCulling = true;
+Ref<Shader> Renderer::m_MeshletCullingShader = nullptr;
+UniquePtr<StorageBuffer> Renderer::m_MeshletCommandsBuffer = nullptr;
+UniquePtr<StorageBuffer> Renderer::m_MeshletCountsBuffers[s_MeshletCountsFrames] = {};
+uint Renderer::m_MeshletCountsFrame = 0;
+
+static const uint s_DrawCommandsBatchSize = 256;
+static const uint s_MeshletsBinding = 1, s_MeshletCommandsBinding = 2, s_MeshletCountsBinding = 3;	// SSBOs of the culling shader
+static const uint s_IndirectCommandSize = 5 * sizeof(uint);											// DrawElementsIndirectCommand
+static const uint s_MeshletsGroupSize = 64;
 // ------------------------------------------------------------------------------
 
 
@@ -35,6 +53,13 @@ void Renderer::Init()
 	ASSERT((v_maj == 4 && v_min <= 6), "Wrong OpenGL version!");
 	SetRendererStatistics(v_maj, v_min);
 
+	// Meshlets draws need glMultiDrawElementsIndirectCount (4.6), not loaded in older contexts
+	if (!GLAD_GL_VERSION_4_6)
+	{
+		ENGINE_LOG("OpenGL %i.%i lacks glMultiDrawElementsIndirectCount, meshlets culling disabled", v_maj, v_min);
+		m_MeshletsCulling = false;
+	}
+
 	// -- Enable OGL Debugging --
 	#ifdef _DEBUG
 		glEnable(GL_DEBUG_OUTPUT);
@@ -50,15 +75,16 @@ void Renderer::Init()
 	RenderCommand::SetScissorTest(true);
 
 
+	// -- Start Async Texture Loads --
+	TextureLoader::Init();
+
 	// -- Load Default Materials, Textures & Meshes --
-	m_MagentaMaterial = *Resources::CreateMaterial("Magenta Material");
-	m_DefaultMaterial = *Resources::CreateMaterial("Default Material");
+	m_MagentaMaterial = Resources::CreateMaterial("Magenta Material");
+	m_DefaultMaterial = Resources::CreateMaterial("Default Material");
 	LoadDefaultTextures();
 
-	m_Sphere = Resources::CreateModel("Resources/Models/Sphere.obj");
-	m_Sphere->GetRootMesh()->SetMaterial(m_DefaultMaterial->m_ID);
-	m_Sphere->GetTransformation().Translation = glm::vec3(1.0f);
-	m_Sphere->GetTransformation().Scale = glm::vec3(0.1f);
+	// Finished on its first use, so it loads along with the scene models
+	m_SphereLoad = Resources::CreateModelsAsync({ "Resources/Models/Sphere.obj" });
 
 
 	// -- Create the Uniform Buffer for the Camera --
@@ -82,14 +108,26 @@ void Renderer::Init()
 	}
 
 	m_LightsSSBuffer = new ShaderStorageBuffer(lights_ssbo_layout, 0);
+
+	// -- Shaders Compilation & Meshlets Culling Shader --
+	Shader::InitCompilation();
+	m_MeshletCullingShader = CreateRef<Shader>("Resources/Shaders/MeshletCullingShader.glsl");
 }
 
 void Renderer::Shutdown()
 {
+	TextureLoader::Shutdown();
 	RendererPrimitives::DefaultTextures::CleanUp();
 	delete m_CameraUniformBuffer;
 	delete m_LightsSSBuffer;
-	m_Lights.clear();
+	m_MeshletCullingShader.reset();
+	Shader::ShutdownCompilation();
+	m_MeshletCommandsBuffer.reset();
+	for (UniquePtr<StorageBuffer>& counts_buffer : m_MeshletCountsBuffers)
+		counts_buffer.reset();
+
+	m_SphereLoad.reset();
+	m_Sphere.reset();
 }
 
 void Renderer::OnWindowResized(uint width, uint height)
@@ -100,47 +138,54 @@ void Renderer::OnWindowResized(uint width, uint height)
 
 
 // ------------------------------------------------------------------------------
-void Renderer::AddLight()
+void Renderer::SetSceneLights(EntityRegistry& scene)
 {
-	if (m_Lights.size() < RendererUtils::s_MaxLights)
-	{
-		int id = m_LightsIndex;
-		++m_LightsIndex;
-		m_Lights.push_back(PointLight(id));
-	}
-	else
-		ENGINE_LOG("Cannot add more lights! Max Lights (%i) reached!", RendererUtils::s_MaxLights);
+	// Active lights written compactly, in the packed order of the lights pool
+	int curr_lights = 0;
+	m_LightsSSBuffer->Bind();
+	scene.View<PointLight>().Each([&curr_lights](Entity, PointLight& light)
+		{
+			if (!light.Active || curr_lights >= (int)RendererUtils::s_MaxLights)
+				return;
+
+			char uniform_name[16];
+			sprintf_s(uniform_name, 16, "PLightsVec[%i].", curr_lights);
+			light.SetLightData(m_LightsSSBuffer, uniform_name);
+			++curr_lights;
+		});
+
+	m_LightsSSBuffer->SetData("CurrentLights", glm::value_ptr(glm::ivec4(curr_lights, 0, 0, 0)));
+	m_LightsSSBuffer->Unbind();
 }
 
-void Renderer::RemoveLight(uint light_id)
+void Renderer::DrawLightsSpheres(const Ref<Shader>& shader, EntityRegistry& scene)
 {
-	std::vector<PointLight>::iterator it = m_Lights.begin();
-	for (; it != m_Lights.end(); ++it)
+	// -- Finish Sphere Load --
+	if (m_SphereLoad)
 	{
-		if ((*it) == light_id)
-		{
-			m_Lights.erase(it);
-			return;
-		}
+		m_Sphere = Resources::FinishModels(m_SphereLoad)[0];
+		m_SphereLoad.reset();
+
+		if (m_Sphere)
+			m_Sphere->GetRootMesh()->SetMaterial(m_DefaultMaterial->m_ID);
 	}
-}
 
-void Renderer::DrawLightsSpheres(const Ref<Shader>& shader)
-{
+	if (!m_Sphere)
+		return;
+
 	RenderCommand::SetWireframeDraw();
 	shader->Bind();
 
-	for (uint i = 0; i < m_Lights.size(); ++i)
-	{
-		if (m_Lights[i].Active)
+	scene.View<PointLight>().Each([&shader](Entity, PointLight& light)
 		{
-			float light_rad = m_Lights[i].GetLightRadius(10.0f);
+			if (!light.Active)
+				return;
 
-			m_Sphere->GetTransformation().Translation = m_Lights[i].Position;
-			m_Sphere->GetTransformation().Scale = glm::vec3(light_rad);
-			SubmitModel(shader, m_Sphere);
-		}
-	}
+			// Own transform for each light, the sphere model is shared (no rotation, so no need for the full TRS)
+			float light_rad = light.GetLightRadius(10.0f);
+			glm::mat4 transform = glm::translate(glm::mat4(1.0f), light.Position) * glm::scale(glm::mat4(1.0f), glm::vec3(light_rad));
+			RenderMesh(shader, m_Sphere->GetRootMesh(), transform);
+		});
 
 	shader->Unbind();
 	RenderCommand::ResetWireframeDraw();
@@ -163,22 +208,15 @@ void Renderer::SetSceneData(const glm::mat4& viewproj_mat, const glm::vec3& view
 	m_CameraUniformBuffer->SetData("CamPosition", glm::value_ptr(glm::vec4(view_position, 0.0f)));
 	m_CameraUniformBuffer->Unbind();
 
-	// -- Set PLighs SSBO --
-	int curr_lights = 0;
-	m_LightsSSBuffer->Bind();
-	for (uint i = 0; i < m_Lights.size(); ++i) // TODO: move this from here (should be on Begin())
-	{
-		if (m_Lights[i].Active)
-		{
-			char uniform_name[16];
-			sprintf_s(uniform_name, 16, "PLightsVec[%i].", i);
-			m_Lights[i].SetLightData(m_LightsSSBuffer, uniform_name);
-			++curr_lights;
-		}
-	}
+	// -- Per-Frame Statistics --
+	m_RendererStatistics.DrawCalls = 0;
+	m_RendererStatistics.TextureBinds = 0;
 
-	m_LightsSSBuffer->SetData("CurrentLights", glm::value_ptr(glm::ivec4(curr_lights, 0, 0, 0)));
-	m_LightsSSBuffer->Unbind();
+	// -- Keep Camera Data for Textures Streaming --
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	m_ViewProjection = viewproj_mat;
+	m_ViewportHeight = (float)viewport[3];
 }
 
 void Renderer::BeginScene(const Ref<Shader>& shader, bool set_directional_lights)
@@ -204,69 +242,173 @@ void Renderer::RenderMesh(const Ref<Shader>& shader, const Mesh* mesh, const glm
 	for (uint i = 0; i < mesh->m_Submeshes.size(); ++i)
 		RenderMesh(shader, mesh->m_Submeshes[i].get(), transform);
 
+	if (!mesh->m_VertexArray || !mesh->m_VertexArray->GetIndexBuffer())
+		return;
+
+	RenderScene::DrawRange draw_range = { mesh->m_VertexArray.get(), 0, mesh->m_VertexArray->GetIndexBuffer()->GetCount() };
+	glm::mat4 mesh_transform = transform * mesh->GetLocalTransform();
+	IssueDrawCommand(shader, BuildDrawCommand(draw_range, mesh->GetMaterial(), mesh_transform, mesh->GetBounds().GetBoundingSphere(mesh_transform)));
+}
+
+
+Renderer::DrawCommand Renderer::BuildDrawCommand(const RenderScene::DrawRange& draw_range, MaterialHandle material, const glm::mat4& transform, const glm::vec4& world_sphere, bool albedo_uv_baked)
+{
+	DrawCommand command;
+	command.Range = &draw_range;
+	command.Transform = &transform;
+
 	// -- Material & Texture Retrieval --
-	Ref<Material> mesh_mat = Resources::GetMaterial(mesh->GetMaterialIndex());
-	Resources::TexturesIndex alb_binding = Resources::TexturesIndex::MAGENTA, norm_binding = Resources::TexturesIndex::TESTNORMAL,
-		bump_binding = Resources::TexturesIndex::BLACK;
-	
-	if (mesh_mat->GetID() == m_DefaultMaterial->GetID())
-		alb_binding = Resources::TexturesIndex::WHITE;
+	// Meshes without material (or with a deleted one) render with the magenta one
+	Material* mesh_mat = Resources::GetMaterialPtr(material);
+	if (!mesh_mat)
+		mesh_mat = m_MagentaMaterial.get();
 
-	Texture* albedo = nullptr;
-	Texture* normal = nullptr;
-	Texture* bump = nullptr;
+	command.DrawMaterial = mesh_mat;
+	if (!albedo_uv_baked)
+		command.AlbedoUVTransform = mesh_mat->AlbedoUVTransform;
 
-	if (mesh_mat)
+	if (mesh_mat == m_DefaultMaterial.get())
+		command.AlbedoBinding = Resources::TexturesIndex::WHITE;
+
+	if (mesh_mat->Albedo && mesh_mat->Albedo->IsResident())
 	{
-		if (mesh_mat->Albedo)
-		{
-			albedo = mesh_mat->Albedo.get();
-			alb_binding = Resources::TexturesIndex::ALBEDO;
-		}
-		if (mesh_mat->Normal)
-		{
-			normal = mesh_mat->Normal.get();
-			norm_binding = Resources::TexturesIndex::NORMAL;
-		}
-		if (mesh_mat->Bump)
-		{
-			bump = mesh_mat->Bump.get();
-			bump_binding = Resources::TexturesIndex::BUMP;
-		}
+		command.Albedo = mesh_mat->Albedo.get();
+		command.AlbedoBinding = Resources::TexturesIndex::ALBEDO;
+	}
+	if (mesh_mat->Normal && mesh_mat->Normal->IsResident())
+	{
+		command.Normal = mesh_mat->Normal.get();
+		command.NormalBinding = Resources::TexturesIndex::NORMAL;
+	}
+	if (mesh_mat->Bump && mesh_mat->Bump->IsResident())
+	{
+		command.Bump = mesh_mat->Bump.get();
+		command.BumpBinding = Resources::TexturesIndex::BUMP;
 	}
 
-	// -- Shader Bindings --
-	Renderer::BindTexture(alb_binding, albedo);
-	Renderer::BindTexture(norm_binding, normal);
-	Renderer::BindTexture(bump_binding, bump);
+	if (mesh_mat->Albedo || mesh_mat->Normal || mesh_mat->Bump)
+		command.ProjectedSize = GetProjectedSize(world_sphere);
 
-	shader->SetUniformMat4("u_Model", transform);
-	shader->SetUniformInt("u_Albedo", (int)alb_binding);
-	shader->SetUniformInt("u_Normal", (int)norm_binding);
-	shader->SetUniformInt("u_Bump", (int)bump_binding);
+	// -- Shader Variant --
+	// Only the features it uses: maps not resident yet are left out (their defaults changed nothing), so are their fetches & loops
+	if (command.Normal)
+		command.ShaderKeywords |= Shader::HAS_NORMAL_MAP;
+	if (command.Bump)
+		command.ShaderKeywords |= Shader::HAS_PARALLAX;
+	if (mesh_mat->IsTwoSided)
+		command.ShaderKeywords |= Shader::TWO_SIDED;
+	if (mesh_mat->IsAlphaTested)
+		command.ShaderKeywords |= Shader::ALPHA_TEST;
+
+	return command;
+}
+
+
+bool Renderer::DrawCommandBefore(const DrawCommand& a, const DrawCommand& b)
+{
+	// Textures by their GL storage (the ones sharing an atlas have the same), default ones by their binding
+	auto texture_key = [](const Texture* texture, Resources::TexturesIndex binding) { return texture ? ((uint64)texture->GetTextureID() << 8) : (uint64)binding; };
+
+	if (a.ShaderKeywords != b.ShaderKeywords)
+		return a.ShaderKeywords < b.ShaderKeywords;
+
+	uint64 a_albedo = texture_key(a.Albedo, a.AlbedoBinding), b_albedo = texture_key(b.Albedo, b.AlbedoBinding);
+	if (a_albedo != b_albedo)
+		return a_albedo < b_albedo;
+
+	uint64 a_normal = texture_key(a.Normal, a.NormalBinding), b_normal = texture_key(b.Normal, b.NormalBinding);
+	if (a_normal != b_normal)
+		return a_normal < b_normal;
+
+	return texture_key(a.Bump, a.BumpBinding) < texture_key(b.Bump, b.BumpBinding);
+}
+
+
+void Renderer::IssueDrawCommand(const Ref<Shader>& shader, const DrawCommand& command)
+{
+	// -- Request Textures Levels --
+	// Albedos baked into an atlas cover only their rect of it, so the whole texture would be that much bigger on screen
+	Material* mesh_mat = command.DrawMaterial;
+	if (mesh_mat->Albedo)
+	{
+		float albedo_scale = std::max(mesh_mat->AlbedoUVTransform.x, mesh_mat->AlbedoUVTransform.y);
+		TextureLoader::RequestLevel(mesh_mat->Albedo.get(), TextureLoader::GetStreamingLevel(mesh_mat->Albedo.get(), command.ProjectedSize / albedo_scale));
+	}
+	if (mesh_mat->Normal)
+		TextureLoader::RequestLevel(mesh_mat->Normal.get(), TextureLoader::GetStreamingLevel(mesh_mat->Normal.get(), command.ProjectedSize));
+	if (mesh_mat->Bump)
+		TextureLoader::RequestLevel(mesh_mat->Bump.get(), TextureLoader::GetStreamingLevel(mesh_mat->Bump.get(), command.ProjectedSize));
+
+	// -- Shader Variant & Bindings --
+	// The uniforms of the features a variant lacks are compiled out of it
+	const uint keywords = command.ShaderKeywords & shader->GetKeywords();
+	shader->Bind(keywords);
+
+	Renderer::BindTexture(command.AlbedoBinding, command.Albedo);
+	Renderer::BindTexture(command.NormalBinding, command.Normal);
+	Renderer::BindTexture(command.BumpBinding, command.Bump);
+
+	shader->SetUniformMat4("u_Model", *command.Transform);
+	shader->SetUniformInt("u_Albedo", (int)command.AlbedoBinding);
 	shader->SetUniformVec4("u_Material.AlbedoColor", mesh_mat->AlbedoColor);
+	shader->SetUniformVec4("u_Material.AlbedoUVTransform", command.AlbedoUVTransform);
 	shader->SetUniformFloat("u_Material.Smoothness", mesh_mat->Smoothness);
-	shader->SetUniformFloat("u_Material.Bumpiness", mesh_mat->Bumpiness);
-	shader->SetUniformFloat("u_Material.Heighscale", mesh_mat->Heightscale);
-	shader->SetUniformFloat("u_Material.ParallaxLayers", mesh_mat->ParallaxLayers);
+
+	if ((keywords & Shader::HAS_NORMAL_MAP) || shader->GetKeywords() == 0)
+	{
+		shader->SetUniformInt("u_Normal", (int)command.NormalBinding);
+		shader->SetUniformFloat("u_Material.Bumpiness", mesh_mat->Bumpiness);
+	}
+	if ((keywords & Shader::HAS_PARALLAX) || shader->GetKeywords() == 0)
+	{
+		shader->SetUniformInt("u_Bump", (int)command.BumpBinding);
+		shader->SetUniformFloat("u_Material.Heighscale", mesh_mat->Heightscale);
+		shader->SetUniformFloat("u_Material.ParallaxLayers", mesh_mat->ParallaxLayers);
+	}
+	if ((keywords & Shader::ALPHA_TEST) || shader->GetKeywords() == 0)
+		shader->SetUniformFloat("u_Material.AlphaCutoff", mesh_mat->AlphaCutoff);
 
 	if (mesh_mat->IsTwoSided)
 		RenderCommand::SetFaceCulling(false);
 	else
 		RenderCommand::SetFaceCulling(true);
 
-	// -- Draw Call & Unbinds --
-	mesh->m_VertexArray->Bind();
-	RenderCommand::DrawIndexed(mesh->m_VertexArray);
-	mesh->m_VertexArray->Unbind();
+	// -- Draw Call --
+	// Draws with meshlets culled this frame draw only the visible ones, with the commands (& count) the culling pass wrote
+	const RenderScene::DrawRange& draw_range = *command.Range;
+	draw_range.DrawVertexArray->Bind();
+	if (command.DrawMeshlets)
+	{
+		const StorageBuffer* counts_buffer = m_MeshletCountsBuffers[m_MeshletCountsFrame].get();
+		m_MeshletCommandsBuffer->Bind(GL_DRAW_INDIRECT_BUFFER);
+		counts_buffer->Bind(GL_PARAMETER_BUFFER);
+		RenderCommand::DrawIndexedIndirectCount((uint64)command.FirstMeshletCommand * s_IndirectCommandSize, (uint64)(1 + command.MeshletsDrawSlot) * sizeof(uint), draw_range.MeshletsCount);
+		counts_buffer->Unbind(GL_PARAMETER_BUFFER);
+		m_MeshletCommandsBuffer->Unbind(GL_DRAW_INDIRECT_BUFFER);
+	}
+	else
+		RenderCommand::DrawIndexedRange(draw_range.IndexCount, draw_range.FirstIndex);
 
-	Renderer::UnbindTexture(bump_binding, bump);
-	Renderer::UnbindTexture(norm_binding, normal);
-	Renderer::UnbindTexture(alb_binding, albedo);
+	draw_range.DrawVertexArray->Unbind();
+	++m_RendererStatistics.DrawCalls;
 	RenderCommand::SetFaceCulling(false);
 }
 
 
+float Renderer::GetProjectedSize(const glm::vec4& world_sphere)
+{
+	// -- Projected Diameter --
+	// Camera inside or behind the sphere needs the finest level
+	float radius = world_sphere.w;
+	glm::vec4 clip_center = m_ViewProjection * glm::vec4(glm::vec3(world_sphere), 1.0f);
+	if (clip_center.w <= radius)
+		return FLT_MAX;
+
+	float projection_scale = glm::length(glm::vec3(m_ViewProjection[0][1], m_ViewProjection[1][1], m_ViewProjection[2][1])); // Vertical focal length
+	return radius * 2.0f * projection_scale * m_ViewportHeight * 0.5f / clip_center.w;
+}
+
+
 void Renderer::SubmitModel(const Ref<Shader>& shader, const Ref<Model>& model)
 {
 	if (!model->GetTransformation().EntityActive)
@@ -274,10 +416,126 @@ void Renderer::SubmitModel(const Ref<Shader>& shader, const Ref<Model>& model)
 
 	shader->Bind();
 	RenderMesh(shader, model->GetRootMesh(), model->GetTransformation().GetTransform());
+	UnbindTextures();
 	shader->Unbind();
 }
 
 
+void Renderer::SubmitScene(const Ref<Shader>& shader, const RenderScene& scene)
+{
+	// Only the draws that passed the last RenderScene::Cull(), linearly through its arrays
+	// Commands built across the jobs threads (resolving materials & textures), then issued in order on this one
+	const uint draws_count = (uint)scene.m_VisibleDraws.size();
+	m_DrawCommands.resize(draws_count);
+	JobSystem::ParallelFor(draws_count, s_DrawCommandsBatchSize, [&scene](uint first, uint count)
+		{
+			for (uint i = first; i < first + count; ++i)
+			{
+				uint draw = scene.m_VisibleDraws[i];
+				bool albedo_uv_baked = (scene.m_Flags[draw] & RenderScene::DRAW_ALBEDO_UV_BAKED) != 0;
+				m_DrawCommands[i] = BuildDrawCommand(scene.m_DrawRanges[draw], scene.m_Materials[draw], scene.m_WorldMatrices[draw], scene.m_WorldSpheres[draw], albedo_uv_baked);
+			}
+		});
+
+	// Opaque ones grouped by shader variant & textures, so consecutive draws skip their binds
+	// Blended ones (transparent materials) are issued after them in the scene order, as their result depends on it
+	auto transparent_begin = std::stable_partition(m_DrawCommands.begin(), m_DrawCommands.end(), [](const DrawCommand& command) { return !command.DrawMaterial->IsTransparent; });
+	std::stable_sort(m_DrawCommands.begin(), transparent_begin, DrawCommandBefore);
+
+	// The draws with meshlets get them culled on the GPU once its shader is compiled, then draw the visible ones only
+	m_MeshletCullingShader->UpdateCompilation();
+	if (m_MeshletsCulling && GLAD_GL_VERSION_4_6 && m_MeshletCullingShader->IsReady())
+		CullMeshlets();
+	else
+		m_RendererStatistics.DrawnMeshlets = 0;
+
+	shader->Bind();
+	for (const DrawCommand& command : m_DrawCommands)
+		IssueDrawCommand(shader, command);
+
+	UnbindTextures();
+	shader->Unbind();
+
+	m_RendererStatistics.SceneDraws = scene.GetDrawsCount();
+	m_RendererStatistics.CulledDraws = scene.GetDrawsCount() - scene.GetVisibleDrawsCount();
+	m_RendererStatistics.SceneMeshlets = scene.GetMeshletsCount();
+}
+
+
+void Renderer::CullMeshlets()
+{
+	// -- Commands Ranges --
+	// Each draw gets room for all its meshlets in the commands buffer & a count in the counts one (after the frame total)
+	uint meshlets_count = 0, meshlet_draws = 0;
+	for (DrawCommand& command : m_DrawCommands)
+	{
+		command.DrawMeshlets = command.Range->Meshlets && command.Range->MeshletsCount > 0;
+		if (!command.DrawMeshlets)
+			continue;
+
+		command.FirstMeshletCommand = meshlets_count;
+		command.MeshletsDrawSlot = meshlet_draws++;
+		meshlets_count += command.Range->MeshletsCount;
+	}
+
+	if (meshlet_draws == 0)
+	{
+		m_RendererStatistics.DrawnMeshlets = 0;
+		return;
+	}
+
+	// -- Rotate Counts Buffers --
+	// The one reused this frame was written s_MeshletCountsFrames frames ago, so its total is read back without waiting for the GPU
+	m_MeshletCountsFrame = (m_MeshletCountsFrame + 1) % s_MeshletCountsFrames;
+	UniquePtr<StorageBuffer>& counts_buffer = m_MeshletCountsBuffers[m_MeshletCountsFrame];
+	if (counts_buffer)
+		counts_buffer->GetData(&m_RendererStatistics.DrawnMeshlets, sizeof(uint));
+
+	// -- Grow Buffers --
+	// With some slack, so they aren't reallocated while the visible draws change
+	uint64 counts_size = (uint64)(1 + meshlet_draws) * sizeof(uint), commands_size = (uint64)meshlets_count * s_IndirectCommandSize;
+	if (!counts_buffer || counts_buffer->GetGPUBytes() < counts_size)
+		counts_buffer = CreateUnique<StorageBuffer>(nullptr, counts_size + counts_size / 2);
+
+	if (!m_MeshletCommandsBuffer || m_MeshletCommandsBuffer->GetGPUBytes() < commands_size)
+		m_MeshletCommandsBuffer = CreateUnique<StorageBuffer>(nullptr, commands_size + commands_size / 2);
+
+	counts_buffer->Clear(counts_size);
+
+	// -- Dispatch Culling --
+	// A thread per meshlet. Cone culling is skipped where backfaces are visible (two-sided) or the transform doesn't keep the normals directions
+	m_MeshletCullingShader->Bind();
+	m_MeshletCommandsBuffer->BindBase(s_MeshletCommandsBinding);
+	counts_buffer->BindBase(s_MeshletCountsBinding);
+
+	for (const DrawCommand& command : m_DrawCommands)
+	{
+		if (!command.DrawMeshlets)
+			continue;
+
+		const glm::mat4& transform = *command.Transform;
+		glm::vec3 scale = glm::vec3(glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2])));
+		float max_scale = glm::max(scale.x, glm::max(scale.y, scale.z)), min_scale = glm::min(scale.x, glm::min(scale.y, scale.z));
+		bool cone_culling = !command.DrawMaterial->IsTwoSided && glm::determinant(glm::mat3(transform)) > 0.0f && max_scale - min_scale <= max_scale * 0.01f;
+
+		command.Range->Meshlets->BindBase(s_MeshletsBinding);
+		m_MeshletCullingShader->SetUniformMat4("u_Model", transform);
+		m_MeshletCullingShader->SetUniformFloat("u_ModelScale", max_scale);
+		m_MeshletCullingShader->SetUniformInt("u_MeshletsCount", (int)command.Range->MeshletsCount);
+		m_MeshletCullingShader->SetUniformInt("u_FirstIndex", (int)command.Range->FirstIndex);
+		m_MeshletCullingShader->SetUniformInt("u_FirstCommand", (int)command.FirstMeshletCommand);
+		m_MeshletCullingShader->SetUniformInt("u_DrawSlot", (int)command.MeshletsDrawSlot);
+		m_MeshletCullingShader->SetUniformInt("u_ConeCulling", cone_culling);
+		RenderCommand::DispatchCompute((command.Range->MeshletsCount + s_MeshletsGroupSize - 1) / s_MeshletsGroupSize);
+	}
+
+	m_MeshletCullingShader->Unbind();
+
+	// Commands & counts written before the draws (and the statistics read back) use them
+	RenderCommand::InsertMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+
 void Renderer::Submit(const Ref<Shader>& shader, const Ref<VertexArray>& vertex_array, const glm::mat4& transform)
 {
 	shader->SetUniformMat4("u_Model", transform);
@@ -302,11 +560,20 @@ void Renderer::BindTexture(Resources::TexturesIndex texture_type, Texture* textu
 	uint materials_textures_pos = (uint)Resources::TexturesIndex::ALBEDO;
 
 	if (index < materials_textures_pos)
-		RendererPrimitives::DefaultTextures::GetTextureFromIndex(index)->Bind(index);
-	else if (index >= materials_textures_pos && texture)
-		texture->Bind(index);
-	else
+		texture = RendererPrimitives::DefaultTextures::GetTextureFromIndex(index);
+	else if (!texture)
+	{
 		ENGINE_LOG("Tried to Bind a nullptr texture!");
+		return;
+	}
+
+	// -- Redundant Binds --
+	if (m_BoundTextures[index] == texture->GetTextureID())
+		return;
+
+	texture->Bind(index);
+	m_BoundTextures[index] = texture->GetTextureID();
+	++m_RendererStatistics.TextureBinds;
 }
 
 void Renderer::UnbindTexture(Resources::TexturesIndex texture_type, Texture* texture)
@@ -320,6 +587,21 @@ void Renderer::UnbindTexture(Resources::TexturesIndex texture_type, Texture* tex
 		texture->Unbind();
 	else
 		ENGINE_LOG("Tried to Unbind a nullptr texture!");
+
+	m_BoundTextures[index] = 0;
+}
+
+void Renderer::UnbindTextures()
+{
+	for (uint slot = 0; slot < s_TextureSlots; ++slot)
+	{
+		if (m_BoundTextures[slot] == 0)
+			continue;
+
+		glActiveTexture(GL_TEXTURE0 + slot);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		m_BoundTextures[slot] = 0;
+	}
 }
 
 
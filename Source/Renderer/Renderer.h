@@ -7,6 +7,7 @@
 #include "Resources/Buffers.h"
 #include "Resources/Shader.h"
 #include "Entities/Lights.h"
+#include "Entities/RenderScene.h"
 
 #include <glm/glm.hpp>
 
@@ -17,6 +18,10 @@ struct RendererStatistics
 
 	uint OGL_MinorVersion = 0, OGL_MajorVersion = 0;
 	uint DrawCalls = 0, QuadCount = 0;
+	uint TextureBinds = 0;						// The ones the draws needed (already bound ones are skipped)
+	uint SceneDraws = 0, CulledDraws = 0;
+	uint SceneMeshlets = 0, DrawnMeshlets = 0;	// Drawn ones read back from the GPU culling, a few frames late
+	uint FBOReallocations = 0;
 
 	uint GetTotalVerticesCount()	const { return QuadCount * 4; }
 	uint GetTotalIndicesCount()		const { return QuadCount * 6; }
@@ -34,12 +39,11 @@ public:
 
 
 	// --- Lighting Stuff ---
-	static void AddLight();
-	static void RemoveLight(uint light_id);
-	static std::vector<PointLight>& GetLights()	{ return m_Lights; }
+	// Point lights are the PointLight components of the scene entities (up to RendererUtils::s_MaxLights active)
 	static Light& GetDirectionalLight()			{ return m_DirectionalLight; }
+	static void SetSceneLights(EntityRegistry& scene);
 	
-	static void DrawLightsSpheres(const Ref<Shader>& shader);
+	static void DrawLightsSpheres(const Ref<Shader>& shader, EntityRegistry& scene);
 
 
 	// --- Rendering Stuff ---
@@ -56,12 +60,24 @@ public:
 	// Needs an already-bound shader!
 	static void SubmitModel(const Ref<Shader>& shader, const Ref<Model>& model);
 
+	// Needs the scene updated & culled for this frame (see RenderScene)
+	static void SubmitScene(const Ref<Shader>& shader, const RenderScene& scene);
+
+	// Scene draws with meshlets draw only the ones passing the GPU culling (frustum & normal cone), otherwise their whole range
+	// Needs OpenGL 4.6 (glMultiDrawElementsIndirectCount), older contexts always draw the whole ranges
+	static void SetMeshletsCulling(bool enable)		{ m_MeshletsCulling = enable && GLAD_GL_VERSION_4_6; }
+	static bool IsMeshletsCullingEnabled()			{ return m_MeshletsCulling; }
+
 
 	// --- Resources Stuff ---
 	// If a default texture is to be bound, just pass its TexturesIndex and a nullptr, otherwise pass the desired index (albedo, specular...) and a pointer to the texture
+	// Binding the texture already bound in that slot (by the renderer) does nothing
 	static void BindTexture(Resources::TexturesIndex texture_type, Texture* texture = nullptr);
 	static void UnbindTexture(Resources::TexturesIndex texture_type, Texture* texture = nullptr);
 
+	// Unbinds every texture bound by BindTexture(), so the next binds don't rely on the slots state
+	static void UnbindTextures();
+
 	// --- Events ---
 	static void OnWindowResized(uint width, uint height);
 
@@ -70,10 +86,43 @@ public:
 	// --- Getters ---
 	static const RendererStatistics& GetStatistics() { return m_RendererStatistics; }
 
+	// --- Statistics ---
+	static void AddFramebufferReallocation() { ++m_RendererStatistics.FBOReallocations; }
+
 private:
 
+	// Draw with its material & textures resolved: built on any thread (reads only), issued in order on the render one
+	struct DrawCommand
+	{
+		const RenderScene::DrawRange* Range = nullptr;
+		const glm::mat4* Transform = nullptr;
+		Material* DrawMaterial = nullptr;
+
+		Texture* Albedo = nullptr, *Normal = nullptr, *Bump = nullptr;
+		Resources::TexturesIndex AlbedoBinding = Resources::TexturesIndex::MAGENTA;
+		Resources::TexturesIndex NormalBinding = Resources::TexturesIndex::TESTNORMAL;
+		Resources::TexturesIndex BumpBinding = Resources::TexturesIndex::BLACK;
+		glm::vec4 AlbedoUVTransform = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);	// The material one, unless the draw UVs have it baked
+		float ProjectedSize = 0.0f;	// For the textures streaming levels
+		uint ShaderKeywords = 0;	// Of the cheapest shader variant for its material & bound textures
+
+		bool DrawMeshlets = false;	// Set by CullMeshlets(), draws the commands it output
+		uint FirstMeshletCommand = 0, MeshletsDrawSlot = 0;
+	};
+
 	// --- Private Rendering Stuff ---
 	static void RenderMesh(const Ref<Shader>& shader, const Mesh* mesh, const glm::mat4& transform = glm::mat4(1.0f));
+	static DrawCommand BuildDrawCommand(const RenderScene::DrawRange& draw_range, MaterialHandle material, const glm::mat4& transform, const glm::vec4& world_sphere, bool albedo_uv_baked = false);
+	static void IssueDrawCommand(const Ref<Shader>& shader, const DrawCommand& command);
+
+	// Draws sharing a shader variant & textures next to each other, so the binds between them are skipped
+	static bool DrawCommandBefore(const DrawCommand& a, const DrawCommand& b);
+
+	// Dispatches the meshlets culling of the draw commands with meshlets, a compute dispatch each
+	static void CullMeshlets();
+
+	// Approximate on-screen size (in pixels) of a world bounding sphere, used to request the textures streaming levels
+	static float GetProjectedSize(const glm::vec4& world_sphere);
 
 	// --- Private Class Methods ---
 	static void SetRendererStatistics(int ogl_major_version, int ogl_min_version);
@@ -84,16 +133,29 @@ private:
 	// --- Renderer Variables ---
 	static RendererStatistics m_RendererStatistics;
 	static UniformBuffer* m_CameraUniformBuffer;
+	static glm::mat4 m_ViewProjection;
+	static float m_ViewportHeight;
 
 	static Ref<Model> m_Sphere;
+	static Ref<ModelsBatch> m_SphereLoad;
 	static Ref<Material> m_DefaultMaterial;
 	static Ref<Material> m_MagentaMaterial;
+	static std::vector<DrawCommand> m_DrawCommands;	// Scene ones, reused every frame
+
+	static constexpr uint s_TextureSlots = (uint)Resources::TexturesIndex::BUMP + 1;
+	static uint m_BoundTextures[s_TextureSlots];	// GL texture bound on each slot by BindTexture(), 0 if none (or unknown)
+
+	// --- Meshlets Culling ---
+	static constexpr uint s_MeshletCountsFrames = 3;	// Counts buffers in flight, so reading back the statistics doesn't stall
+	static bool m_MeshletsCulling;
+	static Ref<Shader> m_MeshletCullingShader;
+	static UniquePtr<StorageBuffer> m_MeshletCommandsBuffer;
+	static UniquePtr<StorageBuffer> m_MeshletCountsBuffers[s_MeshletCountsFrames];
+	static uint m_MeshletCountsFrame;
 	
 	// --- Lighting Variables ---
 	static Light m_DirectionalLight;
 	static ShaderStorageBuffer* m_LightsSSBuffer;
-	static std::vector<PointLight> m_Lights;
-	static uint m_LightsIndex;
 };
 
 #endif //_RENDERER_H_
\ No newline at end of file
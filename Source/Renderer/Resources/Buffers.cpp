@@ -1,28 +1,32 @@
 #include "Buffers.h"
+#include "Renderer/Utils/GPUMemory.h"
 
 #include <glad/glad.h>
 
 
 // ------------------------------------------------------------------------------
-VertexBuffer::VertexBuffer(float* vertices, uint size)
+VertexBuffer::VertexBuffer(const float* vertices, uint size) : m_Size(size)
 {
 	glCreateBuffers(1, &m_ID);
 	glBindBuffer(GL_ARRAY_BUFFER, m_ID);
 	glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW); // TODO: If I make a batch renderer, change this to dynamic
+	GPUMemory::Allocate(GPU_MEMORY::VERTEX_BUFFER, m_Size);
 	//glBindBuffer(GL_ARRAY_BUFFER, 0); //TODO: Take a look at this unbind stuff! (all over the file!)
 }
 
-VertexBuffer::VertexBuffer(uint size)
+VertexBuffer::VertexBuffer(uint size) : m_Size(size)
 {
 	glCreateBuffers(1, &m_ID);
 	glBindBuffer(GL_ARRAY_BUFFER, m_ID);
 	glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STATIC_DRAW);
+	GPUMemory::Allocate(GPU_MEMORY::VERTEX_BUFFER, m_Size);
 	//glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 VertexBuffer::~VertexBuffer()
 {
 	glDeleteBuffers(1, &m_ID);
+	GPUMemory::Free(GPU_MEMORY::VERTEX_BUFFER, m_Size);
 }
 
 void VertexBuffer::Bind() const
@@ -42,14 +46,20 @@ void VertexBuffer::SetData(const void* data, uint size)
 	//glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
+void VertexBuffer::GetData(void* data, uint size, uint offset) const
+{
+	glGetNamedBufferSubData(m_ID, offset, size, data);
+}
+
 
 
 // ------------------------------------------------------------------------------
-IndexBuffer::IndexBuffer(uint* vertices, uint count) : m_Count(count)
+IndexBuffer::IndexBuffer(const uint* vertices, uint count) : m_Count(count)
 {
 	glCreateBuffers(1, &m_ID);
 	glBindBuffer(GL_ARRAY_BUFFER, m_ID);
 	glBufferData(GL_ARRAY_BUFFER, count * sizeof(uint), vertices, GL_STATIC_DRAW); // TODO: If I make a batch renderer, change this to dynamic
+	GPUMemory::Allocate(GPU_MEMORY::INDEX_BUFFER, GetGPUBytes());
 	//glBindBuffer(GL_ARRAY_BUFFER, 0);
 
 	// GL_ELEMENT_ARRAY_BUFFER is not valid without an actively bound VAO
@@ -59,6 +69,7 @@ IndexBuffer::IndexBuffer(uint* vertices, uint count) : m_Count(count)
 IndexBuffer::~IndexBuffer()
 {
 	glDeleteBuffers(1, &m_ID);
+	GPUMemory::Free(GPU_MEMORY::INDEX_BUFFER, GetGPUBytes());
 }
 
 void IndexBuffer::Bind() const
@@ -71,6 +82,11 @@ void IndexBuffer::Unbind() const
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
+void IndexBuffer::GetData(uint* indices, uint size, uint offset) const
+{
+	glGetNamedBufferSubData(m_ID, offset, size, indices);
+}
+
 
 
 // ------------------------------------------------------------------------------
@@ -247,4 +263,55 @@ void ShaderStorageBuffer::SetData(const std::string& element_name, const void* d
 			break;
 		}
 	}
-}
\ No newline at end of file
+}
+
+
+// ------------------------------------------------------------------------------
+StorageBuffer::StorageBuffer(const void* data, uint64 size, bool dynamic) : m_Size(size)
+{
+	glCreateBuffers(1, &m_ID);
+	glNamedBufferStorage(m_ID, m_Size, data, dynamic ? GL_DYNAMIC_STORAGE_BIT : 0);
+	if (!data)
+		glClearNamedBufferData(m_ID, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+	GPUMemory::Allocate(GPU_MEMORY::STORAGE_BUFFER, m_Size);
+}
+
+StorageBuffer::~StorageBuffer()
+{
+	glDeleteBuffers(1, &m_ID);
+	GPUMemory::Free(GPU_MEMORY::STORAGE_BUFFER, m_Size);
+}
+
+void StorageBuffer::BindBase(uint binding) const
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, m_ID);
+}
+
+void StorageBuffer::Bind(uint target) const
+{
+	glBindBuffer(target, m_ID);
+}
+
+void StorageBuffer::Unbind(uint target) const
+{
+	glBindBuffer(target, 0);
+}
+
+void StorageBuffer::SetData(const void* data, uint64 size, uint64 offset)
+{
+	ASSERT(offset + size <= m_Size, "StorageBuffer::SetData() out of the buffer bounds");
+	glNamedBufferSubData(m_ID, offset, size, data);
+}
+
+void StorageBuffer::GetData(void* data, uint64 size, uint64 offset) const
+{
+	ASSERT(offset + size <= m_Size, "StorageBuffer::GetData() out of the buffer bounds");
+	glGetNamedBufferSubData(m_ID, offset, size, data);
+}
+
+void StorageBuffer::Clear(uint64 size, uint64 offset)
+{
+	ASSERT(offset + size <= m_Size, "StorageBuffer::Clear() out of the buffer bounds");
+	glClearNamedBufferSubData(m_ID, GL_R32UI, offset, size, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+}
@@ -82,7 +82,7 @@ class VertexBuffer
 public:
 
 	// --- Des/Construction ---
-	VertexBuffer(float* vertices, uint size);
+	VertexBuffer(const float* vertices, uint size);
 	VertexBuffer(uint size);
 	~VertexBuffer();
 	
@@ -94,11 +94,13 @@ public:
 	const BufferLayout& GetLayout()					const { return m_Layout; }
 	void SetLayout(const BufferLayout& layout)		{ m_Layout = layout; }
 	void SetData(const void* data, uint size);
+	void GetData(void* data, uint size, uint offset = 0) const; // Reads it back, waiting for the GPU
+	uint64 GetGPUBytes()							const { return m_Size; }
 
 private:
 
 	// --- Variables ---
-	uint m_ID = 0;
+	uint m_ID = 0, m_Size = 0;
 	BufferLayout m_Layout;
 };
 
@@ -110,15 +112,18 @@ class IndexBuffer
 public:
 
 	// --- Des/Construction ---
-	IndexBuffer(uint* vertices, uint count);
+	IndexBuffer(const uint* vertices, uint count);
 	~IndexBuffer();
 
 	// --- Class Methods ---
 	void Bind() const;
 	void Unbind() const;
 
+	void GetData(uint* indices, uint size, uint offset = 0) const; // Reads it back (size & offset in bytes), waiting for the GPU
+
 	// -- Getters --
 	uint GetCount() const { return m_Count; }
+	uint64 GetGPUBytes() const { return (uint64)m_Count * sizeof(uint); }
 
 private:
 
@@ -148,6 +153,16 @@ public:
 	inline const Ref<IndexBuffer>& GetIndexBuffer()					const { return m_IndexBuffer; }
 	inline const std::vector<Ref<VertexBuffer>>& GetVertexBuffers()	const { return m_VertexBuffers; }
 
+	// Of its vertex & index buffers
+	uint64 GetGPUBytes() const
+	{
+		uint64 bytes = m_IndexBuffer ? m_IndexBuffer->GetGPUBytes() : 0;
+		for (const Ref<VertexBuffer>& vertex_buffer : m_VertexBuffers)
+			bytes += vertex_buffer->GetGPUBytes();
+
+		return bytes;
+	}
+
 private:
 
 	// --- Private Methods ---
@@ -214,4 +229,37 @@ private:
 };
 
 
+
+// ---- Storage Buffer ----
+// Raw buffer of structs laid out as their std430 declarations (no layout), read & written by shaders or used as indirect draws
+// commands & parameters. Immutable storage (zeroed if no data is passed), SetData() needs it created as dynamic
+class StorageBuffer
+{
+public:
+
+	// --- Des/Construction ---
+	StorageBuffer(const void* data, uint64 size, bool dynamic = false);
+	~StorageBuffer();
+
+	// --- Class Methods ---
+	void BindBase(uint binding) const;			// As the shader storage buffer at the binding point
+	void Bind(uint target) const;				// To any target, like GL_DRAW_INDIRECT_BUFFER or GL_PARAMETER_BUFFER
+	void Unbind(uint target) const;
+
+	void SetData(const void* data, uint64 size, uint64 offset = 0);
+	void GetData(void* data, uint64 size, uint64 offset = 0) const;	// Waits for the GPU if it's still writing it
+	void Clear(uint64 size, uint64 offset = 0);						// To zeros, size & offset multiple of 4
+
+	// --- Getters ---
+	uint GetID()			const { return m_ID; }
+	uint64 GetGPUBytes()	const { return m_Size; }
+
+private:
+
+	// --- Variables ---
+	uint m_ID = 0;
+	uint64 m_Size = 0;
+};
+
+
 #endif //_BUFFERS_H_
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "Framebuffer.h"
+#include "Renderer/Renderer.h"
+#include "Renderer/Utils/GPUMemory.h"
 
 
 // ------------------------------------------------------------------------------
@@ -18,7 +20,10 @@ Framebuffer::Framebuffer(uint width, uint height, std::initializer_list<Renderer
 void Framebuffer::Bind()
 {
 	glBindFramebuffer(GL_FRAMEBUFFER, m_ID);
+
+	// Render into the viewport sub-rectangle, the textures might be bigger (capacity)
 	glViewport(0, 0, m_Width, m_Height);
+	glScissor(0, 0, m_Width, m_Height);
 }
 
 void Framebuffer::Unbind()
@@ -36,13 +41,61 @@ void Framebuffer::Resize(uint width, uint height)
 		ENGINE_LOG("Warning: Tried to resize FBO to %ix%i, aborting operation (too big or 0)", width, height);
 		return;
 	}
-	
-	if (m_ID != 0)
-		DeleteTexturesAndFBO();
 
 	// -- Set FBO values ---
 	m_Width = width;
 	m_Height = height;
+	m_StableFrames = 0;
+
+	// -- Grow Capacity --
+	// Geometrically, so consecutive resizes (such as dragging a panel) fit in the already allocated textures
+	if (m_ID == 0 || width > m_CapacityWidth || height > m_CapacityHeight)
+	{
+		uint capacity_width = width, capacity_height = height;
+		if (m_ID != 0)
+		{
+			if (width > m_CapacityWidth)
+				capacity_width = glm::min(glm::max(width, (uint)(m_CapacityWidth * RendererUtils::s_FBOGrowthFactor)), RendererUtils::s_MaxFBOSize);
+			else
+				capacity_width = m_CapacityWidth;
+
+			if (height > m_CapacityHeight)
+				capacity_height = glm::min(glm::max(height, (uint)(m_CapacityHeight * RendererUtils::s_FBOGrowthFactor)), RendererUtils::s_MaxFBOSize);
+			else
+				capacity_height = m_CapacityHeight;
+		}
+
+		Reallocate(capacity_width, capacity_height);
+	}
+
+	// -- Shrink Capacity --
+	// Only if we are wasting more than half of the allocated textures, and deferred until the size is stable
+	m_ShrinkPending = (uint64)m_CapacityWidth * (uint64)m_CapacityHeight > 2 * (uint64)m_Width * (uint64)m_Height;
+}
+
+void Framebuffer::UpdateDeferredShrink()
+{
+	if (!m_ShrinkPending)
+		return;
+
+	if (++m_StableFrames >= RendererUtils::s_FBOShrinkDelayFrames)
+		Reallocate(m_Width, m_Height);
+}
+
+
+void Framebuffer::Reallocate(uint capacity_width, uint capacity_height)
+{
+	if (m_ID != 0)
+	{
+		DeleteTexturesAndFBO();
+		Renderer::AddFramebufferReallocation();
+	}
+
+	// -- Set FBO values ---
+	m_CapacityWidth = capacity_width;
+	m_CapacityHeight = capacity_height;
+	m_ShrinkPending = false;
+	m_StableFrames = 0;
 
 	// -- Create FBO --
 	GLenum FBOsampling = m_Samples > 1 ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D;
@@ -68,6 +121,17 @@ void Framebuffer::Resize(uint width, uint height)
 	else if (m_ColorTextures.empty()) // Depth pass
 		glDrawBuffer(GL_NONE);
 
+	// -- Track Attachments Memory --
+	uint pixel_size = 0;
+	for (RendererUtils::FBO_TEXTURE_FORMAT format : m_ColorAttachments)
+		pixel_size += RendererUtils::FBOTextureFormatSize(format);
+
+	if (m_DepthTexture != 0)
+		pixel_size += RendererUtils::FBOTextureFormatSize(m_DepthAttachment);
+
+	m_GPUBytes = (uint64)m_CapacityWidth * m_CapacityHeight * m_Samples * pixel_size;
+	GPUMemory::Allocate(GPU_MEMORY::FRAMEBUFFER, m_GPUBytes);
+
 	// -- Unbind FBO --
 	bool fbo_status = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
 	ASSERT(fbo_status, "Framebuffer Incompleted!");
@@ -122,6 +186,9 @@ void Framebuffer::DeleteTexturesAndFBO()
 
 	m_ColorTextures.clear();
 	m_DepthTexture = 0;
+
+	GPUMemory::Free(GPU_MEMORY::FRAMEBUFFER, m_GPUBytes);
+	m_GPUBytes = 0;
 }
 
 
@@ -136,16 +203,16 @@ void Framebuffer::ResetColorTextures(GLenum FBOsampling)
 		switch (m_ColorAttachments[i])
 		{
 			case RendererUtils::FBO_TEXTURE_FORMAT::RGBA8:
-				SetTexture(false, GL_RGBA8, GL_RGBA, m_Width, m_Height, GL_UNSIGNED_BYTE, m_Samples);
+				SetTexture(false, GL_RGBA8, GL_RGBA, m_CapacityWidth, m_CapacityHeight, GL_UNSIGNED_BYTE, m_Samples);
 				break;
 			case RendererUtils::FBO_TEXTURE_FORMAT::RGBA16:
-				SetTexture(false, GL_RGBA16F, GL_RGBA, m_Width, m_Height, GL_FLOAT, m_Samples);
+				SetTexture(false, GL_RGBA16F, GL_RGBA, m_CapacityWidth, m_CapacityHeight, GL_FLOAT, m_Samples);
 				break;
 			case RendererUtils::FBO_TEXTURE_FORMAT::RGBA32:
-				SetTexture(false, GL_RGBA32F, GL_RGBA, m_Width, m_Height, GL_FLOAT, m_Samples);
+				SetTexture(false, GL_RGBA32F, GL_RGBA, m_CapacityWidth, m_CapacityHeight, GL_FLOAT, m_Samples);
 				break;
 			//case RendererUtils::FBO_TEXTURE_FORMAT::FLOAT:
-			//	SetTexture(false, GL_R32F, GL_RED, m_Width, m_Height, GL_UNSIGNED_BYTE, m_Samples);
+			//	SetTexture(false, GL_R32F, GL_RED, m_CapacityWidth, m_CapacityHeight, GL_UNSIGNED_BYTE, m_Samples);
 			//	break;
 		}
 
@@ -161,7 +228,7 @@ void Framebuffer::ResetDepthTexture(GLenum FBOsampling)
 	switch (m_DepthAttachment)
 	{
 		case RendererUtils::FBO_TEXTURE_FORMAT::DEPTH24STENCIL8:
-			SetTexture(true, GL_DEPTH24_STENCIL8, GL_NONE, m_Width, m_Height, 0, m_Samples);
+			SetTexture(true, GL_DEPTH24_STENCIL8, GL_NONE, m_CapacityWidth, m_CapacityHeight, 0, m_Samples);
 			break;
 	}
 
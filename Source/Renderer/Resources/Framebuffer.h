@@ -4,6 +4,7 @@
 #include "Core/Globals.h"
 #include "Renderer/Utils/RendererUtils.h"
 #include <glad/glad.h>
+#include <glm/glm.hpp>
 
 
 // ----- Framebuffer Class -----
@@ -19,18 +20,28 @@ public:
 	void Bind();
 	void Unbind();
 
+	// Growing reallocates with some extra capacity, shrinking only moves the viewport (see UpdateDeferredShrink())
 	void Resize(uint width, uint height);
+	// Call once per frame, reallocates to a tighter capacity once the size has been stable for s_FBOShrinkDelayFrames
+	void UpdateDeferredShrink();
 	//void ClearFBOTexture(uint index, int value);
 
 	// --- Getters ---
 	uint GetFBOTextureID(uint index = 0) const;
 	uint GetWidth() const { return m_Width; }
 	uint GetHeight() const { return m_Height; }
+	uint GetCapacityWidth() const { return m_CapacityWidth; }
+	uint GetCapacityHeight() const { return m_CapacityHeight; }
+	uint64 GetGPUBytes() const { return m_GPUBytes; } // Of all its attachments (at capacity size)
+
+	// Portion of the FBO textures that holds the rendered viewport, multiply UVs by this when sampling them
+	glm::vec2 GetUVScale() const { return { (float)m_Width / (float)m_CapacityWidth, (float)m_Height / (float)m_CapacityHeight }; }
 
 private:
 
 	// --- Private FBO Methods ---
 	void SetTexture(bool depth_texture, GLenum internal_format, GLenum format, uint width, uint height, GLenum data_type, uint samples);
+	void Reallocate(uint capacity_width, uint capacity_height);
 	void DeleteTexturesAndFBO();
 	void ResetColorTextures(GLenum FBOsampling);
 	void ResetDepthTexture(GLenum FBOsampling);
@@ -38,13 +49,17 @@ private:
 private:
 
 	uint m_ID = 0;
-	uint m_Width = 0, m_Height = 0, m_Samples = 1;
+	uint m_Width = 0, m_Height = 0, m_Samples = 1;			// Viewport (what's rendered)
+	uint m_CapacityWidth = 0, m_CapacityHeight = 0;			// Allocated textures size
+	uint m_StableFrames = 0;
+	bool m_ShrinkPending = false;
 
 	std::vector<RendererUtils::FBO_TEXTURE_FORMAT> m_ColorAttachments;
-	RendererUtils::FBO_TEXTURE_FORMAT m_DepthAttachment;
+	RendererUtils::FBO_TEXTURE_FORMAT m_DepthAttachment = RendererUtils::FBO_TEXTURE_FORMAT::NONE;
 
 	std::vector<uint> m_ColorTextures;
 	uint m_DepthTexture = 0;
+	uint64 m_GPUBytes = 0;
 };
 
 #endif //_FRAMEBUFFER_H_
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define _MATERIAL_H_
 
 #include "Core/Globals.h"
+#include "Core/Utils/SlotMap.h"
 #include "Renderer/Resources/Texture.h"
 #include "Renderer/Resources/Shader.h"
 
@@ -13,7 +14,7 @@ class Material
 private:
 
 	// --- Constructor ---
-	Material(int id, const std::string& name = "unnamed") : m_ID(id), m_Name(name) {}
+	Material(const std::string& name = "unnamed") : m_Name(name) {}
 
 public:
 	
@@ -21,7 +22,7 @@ public:
 	~Material() { DeleteMaterial(); }
 
 	// --- Getters ---
-	inline uint GetID()								const	{ return m_ID; }
+	inline MaterialHandle GetID()					const	{ return m_ID; }
 	inline const std::string& GetName()				const	{ return m_Name; }
 	inline void SetName(const std::string& name)			{ m_Name = name; }
 
@@ -41,16 +42,19 @@ private:
 
 	//Ref<Shader> m_Shader; //?
 	std::string m_Name = "unnamed";
-	int m_ID = -1;
+	MaterialHandle m_ID = {};
 
 public:
 
 	float Smoothness = 0.01f, Bumpiness = 1.0f, Heightscale = 0.1f, ParallaxLayers = 32.0f;
 	bool IsTransparent = false, IsEmissive = false, IsTwoSided = true;
+	bool IsAlphaTested = false; // Discards the fragments below the alpha cutoff (shaders ALPHA_TEST variant)
+	float AlphaCutoff = 0.5f;
 
 	glm::vec4 AlbedoColor = glm::vec4(1.0f);
 	glm::vec4 SpecularColor = glm::vec4(0.0f);
 	glm::vec4 EmissiveColor = glm::vec4(0.0f);
+	glm::vec4 AlbedoUVTransform = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f); // Scale (xy) & offset (zw) of its rect in the albedo, if baked into an atlas (see TextureAtlas)
 
 	Ref<Texture> Albedo = nullptr;
 	Ref<Texture> Emissive = nullptr;
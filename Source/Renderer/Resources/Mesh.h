@@ -2,17 +2,65 @@
 #define _MESH_H_
 
 #include "Core/Globals.h"
+#include "Core/Utils/SlotMap.h"
 #include "Renderer/Entities/TransformComponent.h"
 #include <filesystem>
 
 
+// ------------------------------------------------------------------------------
+// Axis-Aligned Bounding Box, in the mesh local space
+struct AABB
+{
+	glm::vec3 Min = glm::vec3(0.0f);
+	glm::vec3 Max = glm::vec3(0.0f);
+
+	glm::vec3 GetCenter()	const { return (Min + Max) * 0.5f; }
+	glm::vec3 GetExtents()	const { return (Max - Min) * 0.5f; }
+
+	void Merge(const AABB& aabb) { Min = glm::min(Min, aabb.Min); Max = glm::max(Max, aabb.Max); }
+
+	// Box enclosing this one transformed (extents projected on the transform axes, as Arvo's method)
+	AABB Transformed(const glm::mat4& transform) const
+	{
+		glm::vec3 center = glm::vec3(transform * glm::vec4(GetCenter(), 1.0f)), extents = GetExtents();
+		glm::vec3 new_extents = glm::abs(glm::vec3(transform[0])) * extents.x + glm::abs(glm::vec3(transform[1])) * extents.y + glm::abs(glm::vec3(transform[2])) * extents.z;
+		return { center - new_extents, center + new_extents };
+	}
+
+	// World bounding sphere enclosing the box transformed, center (xyz) & radius (w)
+	glm::vec4 GetBoundingSphere(const glm::mat4& transform) const
+	{
+		float scale = glm::max(glm::length(glm::vec3(transform[0])), glm::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+		return glm::vec4(glm::vec3(transform * glm::vec4(GetCenter(), 1.0f)), glm::length(GetExtents()) * scale);
+	}
+};
+
+
+// Cluster of a mesh triangles (a contiguous range of its indices), culled as a whole on the GPU. Laid out as in MeshletCullingShader.glsl
+struct Meshlet
+{
+	static constexpr uint s_MaxVertices = 64, s_MaxTriangles = 124;
+
+	glm::vec3 Center = glm::vec3(0.0f);		// Bounding sphere, in the mesh local space
+	float Radius = 0.0f;
+	glm::vec3 ConeAxis = glm::vec3(0.0f);		// Normal cone: all its triangles face away from any viewpoint where
+	float ConeCutoff = 1.0f;					// dot(center - viewpoint, axis) >= cutoff * distance + radius (1 never culls)
+	uint FirstIndex = 0, IndexCount = 0;		// Relative to the mesh draw range
+	uint Padding[2] = {};
+};
+
+
+
 // ------------------------------------------------------------------------------
 class Mesh;
+class StorageBuffer;
 
 class Model
 {
 	friend class Resources;
 	friend class MeshImporter;
+	friend class MeshCache;
+	friend class GltfImporter;
 private:
 
 	// --- Des/Constructor ---
@@ -31,6 +79,7 @@ public:
 	void SetName(const std::string& name)		{ m_Name = name; }
 	const std::string& GetName()		const	{ return m_Name; }
 	Mesh* GetRootMesh()					const	{ return m_RootMesh; }
+	const AABB& GetBounds()				const	{ return m_Bounds; }
 
 	TransformComponent& GetTransformation() { return m_Transform; }
 
@@ -39,6 +88,8 @@ private:
 	std::string m_Path = "unpathed";
 	std::string m_Name = "unnamed";
 	Mesh* m_RootMesh = nullptr;
+	AABB m_Bounds = {};
+	uint64 m_LastUsedFrame = 0; // Resources frame it was last referenced on, for the eviction LRU
 
 	TransformComponent m_Transform = {};
 };
@@ -51,11 +102,12 @@ class Mesh
 	friend class Resources;
 	friend class MeshImporter;
 	friend class Renderer;
+	friend class RenderScene;
 private:
 
 	// --- Constructor ---
-	Mesh(const Ref<VertexArray>& vertex_array, int id, uint material_index = 0, Mesh* parent = nullptr)
-		: m_VertexArray(vertex_array), m_ID(id), m_MaterialIndex(material_index), m_ParentMesh(parent) {}
+	Mesh(const Ref<VertexArray>& vertex_array, MaterialHandle material = {}, Mesh* parent = nullptr)
+		: m_Material(material), m_VertexArray(vertex_array), m_ParentMesh(parent) {}
 
 public:
 	
@@ -64,13 +116,19 @@ public:
 
 	// --- Getters/Setters ---
 	inline void SetName(const std::string& name)			{ m_Name = name; }
-	inline void SetMaterial(uint mat_id)					{ m_MaterialIndex = mat_id; }
+	inline void SetMaterial(MaterialHandle material)		{ m_Material = material; }
 
 	inline const std::string& GetName()				const	{ return m_Name; }
-	inline uint GetID()								const	{ return m_ID; }
+	inline MeshHandle GetID()						const	{ return m_ID; }
 	
-	inline uint GetMaterialIndex()					const	{ return m_MaterialIndex; }
+	inline MaterialHandle GetMaterial()				const	{ return m_Material; }
 	inline const Mesh* GetParent()					const	{ return m_ParentMesh; }
+	inline const AABB& GetBounds()					const	{ return m_Bounds; }
+	inline const glm::mat4& GetLocalTransform()		const	{ return m_LocalTransform; }
+	inline uint GetMeshletsCount()					const	{ return m_MeshletsCount; }
+
+	// Shared by the meshes drawing the same vertex array, as it
+	inline void SetMeshlets(const Ref<StorageBuffer>& meshlets_buffer, uint meshlets_count) { m_MeshletsBuffer = meshlets_buffer; m_MeshletsCount = meshlets_buffer ? meshlets_count : 0; }
 	
 	bool operator==(const Mesh& mesh)				const	{ return m_ID == mesh.m_ID; }
 
@@ -78,13 +136,13 @@ public:
 
 
 	// --- Mesh Methods ---
-	void AddSubmesh(Ref<Mesh>* mesh)
+	void AddSubmesh(const Ref<Mesh>& mesh)
 	{
-		if (!mesh || !mesh->get())
+		if (!mesh)
 			return;
 
-		m_Submeshes.push_back(*mesh);
-		(*mesh)->m_ParentMesh = this;
+		m_Submeshes.push_back(mesh);
+		mesh->m_ParentMesh = this;
 	}
 
 
@@ -98,18 +156,23 @@ private:
 
 		m_Submeshes.clear();
 		m_VertexArray.reset();
+		m_MeshletsBuffer.reset();
 		m_ParentMesh = nullptr;
 	}
 
 private:
 
 	// --- Variables ---
-	int m_ID = -1;
+	MeshHandle m_ID = {};
 	std::string m_Name = "unnamed";				// Debug
-	uint m_MaterialIndex = 0;					// Index of res. material for this mesh
+	MaterialHandle m_Material = {};				// Res. material for this mesh, null renders with the magenta one
+	AABB m_Bounds = {};
 	std::vector<Ref<Mesh>> m_Submeshes;
+	glm::mat4 m_LocalTransform = glm::mat4(1.0f);	// Relative to its model (not to its parent mesh), identity if baked at import
 	
 	Ref<VertexArray> m_VertexArray = nullptr;
+	Ref<StorageBuffer> m_MeshletsBuffer = nullptr;	// Meshlet structs, for the GPU culling
+	uint m_MeshletsCount = 0;
 	Mesh* m_ParentMesh = nullptr;
 };
 
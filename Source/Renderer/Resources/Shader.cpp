@@ -1,31 +1,114 @@
 #include "Shader.h"
 
 #include "Renderer/Utils/RendererUtils.h"
+#include "Core/Resources/ShaderCache.h"
 #include "Core/Utils/FileStringUtils.h"
 
+#include <GLFW/glfw3.h>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <cctype>
 #include <filesystem>
-#include <fstream>
+#include <sstream>
+
+// GL_KHR_parallel_shader_compile (same values as the ARB one), not in the loaded GL
+#ifndef GL_COMPLETION_STATUS_KHR
+	#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+	#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void (APIENTRYP PFN_MaxShaderCompilerThreads)(GLuint count);
+
+
+// ------------------------------------------------------------------------------
+namespace
+{
+	// Names of the keywords, by their bit
+	static const char* s_KeywordNames[Shader::s_KeywordsCount] = { "HAS_NORMAL_MAP", "HAS_PARALLAX", "TWO_SIDED", "ALPHA_TEST" };
+
+	// Flat grey, with the same camera UBO & model uniform than the scene shaders
+	static const char* s_FallbackVertexSource = R"(
+		#version 460 core
+		layout(location = 0) in vec3 a_Position;
+		layout(std140, binding = 0) uniform ub_CameraData { mat4 ViewProjection; vec3 CamPosition; };
+		uniform mat4 u_Model = mat4(1.0);
+		void main() { gl_Position = ViewProjection * u_Model * vec4(a_Position, 1.0); }
+	)";
+
+	static const char* s_FallbackFragmentSource = R"(
+		#version 460 core
+		layout(location = 0) out vec4 color;
+		void main() { color = vec4(0.5, 0.5, 0.5, 1.0); }
+	)";
+
+	GLuint CompileFallbackShader(GLenum type, const char* source)
+	{
+		GLuint shader = glCreateShader(type);
+		glShaderSource(shader, 1, &source, 0);
+		glCompileShader(shader);
+		return shader;
+	}
+}
+
+uint Shader::s_FallbackProgram = 0;
+uint Shader::s_CompilingCount = 0;
+uint Shader::s_BoundProgram = 0;
+bool Shader::s_ParallelCompile = false;
+
+
+void Shader::InitCompilation()
+{
+	// -- Parallel Compilation --
+	// Driver compiler threads left to the driver (0xFFFFFFFF), then programs can be polled for completion
+	const bool khr = glfwExtensionSupported("GL_KHR_parallel_shader_compile"), arb = glfwExtensionSupported("GL_ARB_parallel_shader_compile");
+	PFN_MaxShaderCompilerThreads max_compiler_threads = nullptr;
+	if (khr || arb)
+		max_compiler_threads = (PFN_MaxShaderCompilerThreads)glfwGetProcAddress(khr ? "glMaxShaderCompilerThreadsKHR" : "glMaxShaderCompilerThreadsARB");
+
+	s_ParallelCompile = max_compiler_threads != nullptr;
+	if (s_ParallelCompile)
+		max_compiler_threads(0xFFFFFFFF);
+
+	ENGINE_LOG("Parallel Shader Compilation: %s", s_ParallelCompile ? "supported" : "not supported, programs checked on their first bind");
+
+	// -- Fallback Program --
+	// Tiny, so it's compiled synchronously
+	GLuint vertex_shader = CompileFallbackShader(GL_VERTEX_SHADER, s_FallbackVertexSource);
+	GLuint fragment_shader = CompileFallbackShader(GL_FRAGMENT_SHADER, s_FallbackFragmentSource);
+	s_FallbackProgram = glCreateProgram();
+	glAttachShader(s_FallbackProgram, vertex_shader);
+	glAttachShader(s_FallbackProgram, fragment_shader);
+	glLinkProgram(s_FallbackProgram);
+
+	glDetachShader(s_FallbackProgram, vertex_shader);
+	glDetachShader(s_FallbackProgram, fragment_shader);
+	glDeleteShader(vertex_shader);
+	glDeleteShader(fragment_shader);
+}
+
+void Shader::ShutdownCompilation()
+{
+	glDeleteProgram(s_FallbackProgram);
+	s_FallbackProgram = 0;
+}
+
 
 
 // ------------------------------------------------------------------------------
-Shader::Shader(const std::string& name, const std::string& vertex_src, const std::string& fragment_src)
+Shader::Shader(const std::string& name, const std::string& vertex_src, const std::string& fragment_src) : m_Name(name)
 {
 	// -- Set source for Shader --
-	std::unordered_map<GLenum, std::string> sources;
-	sources[GL_VERTEX_SHADER] = vertex_src;
-	sources[GL_FRAGMENT_SHADER] = fragment_src;
+	m_Sources[GL_VERTEX_SHADER] = vertex_src;
+	m_Sources[GL_FRAGMENT_SHADER] = fragment_src;
 
 	// -- Compile Shader --
-	CompileShader(sources);
+	// Its base variant, the others on their first bind
+	GetVariant(0);
 }
 
 Shader::Shader(const std::string& filepath)
 {
-	// -- Compile Shader --
-	CompileShader(PreProcessShader(ReadShaderFile(filepath)));
-
 	// -- Shader name from filepath --
 	//size_t lastSlash = filepath.find_last_of("/\\");
 	//size_t lastDot = filepath.rfind('.');
@@ -41,29 +124,81 @@ Shader::Shader(const std::string& filepath)
 	// -- File Last Modification Time --
 	m_LastModificationTimestamp = FileUtils::GetFileLastWriteTimestamp(filepath.c_str()); // If problems, try: std::filesystem::last_write_time(path);
 	m_Path = filepath;
+
+	// -- Compile Shader --
+	// After the path is set, it keys its binary cache & its includes are relative to it
+	m_Sources = PreProcessShader(ReadShaderFile(filepath));
+	GetVariant(0);
 }
 
 Shader::~Shader()
 {
-	glDeleteProgram(m_ID);
+	for (auto& [keywords, variant] : m_Variants)
+	{
+		DiscardPendingProgram(variant);
+		if (variant.ID == s_BoundProgram)
+			s_BoundProgram = 0;
+
+		if (variant.ID != s_FallbackProgram)
+			glDeleteProgram(variant.ID);
+	}
 }
 
-void Shader::Bind() const
+void Shader::Bind(uint keywords)
 {
-	glUseProgram(m_ID);
+	// -- Variant --
+	// Swaps in its program if it finished compiling, the base one (if ready) is used meanwhile instead of the fallback program
+	Variant* variant = &GetVariant(keywords & m_Keywords);
+	UpdateCompilation(*variant);
+	if (!IsVariantReady(*variant) && variant->Keywords != 0)
+	{
+		Variant& base_variant = GetVariant(0);
+		UpdateCompilation(base_variant);
+		if (IsVariantReady(base_variant))
+			variant = &base_variant;
+	}
+
+	// -- Use Program --
+	// Draws switching variants of the same shader rebind the same program often
+	m_BoundVariant = variant;
+	if (s_BoundProgram != variant->ID)
+	{
+		glUseProgram(variant->ID);
+		s_BoundProgram = variant->ID;
+	}
+
+	// -- Shared Uniforms --
+	// Only the ones changed since it was last bound (on other variants)
+	if (variant->UniformsVersion != m_UniformsVersion)
+	{
+		for (const auto& [uniform_name, value] : m_Uniforms)
+			if (value.Version > variant->UniformsVersion)
+				ApplyUniform(*variant, uniform_name, value);
+
+		variant->UniformsVersion = m_UniformsVersion;
+	}
 }
 
-void Shader::Unbind() const
+void Shader::Unbind()
 {
+	m_BoundVariant = nullptr;
+	s_BoundProgram = 0;
 	glUseProgram(0);
 }
 
 void Shader::CheckLastModification()
 {
 	uint64 last_time = FileUtils::GetFileLastWriteTimestamp(m_Path.c_str());
+	for (const std::string& included_file : m_IncludedFiles)
+		last_time = std::max(last_time, FileUtils::GetFileLastWriteTimestamp(included_file.c_str()));
+
 	if (last_time > m_LastModificationTimestamp)
 	{
-		CompileShader(PreProcessShader(ReadShaderFile(m_Path)));
+		// Each variant keeps its previous program until the new one is linked
+		m_Sources = PreProcessShader(ReadShaderFile(m_Path));
+		for (auto& [keywords, variant] : m_Variants)
+			CompileVariant(variant);
+
 		m_LastModificationTimestamp = last_time; // If problems, try: std::filesystem::last_write_time(path);
 	}
 }
@@ -73,73 +208,285 @@ void Shader::CheckLastModification()
 // ------------------------------------------------------------------------------
 int Shader::GetUniformLocation(const std::string& uniform_name) const
 {
-	if (m_UniformLocationCache.find(uniform_name) != m_UniformLocationCache.end())
-		return m_UniformLocationCache[uniform_name];
+	return m_BoundVariant ? GetUniformLocation(*m_BoundVariant, uniform_name) : -1;
+}
 
-	int loc = glGetUniformLocation(m_ID, uniform_name.c_str());
-	if (loc == -1)
+int Shader::GetUniformLocation(const Variant& variant, const std::string& uniform_name) const
+{
+	if (variant.UniformLocationCache.find(uniform_name) != variant.UniformLocationCache.end())
+		return variant.UniformLocationCache[uniform_name];
+
+	// The fallback program lacks most of them, & variants compile out the ones of the features they lack
+	int loc = glGetUniformLocation(variant.ID, uniform_name.c_str());
+	if (loc == -1 && variant.ID != s_FallbackProgram && !IsUniformInOtherVariant(variant, uniform_name))
 		ENGINE_LOG("Warning! Uniform '%s' doesn't exist! (loc == -1)", uniform_name.c_str());
 
-	m_UniformLocationCache[uniform_name] = loc;
+	variant.UniformLocationCache[uniform_name] = loc;
 	return loc;
 }
 
+bool Shader::IsUniformInOtherVariant(const Variant& variant, const std::string& uniform_name) const
+{
+	if (m_Keywords == 0)
+		return false;
+
+	// -- Compiled Variants --
+	for (const auto& [keywords, other_variant] : m_Variants)
+	{
+		if (&other_variant == &variant || !IsVariantReady(other_variant))
+			continue;
+
+		auto it = other_variant.UniformLocationCache.find(uniform_name);
+		int loc = it != other_variant.UniformLocationCache.end() ? it->second : glGetUniformLocation(other_variant.ID, uniform_name.c_str());
+		if (loc != -1)
+			return true;
+	}
+
+	// -- Variants not Compiled --
+	// The one with all the keywords would have it if each of its names ("u_Material.Bumpiness", "PLights[0].Pos") is in the sources
+	if (variant.Keywords == m_Keywords)
+		return false;
+
+	size_t begin = 0;
+	while (begin < uniform_name.size())
+	{
+		size_t end = std::min(uniform_name.find_first_of(".[", begin), uniform_name.size());
+		const std::string name = uniform_name.substr(begin, end - begin);
+		bool found = false;
+		for (const auto& [type, source] : m_Sources)
+		{
+			for (size_t pos = source.find(name); pos != std::string::npos && !found; pos = source.find(name, pos + 1))
+			{
+				auto is_identifier = [](char c) { return isalnum((unsigned char)c) || c == '_'; };
+				found = (pos == 0 || !is_identifier(source[pos - 1])) && (pos + name.size() >= source.size() || !is_identifier(source[pos + name.size()]));
+			}
+
+			if (found)
+				break;
+		}
+
+		if (!found)
+			return false;
+
+		begin = uniform_name.find('.', end);
+		begin = begin == std::string::npos ? uniform_name.size() : begin + 1;
+	}
+
+	return true;
+}
+
 
 void Shader::SetUniformInt(const std::string& uniform_name, int value)
 {
-	glUniform1i(GetUniformLocation(uniform_name), value);
+	UniformValue uniform;
+	uniform.Type = GL_INT;
+	uniform.Int = value;
+	SetUniform(uniform_name, uniform);
 }
 
 void Shader::SetUniformFloat(const std::string& uniform_name, float value)
 {
-	glUniform1f(GetUniformLocation(uniform_name), value);
+	UniformValue uniform;
+	uniform.Type = GL_FLOAT;
+	uniform.Floats[0][0] = value;
+	SetUniform(uniform_name, uniform);
+}
+
+void Shader::SetUniformVec2(const std::string& uniform_name, const glm::vec2& value)
+{
+	UniformValue uniform;
+	uniform.Type = GL_FLOAT_VEC2;
+	uniform.Floats[0] = glm::vec4(value, 0.0f, 0.0f);
+	SetUniform(uniform_name, uniform);
 }
 
 void Shader::SetUniformVec3(const std::string& uniform_name, const glm::vec3& value)
 {
-	glUniform3f(GetUniformLocation(uniform_name), value.r, value.g, value.b);
+	UniformValue uniform;
+	uniform.Type = GL_FLOAT_VEC3;
+	uniform.Floats[0] = glm::vec4(value, 0.0f);
+	SetUniform(uniform_name, uniform);
 }
 
 void Shader::SetUniformVec4(const std::string& uniform_name, const glm::vec4& value)
 {
-	glUniform4f(GetUniformLocation(uniform_name), value.r, value.g, value.b, value.a);
+	UniformValue uniform;
+	uniform.Type = GL_FLOAT_VEC4;
+	uniform.Floats[0] = value;
+	SetUniform(uniform_name, uniform);
 }
 
 void Shader::SetUniformMat4(const std::string& uniform_name, const glm::mat4& matrix)
 {
-	glUniformMatrix4fv(GetUniformLocation(uniform_name), 1, GL_FALSE, glm::value_ptr(matrix));
+	UniformValue uniform;
+	uniform.Type = GL_FLOAT_MAT4;
+	uniform.Floats = matrix;
+	SetUniform(uniform_name, uniform);
+}
+
+
+void Shader::SetUniform(const std::string& uniform_name, const UniformValue& value)
+{
+	// -- Keep Value --
+	// Unchanged ones are already set on every synced variant
+	UniformValue& uniform = m_Uniforms[uniform_name];
+	if (uniform.Version != 0 && uniform == value)
+		return;
+
+	uniform = value;
+	uniform.Version = ++m_UniformsVersion;
+
+	// -- Set on the Bound Variant --
+	// If it's still the bound program, the others get it on their next bind
+	if (m_BoundVariant && m_BoundVariant->ID == s_BoundProgram)
+	{
+		ApplyUniform(*m_BoundVariant, uniform_name, value);
+		m_BoundVariant->UniformsVersion = m_UniformsVersion;
+	}
+}
+
+void Shader::ApplyUniform(const Variant& variant, const std::string& uniform_name, const UniformValue& value) const
+{
+	int loc = GetUniformLocation(variant, uniform_name);
+	if (loc == -1)
+		return;
+
+	switch (value.Type)
+	{
+		case GL_INT:			glUniform1i(loc, value.Int); break;
+		case GL_FLOAT:			glUniform1f(loc, value.Floats[0][0]); break;
+		case GL_FLOAT_VEC2:		glUniform2fv(loc, 1, glm::value_ptr(value.Floats[0])); break;
+		case GL_FLOAT_VEC3:		glUniform3fv(loc, 1, glm::value_ptr(value.Floats[0])); break;
+		case GL_FLOAT_VEC4:		glUniform4fv(loc, 1, glm::value_ptr(value.Floats[0])); break;
+		case GL_FLOAT_MAT4:		glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(value.Floats)); break;
+		default:				break;
+	}
 }
 
 
 
 // ------------------------------------------------------------------------------
-void Shader::CompileShader(const std::unordered_map<GLenum, std::string>& shader_sources)
+Shader::Variant& Shader::GetVariant(uint keywords)
 {
-	// -- Create Program --
-	GLuint program = glCreateProgram();
-	std::vector<GLenum> glShaderIDs;
-	glShaderIDs.reserve(shader_sources.size());
+	auto it = m_Variants.find(keywords);
+	if (it != m_Variants.end())
+		return it->second;
+
+	Variant& variant = m_Variants[keywords];
+	variant.Keywords = keywords;
+	CompileVariant(variant);
+	return variant;
+}
+
+
+bool Shader::IsReady() const
+{
+	auto it = m_Variants.find(0);
+	return it != m_Variants.end() && IsVariantReady(it->second);
+}
 
-	// Instead, you could create an array, which is much better than a vector:
-	//std::array<GLenum, 2> glShaderIDs;
-	// int glShaderIDIndex = 0; // In this case, the glShaderIDs.push_back() - downwards -, should be substituted by a glShaderIDs[glShaderIDIndex++] = shader;
 
-	for (auto&& [key, value] : shader_sources)
+std::string Shader::GetCacheName(uint keywords) const
+{
+	const std::string& name = m_Path != "unpathed" ? m_Path : m_Name;
+	return keywords == 0 ? name : name + "_" + std::to_string(keywords);
+}
+
+
+void Shader::CompileVariant(Variant& variant)
+{
+	// -- Keywords Defines --
+	// Right after the #version line of each stage (it must be the first one)
+	std::unordered_map<GLenum, std::string> shader_sources = m_Sources;
+	if (variant.Keywords != 0)
 	{
-		GLenum type = key;
-		const std::string& source = value;
+		std::string defines;
+		for (uint i = 0; i < s_KeywordsCount; ++i)
+			if (variant.Keywords & (1 << i))
+				defines += std::string("#define ") + s_KeywordNames[i] + "\n";
 
-		// -- Create empty Shader handle --
-		GLuint shader = glCreateShader(type);
+		for (auto& [type, source] : shader_sources)
+		{
+			size_t version_pos = source.find("#version");
+			size_t line_end = version_pos == std::string::npos ? std::string::npos : source.find('\n', version_pos);
+			source.insert(line_end == std::string::npos ? 0 : line_end + 1, defines);
+		}
+	}
+
+	// -- Cached Program --
+	// Warm starts (& reloads back to a cached version) skip the GLSL compilation entirely
+	DiscardPendingProgram(variant);
+	uint64 sources_hash = ShaderCache::GetSourcesHash(shader_sources);
+	if (GLuint cached_program = ShaderCache::LoadProgram(GetCacheName(variant.Keywords), sources_hash))
+	{
+		SetProgram(variant, cached_program);
+		return;
+	}
 
-		// -- Send Shader to OGL --
+	// -- Create Program --
+	GLuint program = glCreateProgram();
+	variant.PendingShaders.reserve(shader_sources.size());
+
+	// -- Submit Shaders --
+	// Nothing is queried until it's done (UpdateCompilation()), so the driver compiles the shaders created meanwhile in parallel
+	for (auto&& [type, source] : shader_sources)
+	{
+		GLuint shader = glCreateShader(type);
 		const GLchar* GLShaderSource = source.c_str();
 		glShaderSource(shader, 1, &GLShaderSource, 0);
-
-		// -- Compile Shader --
 		glCompileShader(shader);
 
-		// -- Check for Compilation Errors --
+		glAttachShader(program, shader);
+		variant.PendingShaders.push_back({ type, shader });
+	}
+
+	// -- Link --
+	// Retrievable, to cache its binary
+	glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	glLinkProgram(program);
+
+	variant.PendingProgram = program;
+	variant.PendingSourcesHash = sources_hash;
+	++s_CompilingCount;
+
+	// Draws with the fallback program until it's linked (reloads keep the previous one), compute shaders aren't ready until then
+	if (variant.ID == 0 && shader_sources.find(GL_COMPUTE_SHADER) == shader_sources.end())
+		variant.ID = s_FallbackProgram;
+}
+
+
+void Shader::UpdateCompilation()
+{
+	for (auto& [keywords, variant] : m_Variants)
+		UpdateCompilation(variant);
+}
+
+
+void Shader::UpdateCompilation(Variant& variant)
+{
+	if (variant.PendingProgram == 0)
+		return;
+
+	// -- Poll Completion --
+	// Without the extension it can't be known without waiting, so the status queries below wait for it
+	if (s_ParallelCompile)
+	{
+		GLint completed = GL_FALSE;
+		glGetProgramiv(variant.PendingProgram, GL_COMPLETION_STATUS_KHR, &completed);
+		if (completed == GL_FALSE)
+			return;
+	}
+
+	GLuint program = variant.PendingProgram;
+	std::vector<std::pair<GLenum, uint>> shaders = std::move(variant.PendingShaders);
+	variant.PendingProgram = 0;
+	variant.PendingShaders.clear();
+	--s_CompilingCount;
+
+	// -- Check for Compilation Errors --
+	bool failed = false;
+	for (auto&& [type, shader] : shaders)
+	{
 		GLint isCompiled = 0;
 		glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
 		if (isCompiled == GL_FALSE)
@@ -147,61 +494,114 @@ void Shader::CompileShader(const std::unordered_map<GLenum, std::string>& shader
 			GLint maxLength = 0;
 			glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &maxLength);
 
-			std::vector<GLchar> infoLog(maxLength);
+			std::vector<GLchar> infoLog(std::max(maxLength, 1));
 			glGetShaderInfoLog(shader, maxLength, &maxLength, &infoLog[0]);
-			glDeleteShader(shader);
 
-			ENGINE_LOG("%s Shader Compilation Error: %s", RendererUtils::StringFromShaderType(type), infoLog.data());
-			ASSERT(false, "Shader Compilation Failure!");
-			break;
+			ENGINE_LOG("%s Shader Compilation Error (keywords %u): %s", RendererUtils::StringFromShaderType(type), variant.Keywords, infoLog.data());
+			failed = true;
 		}
-
-		// Attach our shaders to our program
-		glAttachShader(program, shader);
-		glShaderIDs.push_back(shader);
 	}
 
-	// -- Link --
-	m_ID = program;
-	glLinkProgram(program);
-
 	// -- Check for Link Errors --
 	GLint isLinked = 0;
 	glGetProgramiv(program, GL_LINK_STATUS, (int*)&isLinked);
-	if (isLinked == GL_FALSE)
+	if (isLinked == GL_FALSE && !failed)
 	{
 		GLint maxLength = 0;
 		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &maxLength);
 
-		std::vector<GLchar> infoLog(maxLength);
+		std::vector<GLchar> infoLog(std::max(maxLength, 1));
 		glGetProgramInfoLog(program, maxLength, &maxLength, &infoLog[0]);
-		glDeleteProgram(program);
-
-		for (auto id : glShaderIDs)
-			glDeleteShader(id);
+		ENGINE_LOG("Shader Linking Error (keywords %u): %s", variant.Keywords, infoLog.data());
+	}
 
-		ENGINE_LOG("Shader Linking Error: %s", infoLog.data());
-		ASSERT(false, "Shader Program Link Failure!");
-		return;
+	// -- Detach & Delete Shaders --
+	for (auto&& [type, shader] : shaders)
+	{
+		glDetachShader(program, shader);
+		glDeleteShader(shader);
 	}
 
-	// -- Detach Shaders after successful link --
-	for (auto id : glShaderIDs)
+	if (failed || isLinked == GL_FALSE)
 	{
-		glDetachShader(program, id);
-		glDeleteShader(id);
+		glDeleteProgram(program);
+		ASSERT(false, "Shader Program Compilation or Link Failure!");
+		return;
 	}
+
+	ShaderCache::SaveProgram(GetCacheName(variant.Keywords), variant.PendingSourcesHash, program);
+	SetProgram(variant, program);
+}
+
+
+void Shader::DiscardPendingProgram(Variant& variant)
+{
+	if (variant.PendingProgram == 0)
+		return;
+
+	for (auto&& [type, shader] : variant.PendingShaders)
+		glDeleteShader(shader);
+
+	glDeleteProgram(variant.PendingProgram);
+	variant.PendingProgram = 0;
+	variant.PendingShaders.clear();
+	--s_CompilingCount;
 }
 
 
-const std::unordered_map<GLenum, std::string> Shader::PreProcessShader(const std::string& source)
+void Shader::SetProgram(Variant& variant, uint program)
+{
+	// A deleted program stays in use until another one is, but it can't be the bound one
+	if (variant.ID == s_BoundProgram)
+		s_BoundProgram = 0;
+
+	if (variant.ID != s_FallbackProgram)
+		glDeleteProgram(variant.ID);
+
+	// The new program has none of the uniforms set yet
+	variant.ID = program;
+	variant.UniformLocationCache.clear();
+	variant.UniformsVersion = 0;
+	if (m_BoundVariant == &variant)
+		m_BoundVariant = nullptr;
+}
+
+
+
+// ------------------------------------------------------------------------------
+std::unordered_map<GLenum, std::string> Shader::PreProcessShader(const std::string& source)
 {
 	std::unordered_map<GLenum, std::string> ret;
+	m_IncludedFiles.clear();
+
+	// -- Token #keywords for Variants --
+	// Before the first stage, the keywords its variants can be compiled with
+	const char* keywordsToken = "#keywords";
+	size_t keywords_pos = source.find(keywordsToken);
+	m_Keywords = 0;
+	if (keywords_pos != std::string::npos && keywords_pos < source.find("#type"))
+	{
+		size_t begin = keywords_pos + strlen(keywordsToken);
+		std::istringstream keywords_line(source.substr(begin, source.find_first_of("\r\n", keywords_pos) - begin));
+		std::string keyword;
+		while (keywords_line >> keyword)
+		{
+			const char* const* name = std::find_if(std::begin(s_KeywordNames), std::end(s_KeywordNames), [&keyword](const char* name) { return keyword == name; });
+			if (name != std::end(s_KeywordNames))
+			{
+				m_Keywords |= 1 << (uint)(name - std::begin(s_KeywordNames));
+				continue;
+			}
+
+			ENGINE_LOG("Unknown keyword '%s' in Shader '%s', ignored", keyword.c_str(), m_Path.c_str());
+		}
+	}
 
 	// -- Token #type for Shader Type --
 	const char* typeToken = "#type";
 	size_t typeTokenLength = strlen(typeToken);
 	size_t pos = source.find(typeToken, 0);
+	const std::string directory = std::filesystem::path(m_Path).parent_path().generic_string();
 
 	// -- Iterate all the string --
 	while (pos != std::string::npos)
@@ -214,37 +614,70 @@ const std::unordered_map<GLenum, std::string> Shader::PreProcessShader(const std
 
 		size_t next_line_pos = source.find_first_not_of("\r\n", eol);		// Start of shader code after token
 		pos = source.find(typeToken, next_line_pos);						// Start of next shader token
-		ret[RendererUtils::ShaderTypeFromString(shader_type)] = (pos == std::string::npos) ? source.substr(next_line_pos) : source.substr(next_line_pos, pos - next_line_pos);
+		std::string stage_source = (pos == std::string::npos) ? source.substr(next_line_pos) : source.substr(next_line_pos, pos - next_line_pos);
+
+		// Each stage includes its files once
+		std::unordered_set<std::string> included;
+		ret[RendererUtils::ShaderTypeFromString(shader_type)] = ResolveIncludes(stage_source, directory, included);
 	}
 
 	return ret;
 }
 
 
-const std::string Shader::ReadShaderFile(const std::string& filepath)
+std::string Shader::ResolveIncludes(const std::string& source, const std::string& directory, std::unordered_set<std::string>& included)
 {
-	std::ifstream file(filepath, std::ios::in | std::ios::binary);
+	// -- Token #include "file" --
+	// Paths relative to the including file, the included files resolve their own includes (each file once, so cycles end)
 	std::string ret;
-
-	if (file)
+	ret.reserve(source.size());
+	size_t line_begin = 0;
+	while (line_begin < source.size())
 	{
-		// -- File Size --
-		file.seekg(0, std::ios::end);
-		size_t file_size = file.tellg();
-		
-		if (file_size != -1)
+		size_t line_end = source.find('\n', line_begin);
+		line_end = line_end == std::string::npos ? source.size() : line_end + 1;
+
+		size_t token_pos = source.find_first_not_of(" \t", line_begin);
+		if (token_pos >= line_end || source.compare(token_pos, 8, "#include") != 0)
+		{
+			ret.append(source, line_begin, line_end - line_begin);
+			line_begin = line_end;
+			continue;
+		}
+
+		size_t open_quote = source.find('"', token_pos);
+		size_t close_quote = open_quote < line_end ? source.find('"', open_quote + 1) : std::string::npos;
+		if (close_quote >= line_end)
 		{
-			// -- String as big as file size & Load file into string --			
-			ret.resize(file_size);
-			file.seekg(0, std::ios::beg); // Cursor at file beginning
-			file.read(&ret[0], file_size);
-			return ret;
+			ENGINE_LOG("Invalid #include in Shader '%s': %s", m_Path.c_str(), source.substr(token_pos, line_end - token_pos).c_str());
 		}
 		else
-			ENGINE_LOG("Couldn't read Shader file at path '%s'", filepath.c_str());
+		{
+			std::filesystem::path include_path = (std::filesystem::path(directory) / source.substr(open_quote + 1, close_quote - open_quote - 1)).lexically_normal();
+			std::string include_filepath = include_path.generic_string();
+			if (included.insert(include_filepath).second)
+			{
+				if (std::find(m_IncludedFiles.begin(), m_IncludedFiles.end(), include_filepath) == m_IncludedFiles.end())
+					m_IncludedFiles.push_back(include_filepath);
+
+				ret += ResolveIncludes(ReadShaderFile(include_filepath), include_path.parent_path().generic_string(), included);
+				ret += "\n";
+			}
+		}
+
+		line_begin = line_end;
 	}
-	else
-		ENGINE_LOG("Couldn't open Shader file at path '%s'", filepath.c_str());
 
 	return ret;
-}
\ No newline at end of file
+}
+
+
+const std::string Shader::ReadShaderFile(const std::string& filepath)
+{
+	FileUtils::VirtualFile file(filepath);
+	if (file.IsOpen())
+		return std::string((const char*)file.GetData(), file.GetSize());
+
+	ENGINE_LOG("Couldn't open Shader file at path '%s'", filepath.c_str());
+	return std::string();
+}
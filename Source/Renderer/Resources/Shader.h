@@ -5,52 +5,138 @@
 #include <glad/glad.h>
 
 #include <glm/glm.hpp>
+#include <unordered_set>
 
 
 class Shader
 {
 public:
 
+	// Feature keywords a shader declares with a "#keywords" line (before its stages), each combination drawn with is a program variant
+	// compiled with them #defined (on its first bind, binary cached), so the shading code branches on none of them at runtime
+	enum KEYWORDS : uint { HAS_NORMAL_MAP = 1 << 0, HAS_PARALLAX = 1 << 1, TWO_SIDED = 1 << 2, ALPHA_TEST = 1 << 3 };
+	static const uint s_KeywordsCount = 4;
+
 	// --- Des/Construction ---
 	Shader(const std::string& name, const std::string& vertex_src, const std::string& fragment_src);
 	Shader(const std::string& filepath);
 	~Shader();
 
 	// --- Class Methods ---
-	void Bind() const;
-	void Unbind() const;
+	// Binds the variant of the keywords it declares among these, its base one (no keywords) while that variant compiles
+	void Bind(uint keywords = 0);
+	void Unbind();
+
+	// Reloads if the file or any file it includes changed, compiling again all its variants
 	void CheckLastModification();
 
+	// --- Parallel Compilation ---
+	// Programs are submitted to the driver without waiting (compiled in parallel with GL_KHR_parallel_shader_compile, if supported)
+	// & swapped in once linked, drawing with a flat fallback program meanwhile. Renderer inits it (compiler threads & fallback program)
+	static void InitCompilation();
+	static void ShutdownCompilation();
+
+	// Polls its variants pending programs (without blocking if the driver can tell) & swaps them in once linked, on each Bind()
+	void UpdateCompilation();
+
+	// False while its base program first compiles (compute ones can't be used until then), reloads keep the previous program instead
+	bool IsReady() const;
+	static uint GetCompilingCount() { return s_CompilingCount; }
+
 	// --- Getters ---
 	const std::string& GetName() const { return m_Name; }
+	uint GetKeywords() const { return m_Keywords; }
+	uint GetVariantsCount() const { return (uint)m_Variants.size(); }
 
 public:
 
 	// --- Uniforms Cache ---
+	// In the bound variant
 	int GetUniformLocation(const std::string& uniform_name) const;
 
 	// --- Uniforms Methods ---
+	// Shared by all the variants: kept & set again on a variant bound after they changed
 	void SetUniformInt(const std::string& uniform_name, int value);
 	void SetUniformFloat(const std::string& uniform_name, float value);
+	void SetUniformVec2(const std::string& uniform_name, const glm::vec2& value);
 	void SetUniformVec3(const std::string& uniform_name, const glm::vec3& value);
 	void SetUniformVec4(const std::string& uniform_name, const glm::vec4& value);
 	void SetUniformMat4(const std::string& uniform_name, const glm::mat4& matrix);
 
 private:
 
+	// Program of a keywords combination
+	struct Variant
+	{
+		uint Keywords = 0;
+		uint ID = 0;
+		uint64 UniformsVersion = 0; // Of the shader uniforms last set on it
+		mutable std::unordered_map<std::string, int> UniformLocationCache;
+
+		// -- Pending Compilation --
+		// Program submitted & not checked yet, with its shaders (by stage)
+		uint PendingProgram = 0;
+		std::vector<std::pair<GLenum, uint>> PendingShaders;
+		uint64 PendingSourcesHash = 0;
+	};
+
+	// Value of a uniform, as set (Type is the GL one), & the uniforms version it was last changed on
+	struct UniformValue
+	{
+		GLenum Type = GL_INT;
+		int Int = 0;
+		glm::mat4 Floats = glm::mat4(0.0f);
+		uint64 Version = 0;
+
+		bool operator==(const UniformValue& value) const { return Type == value.Type && Int == value.Int && Floats == value.Floats; }
+	};
+
 	// --- Private Methods ---
-	void CompileShader(const std::unordered_map<GLenum, std::string>& shader_sources);
-	const std::unordered_map<GLenum, std::string> PreProcessShader(const std::string& source);
+	// Creates the variant the first time it's asked for, submitting its program
+	Variant& GetVariant(uint keywords);
+	bool IsVariantReady(const Variant& variant) const { return variant.ID != 0 && variant.ID != s_FallbackProgram; }
+
+	// Creates the program from its cached binary if it's valid, otherwise submits the sources (with its keywords defines) to compile & link
+	// (cached once linked)
+	void CompileVariant(Variant& variant);
+	void UpdateCompilation(Variant& variant);
+
+	// Replaces the current program (on reloads), its uniform locations are dropped
+	void SetProgram(Variant& variant, uint program);
+	void DiscardPendingProgram(Variant& variant);
+
+	// Keys the variant binary cache
+	std::string GetCacheName(uint keywords) const;
+	int GetUniformLocation(const Variant& variant, const std::string& uniform_name) const;
+	bool IsUniformInOtherVariant(const Variant& variant, const std::string& uniform_name) const;
+	void SetUniform(const std::string& uniform_name, const UniformValue& value);
+	void ApplyUniform(const Variant& variant, const std::string& uniform_name, const UniformValue& value) const;
+
+	// Splits the stages (#type), resolving the #include lines in each, & reads the #keywords line
+	std::unordered_map<GLenum, std::string> PreProcessShader(const std::string& source);
+	std::string ResolveIncludes(const std::string& source, const std::string& directory, std::unordered_set<std::string>& included);
 	const std::string ReadShaderFile(const std::string& filepath);
 
 private:
 
 	// --- Variables ---
-	uint m_ID = 0;
 	std::string m_Name = "unnamed", m_Path = "unpathed";
 	uint64 m_LastModificationTimestamp = 0;
+	std::vector<std::string> m_IncludedFiles;
+
+	// --- Variants ---
+	// By keywords (only the declared ones), all compiled from the preprocessed sources
+	uint m_Keywords = 0;
+	std::unordered_map<GLenum, std::string> m_Sources;
+	std::unordered_map<uint, Variant> m_Variants;
+	Variant* m_BoundVariant = nullptr;
+
+	// --- Uniforms ---
+	std::unordered_map<std::string, UniformValue> m_Uniforms;
+	uint64 m_UniformsVersion = 0;
 
-	mutable std::unordered_map<std::string, int> m_UniformLocationCache;
+	static uint s_FallbackProgram, s_CompilingCount, s_BoundProgram;
+	static bool s_ParallelCompile;
 };
 
 #endif //_SHADER_H_
\ No newline at end of file
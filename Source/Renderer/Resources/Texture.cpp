@@ -1,39 +1,39 @@
 #include "Texture.h"
 #include "Core/Resources/Resources.h"
+#include "Core/Utils/FileStringUtils.h"
+#include "Renderer/Utils/GPUMemory.h"
+#include "Renderer/Utils/MipmapUtils.h"
+#include "Renderer/Utils/RendererUtils.h"
+#include "Renderer/Utils/TextureCompression.h"
 
 #include <stb_image.h>
 #include <stb_image_write.h>
 
 
-// ------------------------------------------------------------------------------
-Texture::Texture(uint width, uint height) : m_Width(width), m_Height(height)
+// Decodes an image from wherever it lives (asset packs or disk)
+static stbi_uc* LoadImageData(const std::string& filepath, int* w, int* h, int* channels)
 {
-	// -- Set Parameters --
-	m_InternalFormat = GL_RGBA8;
-	m_DataFormat = GL_RGBA;
+	FileUtils::VirtualFile file(filepath);
+	if (!file.IsOpen())
+		return nullptr;
 
-	// -- Create Texture ---
-	glCreateTextures(GL_TEXTURE_2D, 1, &m_ID);
-	//glBindTexture(GL_TEXTURE_2D, m_ID);
-	glTextureStorage2D(m_ID, 1, GL_RGBA8, m_Width, m_Height);
-	
-	// -- Set Texture Parameters --
-	glTextureParameteri(m_ID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTextureParameteri(m_ID, GL_TEXTURE_MAG_FILTER, GL_NEAREST); // this gives error: GL_LINEAR_MIPMAP_LINEAR
-	glTextureParameteri(m_ID, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-	glTextureParameteri(m_ID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTextureParameteri(m_ID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-	// -- Mipmap & Unbind --
-	glGenerateMipmap(GL_TEXTURE_2D);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	return stbi_load_from_memory(file.GetData(), (int)file.GetSize(), w, h, channels, 0);
+}
+
+
+// ------------------------------------------------------------------------------
+Texture::Texture(uint width, uint height)
+{
+	// -- Create Texture --
+	// Mips are generated from the data on SetData()
+	CreateStorage(width, height, GL_RGBA8, GL_RGBA, MipmapUtils::GetLevelsCount(width, height));
 }
 
 Texture::Texture(const std::string& path)
 {
 	int w, h, channels;
 	stbi_set_flip_vertically_on_load(1);
-	stbi_uc* texture_data = stbi_load(path.c_str(), &w, &h, &channels, 0);
+	stbi_uc* texture_data = LoadImageData(path, &w, &h, &channels);
 
 	// -- Check for Failure --
 	//ASSERT(texture_data, "Failed to load texture data from path: %s", path.c_str());
@@ -44,39 +44,22 @@ Texture::Texture(const std::string& path)
 		return;
 	}
 
-	// -- Set Parameters --
-	m_Width = w; m_Height = h;
+	// -- Create Texture --
 	m_Path = path;
-
+	uint levels = MipmapUtils::GetLevelsCount(w, h);
 	if (channels == 4)
-	{
-		m_InternalFormat = GL_RGBA8;
-		m_DataFormat = GL_RGBA;
-	}
+		CreateStorage(w, h, GL_RGBA8, GL_RGBA, levels);
 	else if (channels == 3)
-	{
-		m_InternalFormat = GL_RGB8;
-		m_DataFormat = GL_RGB;
-	}
+		CreateStorage(w, h, GL_RGB8, GL_RGB, levels);
+	else
+		CreateStorage(w, h, 0, 0);
 
-	ASSERT(m_InternalFormat & m_DataFormat, "Image Format not Supported!"); // False (0) if either is 0
-	
-	// -- Set Texture Parameters --
-	glCreateTextures(GL_TEXTURE_2D, 1, &m_ID);
-	//glBindTexture(GL_TEXTURE_2D, m_ID);
-	//glTexStorage2D(GL_TEXTURE_2D, 1, m_InternalFormat, m_Width, m_Height);
-	glTextureStorage2D(m_ID, 1, m_InternalFormat, m_Width, m_Height);
-
-	glTextureParameteri(m_ID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTextureParameteri(m_ID, GL_TEXTURE_MAG_FILTER, GL_NEAREST); // this gives error: GL_LINEAR_MIPMAP_LINEAR
-	glTextureParameteri(m_ID, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-	glTextureParameteri(m_ID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTextureParameteri(m_ID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-	// -- Set Subimage, Mipmap & Unbind --
+	// -- Set Subimage & Mipmap --
+	// Synchronous loads (before the TextureLoader runs) are few & small, so their mips are left to the driver
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 	glTextureSubImage2D(m_ID, 0, 0, 0, m_Width, m_Height, m_DataFormat, GL_UNSIGNED_BYTE, texture_data);
-	glGenerateMipmap(GL_TEXTURE_2D);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glGenerateTextureMipmap(m_ID);
 
 	// -- Free STBI Image --
 	stbi_image_free(texture_data);
@@ -84,10 +67,109 @@ Texture::Texture(const std::string& path)
 
 Texture::~Texture()
 {
+	if (m_ID != 0)
+		GPUMemory::Free(GPU_MEMORY::TEXTURE, GetGPUBytes());
+
 	glDeleteTextures(1, &m_ID);
 }
 
 
+void Texture::CreateStorage(uint width, uint height, GLenum internal_format, GLenum data_format, uint levels)
+{
+	SetLevelsInfo(width, height, internal_format, data_format, levels);
+	m_ID = AllocateLevels(0);
+	m_TopLevel = 0;
+}
+
+
+void Texture::SetLevelsInfo(uint width, uint height, GLenum internal_format, GLenum data_format, uint levels)
+{
+	m_Width = width; m_Height = height;
+	m_InternalFormat = internal_format;
+	m_DataFormat = data_format;
+	m_Levels = levels;
+	m_TopLevel = m_RequestedLevel = levels;
+
+	ASSERT(m_InternalFormat != 0, "Image Format not Supported!");
+}
+
+
+uint Texture::AllocateLevels(uint top_level) const
+{
+	// -- Create Texture --
+	uint id = 0, levels = m_Levels - top_level;
+	glCreateTextures(GL_TEXTURE_2D, 1, &id);
+	glTextureStorage2D(id, levels, m_InternalFormat, std::max(m_Width >> top_level, 1u), std::max(m_Height >> top_level, 1u));
+	GPUMemory::Allocate(GPU_MEMORY::TEXTURE, GetStorageBytes(m_Width, m_Height, m_InternalFormat, top_level, m_Levels));
+
+	// -- Set Texture Parameters --
+	// Trilinear & anisotropic if it has mips
+	glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTextureParameteri(id, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	if (levels > 1)
+	{
+		static float max_anisotropy = 0.0f;
+		if (max_anisotropy == 0.0f)
+			glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &max_anisotropy);
+
+		glTextureParameterf(id, GL_TEXTURE_MAX_ANISOTROPY, std::min(RendererUtils::s_TextureMaxAnisotropy, std::max(max_anisotropy, 1.0f)));
+	}
+
+	return id;
+}
+
+
+void Texture::SwapLevelsStorage(uint new_id, uint top_level)
+{
+	// -- Copy Levels --
+	// GPU-side copy of the levels both storages have, except the new finer ones (already uploaded into new_id)
+	if (m_ID != 0)
+	{
+		for (uint level = std::max(top_level, m_TopLevel); level < m_Levels; ++level)
+		{
+			uint width = std::max(m_Width >> level, 1u), height = std::max(m_Height >> level, 1u);
+			glCopyImageSubData(m_ID, GL_TEXTURE_2D, level - m_TopLevel, 0, 0, 0, new_id, GL_TEXTURE_2D, level - top_level, 0, 0, 0, width, height, 1);
+		}
+
+		DeleteLevelsStorage(m_ID, m_TopLevel);
+	}
+
+	m_ID = new_id;
+	m_TopLevel = top_level;
+}
+
+
+void Texture::DeleteLevelsStorage(uint id, uint top_level) const
+{
+	GPUMemory::Free(GPU_MEMORY::TEXTURE, GetStorageBytes(m_Width, m_Height, m_InternalFormat, top_level, m_Levels));
+	glDeleteTextures(1, &id);
+}
+
+
+uint64 Texture::GetStorageBytes(uint width, uint height, GLenum internal_format, uint top_level, uint levels)
+{
+	// Compressed formats are stored in 4x4 blocks of 8 (BC1, BC4) or 16 bytes, RGB8 is usually padded to 4 bytes per pixel
+	bool compressed = internal_format != GL_RGBA8 && internal_format != GL_RGB8;
+	uint64 block_size = internal_format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || internal_format == GL_COMPRESSED_RED_RGTC1 ? 8 : 16;
+
+	uint64 bytes = 0;
+	for (uint level = top_level; level < levels; ++level)
+	{
+		uint64 level_width = std::max(width >> level, 1u), level_height = std::max(height >> level, 1u);
+		if (compressed)
+			bytes += ((level_width + 3) / 4) * ((level_height + 3) / 4) * block_size;
+		else
+			bytes += level_width * level_height * 4;
+	}
+
+	return bytes;
+}
+
+
 
 // ------------------------------------------------------------------------------
 void Texture::SetData(void* data, uint size)
@@ -98,13 +180,16 @@ void Texture::SetData(void* data, uint size)
 	Bind();
 	//glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_Width, m_Height, m_DataFormat, GL_UNSIGNED_BYTE, data);
 	glTextureSubImage2D(m_ID, 0, 0, 0, m_Width, m_Height, m_DataFormat, GL_UNSIGNED_BYTE, data);
+
+	if (m_Levels > 1)
+		glGenerateTextureMipmap(m_ID);
 }
 
 
 void Texture::Bind(uint slot) const
 {
 	glActiveTexture(GL_TEXTURE0 + slot);
-	glBindTexture(GL_TEXTURE_2D, m_ID);
+	glBindTexture(GL_TEXTURE_2D, GetTextureID());
 }
 
 void Texture::Unbind() const
@@ -132,12 +217,18 @@ CubemapTexture::CubemapTexture()
 	LoadTextures();
 }
 
+CubemapTexture::~CubemapTexture()
+{
+	GPUMemory::Free(GPU_MEMORY::CUBEMAP, m_GPUBytes);
+	glDeleteTextures(1, &m_ID);
+}
+
 void CubemapTexture::SetTexture(CUBEMAP_TEXTURE cubemap_texture_type, const std::string& filepath)
 {
-	if (std::filesystem::exists(filepath))
+	if (FileUtils::FileExists(filepath))
 	{
 		int w, h, channels;
-		stbi_uc* data = stbi_load(filepath.c_str(), &w, &h, &channels, 0);
+		stbi_uc* data = LoadImageData(filepath, &w, &h, &channels);
 
 		if (!data)
 		{
@@ -160,13 +251,21 @@ void CubemapTexture::LoadTextures()
 	stbi_set_flip_vertically_on_load(1);
 
 	// -- Create Cubemap Texture --
+	// Replacing the previous one, if any
+	if (m_ID != 0)
+	{
+		GPUMemory::Free(GPU_MEMORY::CUBEMAP, m_GPUBytes);
+		glDeleteTextures(1, &m_ID);
+		m_GPUBytes = 0;
+	}
+
 	glGenTextures(1, &m_ID);
 	glBindTexture(GL_TEXTURE_CUBE_MAP, m_ID);
 
 	// -- Load Cubemap Textures --
 	for (uint i = 0; i < 6; ++i)
 	{
-		texture_data.push_back(stbi_load(m_TexturePaths[i].c_str(), &w, &h, &channels, 0));
+		texture_data.push_back(LoadImageData(m_TexturePaths[i], &w, &h, &channels));
 		if (!texture_data[i])
 		{
 			ENGINE_LOG("Failed to load texture data from path: %s\nAborting...", m_TexturePaths[i].c_str());
@@ -183,6 +282,9 @@ void CubemapTexture::LoadTextures()
 	for (uint i = 0; i < 6; ++i)
 		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, texture_data[i]);
 
+	m_GPUBytes = (uint64)w * h * 8 * 6; // RGB16F, padded to RGBA
+	GPUMemory::Allocate(GPU_MEMORY::CUBEMAP, m_GPUBytes);
+
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
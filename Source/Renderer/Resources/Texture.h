@@ -7,16 +7,36 @@
 
 class CubemapTexture;
 
+// What the texture holds, decides how it's compressed (color: BC1/BC7, normal: BC5 (RG), height: BC4 (R))
+enum class TEXTURE_USAGE { COLOR = 0, NORMAL, HEIGHT };
+
 class Texture
 {
 	friend class Resources;
 	friend class Renderer;
 	friend class CubemapTexture;
+	friend class TextureLoader;
 private:
 
 	// --- Des/Construction ---
 	Texture(const std::string& path);
-	Texture() = default; // Only for cubemaps use!
+	Texture() = default; // Only for cubemaps & async loads use!
+
+	// Creates the GL texture & its storage (without data) for an image of these dimensions, data format is 0 for compressed formats
+	void CreateStorage(uint width, uint height, GLenum internal_format, GLenum data_format, uint levels = 1);
+
+	// --- Streaming ---
+	// Sets the texture dimensions & formats without any GL storage (no level resident), for streamed textures
+	void SetLevelsInfo(uint width, uint height, GLenum internal_format, GLenum data_format, uint levels);
+
+	// New GL texture with storage for levels [top_level, m_Levels) & the sampling parameters, its level 0 is this texture's top_level
+	uint AllocateLevels(uint top_level) const;
+
+	// Replaces the GL texture by new_id (allocated by AllocateLevels(top_level)), copying the levels from the current one that it didn't get uploaded
+	void SwapLevelsStorage(uint new_id, uint top_level);
+
+	// Deletes a storage allocated by AllocateLevels(top_level) that never got swapped in
+	void DeleteLevelsStorage(uint id, uint top_level) const;
 
 	// --- Class Private Methods ---
 	// Slot 0 should be left for internal stuff, 1 for white. Use from there.
@@ -31,19 +51,49 @@ public:
 	~Texture();
 
 	// --- Getters ---
-	uint GetWidth()		const { return m_Width; }
-	uint GetHeight()	const { return m_Height; }
-	uint GetTextureID()	const { return m_ID; }
+	// Of the shared storage if it's a duplicate of another texture
+	uint GetWidth()		const { return GetStorage().m_Width; }
+	uint GetHeight()	const { return GetStorage().m_Height; }
+	uint GetTextureID()	const { return GetStorage().m_ID; }
+	uint GetLevels()	const { return GetStorage().m_Levels; }
+	uint GetTopLevel()	const { return GetStorage().m_TopLevel; } // Finest level resident (m_Levels if none)
+	TEXTURE_USAGE GetUsage() const { return m_Usage; }
+	const std::string& GetPath() const { return m_Path; }
+
+	// VRAM of its resident levels (0 if it shares another texture storage)
+	uint64 GetGPUBytes() const { return m_ID != 0 ? GetStorageBytes(m_Width, m_Height, m_InternalFormat, m_TopLevel, m_Levels) : 0; }
+
+	// Size of a storage with levels [top_level, levels) of a texture of these dimensions & format
+	static uint64 GetStorageBytes(uint width, uint height, GLenum internal_format, uint top_level, uint levels);
+
+	// False while an async load is decoding/uploading it, renderer binds a default texture meanwhile
+	bool IsResident()	const { return GetStorage().m_Resident; }
 
 	// --- Operators ---
-	bool operator==(const Texture& texture) const { return m_ID == texture.m_ID; }
+	bool operator==(const Texture& texture) const { return GetTextureID() == texture.GetTextureID(); }
+
+private:
+
+	// Texture holding the GL storage, itself unless it's a duplicate
+	const Texture& GetStorage() const { return m_SharedStorage ? *m_SharedStorage : *this; }
 
 private:
 
 	// --- Variables ---
 	std::string m_Path = "unpathed"; // Debug
 	uint m_Width = 0, m_Height = 0;
-	uint m_ID = 0;
+	uint m_ID = 0, m_Levels = 1;
+	bool m_Resident = true;
+	TEXTURE_USAGE m_Usage = TEXTURE_USAGE::COLOR;
+
+	// Streaming: finest level resident & the finest one the renderer asked for (and when, in frames)
+	uint m_TopLevel = 0, m_RequestedLevel = 0;
+	uint64 m_LastRequestFrame = 0;
+
+	uint64 m_LastUsedFrame = 0; // Resources frame it was last referenced on, for the eviction LRU
+
+	// Byte-identical texture (same usage) loaded before, whose GL storage this one uses instead of having its own
+	Ref<Texture> m_SharedStorage = nullptr;
 
 	GLenum m_InternalFormat = 0, m_DataFormat = 0;
 };
@@ -57,17 +107,21 @@ public:
 	enum class CUBEMAP_TEXTURE { RIGHT, LEFT, BOTTOM, TOP, FRONT, BACK };
 
 	CubemapTexture();
+	~CubemapTexture();
+
 	void SetTexture(CUBEMAP_TEXTURE cubemap_texture_type, const std::string& filepath);
 	void LoadTextures();
 
 public:
 
 	uint GetTextureID() const { return m_ID; }
+	uint64 GetGPUBytes() const { return m_GPUBytes; }
 
 private:
 
 	uint m_ID = 0;
 	uint m_Width = 0, m_Height = 0;
+	uint64 m_GPUBytes = 0;
 
 	std::vector<std::string> m_TexturePaths;
 };
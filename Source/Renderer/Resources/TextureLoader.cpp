@@ -0,0 +1,682 @@
+#include "TextureLoader.h"
+
+#include "Texture.h"
+#include "Renderer/Utils/GPUMemory.h"
+#include "Renderer/Utils/RendererUtils.h"
+#include "Renderer/Utils/MipmapUtils.h"
+#include "Renderer/Utils/TextureCompression.h"
+#include "Core/Resources/TextureCache.h"
+#include "Core/Utils/FileStringUtils.h"
+#include "Core/Utils/JobSystem.h"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+
+
+// ------------------------------------------------------------------------------
+namespace
+{
+	struct LoadedImage
+	{
+		std::weak_ptr<Texture> TargetTexture; // Not owned, if nobody uses the texture anymore its load is dropped
+		std::string Path;
+		TEXTURE_USAGE Usage = TEXTURE_USAGE::COLOR;
+		TextureData Data; // No levels if the load failed
+
+		// Set if the worker found a byte-identical texture (same usage) already loading, nothing is processed then
+		bool IsDuplicate = false;
+		std::weak_ptr<Texture> SharedTexture;
+	};
+
+	// Finer levels being uploaded into a new storage, which replaces the texture's one once they're all uploaded
+	struct LevelsUpload
+	{
+		uint StorageID = 0;					// 0 if there's no upload in progress
+		uint TopLevel = 0;					// Finest level of the new storage
+		int NextLevel = 0;					// Uploaded from coarse to fine, down to TopLevel
+		uint NextRow = 0;					// Rows (blocks rows if compressed) of NextLevel already uploaded
+		Ref<std::atomic<bool>> Prefetched;	// Set by a worker once the levels data is read into memory (so uploads never wait on disk)
+	};
+
+	struct StreamedTexture
+	{
+		std::weak_ptr<Texture> TargetTexture;
+		Ref<TextureData> Data;	// Shared with the workers prefetching it
+		uint MinimumLevel = 0;	// Finest level always resident (the first with size <= s_TextureStreamingMinSize)
+		LevelsUpload Upload;
+		bool Resident = false;	// Once its minimum level got uploaded
+	};
+
+	struct UploadBuffer
+	{
+		GLuint ID = 0;
+		uint8_t* MappedData = nullptr;
+		GLsync Fence = nullptr; // Signaled once the GPU finished reading the uploads sourced from this buffer
+	};
+
+	static JobCounter s_Jobs;						// Decoding & prefetching jobs
+	static std::atomic<bool> s_Running = { false };	// Once stopped, queued jobs return without processing
+
+	static std::mutex s_LoadedMutex;
+	static std::vector<LoadedImage> s_LoadedImages;			// Filled by the workers
+	static std::vector<StreamedTexture> s_StreamedTextures;	// Main thread only
+	static std::atomic<uint> s_PendingTextures = { 0 };
+
+	static std::mutex s_ContentMutex;
+	static std::unordered_map<uint64, std::weak_ptr<Texture>> s_ContentRegistry; // Textures by source hash (contents, usage & version)
+
+	static UploadBuffer s_UploadBuffers[RendererUtils::s_TextureUploadBuffers];
+	static uint s_CurrentUploadBuffer = 0;
+	static uint s_UploadedBytesLastFrame = 0;
+
+	static uint64 s_StreamingBudget = RendererUtils::s_TextureStreamingBudget;
+	static uint64 s_StreamedBytes = 0;
+	static uint64 s_FrameCount = 0;
+
+	// Queried on Init(), S3TC is an extension & BPTC might be missing in old drivers
+	static bool s_S3TCSupported = false, s_BPTCSupported = false;
+
+
+	// --- Processing ---
+	TextureCompression::BC_FORMAT ChooseFormat(TEXTURE_USAGE usage, bool has_alpha)
+	{
+		using TextureCompression::BC_FORMAT;
+		switch (usage)
+		{
+			case TEXTURE_USAGE::NORMAL:	return BC_FORMAT::BC5;
+			case TEXTURE_USAGE::HEIGHT:	return BC_FORMAT::BC4;
+			case TEXTURE_USAGE::COLOR:
+				if (has_alpha)
+					return s_BPTCSupported ? BC_FORMAT::BC7 : (s_S3TCSupported ? BC_FORMAT::BC3 : BC_FORMAT::NONE);
+
+				return s_S3TCSupported ? BC_FORMAT::BC1 : (s_BPTCSupported ? BC_FORMAT::BC7 : BC_FORMAT::NONE);
+		}
+
+		return BC_FORMAT::NONE;
+	}
+
+	bool IsFormatSupported(GLenum internal_format)
+	{
+		if (internal_format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || internal_format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+			return s_S3TCSupported;
+		if (internal_format == GL_COMPRESSED_RGBA_BPTC_UNORM)
+			return s_BPTCSupported;
+
+		return true;
+	}
+
+	// Full mip chain of the image, each level block-compressed in the format (or kept as RGBA8 if NONE)
+	// Color mips are Kaiser-filtered in linear space, normals & heights box-filtered (normals renormalized)
+	void BuildMipChain(const uint8_t* pixels, uint width, uint height, TEXTURE_USAGE usage, TextureCompression::BC_FORMAT format, TextureData& texture_data)
+	{
+		bool compressed = format != TextureCompression::BC_FORMAT::NONE;
+		texture_data.InternalFormat = compressed ? TextureCompression::GetGLFormat(format) : GL_RGBA8;
+		texture_data.DataFormat = compressed ? 0 : GL_RGBA;
+
+		MipmapUtils::MIP_FILTER filter = usage == TEXTURE_USAGE::COLOR ? MipmapUtils::MIP_FILTER::KAISER : MipmapUtils::MIP_FILTER::BOX;
+		MipmapUtils::MIP_DATA data = usage == TEXTURE_USAGE::COLOR ? MipmapUtils::MIP_DATA::COLOR : (usage == TEXTURE_USAGE::NORMAL ? MipmapUtils::MIP_DATA::NORMAL : MipmapUtils::MIP_DATA::LINEAR);
+
+		uint levels_count = MipmapUtils::GetLevelsCount(width, height);
+		std::vector<uint8_t> level_pixels(pixels, pixels + (size_t)width * height * 4), next_level_pixels;
+
+		for (uint i = 0; i < levels_count; ++i)
+		{
+			TextureMipLevel level;
+			level.Width = width; level.Height = height;
+			level.Offset = texture_data.Data.size();
+			level.Size = compressed ? TextureCompression::GetCompressedSize(format, width, height) : (uint64)width * height * 4;
+			texture_data.Levels.push_back(level);
+			texture_data.Data.resize(level.Offset + level.Size);
+
+			if (compressed)
+				TextureCompression::CompressImage(format, level_pixels.data(), width, height, texture_data.Data.data() + level.Offset);
+			else
+				memcpy(texture_data.Data.data() + level.Offset, level_pixels.data(), level.Size);
+
+			if (i + 1 < levels_count)
+			{
+				next_level_pixels.resize((size_t)MipmapUtils::GetNextLevelSize(width) * MipmapUtils::GetNextLevelSize(height) * 4);
+				MipmapUtils::Downsample(level_pixels.data(), width, height, next_level_pixels.data(), filter, data);
+				level_pixels.swap(next_level_pixels);
+				width = MipmapUtils::GetNextLevelSize(width); height = MipmapUtils::GetNextLevelSize(height);
+			}
+		}
+	}
+
+	// Worker threads: returns true if there's another texture with this source hash, otherwise registers this one
+	// Textures are never locked here (they can't be destroyed out of the main thread), so the duplicate might expire before it's shared
+	bool FindDuplicate(uint64 source_hash, LoadedImage& image)
+	{
+		if (!RendererUtils::s_TextureContentDeduplication)
+			return false;
+
+		std::lock_guard<std::mutex> lock(s_ContentMutex);
+		std::weak_ptr<Texture>& registered = s_ContentRegistry[source_hash];
+		bool is_itself = !registered.owner_before(image.TargetTexture) && !image.TargetTexture.owner_before(registered);
+		if (registered.expired() || is_itself)
+		{
+			registered = image.TargetTexture;
+			return false;
+		}
+
+		image.IsDuplicate = true;
+		image.SharedTexture = registered;
+		return true;
+	}
+
+	// Worker threads: gets the processed texture from the cache or decodes, mips & compresses it (and caches it)
+	void ProcessImage(LoadedImage image)
+	{
+		if (!s_Running)
+			return;
+
+		if (!image.TargetTexture.expired())
+		{
+			FileUtils::VirtualFile file(image.Path);
+			if (file.IsOpen())
+			{
+				uint64 source_hash = TextureCache::GetSourceHash(file.GetData(), file.GetSize(), image.Usage);
+				if (FindDuplicate(source_hash, image))
+				{
+					std::lock_guard<std::mutex> lock(s_LoadedMutex);
+					s_LoadedImages.push_back(std::move(image));
+					return;
+				}
+
+				if (!TextureCache::LoadTexture(image.Path, image.Usage, source_hash, image.Data) || !IsFormatSupported(image.Data.InternalFormat))
+				{
+					image.Data = TextureData();
+
+					int width, height, channels;
+					stbi_set_flip_vertically_on_load_thread(1);
+					stbi_uc* pixels = stbi_load_from_memory(file.GetData(), (int)file.GetSize(), &width, &height, &channels, 4);
+					if (pixels)
+					{
+						bool has_alpha = false;
+						if (channels == 4 || channels == 2)
+						{
+							for (size_t i = 3; i < (size_t)width * height * 4 && !has_alpha; i += 4)
+								has_alpha = pixels[i] != 255;
+						}
+
+						BuildMipChain(pixels, width, height, image.Usage, ChooseFormat(image.Usage, has_alpha), image.Data);
+						stbi_image_free(pixels);
+
+						// Streamed from the mapped cache from now on, so the chain isn't kept in memory
+						TextureData texture_data;
+						if (TextureCache::SaveTexture(image.Path, image.Usage, source_hash, image.Data) && TextureCache::LoadTexture(image.Path, image.Usage, source_hash, texture_data))
+							image.Data = std::move(texture_data);
+					}
+				}
+			}
+
+			if (image.Data.Levels.empty())
+				ENGINE_LOG("Failed to load texture data from path: %s", image.Path.c_str());
+		}
+
+		std::lock_guard<std::mutex> lock(s_LoadedMutex);
+		s_LoadedImages.push_back(std::move(image));
+	}
+
+	// Worker threads: reads the levels data (paging it in from the mapped cache file) so the main thread copies it from memory
+	void PrefetchLevels(Ref<TextureData> texture_data, uint first_level, uint last_level, Ref<std::atomic<bool>> prefetched)
+	{
+		if (!s_Running)
+			return;
+
+		uint checksum = 0;
+		for (uint level = first_level; level <= last_level; ++level)
+		{
+			const uint8_t* data = texture_data->GetLevelData(level);
+			for (uint64 offset = 0; offset < texture_data->Levels[level].Size; offset += 4096)
+				checksum += data[offset];
+		}
+
+		static std::atomic<uint> s_Checksum = { 0 }; // Just so the reads aren't optimized away
+		s_Checksum += checksum;
+		*prefetched = true;
+	}
+
+
+	// --- Streaming ---
+	uint64 GetLevelsSize(const TextureData& texture_data, uint top_level)
+	{
+		uint64 size = 0;
+		for (uint level = top_level; level < texture_data.Levels.size(); ++level)
+			size += texture_data.Levels[level].Size;
+
+		return size;
+	}
+
+	// Bytes of VRAM it has allocated (including the storage being uploaded)
+	uint64 GetAllocatedBytes(const StreamedTexture& streamed, const Texture& texture)
+	{
+		uint64 size = texture.GetTopLevel() < texture.GetLevels() ? GetLevelsSize(*streamed.Data, texture.GetTopLevel()) : 0;
+		if (streamed.Upload.StorageID != 0)
+			size += GetLevelsSize(*streamed.Data, streamed.Upload.TopLevel);
+
+		return size;
+	}
+
+	// For uploads whose texture is gone (otherwise Texture::DeleteLevelsStorage() does it)
+	void DeleteUploadStorage(const StreamedTexture& streamed)
+	{
+		const TextureData& data = *streamed.Data;
+		GPUMemory::Free(GPU_MEMORY::TEXTURE, Texture::GetStorageBytes(data.Levels[0].Width, data.Levels[0].Height, data.InternalFormat, streamed.Upload.TopLevel, (uint)data.Levels.size()));
+		glDeleteTextures(1, &streamed.Upload.StorageID);
+	}
+}
+
+
+
+// ------------------------------------------------------------------------------
+void TextureLoader::Init()
+{
+	// -- Check Compressed Formats Support --
+	GLint s3tc_supported = GL_FALSE, bptc_supported = GL_FALSE;
+	glGetInternalformativ(GL_TEXTURE_2D, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_INTERNALFORMAT_SUPPORTED, 1, &s3tc_supported);
+	glGetInternalformativ(GL_TEXTURE_2D, GL_COMPRESSED_RGBA_BPTC_UNORM, GL_INTERNALFORMAT_SUPPORTED, 1, &bptc_supported);
+	s_S3TCSupported = s3tc_supported == GL_TRUE;
+	s_BPTCSupported = bptc_supported == GL_TRUE;
+
+	// -- Create Upload Buffers Ring --
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	for (UploadBuffer& buffer : s_UploadBuffers)
+	{
+		glCreateBuffers(1, &buffer.ID);
+		glNamedBufferStorage(buffer.ID, RendererUtils::s_TextureUploadBudget, nullptr, flags);
+		buffer.MappedData = (uint8_t*)glMapNamedBufferRange(buffer.ID, 0, RendererUtils::s_TextureUploadBudget, flags);
+		ASSERT(buffer.MappedData, "Couldn't map Texture Upload Buffer");
+	}
+
+	// -- Start Processing --
+	s_Running = true;
+	ENGINE_LOG("Texture Loader using %i processing threads (S3TC %s, BPTC %s)", JobSystem::GetThreadsCount(), s_S3TCSupported ? "supported" : "unsupported", s_BPTCSupported ? "supported" : "unsupported");
+}
+
+
+void TextureLoader::Shutdown()
+{
+	// -- Stop Jobs & Drop Pending Images --
+	// The queued ones return right away, only the ones already running are waited for
+	s_Running = false;
+	JobSystem::Wait(s_Jobs);
+
+	for (StreamedTexture& streamed : s_StreamedTextures)
+		if (streamed.Upload.StorageID != 0)
+			DeleteUploadStorage(streamed);
+
+	s_LoadedImages.clear();
+	s_StreamedTextures.clear();
+	s_ContentRegistry.clear();
+	s_PendingTextures = 0;
+	s_StreamedBytes = 0;
+
+	// -- Delete Upload Buffers --
+	for (UploadBuffer& buffer : s_UploadBuffers)
+	{
+		if (buffer.Fence)
+			glDeleteSync(buffer.Fence);
+
+		glUnmapNamedBuffer(buffer.ID);
+		glDeleteBuffers(1, &buffer.ID);
+		buffer = UploadBuffer();
+	}
+}
+
+
+
+// ------------------------------------------------------------------------------
+Ref<Texture> TextureLoader::LoadAsync(const std::string& filepath, TEXTURE_USAGE usage)
+{
+	if (!s_Running)
+		return nullptr;
+
+	Ref<Texture> texture = CreateRef<Texture>(new Texture());
+	texture->m_Path = filepath;
+	texture->m_Usage = usage;
+	texture->m_Resident = false;
+
+	LoadedImage image;
+	image.TargetTexture = texture;
+	image.Path = filepath;
+	image.Usage = usage;
+
+	++s_PendingTextures;
+	JobSystem::RunBackground([image]() { ProcessImage(image); }, &s_Jobs);
+	return texture;
+}
+
+
+void TextureLoader::RequestLevel(Texture* texture, uint level)
+{
+	if (texture->m_SharedStorage)
+		texture = texture->m_SharedStorage.get();
+
+	if (texture->m_LastRequestFrame != s_FrameCount)
+	{
+		texture->m_LastRequestFrame = s_FrameCount;
+		texture->m_RequestedLevel = level;
+	}
+	else
+		texture->m_RequestedLevel = std::min(texture->m_RequestedLevel, level);
+}
+
+
+uint TextureLoader::GetStreamingLevel(const Texture* texture, float projected_size)
+{
+	// One texel per pixel, assuming the texture covers the mesh once
+	float texture_size = (float)std::max(texture->GetWidth(), texture->GetHeight());
+	float level = floorf(log2f(texture_size / std::max(projected_size, 1.0f)));
+	return (uint)std::min(std::max(level, 0.0f), (float)(texture->GetLevels() - 1));
+}
+
+
+
+// ------------------------------------------------------------------------------
+uint TextureLoader::GetPendingTexturesCount()
+{
+	return s_PendingTextures;
+}
+
+uint TextureLoader::GetUploadedBytesLastFrame()
+{
+	return s_UploadedBytesLastFrame;
+}
+
+uint64 TextureLoader::GetStreamedBytes()
+{
+	return s_StreamedBytes;
+}
+
+uint64 TextureLoader::GetStreamingBudget()
+{
+	return s_StreamingBudget;
+}
+
+void TextureLoader::SetStreamingBudget(uint64 budget_bytes)
+{
+	s_StreamingBudget = budget_bytes;
+}
+
+
+
+// ------------------------------------------------------------------------------
+void TextureLoader::StartUpload(uint streamed_index, uint top_level)
+{
+	StreamedTexture& streamed = s_StreamedTextures[streamed_index];
+	Ref<Texture> texture = streamed.TargetTexture.lock();
+
+	LevelsUpload& upload = streamed.Upload;
+	upload.StorageID = texture->AllocateLevels(top_level);
+	upload.TopLevel = top_level;
+	upload.NextLevel = (int)texture->m_TopLevel - 1;
+	upload.NextRow = 0;
+	upload.Prefetched = CreateRef<std::atomic<bool>>(streamed.Data->File == nullptr);
+
+	if (!*upload.Prefetched)
+	{
+		Ref<TextureData> texture_data = streamed.Data;
+		Ref<std::atomic<bool>> prefetched = upload.Prefetched;
+		uint last_level = (uint)upload.NextLevel;
+		JobSystem::RunBackground([texture_data, top_level, last_level, prefetched]() { PrefetchLevels(texture_data, top_level, last_level, prefetched); }, &s_Jobs);
+	}
+}
+
+
+uint64 TextureLoader::EvictLevels(uint64 needed_bytes, uint64 protected_frame)
+{
+	// -- Get Least Recently Needed Textures --
+	std::vector<std::pair<uint, Ref<Texture>>> candidates;
+	for (uint i = 0; i < s_StreamedTextures.size(); ++i)
+	{
+		Ref<Texture> texture = s_StreamedTextures[i].TargetTexture.lock();
+		if (texture && s_StreamedTextures[i].Upload.StorageID == 0 && texture->m_TopLevel < s_StreamedTextures[i].MinimumLevel)
+			candidates.push_back({ i, texture });
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) { return a.second->m_LastRequestFrame < b.second->m_LastRequestFrame; });
+
+	// -- Free their Finest Levels --
+	// Textures needed recently only lose the levels finer than the ones they need
+	uint64 freed_bytes = 0;
+	for (auto& [index, texture] : candidates)
+	{
+		if (freed_bytes >= needed_bytes)
+			break;
+
+		const StreamedTexture& streamed = s_StreamedTextures[index];
+		uint floor_level = texture->m_LastRequestFrame >= protected_frame ? std::min(texture->m_RequestedLevel, streamed.MinimumLevel) : streamed.MinimumLevel;
+
+		uint top_level = texture->m_TopLevel;
+		while (top_level < floor_level && freed_bytes < needed_bytes)
+			freed_bytes += streamed.Data->Levels[top_level++].Size;
+
+		if (top_level != texture->m_TopLevel)
+			texture->SwapLevelsStorage(texture->AllocateLevels(top_level), top_level);
+	}
+
+	return freed_bytes;
+}
+
+
+
+// ------------------------------------------------------------------------------
+void TextureLoader::Update()
+{
+	s_UploadedBytesLastFrame = 0;
+
+	// -- Register Processed Images --
+	// Nothing is allocated yet, their minimum levels are streamed in first
+	std::vector<LoadedImage> loaded_images;
+	{
+		std::lock_guard<std::mutex> lock(s_LoadedMutex);
+		loaded_images.swap(s_LoadedImages);
+	}
+
+	for (LoadedImage& image : loaded_images)
+	{
+		Ref<Texture> texture = image.TargetTexture.lock();
+		if (texture && image.IsDuplicate)
+		{
+			// -- Share Duplicate Storage --
+			// If the duplicate is gone by now, it's processed again (registering itself instead)
+			if (Ref<Texture> shared_texture = image.SharedTexture.lock())
+			{
+				texture->m_SharedStorage = shared_texture;
+				--s_PendingTextures;
+			}
+			else
+			{
+				image.IsDuplicate = false;
+				image.SharedTexture.reset();
+				JobSystem::RunBackground([image]() { ProcessImage(image); }, &s_Jobs);
+			}
+
+			continue;
+		}
+
+		if (!texture || image.Data.Levels.empty())
+		{
+			--s_PendingTextures;
+			continue;
+		}
+
+		StreamedTexture streamed;
+		streamed.TargetTexture = texture;
+		streamed.Data = CreateRef<TextureData>(std::move(image.Data));
+
+		const std::vector<TextureMipLevel>& levels = streamed.Data->Levels;
+		texture->SetLevelsInfo(levels[0].Width, levels[0].Height, streamed.Data->InternalFormat, streamed.Data->DataFormat, (uint)levels.size());
+
+		while (streamed.MinimumLevel + 1 < levels.size() && std::max(levels[streamed.MinimumLevel].Width, levels[streamed.MinimumLevel].Height) > RendererUtils::s_TextureStreamingMinSize)
+			++streamed.MinimumLevel;
+
+		s_StreamedTextures.push_back(std::move(streamed));
+	}
+
+	// -- Drop Unused Textures & Count VRAM --
+	s_StreamedBytes = 0;
+	for (uint i = 0; i < s_StreamedTextures.size();)
+	{
+		StreamedTexture& streamed = s_StreamedTextures[i];
+		Ref<Texture> texture = streamed.TargetTexture.lock();
+		if (texture)
+		{
+			s_StreamedBytes += GetAllocatedBytes(streamed, *texture);
+			++i;
+			continue;
+		}
+
+		if (streamed.Upload.StorageID != 0)
+			DeleteUploadStorage(streamed);
+
+		if (!streamed.Resident)
+			--s_PendingTextures;
+
+		s_StreamedTextures[i] = std::move(s_StreamedTextures.back());
+		s_StreamedTextures.pop_back();
+	}
+
+	// -- Keep Within Budget --
+	if (s_StreamedBytes > s_StreamingBudget)
+		s_StreamedBytes -= EvictLevels(s_StreamedBytes - s_StreamingBudget, s_FrameCount);
+
+	// -- Start Uploads of Needed Levels --
+	// New textures (their minimum levels) first, then the coarser requests (cheaper, so more textures get sharper); if there's no room, LRU levels are evicted
+	std::vector<std::pair<uint, Ref<Texture>>> candidates;
+	for (uint i = 0; i < s_StreamedTextures.size(); ++i)
+	{
+		Ref<Texture> texture = s_StreamedTextures[i].TargetTexture.lock();
+		bool is_new = texture->m_TopLevel == texture->m_Levels;
+		if (s_StreamedTextures[i].Upload.StorageID == 0 && (is_new || (texture->m_LastRequestFrame == s_FrameCount && texture->m_RequestedLevel < texture->m_TopLevel)))
+			candidates.push_back({ i, texture });
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b)
+	{
+		bool a_new = a.second->m_TopLevel == a.second->m_Levels, b_new = b.second->m_TopLevel == b.second->m_Levels;
+		return a_new != b_new ? a_new : a.second->m_RequestedLevel > b.second->m_RequestedLevel;
+	});
+
+	for (auto& [index, texture] : candidates)
+	{
+		const StreamedTexture& streamed = s_StreamedTextures[index];
+		if (texture->m_TopLevel == texture->m_Levels)
+		{
+			StartUpload(index, streamed.MinimumLevel);
+			s_StreamedBytes += GetLevelsSize(*streamed.Data, streamed.MinimumLevel);
+			continue;
+		}
+
+		// While the new storage is uploaded both are allocated, so that's what has to fit
+		uint top_level = std::min(texture->m_RequestedLevel, streamed.MinimumLevel);
+		uint64 needed_bytes = GetLevelsSize(*streamed.Data, top_level);
+		if (s_StreamedBytes + needed_bytes > s_StreamingBudget)
+			s_StreamedBytes -= EvictLevels(s_StreamedBytes + needed_bytes - s_StreamingBudget, s_FrameCount);
+
+		while (top_level < texture->m_TopLevel && s_StreamedBytes + GetLevelsSize(*streamed.Data, top_level) > s_StreamingBudget)
+			++top_level;
+
+		if (top_level < texture->m_TopLevel)
+		{
+			StartUpload(index, top_level);
+			s_StreamedBytes += GetLevelsSize(*streamed.Data, top_level);
+		}
+	}
+
+	++s_FrameCount;
+
+	// -- Get Next Upload Buffer --
+	// If the GPU is still reading from it (uploads from some frames ago), wait for the next frame instead of stalling
+	UploadBuffer& buffer = s_UploadBuffers[s_CurrentUploadBuffer];
+	if (buffer.Fence)
+	{
+		GLenum wait_result = glClientWaitSync(buffer.Fence, 0, 0);
+		if (wait_result == GL_TIMEOUT_EXPIRED)
+			return;
+
+		glDeleteSync(buffer.Fence);
+		buffer.Fence = nullptr;
+	}
+
+	// -- Upload Levels --
+	// Levels bigger than the budget are uploaded in bands of rows (of 4x4 blocks if compressed) along several frames
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.ID);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	uint used_bytes = 0;
+	for (uint i = 0; i < s_StreamedTextures.size() && used_bytes < RendererUtils::s_TextureUploadBudget; ++i)
+	{
+		StreamedTexture& streamed = s_StreamedTextures[i];
+		LevelsUpload& upload = streamed.Upload;
+		if (upload.StorageID == 0 || !*upload.Prefetched)
+			continue;
+
+		const TextureData& data = *streamed.Data;
+		bool budget_full = false;
+		while (upload.NextLevel >= (int)upload.TopLevel)
+		{
+			const TextureMipLevel& level = data.Levels[upload.NextLevel];
+			uint row_height = data.IsCompressed() ? 4 : 1;
+			uint level_rows = (level.Height + row_height - 1) / row_height;
+			uint row_size = (uint)(level.Size / level_rows);
+
+			uint rows = std::min((RendererUtils::s_TextureUploadBudget - used_bytes) / row_size, level_rows - upload.NextRow);
+			if (rows == 0)
+			{
+				budget_full = true;
+				break;
+			}
+
+			uint y = upload.NextRow * row_height;
+			uint height = std::min(rows * row_height, level.Height - y);
+			uint storage_level = (uint)upload.NextLevel - upload.TopLevel;
+			memcpy(buffer.MappedData + used_bytes, data.GetLevelData(upload.NextLevel) + (size_t)upload.NextRow * row_size, (size_t)rows * row_size);
+
+			if (data.IsCompressed())
+				glCompressedTextureSubImage2D(upload.StorageID, storage_level, 0, y, level.Width, height, data.InternalFormat, rows * row_size, (const void*)(uintptr_t)used_bytes);
+			else
+				glTextureSubImage2D(upload.StorageID, storage_level, 0, y, level.Width, height, data.DataFormat, GL_UNSIGNED_BYTE, (const void*)(uintptr_t)used_bytes);
+
+			used_bytes += rows * row_size;
+			upload.NextRow += rows;
+
+			if (upload.NextRow == level_rows)
+			{
+				--upload.NextLevel;
+				upload.NextRow = 0;
+			}
+		}
+
+		if (budget_full)
+			break;
+
+		// -- Swap Storage --
+		// Levels the old storage had are copied on the GPU
+		Ref<Texture> texture = streamed.TargetTexture.lock();
+		texture->SwapLevelsStorage(upload.StorageID, upload.TopLevel);
+		if (!streamed.Resident)
+		{
+			streamed.Resident = texture->m_Resident = true;
+			--s_PendingTextures;
+		}
+
+		upload = LevelsUpload();
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	// -- Fence & Advance Ring --
+	if (used_bytes > 0)
+	{
+		buffer.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		s_CurrentUploadBuffer = (s_CurrentUploadBuffer + 1) % RendererUtils::s_TextureUploadBuffers;
+	}
+
+	s_UploadedBytesLastFrame = used_bytes;
+}
@@ -0,0 +1,52 @@
+#ifndef _TEXTURELOADER_H_
+#define _TEXTURELOADER_H_
+
+#include "Core/Globals.h"
+#include "Texture.h"
+
+
+// Loads textures without blocking the render thread: worker threads take them from the TextureCache or decode, mip & block-compress them
+// (by usage), then they're uploaded through a ring of persistently mapped PBOs, never more than RendererUtils::s_TextureUploadBudget bytes per frame
+// Mips are streamed: only the coarsest ones (up to s_TextureStreamingMinSize) are loaded at first, finer ones are streamed in from the mapped
+// cache as the renderer requests them & evicted (least recently requested first) to keep the textures VRAM within the streaming budget
+class TextureLoader
+{
+	friend class Renderer;
+	friend class Application;
+public:
+
+	// Returns a non-resident texture that becomes resident once decoded & uploaded, nullptr if called before Init()
+	static Ref<Texture> LoadAsync(const std::string& filepath, TEXTURE_USAGE usage = TEXTURE_USAGE::COLOR);
+
+	// --- Streaming ---
+	// Renderer, each frame a texture is drawn: the finest level needed (the finest of all requests in a frame is kept)
+	static void RequestLevel(Texture* texture, uint level);
+
+	// Level with about a texel per pixel for a texture covering projected_size pixels on screen
+	static uint GetStreamingLevel(const Texture* texture, float projected_size);
+
+	static void SetStreamingBudget(uint64 budget_bytes);
+
+	// --- Getters ---
+	static uint GetPendingTexturesCount();
+	static uint GetUploadedBytesLastFrame();
+	static uint64 GetStreamedBytes();
+	static uint64 GetStreamingBudget();
+
+private:
+
+	static void Init();
+	static void Shutdown();
+
+	// Main thread, once per frame: picks the levels to stream in/out & uploads them within the budget
+	static void Update();
+
+	// Allocates a storage for the levels [top_level, ...) & starts uploading the ones not resident (coarse to fine)
+	static void StartUpload(uint streamed_index, uint top_level);
+
+	// Drops the finest levels of the least recently requested textures until needed_bytes are freed (or nothing else can be)
+	// Textures requested since protected_frame keep the levels they requested, returns the bytes freed
+	static uint64 EvictLevels(uint64 needed_bytes, uint64 protected_frame);
+};
+
+#endif //_TEXTURELOADER_H_
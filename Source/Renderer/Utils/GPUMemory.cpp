@@ -0,0 +1,49 @@
+#include "GPUMemory.h"
+
+#include <algorithm>
+
+
+// ------------------------------------------------------------------------------
+uint64 GPUMemory::s_AllocatedBytes[(int)GPU_MEMORY::MAX] = {};
+uint64 GPUMemory::s_PeakBytes[(int)GPU_MEMORY::MAX] = {};
+uint64 GPUMemory::s_TotalBytes = 0;
+uint64 GPUMemory::s_TotalPeakBytes = 0;
+
+
+// ------------------------------------------------------------------------------
+void GPUMemory::Allocate(GPU_MEMORY category, uint64 bytes)
+{
+	uint64& allocated = s_AllocatedBytes[(int)category];
+	allocated += bytes;
+	s_TotalBytes += bytes;
+
+	s_PeakBytes[(int)category] = std::max(s_PeakBytes[(int)category], allocated);
+	s_TotalPeakBytes = std::max(s_TotalPeakBytes, s_TotalBytes);
+}
+
+void GPUMemory::Free(GPU_MEMORY category, uint64 bytes)
+{
+	uint64& allocated = s_AllocatedBytes[(int)category];
+	ASSERT(bytes <= allocated, "Freeing more GPU memory than allocated!");
+
+	bytes = std::min(bytes, allocated);
+	allocated -= bytes;
+	s_TotalBytes -= bytes;
+}
+
+
+const char* GPUMemory::GetCategoryName(GPU_MEMORY category)
+{
+	switch (category)
+	{
+		case GPU_MEMORY::TEXTURE:		return "Textures";
+		case GPU_MEMORY::VERTEX_BUFFER:	return "Vertex Buffers";
+		case GPU_MEMORY::INDEX_BUFFER:	return "Index Buffers";
+		case GPU_MEMORY::STORAGE_BUFFER:	return "Storage Buffers";
+		case GPU_MEMORY::FRAMEBUFFER:	return "Framebuffers";
+		case GPU_MEMORY::CUBEMAP:		return "Cubemaps";
+		case GPU_MEMORY::MAX:			ASSERT(false, "GPU_MEMORY::MAX is not a category!"); break;
+	}
+
+	return "Unknown";
+}
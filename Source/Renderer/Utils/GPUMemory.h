@@ -0,0 +1,33 @@
+#ifndef _GPUMEMORY_H_
+#define _GPUMEMORY_H_
+
+#include "Core/Globals.h"
+
+
+// What a GPU allocation is for, used to group the VRAM accounting
+enum class GPU_MEMORY { TEXTURE = 0, VERTEX_BUFFER, INDEX_BUFFER, STORAGE_BUFFER, FRAMEBUFFER, CUBEMAP, MAX };
+
+// Bytes of VRAM held by the engine resources (as requested to GL, drivers may pad them), per category, and their high-water marks
+// Resources report their storage when they (re)allocate & free it. Main thread only, like any GL call
+class GPUMemory
+{
+public:
+
+	static void Allocate(GPU_MEMORY category, uint64 bytes);
+	static void Free(GPU_MEMORY category, uint64 bytes);
+
+	// --- Getters ---
+	static uint64 GetAllocatedBytes(GPU_MEMORY category)	{ return s_AllocatedBytes[(int)category]; }
+	static uint64 GetPeakBytes(GPU_MEMORY category)			{ return s_PeakBytes[(int)category]; }
+	static uint64 GetTotalBytes()							{ return s_TotalBytes; }
+	static uint64 GetTotalPeakBytes()						{ return s_TotalPeakBytes; }
+	static const char* GetCategoryName(GPU_MEMORY category);
+
+private:
+
+	static uint64 s_AllocatedBytes[(int)GPU_MEMORY::MAX];
+	static uint64 s_PeakBytes[(int)GPU_MEMORY::MAX];
+	static uint64 s_TotalBytes, s_TotalPeakBytes;
+};
+
+#endif //_GPUMEMORY_H_
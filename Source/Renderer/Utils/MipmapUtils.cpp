@@ -0,0 +1,267 @@
+#include "MipmapUtils.h"
+
+#include <algorithm>
+#include <emmintrin.h>
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#endif
+
+
+// ------------------------------------------------------------------------------
+namespace
+{
+	using MipmapUtils::MIP_DATA;
+
+	static const uint s_LinearToSRGBSize = 4096;	// Entries of the linear->sRGB table (enough precision for 8 bits even in darks)
+	static const int s_KaiserTaps = 6;				// Source pixels per output pixel & dimension
+	static const double s_KaiserAlpha = 4.0;		// Window shape, higher is smoother (less ringing, blurrier)
+
+	// Built once (thread-safe static init), used by all workers
+	struct FilterTables
+	{
+		float SRGBToLinear[256];
+		uint8_t LinearToSRGB[s_LinearToSRGBSize];
+		float KaiserWeights[s_KaiserTaps]; // For source pixels at -2.5, -1.5 ... 2.5 pixels from the output pixel center
+
+		FilterTables()
+		{
+			// -- sRGB Conversions --
+			for (uint i = 0; i < 256; ++i)
+			{
+				double c = i / 255.0;
+				SRGBToLinear[i] = (float)(c <= 0.04045 ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4));
+			}
+
+			for (uint i = 0; i < s_LinearToSRGBSize; ++i)
+			{
+				double l = (double)i / (s_LinearToSRGBSize - 1);
+				double c = l <= 0.0031308 ? l * 12.92 : 1.055 * pow(l, 1.0 / 2.4) - 0.055;
+				LinearToSRGB[i] = (uint8_t)std::min(std::max(c * 255.0 + 0.5, 0.0), 255.0);
+			}
+
+			// -- Kaiser Weights --
+			// Sinc at half the source rate (the new Nyquist), windowed by Kaiser over the taps & normalized
+			auto bessel_i0 = [](double x)
+			{
+				double sum = 1.0, term = 1.0;
+				for (int k = 1; k < 32; ++k)
+				{
+					term *= (x / (2.0 * k)) * (x / (2.0 * k));
+					sum += term;
+				}
+
+				return sum;
+			};
+
+			const double pi = 3.14159265358979323846, half_width = s_KaiserTaps / 2.0;
+			double total = 0.0, weights[s_KaiserTaps];
+			for (int i = 0; i < s_KaiserTaps; ++i)
+			{
+				double distance = i - half_width + 0.5;
+				double x = distance / 2.0;
+				double sinc = sin(pi * x) / (pi * x);
+				double window = bessel_i0(s_KaiserAlpha * sqrt(1.0 - (distance / half_width) * (distance / half_width))) / bessel_i0(s_KaiserAlpha);
+				weights[i] = sinc * window;
+				total += weights[i];
+			}
+
+			for (int i = 0; i < s_KaiserTaps; ++i)
+				KaiserWeights[i] = (float)(weights[i] / total);
+		}
+	};
+
+	const FilterTables& GetTables()
+	{
+		static const FilterTables tables;
+		return tables;
+	}
+
+
+	// --- Rows Conversion ---
+	// RGBA8 row to RGBA float row in [0, 1], linearized if color
+	void RowToFloat(const uint8_t* src, uint width, MIP_DATA data, float* dst)
+	{
+		const FilterTables& tables = GetTables();
+		for (uint x = 0; x < width; ++x, src += 4, dst += 4)
+		{
+			if (data == MIP_DATA::COLOR)
+			{
+				dst[0] = tables.SRGBToLinear[src[0]];
+				dst[1] = tables.SRGBToLinear[src[1]];
+				dst[2] = tables.SRGBToLinear[src[2]];
+			}
+			else
+			{
+				dst[0] = src[0] / 255.0f;
+				dst[1] = src[1] / 255.0f;
+				dst[2] = src[2] / 255.0f;
+			}
+
+			dst[3] = src[3] / 255.0f;
+		}
+	}
+
+	// RGBA float row back to RGBA8, clamped (Kaiser can overshoot)
+	void FloatToRow(const float* src, uint width, MIP_DATA data, uint8_t* dst)
+	{
+		const FilterTables& tables = GetTables();
+		const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+		const __m128 to_bytes = _mm_set1_ps(255.0f), to_table = _mm_set1_ps((float)(s_LinearToSRGBSize - 1));
+
+		for (uint x = 0; x < width; ++x, src += 4, dst += 4)
+		{
+			__m128 pixel = _mm_loadu_ps(src);
+
+			if (data == MIP_DATA::NORMAL)
+			{
+				// Decode, renormalize & encode XYZ (averaged unit vectors get shorter)
+				__m128 normal = _mm_sub_ps(_mm_mul_ps(pixel, _mm_set1_ps(2.0f)), one);
+				__m128 squared = _mm_mul_ps(normal, normal);
+				float length_sq = _mm_cvtss_f32(squared) + _mm_cvtss_f32(_mm_shuffle_ps(squared, squared, 1)) + _mm_cvtss_f32(_mm_shuffle_ps(squared, squared, 2));
+				if (length_sq > 1e-8f)
+				{
+					__m128 normalized = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(normal, _mm_set1_ps(1.0f / sqrtf(length_sq))), _mm_set1_ps(0.5f)), _mm_set1_ps(0.5f));
+					pixel = _mm_shuffle_ps(normalized, _mm_unpackhi_ps(normalized, pixel), _MM_SHUFFLE(3, 0, 1, 0)); // XYZ normalized, W (alpha) untouched
+				}
+			}
+
+			pixel = _mm_min_ps(_mm_max_ps(pixel, zero), one);
+
+			if (data == MIP_DATA::COLOR)
+			{
+				// RGB through the table, alpha is linear
+				alignas(16) int indices[4], bytes[4];
+				_mm_store_si128((__m128i*)indices, _mm_cvtps_epi32(_mm_mul_ps(pixel, to_table)));
+				_mm_store_si128((__m128i*)bytes, _mm_cvtps_epi32(_mm_mul_ps(pixel, to_bytes)));
+				dst[0] = tables.LinearToSRGB[indices[0]];
+				dst[1] = tables.LinearToSRGB[indices[1]];
+				dst[2] = tables.LinearToSRGB[indices[2]];
+				dst[3] = (uint8_t)bytes[3];
+			}
+			else
+			{
+				// Packs to bytes with saturation, rounding to nearest
+				__m128i ints = _mm_cvtps_epi32(_mm_mul_ps(pixel, to_bytes));
+				ints = _mm_packs_epi32(ints, ints);
+				ints = _mm_packus_epi16(ints, ints);
+				*(int*)dst = _mm_cvtsi128_si32(ints);
+			}
+		}
+	}
+
+
+	// --- Filters ---
+	void DownsampleBox(const uint8_t* src, uint width, uint height, uint8_t* dst, MIP_DATA data)
+	{
+		const uint dst_width = MipmapUtils::GetNextLevelSize(width), dst_height = MipmapUtils::GetNextLevelSize(height);
+		std::vector<float> row0(width * 4), row1(width * 4), out_row(dst_width * 4);
+		const __m128 quarter = _mm_set1_ps(0.25f);
+
+		for (uint y = 0; y < dst_height; ++y)
+		{
+			RowToFloat(src + (size_t)std::min(y * 2, height - 1) * width * 4, width, data, row0.data());
+			RowToFloat(src + (size_t)std::min(y * 2 + 1, height - 1) * width * 4, width, data, row1.data());
+
+			uint x = 0;
+#if defined(__AVX2__)
+			// 2 output pixels per iteration: sum rows of 4 source pixels, then add the even & odd ones
+			const __m256 quarter_x2 = _mm256_set1_ps(0.25f);
+			for (; x + 1 < dst_width && x * 2 + 3 < width; x += 2)
+			{
+				__m256 a = _mm256_add_ps(_mm256_loadu_ps(&row0[x * 8]), _mm256_loadu_ps(&row1[x * 8]));
+				__m256 b = _mm256_add_ps(_mm256_loadu_ps(&row0[x * 8 + 8]), _mm256_loadu_ps(&row1[x * 8 + 8]));
+				__m256 sum = _mm256_add_ps(_mm256_permute2f128_ps(a, b, 0x20), _mm256_permute2f128_ps(a, b, 0x31));
+				_mm256_storeu_ps(&out_row[x * 4], _mm256_mul_ps(sum, quarter_x2));
+			}
+#endif
+			for (; x < dst_width; ++x)
+			{
+				uint x0 = std::min(x * 2, width - 1) * 4, x1 = std::min(x * 2 + 1, width - 1) * 4;
+				__m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(&row0[x0]), _mm_loadu_ps(&row0[x1])), _mm_add_ps(_mm_loadu_ps(&row1[x0]), _mm_loadu_ps(&row1[x1])));
+				_mm_storeu_ps(&out_row[x * 4], _mm_mul_ps(sum, quarter));
+			}
+
+			FloatToRow(out_row.data(), dst_width, data, dst + (size_t)y * dst_width * 4);
+		}
+	}
+
+
+	void DownsampleKaiser(const uint8_t* src, uint width, uint height, uint8_t* dst, MIP_DATA data)
+	{
+		const uint dst_width = MipmapUtils::GetNextLevelSize(width), dst_height = MipmapUtils::GetNextLevelSize(height);
+		const float* weights = GetTables().KaiserWeights;
+		const int half_taps = s_KaiserTaps / 2;
+
+		// -- Horizontally Filtered Rows Cache --
+		// Each source row feeds 3 output rows, so rows are filtered once & kept in a ring (a window never has 2 rows in the same slot)
+		std::vector<float> src_row(width * 4), out_row(dst_width * 4);
+		std::vector<float> filtered_rows(s_KaiserTaps * dst_width * 4);
+		int filtered_tags[s_KaiserTaps];
+		std::fill(filtered_tags, filtered_tags + s_KaiserTaps, -1);
+
+		auto get_filtered_row = [&](int row) -> const float*
+		{
+			float* filtered = &filtered_rows[(row % s_KaiserTaps) * dst_width * 4];
+			if (filtered_tags[row % s_KaiserTaps] == row)
+				return filtered;
+
+			RowToFloat(src + (size_t)row * width * 4, width, data, src_row.data());
+			for (uint x = 0; x < dst_width; ++x)
+			{
+				__m128 sum = _mm_setzero_ps();
+				for (int t = 0; t < s_KaiserTaps; ++t)
+				{
+					int source_x = std::min(std::max((int)x * 2 - half_taps + 1 + t, 0), (int)width - 1);
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(&src_row[source_x * 4]), _mm_set1_ps(weights[t])));
+				}
+
+				_mm_storeu_ps(&filtered[x * 4], sum);
+			}
+
+			filtered_tags[row % s_KaiserTaps] = row;
+			return filtered;
+		};
+
+		// -- Vertical Pass --
+		for (uint y = 0; y < dst_height; ++y)
+		{
+			const float* rows[s_KaiserTaps];
+			for (int t = 0; t < s_KaiserTaps; ++t)
+				rows[t] = get_filtered_row(std::min(std::max((int)y * 2 - half_taps + 1 + t, 0), (int)height - 1));
+
+			uint i = 0;
+#if defined(__AVX2__)
+			for (; i + 8 <= dst_width * 4; i += 8)
+			{
+				__m256 sum = _mm256_setzero_ps();
+				for (int t = 0; t < s_KaiserTaps; ++t)
+					sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(rows[t] + i), _mm256_set1_ps(weights[t])));
+
+				_mm256_storeu_ps(&out_row[i], sum);
+			}
+#endif
+			for (; i < dst_width * 4; i += 4)
+			{
+				__m128 sum = _mm_setzero_ps();
+				for (int t = 0; t < s_KaiserTaps; ++t)
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(rows[t] + i), _mm_set1_ps(weights[t])));
+
+				_mm_storeu_ps(&out_row[i], sum);
+			}
+
+			FloatToRow(out_row.data(), dst_width, data, dst + (size_t)y * dst_width * 4);
+		}
+	}
+}
+
+
+
+// ------------------------------------------------------------------------------
+void MipmapUtils::Downsample(const uint8_t* src, uint width, uint height, uint8_t* dst, MIP_FILTER filter, MIP_DATA data)
+{
+	if (filter == MIP_FILTER::KAISER)
+		DownsampleKaiser(src, width, height, dst, data);
+	else
+		DownsampleBox(src, width, height, dst, data);
+}
@@ -0,0 +1,32 @@
+#ifndef _MIPMAPUTILS_H_
+#define _MIPMAPUTILS_H_
+
+#include "Core/Globals.h"
+
+
+// CPU mip generation for RGBA8 images, filtering in float with SSE2 (AVX2 if the build targets it)
+namespace MipmapUtils
+{
+	// Box: 2x2 average - Kaiser: 6x6 Kaiser-windowed sinc, sharper mips without aliasing (for color)
+	enum class MIP_FILTER { BOX = 0, KAISER };
+
+	// Color: filtered in linear space (sRGB decoded, alpha kept linear) - Normal: [0, 1] encoded vectors, renormalized after filtering
+	enum class MIP_DATA { LINEAR = 0, COLOR, NORMAL };
+
+	// Levels of a full chain down to 1x1
+	inline uint GetLevelsCount(uint width, uint height)
+	{
+		uint levels = 1;
+		for (uint size = width > height ? width : height; size > 1; size /= 2)
+			++levels;
+
+		return levels;
+	}
+
+	inline uint GetNextLevelSize(uint size) { return size > 1 ? size / 2 : 1; }
+
+	// Writes the next level (GetNextLevelSize() of each dimension) of an RGBA8 image into dst
+	void Downsample(const uint8_t* src, uint width, uint height, uint8_t* dst, MIP_FILTER filter, MIP_DATA data);
+}
+
+#endif //_MIPMAPUTILS_H_
@@ -59,11 +59,26 @@ public:
 		//glBindTexture(GL_TEXTURE_2D, 0);
 	};
 
+	inline static void DrawIndexedRange(uint index_count, uint first_index = 0)
+	{
+		glDrawElements(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, (const void*)((uint64)first_index * sizeof(uint)));
+	}
+
 	inline static void DrawTriangles(uint index_count = 0)
 	{
 		glDrawArrays(GL_TRIANGLES, 0, index_count);
 	}
 
+	// Commands (DrawElementsIndirectCommand) from the bound GL_DRAW_INDIRECT_BUFFER, their count read from the bound GL_PARAMETER_BUFFER
+	inline static void DrawIndexedIndirectCount(uint64 commands_offset, uint64 count_offset, uint max_draws)
+	{
+		glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*)commands_offset, (GLintptr)count_offset, max_draws, 0);
+	}
+
+	// --- Compute ---
+	inline static void DispatchCompute(uint groups_x, uint groups_y = 1, uint groups_z = 1)	{ glDispatchCompute(groups_x, groups_y, groups_z); }
+	inline static void InsertMemoryBarrier(uint barriers)									{ glMemoryBarrier(barriers); }
+
 private:
 
 	static bool m_BlendEnabled, m_DepthTestEnabled, m_ScissorTestEnabled, m_CubemapSeamless, m_FaceCulling;
@@ -95,6 +95,8 @@ namespace RendererUtils
 			return GL_VERTEX_SHADER;
 		if (shader_type_str == "FRAGMENT_SHADER" || shader_type_str == "PIXEL_SHADER")
 			return GL_FRAGMENT_SHADER;
+		if (shader_type_str == "COMPUTE_SHADER")
+			return GL_COMPUTE_SHADER;
 
 		ASSERT(false, "Unknown Shader Type '%s'", shader_type_str.c_str());
 		return 0;
@@ -106,6 +108,8 @@ namespace RendererUtils
 			return "Vertex";
 		if (shader_type == GL_FRAGMENT_SHADER)
 			return "Fragment/Pixel";
+		if (shader_type == GL_COMPUTE_SHADER)
+			return "Compute";
 
 		ASSERT(false, "Unknown Shader Type '%i'", (int)shader_type);
 		return 0;
@@ -140,6 +144,8 @@ namespace RendererUtils
 	// ------------------------------------------------------------------------------
 	// ----- Framebuffer Stuff -----
 	static const uint s_MaxFBOSize = 8192; // Hardcoded because we don't have a Renderer-Capabilities system
+	static const float s_FBOGrowthFactor = 1.5f;	// Capacity growth when a FBO has to be resized bigger than what it has allocated
+	static const uint s_FBOShrinkDelayFrames = 30;	// Frames a FBO size has to be stable before its capacity is shrunk
 
 	enum class FBO_TEXTURE_FORMAT
 	{
@@ -169,6 +175,19 @@ namespace RendererUtils
 		return GL_NONE;
 	}
 
+	static uint FBOTextureFormatSize(FBO_TEXTURE_FORMAT format) // Bytes per pixel
+	{
+		switch (format)
+		{
+			case FBO_TEXTURE_FORMAT::DEPTH24STENCIL8:	return 4;
+			case FBO_TEXTURE_FORMAT::RGBA8:				return 4;
+			case FBO_TEXTURE_FORMAT::RGBA16:			return 8;
+			case FBO_TEXTURE_FORMAT::RGBA32:			return 16;
+		}
+
+		return 0;
+	}
+
 	static bool IsDepthFormatTexture(FBO_TEXTURE_FORMAT format)
 	{
 		switch (format)
@@ -178,6 +197,20 @@ namespace RendererUtils
 
 		return false;
 	}
+
+
+
+	// ------------------------------------------------------------------------------
+	// ----- Texture Uploads Stuff -----
+	static const uint s_TextureUploadBuffers = 3;					// Persistently mapped PBOs in the upload ring (frames an upload can be in flight)
+	static const uint s_TextureUploadBudget = 16 * 1024 * 1024;		// Max bytes of texture data uploaded per frame (size of each PBO)
+	static const float s_TextureMaxAnisotropy = 8.0f;				// Anisotropic filtering samples (clamped to what the GPU supports)
+	static const uint s_TextureStreamingMinSize = 64;				// Levels up to this size are always resident (loaded first), finer ones are streamed
+	static const uint64 s_TextureStreamingBudget = 512ull * 1024 * 1024;	// Default max bytes of VRAM for streamed textures (levels evicted past it)
+	static const bool s_TextureContentDeduplication = true;			// Byte-identical textures (same usage) under different paths share their GPU storage
+
+	// ----- GPU Memory Stuff -----
+	static const uint64 s_GPUMemoryBudget = 1024ull * 1024 * 1024;	// Default VRAM budget of all resources, past it Resources evicts the unreferenced ones
 }
 
 #endif //_RENDERERUTILS_H_
\ No newline at end of file
@@ -0,0 +1,483 @@
+#include "TextureCompression.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+
+
+// ------------------------------------------------------------------------------
+namespace
+{
+	// --- Helpers ---
+	inline int Clamp(int value, int min, int max) { return value < min ? min : (value > max ? max : value); }
+
+	// Main direction of the colors (first principal component), by power iteration over their covariance
+	template<uint N>
+	void PrincipalAxis(const float colors[16][4], float mean[N], float axis[N])
+	{
+		for (uint c = 0; c < N; ++c)
+		{
+			mean[c] = 0.0f;
+			for (uint i = 0; i < 16; ++i)
+				mean[c] += colors[i][c];
+
+			mean[c] /= 16.0f;
+		}
+
+		float covariance[N][N] = {};
+		for (uint i = 0; i < 16; ++i)
+			for (uint a = 0; a < N; ++a)
+				for (uint b = 0; b < N; ++b)
+					covariance[a][b] += (colors[i][a] - mean[a]) * (colors[i][b] - mean[b]);
+
+		// Start from the bounding box diagonal, it's usually close already
+		for (uint c = 0; c < N; ++c)
+		{
+			float min = colors[0][c], max = colors[0][c];
+			for (uint i = 1; i < 16; ++i)
+			{
+				min = std::min(min, colors[i][c]);
+				max = std::max(max, colors[i][c]);
+			}
+
+			axis[c] = max - min;
+		}
+
+		for (uint iteration = 0; iteration < 8; ++iteration)
+		{
+			float result[N] = {};
+			float length = 0.0f;
+			for (uint a = 0; a < N; ++a)
+			{
+				for (uint b = 0; b < N; ++b)
+					result[a] += covariance[a][b] * axis[b];
+
+				length = std::max(length, fabsf(result[a]));
+			}
+
+			if (length < 1e-6f)
+				break;
+
+			for (uint c = 0; c < N; ++c)
+				axis[c] = result[c] / length;
+		}
+
+		float length = 0.0f;
+		for (uint c = 0; c < N; ++c)
+			length += axis[c] * axis[c];
+
+		length = sqrtf(length);
+		for (uint c = 0; c < N; ++c)
+			axis[c] = length > 1e-6f ? axis[c] / length : 0.0f;
+	}
+
+	template<uint N>
+	void ProjectionExtremes(const float colors[16][4], const float mean[N], const float axis[N], float endpoint_max[N], float endpoint_min[N])
+	{
+		float min_t = FLT_MAX, max_t = -FLT_MAX;
+		for (uint i = 0; i < 16; ++i)
+		{
+			float t = 0.0f;
+			for (uint c = 0; c < N; ++c)
+				t += (colors[i][c] - mean[c]) * axis[c];
+
+			min_t = std::min(min_t, t);
+			max_t = std::max(max_t, t);
+		}
+
+		for (uint c = 0; c < N; ++c)
+		{
+			endpoint_max[c] = std::min(std::max(mean[c] + axis[c] * max_t, 0.0f), 255.0f);
+			endpoint_min[c] = std::min(std::max(mean[c] + axis[c] * min_t, 0.0f), 255.0f);
+		}
+	}
+
+	// Solves the endpoints that best fit the colors given each one's weight towards endpoint 0 (least squares)
+	template<uint N>
+	bool LeastSquaresEndpoints(const float colors[16][4], const float weights[16], float endpoint0[N], float endpoint1[N])
+	{
+		float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+		float ax[N] = {}, bx[N] = {};
+		for (uint i = 0; i < 16; ++i)
+		{
+			float a = weights[i], b = 1.0f - weights[i];
+			aa += a * a; bb += b * b; ab += a * b;
+			for (uint c = 0; c < N; ++c)
+			{
+				ax[c] += a * colors[i][c];
+				bx[c] += b * colors[i][c];
+			}
+		}
+
+		float determinant = aa * bb - ab * ab;
+		if (fabsf(determinant) < 1e-6f)
+			return false;
+
+		for (uint c = 0; c < N; ++c)
+		{
+			endpoint0[c] = std::min(std::max((ax[c] * bb - bx[c] * ab) / determinant, 0.0f), 255.0f);
+			endpoint1[c] = std::min(std::max((bx[c] * aa - ax[c] * ab) / determinant, 0.0f), 255.0f);
+		}
+
+		return true;
+	}
+
+	void ToFloatColors(const uint8_t* block_rgba, float colors[16][4])
+	{
+		for (uint i = 0; i < 16; ++i)
+			for (uint c = 0; c < 4; ++c)
+				colors[i][c] = (float)block_rgba[i * 4 + c];
+	}
+
+
+
+	// --- BC1 ---
+	inline uint16_t PackRGB565(const float color[3])
+	{
+		int r = Clamp((int)(color[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+		int g = Clamp((int)(color[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+		int b = Clamp((int)(color[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	inline void UnpackRGB565(uint16_t color, int rgb[3])
+	{
+		int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+		rgb[0] = (r << 3) | (r >> 2);
+		rgb[1] = (g << 2) | (g >> 4);
+		rgb[2] = (b << 3) | (b >> 2);
+	}
+
+	// Picks the closest of the 4 colors (4-color mode) for each pixel, returns the total squared error
+	float BC1Indices(const float colors[16][4], uint16_t c0, uint16_t c1, uint indices[16])
+	{
+		int palette[4][3];
+		UnpackRGB565(c0, palette[0]);
+		UnpackRGB565(c1, palette[1]);
+		for (uint c = 0; c < 3; ++c)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		float total_error = 0.0f;
+		for (uint i = 0; i < 16; ++i)
+		{
+			float best_error = FLT_MAX;
+			for (uint p = 0; p < 4; ++p)
+			{
+				float error = 0.0f;
+				for (uint c = 0; c < 3; ++c)
+					error += (colors[i][c] - palette[p][c]) * (colors[i][c] - palette[p][c]);
+
+				if (error < best_error)
+				{
+					best_error = error;
+					indices[i] = p;
+				}
+			}
+
+			total_error += best_error;
+		}
+
+		return total_error;
+	}
+
+	void WriteBC1Block(uint16_t c0, uint16_t c1, uint indices[16], uint8_t* dst)
+	{
+		// c0 > c1 selects the 4-color mode, swapping endpoints swaps indices 0<->1 & 2<->3
+		if (c0 < c1)
+		{
+			std::swap(c0, c1);
+			for (uint i = 0; i < 16; ++i)
+				indices[i] ^= 1;
+		}
+		else if (c0 == c1)
+		{
+			for (uint i = 0; i < 16; ++i)
+				indices[i] = 0;
+		}
+
+		uint packed_indices = 0;
+		for (uint i = 0; i < 16; ++i)
+			packed_indices |= indices[i] << (i * 2);
+
+		dst[0] = (uint8_t)(c0 & 0xFF); dst[1] = (uint8_t)(c0 >> 8);
+		dst[2] = (uint8_t)(c1 & 0xFF); dst[3] = (uint8_t)(c1 >> 8);
+		memcpy(dst + 4, &packed_indices, 4);
+	}
+
+
+
+	// --- BC7 (Mode 6: single subset, RGBA 7.7.7.7 endpoints + unique p-bit, 4-bit indices) ---
+	static const int s_BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	struct BC7Endpoint { int Quantized[4]; int PBit; int Value[4]; };
+
+	BC7Endpoint QuantizeBC7Endpoint(const float endpoint[4])
+	{
+		BC7Endpoint best = {};
+		float best_error = FLT_MAX;
+		for (int p = 0; p < 2; ++p)
+		{
+			BC7Endpoint candidate = {};
+			candidate.PBit = p;
+			float error = 0.0f;
+			for (uint c = 0; c < 4; ++c)
+			{
+				candidate.Quantized[c] = Clamp((int)((endpoint[c] - p) / 2.0f + 0.5f), 0, 127);
+				candidate.Value[c] = (candidate.Quantized[c] << 1) | p;
+				error += (candidate.Value[c] - endpoint[c]) * (candidate.Value[c] - endpoint[c]);
+			}
+
+			if (error < best_error)
+			{
+				best_error = error;
+				best = candidate;
+			}
+		}
+
+		return best;
+	}
+
+	float BC7Indices(const float colors[16][4], const BC7Endpoint& e0, const BC7Endpoint& e1, uint indices[16])
+	{
+		int palette[16][4];
+		for (uint p = 0; p < 16; ++p)
+			for (uint c = 0; c < 4; ++c)
+				palette[p][c] = ((64 - s_BC7Weights[p]) * e0.Value[c] + s_BC7Weights[p] * e1.Value[c] + 32) >> 6;
+
+		float total_error = 0.0f;
+		for (uint i = 0; i < 16; ++i)
+		{
+			float best_error = FLT_MAX;
+			for (uint p = 0; p < 16; ++p)
+			{
+				float error = 0.0f;
+				for (uint c = 0; c < 4; ++c)
+					error += (colors[i][c] - palette[p][c]) * (colors[i][c] - palette[p][c]);
+
+				if (error < best_error)
+				{
+					best_error = error;
+					indices[i] = p;
+				}
+			}
+
+			total_error += best_error;
+		}
+
+		return total_error;
+	}
+
+	struct BitWriter
+	{
+		uint8_t* Data;
+		uint Position = 0;
+
+		void Write(uint value, uint bits)
+		{
+			for (uint i = 0; i < bits; ++i, ++Position)
+				if (value & (1u << i))
+					Data[Position >> 3] |= (uint8_t)(1u << (Position & 7));
+		}
+	};
+}
+
+
+
+// ------------------------------------------------------------------------------
+void TextureCompression::CompressBlockBC1(const uint8_t* block_rgba, uint8_t* dst)
+{
+	float colors[16][4];
+	ToFloatColors(block_rgba, colors);
+
+	// -- Endpoints along the Main Axis --
+	// Inset a bit, since extremes are rarely the best endpoints once quantized
+	float mean[3], axis[3], endpoint0[3], endpoint1[3];
+	PrincipalAxis<3>(colors, mean, axis);
+	ProjectionExtremes<3>(colors, mean, axis, endpoint0, endpoint1);
+
+	for (uint c = 0; c < 3; ++c)
+	{
+		float inset = (endpoint0[c] - endpoint1[c]) / 16.0f;
+		endpoint0[c] -= inset;
+		endpoint1[c] += inset;
+	}
+
+	uint16_t c0 = PackRGB565(endpoint0), c1 = PackRGB565(endpoint1);
+	uint indices[16];
+	float error = BC1Indices(colors, c0, c1, indices);
+
+	// -- Refine Endpoints for the chosen Indices --
+	static const float s_IndexWeights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+	float weights[16];
+	for (uint i = 0; i < 16; ++i)
+		weights[i] = s_IndexWeights[indices[i]];
+
+	if (LeastSquaresEndpoints<3>(colors, weights, endpoint0, endpoint1))
+	{
+		uint16_t refined_c0 = PackRGB565(endpoint0), refined_c1 = PackRGB565(endpoint1);
+		uint refined_indices[16];
+		if (BC1Indices(colors, refined_c0, refined_c1, refined_indices) < error)
+		{
+			c0 = refined_c0; c1 = refined_c1;
+			memcpy(indices, refined_indices, sizeof(indices));
+		}
+	}
+
+	WriteBC1Block(c0, c1, indices, dst);
+}
+
+
+void TextureCompression::CompressBlockBC4(const uint8_t* block_rgba, uint channel, uint8_t* dst)
+{
+	// -- Endpoints --
+	// Max as first endpoint selects the 8-values mode (a flat block works with any mode)
+	int min = 255, max = 0;
+	for (uint i = 0; i < 16; ++i)
+	{
+		min = std::min(min, (int)block_rgba[i * 4 + channel]);
+		max = std::max(max, (int)block_rgba[i * 4 + channel]);
+	}
+
+	int palette[8] = { max, min };
+	for (int i = 1; i < 7; ++i)
+		palette[i + 1] = ((7 - i) * max + i * min) / 7;
+
+	// -- Indices --
+	uint64 packed_indices = 0;
+	for (uint i = 0; i < 16; ++i)
+	{
+		int value = block_rgba[i * 4 + channel];
+		uint best_index = 0;
+		int best_error = INT_MAX;
+		for (uint p = 0; p < 8; ++p)
+		{
+			int error = abs(value - palette[p]);
+			if (error < best_error)
+			{
+				best_error = error;
+				best_index = p;
+			}
+		}
+
+		packed_indices |= (uint64)best_index << (i * 3);
+	}
+
+	dst[0] = (uint8_t)max;
+	dst[1] = (uint8_t)min;
+	for (uint i = 0; i < 6; ++i)
+		dst[2 + i] = (uint8_t)(packed_indices >> (i * 8));
+}
+
+
+void TextureCompression::CompressBlockBC3(const uint8_t* block_rgba, uint8_t* dst)
+{
+	CompressBlockBC4(block_rgba, 3, dst);
+	CompressBlockBC1(block_rgba, dst + 8);
+}
+
+void TextureCompression::CompressBlockBC5(const uint8_t* block_rgba, uint8_t* dst)
+{
+	CompressBlockBC4(block_rgba, 0, dst);
+	CompressBlockBC4(block_rgba, 1, dst + 8);
+}
+
+
+void TextureCompression::CompressBlockBC7(const uint8_t* block_rgba, uint8_t* dst)
+{
+	float colors[16][4];
+	ToFloatColors(block_rgba, colors);
+
+	// -- Endpoints along the Main Axis --
+	float mean[4], axis[4], endpoint0[4], endpoint1[4];
+	PrincipalAxis<4>(colors, mean, axis);
+	ProjectionExtremes<4>(colors, mean, axis, endpoint0, endpoint1);
+
+	BC7Endpoint e0 = QuantizeBC7Endpoint(endpoint0), e1 = QuantizeBC7Endpoint(endpoint1);
+	uint indices[16];
+	float error = BC7Indices(colors, e0, e1, indices);
+
+	// -- Refine Endpoints for the chosen Indices --
+	float weights[16];
+	for (uint i = 0; i < 16; ++i)
+		weights[i] = 1.0f - s_BC7Weights[indices[i]] / 64.0f;
+
+	if (LeastSquaresEndpoints<4>(colors, weights, endpoint0, endpoint1))
+	{
+		BC7Endpoint refined_e0 = QuantizeBC7Endpoint(endpoint0), refined_e1 = QuantizeBC7Endpoint(endpoint1);
+		uint refined_indices[16];
+		if (BC7Indices(colors, refined_e0, refined_e1, refined_indices) < error)
+		{
+			e0 = refined_e0; e1 = refined_e1;
+			memcpy(indices, refined_indices, sizeof(indices));
+		}
+	}
+
+	// -- Anchor Index --
+	// First index is stored without its top bit, so it must be < 8 (swapping endpoints inverts the indices)
+	if (indices[0] & 8)
+	{
+		std::swap(e0, e1);
+		for (uint i = 0; i < 16; ++i)
+			indices[i] = 15 - indices[i];
+	}
+
+	// -- Write Block --
+	memset(dst, 0, 16);
+	BitWriter writer = { dst };
+	writer.Write(1 << 6, 7); // Mode 6
+
+	for (uint c = 0; c < 4; ++c)
+	{
+		writer.Write(e0.Quantized[c], 7);
+		writer.Write(e1.Quantized[c], 7);
+	}
+
+	writer.Write(e0.PBit, 1);
+	writer.Write(e1.PBit, 1);
+
+	writer.Write(indices[0], 3);
+	for (uint i = 1; i < 16; ++i)
+		writer.Write(indices[i], 4);
+}
+
+
+
+// ------------------------------------------------------------------------------
+void TextureCompression::CompressImage(BC_FORMAT format, const uint8_t* rgba, uint width, uint height, uint8_t* dst)
+{
+	const uint block_size = GetBlockSize(format);
+	uint8_t block[16 * 4];
+
+	for (uint block_y = 0; block_y < height; block_y += 4)
+	{
+		for (uint block_x = 0; block_x < width; block_x += 4)
+		{
+			// -- Gather Block Pixels --
+			for (uint y = 0; y < 4; ++y)
+			{
+				uint pixel_y = std::min(block_y + y, height - 1);
+				for (uint x = 0; x < 4; ++x)
+				{
+					uint pixel_x = std::min(block_x + x, width - 1);
+					memcpy(block + (y * 4 + x) * 4, rgba + ((size_t)pixel_y * width + pixel_x) * 4, 4);
+				}
+			}
+
+			// -- Compress --
+			switch (format)
+			{
+				case BC_FORMAT::BC1:	CompressBlockBC1(block, dst);		break;
+				case BC_FORMAT::BC3:	CompressBlockBC3(block, dst);		break;
+				case BC_FORMAT::BC4:	CompressBlockBC4(block, 0, dst);	break;
+				case BC_FORMAT::BC5:	CompressBlockBC5(block, dst);		break;
+				case BC_FORMAT::BC7:	CompressBlockBC7(block, dst);		break;
+				default:				ASSERT(false, "Invalid BC Format!");
+			}
+
+			dst += block_size;
+		}
+	}
+}
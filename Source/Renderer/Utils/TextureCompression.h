@@ -0,0 +1,57 @@
+#ifndef _TEXTURECOMPRESSION_H_
+#define _TEXTURECOMPRESSION_H_
+
+#include "Core/Globals.h"
+#include <glad/glad.h>
+
+// S3TC formats are an extension (supported everywhere on desktop), so glad doesn't have them
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+	#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+	#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+
+// CPU block-compression encoders (4x4 pixel blocks) for GPU textures
+namespace TextureCompression
+{
+	// BC1: RGB, 4bpp (albedo w/o alpha) - BC3: RGBA, 8bpp - BC4: R, 4bpp (height) - BC5: RG, 8bpp (normals) - BC7: RGBA, 8bpp, best quality
+	enum class BC_FORMAT { NONE = 0, BC1, BC3, BC4, BC5, BC7 };
+
+	// --- Format Stuff ---
+	inline uint GetBlockSize(BC_FORMAT format) { return (format == BC_FORMAT::BC1 || format == BC_FORMAT::BC4) ? 8 : 16; }
+
+	inline size_t GetCompressedSize(BC_FORMAT format, uint width, uint height)
+	{
+		return (size_t)((width + 3) / 4) * (size_t)((height + 3) / 4) * GetBlockSize(format);
+	}
+
+	inline GLenum GetGLFormat(BC_FORMAT format)
+	{
+		switch (format)
+		{
+			case BC_FORMAT::BC1:	return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+			case BC_FORMAT::BC3:	return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+			case BC_FORMAT::BC4:	return GL_COMPRESSED_RED_RGTC1;
+			case BC_FORMAT::BC5:	return GL_COMPRESSED_RG_RGTC2;
+			case BC_FORMAT::BC7:	return GL_COMPRESSED_RGBA_BPTC_UNORM;
+			case BC_FORMAT::NONE:	ASSERT(false, "BC_FORMAT::NONE has no GL format!"); break;
+		}
+
+		return 0;
+	}
+
+	// --- Compression ---
+	// Compresses an RGBA8 image into dst (GetCompressedSize() bytes), edge blocks of non multiple of 4 sizes repeat their last pixels
+	void CompressImage(BC_FORMAT format, const uint8_t* rgba, uint width, uint height, uint8_t* dst);
+
+	// Single blocks, from 16 RGBA8 pixels
+	void CompressBlockBC1(const uint8_t* block_rgba, uint8_t* dst);
+	void CompressBlockBC3(const uint8_t* block_rgba, uint8_t* dst);
+	void CompressBlockBC4(const uint8_t* block_rgba, uint channel, uint8_t* dst);
+	void CompressBlockBC5(const uint8_t* block_rgba, uint8_t* dst);
+	void CompressBlockBC7(const uint8_t* block_rgba, uint8_t* dst);
+}
+
+#endif //_TEXTURECOMPRESSION_H_
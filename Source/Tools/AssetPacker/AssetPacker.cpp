@@ -0,0 +1,45 @@
+#include "Core/Globals.h"
+#include "Core/Resources/AssetPack.h"
+
+#include <filesystem>
+
+
+// ----------------------- Asset Packer ---------------------------------------------------------------
+// Builds an asset pack the engine mounts at startup. Run it from the engine's root directory, so packed paths match the loaded ones
+// Usage: AssetPacker [-o output.agppack] [--no-compression] [files or directories...] (packs 'Resources' by default)
+int main(int argc, char** argv)
+{
+    // -- Parse Arguments --
+    std::string output_filepath = AssetPack::s_DefaultFilepath;
+    std::vector<std::string> inputs;
+    bool compress = true;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc)
+            output_filepath = argv[++i];
+        else if (arg == "--no-compression")
+            compress = false;
+        else
+            inputs.push_back(arg);
+    }
+
+    if (inputs.empty())
+        inputs.push_back("Resources");
+
+    // -- Add Inputs --
+    AssetPackBuilder builder;
+    for (const std::string& input : inputs)
+    {
+        if (std::filesystem::is_directory(input))
+            builder.AddDirectory(input);
+        else if (std::filesystem::is_regular_file(input))
+            builder.AddFile(input);
+        else
+            ENGINE_LOG("Input '%s' doesn't exist, skipping it", input.c_str());
+    }
+
+    // -- Build Pack --
+    return builder.Build(output_filepath, compress) ? 0 : 1;
+}